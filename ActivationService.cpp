@@ -0,0 +1,105 @@
+// File: ActivationService.cpp
+// Version: 1.1
+// -------------------------------------------------------------------------
+// This file implements ActivationService (see ActivationService.h).
+// -------------------------------------------------------------------------
+
+#include "ActivationService.h"
+#include "WindowUtils.h"  // For GetWindowHandleByFileName()
+#include "TextMatch.h"    // For EqualsNoCase()
+#include "WindowResolver.h" // For WindowResolverRegistry
+#include <algorithm>
+#include <fstream>
+
+static bool IsUrlFile(const std::wstring &filePath) {
+    return filePath.size() >= 4 && EqualsNoCase(filePath.c_str() + filePath.size() - 4, L".url", 4);
+}
+
+UrlTarget ActivationService::GetUrl(const std::wstring &filePath, ULONGLONG lastWriteTime, std::wstring &url) {
+    if (!IsUrlFile(filePath))
+        return UrlTarget::NotUrl;
+    Entry &entry = m_entries[filePath];
+    if (lastWriteTime == 0 || entry.urlWriteTime != lastWriteTime) {
+        std::wifstream ifs(filePath.c_str());
+        if (!ifs)
+            return UrlTarget::Unreadable; // Not cached; the next activation tries again.
+        entry.url.clear();
+        entry.urlTarget = UrlTarget::Missing;
+        std::wstring line;
+        while (std::getline(ifs, line)) {
+            if (line.find(L"URL=") == 0) {
+                entry.url = line.substr(4);
+                if (!entry.url.empty())
+                    entry.urlTarget = UrlTarget::Found;
+                break;
+            }
+        }
+        entry.urlWriteTime = lastWriteTime;
+    }
+    if (entry.urlTarget == UrlTarget::Found)
+        url = entry.url;
+    return entry.urlTarget;
+}
+
+bool ActivationService::IsVerified(const std::wstring &filePath, HWND hwnd, ULONGLONG generation) const {
+    auto it = m_entries.find(filePath);
+    return it != m_entries.end() && it->second.hwnd == hwnd && it->second.generation == generation;
+}
+
+void ActivationService::SetVerified(const std::wstring &filePath, HWND hwnd, ULONGLONG generation) {
+    Entry &entry = m_entries[filePath];
+    entry.hwnd = hwnd;
+    entry.generation = generation;
+}
+
+HWND ActivationService::FindFileWindow(const std::wstring &filePath, int fileIndex,
+                                       const WindowSnapshot &snapshot, const TitleMatchResult &matches) {
+    const WindowResolverRegistry &resolvers = WindowResolverRegistry::Shared();
+    std::wstring fileName = filePath.substr(filePath.find_last_of(L'\\') + 1);
+    Entry &entry = m_entries[filePath];
+    if (entry.hwnd && IsWindow(entry.hwnd)) {
+        if (entry.generation == snapshot.generation)
+            return entry.hwnd;
+        // A newer snapshot: the window still qualifies if its title still contains
+        // the name, or if it still meets the rule that resolved it.
+        int row = snapshot.FindWindowIndex(entry.hwnd);
+        bool stillMatches = false;
+        if (row >= 0 && entry.resolver >= 0) {
+            stillMatches = resolvers.Matches(entry.resolver, snapshot.windows, row,
+                                             resolvers.GetTitleKey(entry.resolver, fileName));
+        } else if (row >= 0 && fileIndex >= 0 && row < static_cast<int>(matches.windowFiles.size())) {
+            const std::vector<int> &files = matches.windowFiles[row];
+            stillMatches = std::find(files.begin(), files.end(), fileIndex) != files.end();
+        }
+        if (stillMatches) {
+            entry.generation = snapshot.generation;
+            return entry.hwnd;
+        }
+    }
+    HWND hwnd = nullptr;
+    int resolver = -1;
+    if (fileIndex >= 0 && fileIndex < static_cast<int>(matches.fileWindows.size()))
+        hwnd = matches.fileWindows[fileIndex];
+    if (!hwnd || !IsWindow(hwnd)) {
+        int rule = resolvers.FindRule(filePath);
+        if (rule >= 0) {
+            std::wstring titleKey = resolvers.GetTitleKey(rule, fileName);
+            int row = resolvers.FindInTable(rule, snapshot.windows, titleKey);
+            hwnd = (row >= 0) ? snapshot.windows.GetHwnd(row) : nullptr;
+            // The window may be newer than the snapshot; only the rule's class is read.
+            if (!hwnd || !IsWindow(hwnd))
+                hwnd = resolvers.FindOnDesktop(rule, titleKey);
+            if (hwnd)
+                resolver = rule;
+        } else {
+            // The window may be newer than the snapshot.
+            hwnd = GetWindowHandleByFileName(fileName);
+        }
+    }
+    entry.hwnd = hwnd;
+    entry.generation = hwnd ? snapshot.generation : 0;
+    entry.resolver = resolver;
+    return hwnd;
+}
+
+// End of file: ActivationService.cpp (Version: 1.1)
@@ -0,0 +1,83 @@
+// File: ActivationService.h
+// Version: 1.1
+// -------------------------------------------------------------------------
+// This header declares ActivationService, the resolution cache behind
+// TrackerEngine::OpenFile().
+//
+// Opening a file used to re-read everything on every activation: a .url
+// file was parsed again, a tracked window's fingerprint was read from the
+// other process, and an untracked file enumerated the desktop. The service
+// keeps, per file path, the last window verified for the file with the
+// snapshot generation it was verified against, and the parsed URL= target
+// of a .url file with the last write time it was parsed at. A repeated
+// activation against the same snapshot is then a hash lookup plus the
+// caller's IsWindow() check; a newer snapshot re-verifies the window from
+// the snapshot's title matches instead of enumerating windows.
+//
+// Changes in Version 1.1:
+//  - Files with a WindowResolverRegistry rule (e.g. Office documents) are
+//    resolved by the rule against the snapshot, and on a miss by one live
+//    pass of the rule instead of a whole-desktop title scan. The entry keeps
+//    the rule, so a newer snapshot re-verifies the window with it.
+//
+// All methods are called on the engine's thread.
+// -------------------------------------------------------------------------
+
+#ifndef ACTIVATIONSERVICE_H
+#define ACTIVATIONSERVICE_H
+
+#include <windows.h>
+#include <string>
+#include <unordered_map>
+#include "WindowSnapshotWorker.h" // For WindowSnapshot
+#include "TitleMatcher.h"         // For TitleMatchResult
+
+// Result of ActivationService::GetUrl().
+enum class UrlTarget {
+    NotUrl,     ///< Not a .url file.
+    Found,      ///< url holds the URL= target.
+    Missing,    ///< A .url file without a URL= line.
+    Unreadable  ///< The .url file could not be opened.
+};
+
+class ActivationService {
+public:
+    // Returns the URL= target of a .url file in url. The file is parsed only
+    // when lastWriteTime differs from the one of the cached target (0 means
+    // unknown and always parses).
+    UrlTarget GetUrl(const std::wstring &filePath, ULONGLONG lastWriteTime, std::wstring &url);
+
+    // True if hwnd was verified as the window of filePath against the
+    // snapshot generation.
+    bool IsVerified(const std::wstring &filePath, HWND hwnd, ULONGLONG generation) const;
+    void SetVerified(const std::wstring &filePath, HWND hwnd, ULONGLONG generation);
+
+    // Returns a window whose title contains the file name: the cached one if
+    // the snapshot still matches it, else the snapshot's first match, else the
+    // window the file's resolver rule finds (in the snapshot, then live), else
+    // the result of a desktop enumeration. fileIndex is the file's
+    // TitleMatcher index (-1 if unknown). Returns nullptr if no such window exists.
+    HWND FindFileWindow(const std::wstring &filePath, int fileIndex,
+                        const WindowSnapshot &snapshot, const TitleMatchResult &matches);
+
+    // Drops the cached resolution of a removed or renamed file, or of all files.
+    void Forget(const std::wstring &filePath) { m_entries.erase(filePath); }
+    void Clear() { m_entries.clear(); }
+
+private:
+    struct Entry {
+        HWND hwnd;                 ///< Last window verified for the file, or nullptr.
+        ULONGLONG generation;      ///< Snapshot generation hwnd was verified against.
+        ULONGLONG urlWriteTime;    ///< Last write time url was parsed at (0: not parsed).
+        UrlTarget urlTarget;       ///< Result of that parse.
+        std::wstring url;
+        int resolver;              ///< WindowResolverRegistry rule that found hwnd (-1: title match).
+        Entry() : hwnd(nullptr), generation(0), urlWriteTime(0), urlTarget(UrlTarget::NotUrl), resolver(-1) {}
+    };
+
+    std::unordered_map<std::wstring, Entry> m_entries;  ///< By file path.
+};
+
+#endif // ACTIVATIONSERVICE_H
+
+// End of file: ActivationService.h (Version: 1.1)
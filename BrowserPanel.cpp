@@ -1,11 +1,24 @@
 // File: BrowserPanel.cpp
-// Version: 1.3 (Removed WIL references, replaced with WRL::ComPtr usage to fix 'wil/com.h' not found)
+// Version: 1.5 (Shared environment, controller pool and tabs)
 // -------------------------------------------------------------------------
 // This file implements the BrowserPanel class, which hosts an embedded
 // WebView2 control without relying on WIL. All references to wil/com.h
 // have been removed or replaced by WRL::ComPtr. This way, we do not need
 // the Windows Implementation Library (WIL) installed.
 //
+// Changes in Version 1.5:
+// 1) The environment is the process-wide WebViewEnvironment (created once, with an
+//    explicit user data folder); its creation and tracing moved there.
+// 2) Controllers are created hidden into m_pool as soon as the panel exists and are
+//    handed to tabs; Navigate() opens or reuses a tab and queues its URL until the
+//    tab has a controller. Each creation keeps its own trace activity.
+// 3) Errors are shown once, and only while a tab is waiting; a failed pool refill
+//    is only logged. A later Navigate() retries.
+//
+// Changes in Version 1.4:
+// 1) Environment and controller creation are traced as the WebViewEnvironment and
+//    WebViewController phases (Tracing.h), from the call to its completion callback.
+//
 // Changes in Version 1.3:
 // 1) Removed #include <wil/com.h> and replaced wil::com_ptr with WRL::ComPtr.
 // 2) Added #include <wrl.h> and #include <wrl/client.h> for ComPtr.
@@ -20,14 +33,12 @@
 #include "BrowserPanel.h"
 #include <string>
 #include <sstream>
+#include <algorithm>
 #include <windows.h>
-#include <cstdio> // [TEST] Simple line to demonstrate patch
-#include <objbase.h>
-#include <shellapi.h>
 #include <commctrl.h>
-#include <shlwapi.h>
-#include "FingerprintUtils.h"
 #include "Config.h"
+#include "Tracing.h"
+#include "WebViewEnvironment.h"
 
 // For WRL
 #include <wrl.h>
@@ -43,10 +54,23 @@ static void LogDebug(const wchar_t* msg)
     OutputDebugStringW(L"\n");
 }
 
+// Tab caption: the host of url, or url itself if it has none.
+static std::wstring TabLabel(const std::wstring &url)
+{
+    size_t start = url.find(L"://");
+    start = (start == std::wstring::npos) ? 0 : start + 3;
+    size_t end = url.find_first_of(L"/?#", start);
+    std::wstring host = url.substr(start, end == std::wstring::npos ? std::wstring::npos : end - start);
+    return host.empty() ? url : host;
+}
+
 BrowserPanel::BrowserPanel()
     : m_hWnd(nullptr)
-    , m_controller(nullptr)
-    , m_webView(nullptr)
+    , m_hTabs(nullptr)
+    , m_currentTab(-1)
+    , m_creating(0)
+    , m_useCounter(0)
+    , m_errorShown(false)
 {
 }
 
@@ -57,12 +81,12 @@ BrowserPanel::~BrowserPanel()
 
 bool BrowserPanel::Create(HWND hParent, const RECT &rc)
 {
-    // Create a child window to represent this panel
+    // Create a hidden child window to represent this panel
     m_hWnd = CreateWindowEx(
         0,
         L"STATIC",
         L"BrowserPanel",
-        WS_CHILD | WS_VISIBLE,
+        WS_CHILD | WS_CLIPCHILDREN,
         rc.left,
         rc.top,
         rc.right - rc.left,
@@ -73,94 +97,42 @@ bool BrowserPanel::Create(HWND hParent, const RECT &rc)
         nullptr
     );
     if (!m_hWnd) {
-        MessageBox(hParent, L"Failed to create BrowserPanel window.", L"Error", MB_OK | MB_ICONERROR);
+        LogDebug(L"[BrowserPanel] Failed to create BrowserPanel window.");
         return false;
     }
     // Store a pointer to this class in GWLP_USERDATA
     SetWindowLongPtr(m_hWnd, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(this));
+    m_hTabs = CreateWindowEx(0, WC_TABCONTROL, L"", WS_CHILD | WS_VISIBLE | WS_CLIPSIBLINGS,
+                             0, 0, rc.right - rc.left, BROWSER_TAB_HEIGHT,
+                             m_hWnd, nullptr, GetModuleHandle(nullptr), nullptr);
+    SetWindowSubclass(m_hWnd, PanelProc, 1, reinterpret_cast<DWORD_PTR>(this));
+    m_alive = std::make_shared<bool>(true);
 
-    // Attempt to create the WebView2 environment
-    LogDebug(L"[BrowserPanel] Creating WebView2 environment...");
-    HRESULT hr = CreateCoreWebView2EnvironmentWithOptions(
-        nullptr, // browserExecutableFolder
-        nullptr, // userDataFolder
-        nullptr, // options
-        Microsoft::WRL::Callback<ICoreWebView2CreateCoreWebView2EnvironmentCompletedHandler>(
-            [this, hParent, rc](HRESULT result, ICoreWebView2Environment* env) -> HRESULT
-            {
-                if (FAILED(result)) {
-                    std::wstringstream ss;
-                    ss << L"[BrowserPanel] Failed to create WebView2 environment. HRESULT=0x"
-                       << std::hex << result;
-                    LogDebug(ss.str().c_str());
-                    MessageBox(hParent, ss.str().c_str(), L"WebView2 Error", MB_OK | MB_ICONERROR);
-                    return result;
-                }
-                LogDebug(L"[BrowserPanel] WebView2 environment created OK. Creating controller...");
-
-                // Create the WebView2 controller
-                env->CreateCoreWebView2Controller(m_hWnd,
-                    Microsoft::WRL::Callback<ICoreWebView2CreateCoreWebView2ControllerCompletedHandler>(
-                        [this, rc, hParent](HRESULT result, ICoreWebView2Controller* controller) -> HRESULT
-                        {
-                            if (FAILED(result) || !controller) {
-                                std::wstringstream ss;
-                                ss << L"[BrowserPanel] Failed to create WebView2 controller. HRESULT=0x"
-                                   << std::hex << result;
-                                LogDebug(ss.str().c_str());
-                                MessageBox(hParent, ss.str().c_str(), L"WebView2 Error", MB_OK | MB_ICONERROR);
-                                return result;
-                            }
-                            // Store the controller
-                            m_controller = controller;
-
-                            // Retrieve the CoreWebView2
-                            HRESULT hrLocal = m_controller->get_CoreWebView2(&m_webView);
-                            if (FAILED(hrLocal) || !m_webView) {
-                                LogDebug(L"[BrowserPanel] get_CoreWebView2 returned null or failed!");
-                                MessageBox(hParent, L"get_CoreWebView2 returned null!", L"WebView2 Error", MB_OK | MB_ICONERROR);
-                                return E_FAIL;
-                            }
-
-                            // Resize the controller to fill this panel
-                            RECT bounds = rc;
-                            bounds.right -= bounds.left;
-                            bounds.bottom -= bounds.top;
-                            bounds.left = 0;
-                            bounds.top = 0;
-                            m_controller->put_Bounds(bounds);
-
-                            LogDebug(L"[BrowserPanel] WebView2 controller created OK.");
-                            return S_OK;
-                        }
-                    ).Get());
-                return S_OK;
-            }
-        ).Get()
-    );
-
-    if (FAILED(hr)) {
-        std::wstringstream ss;
-        ss << L"[BrowserPanel] CreateCoreWebView2EnvironmentWithOptions call failed immediately. HRESULT=0x"
-           << std::hex << hr;
-        LogDebug(ss.str().c_str());
-        MessageBox(hParent, ss.str().c_str(), L"WebView2 Error", MB_OK | MB_ICONERROR);
-        return false;
-    }
+    // Fill the pool while the panel is still hidden.
+    RequestControllers();
     return true;
 }
 
 void BrowserPanel::Destroy()
 {
-    if (m_controller) {
-        m_controller->Close();
-        m_controller = nullptr;
+    // Callbacks still in flight close their controller instead.
+    m_alive.reset();
+    for (Tab &tab : m_tabs) {
+        if (tab.view.controller)
+            tab.view.controller->Close();
     }
-    m_webView = nullptr;
+    for (View &view : m_pool)
+        view.controller->Close();
+    m_tabs.clear();
+    m_pool.clear();
+    m_currentTab = -1;
+    m_creating = 0;
     if (m_hWnd && IsWindow(m_hWnd)) {
+        RemoveWindowSubclass(m_hWnd, PanelProc, 1);
         DestroyWindow(m_hWnd);
-        m_hWnd = nullptr;
     }
+    m_hWnd = nullptr;
+    m_hTabs = nullptr;
 }
 
 void BrowserPanel::SetBounds(const RECT &rc)
@@ -173,24 +145,229 @@ void BrowserPanel::SetBounds(const RECT &rc)
             rc.bottom - rc.top,
             SWP_NOZORDER
         );
+        SetWindowPos(m_hTabs, nullptr, 0, 0, rc.right - rc.left, BROWSER_TAB_HEIGHT, SWP_NOZORDER);
     }
-    if (m_controller) {
-        RECT local = {0, 0, rc.right - rc.left, rc.bottom - rc.top};
-        m_controller->put_Bounds(local);
+    // Pooled controllers are resized too, so a new tab shows at the right size.
+    RECT bounds = GetViewBounds();
+    for (Tab &tab : m_tabs) {
+        if (tab.view.controller)
+            tab.view.controller->put_Bounds(bounds);
     }
+    for (View &view : m_pool)
+        view.controller->put_Bounds(bounds);
+}
+
+void BrowserPanel::Show(bool show)
+{
+    if (m_hWnd)
+        ShowWindow(m_hWnd, show ? SW_SHOW : SW_HIDE);
+}
+
+bool BrowserPanel::IsVisible() const
+{
+    return m_hWnd && (GetWindowLongPtr(m_hWnd, GWL_STYLE) & WS_VISIBLE) != 0;
 }
 
 void BrowserPanel::Navigate(const std::wstring &url)
 {
-    if (!m_webView) {
-        LogDebug(L"[BrowserPanel] Navigate called but m_webView is null!");
-        MessageBox(nullptr, L"WebView not yet initialized.", L"WebView2 Error", MB_OK | MB_ICONERROR);
+    if (!m_hWnd)
         return;
-    }
+    // A new request reports its own failure, even after an earlier one.
+    m_errorShown = false;
     std::wstringstream ss;
     ss << L"[BrowserPanel] Navigating to: " << url;
     LogDebug(ss.str().c_str());
-    m_webView->Navigate(url.c_str());
+
+    for (size_t i = 0; i < m_tabs.size(); ++i) {
+        if (m_tabs[i].url == url) {
+            SelectTab(static_cast<int>(i));
+            return;
+        }
+    }
+
+    std::wstring label = TabLabel(url);
+    TCITEM item = {};
+    item.mask = TCIF_TEXT;
+    item.pszText = const_cast<LPWSTR>(label.c_str());
+    int index;
+    if (m_tabs.size() < BROWSER_MAX_TABS) {
+        Tab tab;
+        tab.url = url;
+        tab.lastUsed = 0;
+        m_tabs.push_back(tab);
+        index = static_cast<int>(m_tabs.size()) - 1;
+        TabCtrl_InsertItem(m_hTabs, index, &item);
+        if (!m_pool.empty()) {
+            View view = m_pool.back();
+            m_pool.pop_back();
+            AttachView(index, view);
+        }
+    } else {
+        // Reuse the least recently used tab (and its controller) for the new URL.
+        index = 0;
+        for (size_t i = 1; i < m_tabs.size(); ++i) {
+            if (m_tabs[i].lastUsed < m_tabs[index].lastUsed)
+                index = static_cast<int>(i);
+        }
+        m_tabs[index].url = url;
+        TabCtrl_SetItem(m_hTabs, index, &item);
+        if (m_tabs[index].view.webView)
+            m_tabs[index].view.webView->Navigate(url.c_str());
+    }
+    SelectTab(index);
+    // Replace the pooled controller just taken, or create one for this tab.
+    RequestControllers();
+}
+
+LRESULT CALLBACK BrowserPanel::PanelProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam,
+                                         UINT_PTR uIdSubclass, DWORD_PTR dwRefData)
+{
+    BrowserPanel* pThis = reinterpret_cast<BrowserPanel*>(dwRefData);
+    if (uMsg == WM_NOTIFY) {
+        LPNMHDR hdr = reinterpret_cast<LPNMHDR>(lParam);
+        if (hdr->hwndFrom == pThis->m_hTabs && hdr->code == TCN_SELCHANGE) {
+            pThis->SelectTab(TabCtrl_GetCurSel(pThis->m_hTabs));
+            return 0;
+        }
+    }
+    return DefSubclassProc(hWnd, uMsg, wParam, lParam);
+}
+
+void BrowserPanel::RequestControllers()
+{
+    int waiting = 0;
+    for (const Tab &tab : m_tabs) {
+        if (!tab.view.controller)
+            ++waiting;
+    }
+    int spares = (std::max)(0, static_cast<int>(BROWSER_CONTROLLER_POOL_SIZE) - static_cast<int>(m_pool.size()));
+    int wanted = waiting + spares - m_creating;
+    if (wanted <= 0)
+        return;
+    // Counted now, so calls made before the environment exists do not ask again.
+    m_creating += wanted;
+    std::weak_ptr<bool> alive = m_alive;
+    WebViewEnvironment::Shared().WhenReady(
+        [this, alive, wanted](HRESULT result, ICoreWebView2Environment* env)
+        {
+            if (alive.expired())
+                return;
+            if (FAILED(result)) {
+                m_creating -= wanted;
+                ReportError(L"environment", result);
+                return;
+            }
+            for (int i = 0; i < wanted; ++i)
+                CreateController(env);
+        });
+}
+
+void BrowserPanel::CreateController(ICoreWebView2Environment *environment)
+{
+    std::shared_ptr<TraceActivity> activity = std::make_shared<TraceActivity>();
+    std::weak_ptr<bool> alive = m_alive;
+    TraceStart(*activity, TracePhase::WebViewController);
+    HRESULT hr = environment->CreateCoreWebView2Controller(m_hWnd,
+        Microsoft::WRL::Callback<ICoreWebView2CreateCoreWebView2ControllerCompletedHandler>(
+            [this, alive, activity](HRESULT result, ICoreWebView2Controller* controller) -> HRESULT
+            {
+                if (!FAILED(result) && !controller)
+                    result = E_FAIL;
+                TraceWebViewControllerStop(*activity, result);
+                if (alive.expired()) {
+                    if (controller)
+                        controller->Close();
+                    return S_OK;
+                }
+                OnControllerCreated(result, controller);
+                return S_OK;
+            }
+        ).Get());
+    if (FAILED(hr)) {
+        TraceWebViewControllerStop(*activity, hr);
+        OnControllerCreated(hr, nullptr);
+    }
+}
+
+void BrowserPanel::OnControllerCreated(HRESULT result, ICoreWebView2Controller *controller)
+{
+    --m_creating;
+    if (FAILED(result)) {
+        ReportError(L"controller", result);
+        return;
+    }
+    View view;
+    view.controller = controller;
+    HRESULT hrLocal = view.controller->get_CoreWebView2(&view.webView);
+    if (FAILED(hrLocal) || !view.webView) {
+        view.controller->Close();
+        ReportError(L"core webview", FAILED(hrLocal) ? hrLocal : E_FAIL);
+        return;
+    }
+    m_errorShown = false;
+    view.controller->put_IsVisible(FALSE);
+    view.controller->put_Bounds(GetViewBounds());
+    LogDebug(L"[BrowserPanel] WebView2 controller created OK.");
+
+    int waiting = FindWaitingTab();
+    if (waiting >= 0)
+        AttachView(waiting, view);
+    else
+        m_pool.push_back(view);
+}
+
+void BrowserPanel::AttachView(int index, const View &view)
+{
+    Tab &tab = m_tabs[index];
+    tab.view = view;
+    tab.view.webView->Navigate(tab.url.c_str());
+    tab.view.controller->put_IsVisible(index == m_currentTab ? TRUE : FALSE);
+}
+
+void BrowserPanel::SelectTab(int index)
+{
+    if (index < 0 || index >= static_cast<int>(m_tabs.size()))
+        return;
+    m_currentTab = index;
+    TabCtrl_SetCurSel(m_hTabs, index);
+    m_tabs[index].lastUsed = ++m_useCounter;
+    for (size_t i = 0; i < m_tabs.size(); ++i) {
+        if (m_tabs[i].view.controller)
+            m_tabs[i].view.controller->put_IsVisible(static_cast<int>(i) == index ? TRUE : FALSE);
+    }
+}
+
+int BrowserPanel::FindWaitingTab() const
+{
+    // The selected tab first: it is the one on screen.
+    if (m_currentTab >= 0 && !m_tabs[m_currentTab].view.controller)
+        return m_currentTab;
+    for (size_t i = 0; i < m_tabs.size(); ++i) {
+        if (!m_tabs[i].view.controller)
+            return static_cast<int>(i);
+    }
+    return -1;
+}
+
+RECT BrowserPanel::GetViewBounds() const
+{
+    RECT rc = {0, 0, 0, 0};
+    if (m_hWnd)
+        GetClientRect(m_hWnd, &rc);
+    rc.top = (std::min)(static_cast<LONG>(BROWSER_TAB_HEIGHT), rc.bottom);
+    return rc;
+}
+
+void BrowserPanel::ReportError(const wchar_t *what, HRESULT result)
+{
+    std::wstringstream ss;
+    ss << L"[BrowserPanel] Failed to create WebView2 " << what << L". HRESULT=0x" << std::hex << result;
+    LogDebug(ss.str().c_str());
+    // A failed pool refill stays silent; a tab waiting for its page is reported once.
+    if (m_errorShown || FindWaitingTab() < 0)
+        return;
+    m_errorShown = true;
+    MessageBox(GetParent(m_hWnd), ss.str().c_str(), L"WebView2 Error", MB_OK | MB_ICONERROR);
 }
 
-// End of file: BrowserPanel.cpp (Version: 1.3)
+// End of file: BrowserPanel.cpp (Version: 1.5)
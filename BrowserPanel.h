@@ -1,9 +1,27 @@
 // File: BrowserPanel.h
-// Version: 1.3 (Synchronized with BrowserPanel.cpp to fix mismatched signatures and missing members)
+// Version: 1.5 (Shared environment, controller pool and tabs)
 // -------------------------------------------------------------------------
-// This header declares the BrowserPanel class, which hosts an embedded
-// WebView2 control without using WIL. It matches the BrowserPanel.cpp
-// (Version 1.3) that references m_hWnd, m_controller, and m_webView.
+// This header declares the BrowserPanel class, which hosts embedded WebView2
+// controls without using WIL.
+//
+// Changes in Version 1.5:
+//  1) The panel shows one tab per URL: a tab strip (WC_TABCONTROL) above the
+//     controllers, at most BROWSER_MAX_TABS tabs, after which the least recently
+//     used tab is navigated to the new URL. Opening a URL a tab already shows
+//     selects that tab.
+//  2) Controllers come from the process-wide WebViewEnvironment and a pool of
+//     BROWSER_CONTROLLER_POOL_SIZE hidden, preconfigured controllers that is
+//     filled as soon as the panel is created (MainWindow creates it hidden after
+//     the first paint), so a new tab normally takes a ready controller.
+//  3) Navigate() before a controller is ready no longer drops the URL: the tab
+//     keeps it and navigates when its controller arrives.
+//  4) Added Show() and IsVisible(); the panel is created hidden.
+//  5) Callbacks that complete after Destroy() close their controller instead of
+//     touching the deleted panel.
+//
+// Changes in Version 1.4:
+//  1) Added m_environmentActivity and m_controllerActivity, which trace WebView2
+//     creation across its asynchronous callbacks (Tracing.h).
 //
 // Changes in Version 1.3:
 //  1) Added non-static bool Create(HWND hParent, const RECT &rc);
@@ -22,6 +40,8 @@
 
 #include <windows.h>
 #include <string>
+#include <vector>
+#include <memory>
 #include <wrl.h>            // For Microsoft::WRL::ComPtr
 #include <WebView2.h>       // For ICoreWebView2, ICoreWebView2Controller
 
@@ -31,24 +51,62 @@ public:
     BrowserPanel();
     ~BrowserPanel();
 
-    // Creates the child window for this panel, and asynchronously sets up WebView2.
+    // Creates the hidden panel window with its tab strip and starts filling the
+    // controller pool from the shared WebView2 environment.
     bool Create(HWND hParent, const RECT &rc);
 
-    // Closes the WebView2 controller (if any) and destroys this panel window.
+    // Closes every WebView2 controller and destroys this panel window.
     void Destroy();
 
-    // Adjusts this panel's window and the WebView2 controller bounds.
+    // Adjusts this panel's window, the tab strip and the controller bounds.
     void SetBounds(const RECT &rc);
 
-    // Navigates the WebView2 control to the specified URL (once created).
+    // Shows or hides the panel window.
+    void Show(bool show);
+    bool IsVisible() const;
+
+    // Shows url in a tab: the one already showing it, else a new tab, else the
+    // least recently used one. The URL waits in the tab until it has a controller.
     void Navigate(const std::wstring &url);
 
 private:
+    // A preconfigured controller: created hidden, sized to the view area.
+    struct View {
+        Microsoft::WRL::ComPtr<ICoreWebView2Controller> controller;
+        Microsoft::WRL::ComPtr<ICoreWebView2> webView;
+    };
+
+    struct Tab {
+        std::wstring url;       ///< Shown, or queued while view has no controller.
+        View view;
+        ULONGLONG lastUsed;     ///< m_useCounter when last selected.
+    };
+
+    static LRESULT CALLBACK PanelProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam,
+                                      UINT_PTR uIdSubclass, DWORD_PTR dwRefData);
+
+    // Starts enough controller creations for the waiting tabs and the pool.
+    void RequestControllers();
+    void CreateController(ICoreWebView2Environment *environment);
+    void OnControllerCreated(HRESULT result, ICoreWebView2Controller *controller);
+    // Gives tab index a ready view and navigates its queued URL.
+    void AttachView(int index, const View &view);
+    void SelectTab(int index);
+    int FindWaitingTab() const;
+    RECT GetViewBounds() const;
+    void ReportError(const wchar_t *what, HRESULT result);
+
     HWND m_hWnd;   // Panel window handle
-    Microsoft::WRL::ComPtr<ICoreWebView2Controller> m_controller;
-    Microsoft::WRL::ComPtr<ICoreWebView2> m_webView;
+    HWND m_hTabs;  // Tab strip
+    std::vector<Tab> m_tabs;            ///< In tab strip order.
+    std::vector<View> m_pool;           ///< Ready controllers without a tab.
+    int m_currentTab;                   ///< Selected tab, or -1.
+    int m_creating;                     ///< Controller creations in flight.
+    ULONGLONG m_useCounter;
+    bool m_errorShown;                  ///< A creation error was reported since the last success.
+    std::shared_ptr<bool> m_alive;      ///< Cleared by Destroy(); checked by pending callbacks.
 };
 
 #endif // BROWSERPANEL_H
 
-// ---------------------------- End of file: BrowserPanel.h (Version: 1.3) ----------------------------
+// ---------------------------- End of file: BrowserPanel.h (Version: 1.5) ----------------------------
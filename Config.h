@@ -1,10 +1,66 @@
 // File: Config.h
-// Version: 1.1
+// Version: 1.16
 // -------------------------------------------------------------------------
 // This file centralizes configuration constants for MYexplorer.
 // Externalized constants include the project folder, timer configuration,
 // persistence file name, and UI layout values.
 //
+// Changes in Version 1.16:
+//  - Added the CLI fuzzy search settings (FuzzySearch), the frecency settings
+//    (Frecency) and WM_APP_SEARCH_RESULTS.
+//
+// Changes in Version 1.15:
+//  - Added the window history settings (WindowHistory).
+//  - PROJECT_FOLDER is the first of several PROJECT_ROOTS, listed recursively
+//    in batches (DIRECTORY_SCAN_BATCH_FILES, DIRECTORY_SCAN_FLUSH_INTERVAL).
+//
+// Changes in Version 1.14:
+//  - MAX_LAUNCHER_BUTTONS and BUTTON_ROW_Y were replaced by LAUNCHER_COMMAND_COUNT
+//    and the state strip settings (LauncherBar).
+//
+// Changes in Version 1.13:
+//  - Added STARTUP_METRICS_FILE (StartupMetrics).
+//
+// Changes in Version 1.12:
+//  - Added the integrated browser settings (WebViewEnvironment, BrowserPanel)
+//    and BROWSER_PREWARM_TIMER_ID.
+//
+// Changes in Version 1.11:
+//  - Added the icon cache settings and WM_APP_ICONS_READY (IconCache).
+//
+// Changes in Version 1.10:
+//  - Added the tracking journal settings and WM_APP_TRACKING_LOADED (TrackingJournal).
+//
+// Changes in Version 1.9:
+//  - Added the window event ring settings (WindowEventRing).
+//
+// Changes in Version 1.8:
+//  - Added the query pipe settings and WM_APP_QUERY_ACTIVATE (QueryServer).
+//
+// Changes in Version 1.7:
+//  - Added IDM_RESTORE_WORKSPACE.
+//
+// Changes in Version 1.6:
+//  - TIMER_INTERVAL and the new REFRESH_* values are only the defaults of the
+//    run-time adjustable RefreshRates used by RefreshScheduler; added the
+//    refresh timer and the system menu commands that switch the rates.
+//
+// Changes in Version 1.5:
+//  - Window snapshots are collected by WindowSnapshotWorker, which runs the
+//    sweep and event coalescing itself; the UI timer identifiers were removed
+//    and WM_APP_WINDOWS_CHANGED became WM_APP_SNAPSHOT_READY.
+//
+// Changes in Version 1.4:
+//  - Added WM_APP_LAUNCH_COMPLETE and the LaunchService wait settings.
+//
+// Changes in Version 1.3:
+//  - Added WM_APP_DIRECTORY_CHANGED, posted by DirectoryIndex.
+//
+// Changes in Version 1.2:
+//  - TIMER_INTERVAL is now the slow consistency sweep; window events drive
+//    regular updates through WM_APP_WINDOWS_CHANGED.
+//  - Added the event refresh timer used to coalesce bursts of window events.
+//
 // Changes in Version 1.1:
 //  - Moved hard-coded constants from various modules into this file.
 //  - Added #include <windows.h> to ensure Windows-specific types (e.g., UINT_PTR, UINT)
@@ -16,29 +72,115 @@
 
 #include <windows.h>  // Required for UINT_PTR, UINT, etc.
 #include <string>
+#include <vector>
 
-// Folder where the application monitors files.
-const std::wstring PROJECT_FOLDER = L"C:\\tmp";
+// Folders where the application monitors files, each listed recursively and
+// watched by its own DirectoryIndex shard. Files under the first are named
+// relative to it, files under the others by their full path.
+const std::vector<std::wstring> PROJECT_ROOTS = { L"C:\\tmp" };
+const std::wstring PROJECT_FOLDER = PROJECT_ROOTS.front();
 
-// Timer configuration.
-const UINT_PTR TIMER_ID = 1;          // Timer identifier.
-const UINT TIMER_INTERVAL = 500;      // Timer interval for updating UI (in milliseconds).
+// Folder listing (see DirectoryIndex.h).
+const size_t DIRECTORY_SCAN_BATCH_FILES = 2048;       // Files listed before a batch is handed to the UI.
+const ULONGLONG DIRECTORY_SCAN_FLUSH_INTERVAL = 100;  // Longest a listed file waits for its batch (in milliseconds).
+
+// Snapshot worker timing.
+const UINT TIMER_INTERVAL = 5000;     // Default consistency sweep interval; window events drive regular updates (in milliseconds).
+const UINT EVENT_REFRESH_DELAY = 50;  // Delay between the first window event and the published snapshot (in milliseconds).
+
+// Panel refresh defaults (see RefreshScheduler); adjustable at run time.
+const UINT REFRESH_VISIBLE_INTERVAL = 0;        // Visible panel: every snapshot (in milliseconds).
+const UINT REFRESH_DECAY_START_INTERVAL = 500;  // A hidden panel starts at this interval and doubles it (in milliseconds).
+const UINT REFRESH_HIDDEN_INTERVAL = 10000;     // Slowest hidden panel interval (in milliseconds).
+
+// "Battery saver" refresh rates, selectable from the system menu.
+const UINT BATTERY_VISIBLE_INTERVAL = 1000;
+const UINT BATTERY_HIDDEN_INTERVAL = 60000;
+const UINT BATTERY_SWEEP_INTERVAL = 30000;
+
+// UI timer and system menu commands (system menu IDs must be multiples of 16 below 0xF000).
+const UINT_PTR REFRESH_TIMER_ID = 1;          // One-shot timer for the next due panel.
+const UINT_PTR BROWSER_PREWARM_TIMER_ID = 2;  // One-shot timer that creates the hidden browser panel after the first paint.
+const UINT IDM_REFRESH_NORMAL = 0x0110;
+const UINT IDM_REFRESH_BATTERY_SAVER = 0x0120;
+const UINT IDM_RESTORE_WORKSPACE = 0x0130;
+
+// Private window messages.
+const UINT WM_APP_SNAPSHOT_READY = WM_APP + 1;    // Posted by WindowSnapshotWorker when a snapshot is published.
+const UINT WM_APP_DIRECTORY_CHANGED = WM_APP + 2; // Posted by DirectoryIndex when folder deltas are pending.
+const UINT WM_APP_LAUNCH_COMPLETE = WM_APP + 3;   // Posted by LaunchService; LPARAM is a LaunchResult* owned by the receiver.
+const UINT WM_APP_QUERY_ACTIVATE = WM_APP + 4;    // Posted by QueryServer; LPARAM is a QueryActivation* owned by the receiver.
+const UINT WM_APP_TRACKING_LOADED = WM_APP + 5;   // Posted by TrackingJournal; LPARAM is a std::vector<StoredTrackedWindow>* owned by the receiver.
+const UINT WM_APP_ICONS_READY = WM_APP + 6;       // Posted by IconCache when extracted icons are pending.
+const UINT WM_APP_SEARCH_RESULTS = WM_APP + 7;    // Posted by FuzzySearcher when a CLI search result is ready.
+
+// Query pipe (see QueryProtocol.h).
+const wchar_t QUERY_PIPE_NAME[] = L"\\\\.\\pipe\\MYexplorer-query";
+const DWORD QUERY_PIPE_MAX_INSTANCES = 32;        // Clients served at the same time.
+
+// Shared-memory window event ring (see WindowEventRing.h).
+const wchar_t WINDOW_EVENT_RING_NAME[] = L"Local\\MYexplorer-window-events";
+const UINT WINDOW_EVENT_RING_SLOTS = 4096;        // Events kept for slow readers (256 bytes each).
+
+// Launch configuration.
+const UINT LAUNCH_WINDOW_TIMEOUT = 15000;     // How long a launch waits for the new window (in milliseconds).
+const UINT LAUNCH_IDLE_POLL_INTERVAL = 100;   // WaitForInputIdle polling interval while a launch waits (in milliseconds).
 
 // File used to persist window tracking mapping.
 const std::wstring TRACKING_FILE = L"tracking.dat";
 
-// UI and launcher button settings.
+// Tracking journal (see TrackingJournal.h); compacted into TRACKING_FILE.
+const std::wstring TRACKING_JOURNAL_FILE = L"tracking.journal";
+const UINT TRACKING_JOURNAL_COMMIT_DELAY = 200;            // Records queued within this time share one write and flush (in milliseconds).
+const ULONGLONG TRACKING_JOURNAL_COMPACT_BYTES = 256 * 1024; // Journal size that triggers compaction; bounds the replay at startup.
+
+// Window activity history (see WindowHistory.h); memory and file size are fixed.
+const std::wstring HISTORY_FILE = L"window_history.dat";
+const size_t HISTORY_BLOCK_BYTES = 256 * 1024;                  // Record bytes of one block (keyframe plus deltas).
+const size_t HISTORY_MEMORY_BLOCKS = 8;                         // Newest blocks kept in memory, the current one included.
+const size_t HISTORY_DISK_BLOCKS = 128;                         // Slots of HISTORY_FILE, overwritten oldest first (32 MB).
+const ULONGLONG HISTORY_KEYFRAME_INTERVAL = 10 * 60 * 1000;     // Age at which the next record starts a new block (in milliseconds); bounds the decode of a query.
+const size_t HISTORY_TITLE_CHARS = 64;                          // Title characters recorded per window.
+
+// Icon cache (see IconCache.h).
+const std::wstring ICON_CACHE_FILE = L"iconcache.dat";
+const UINT ICON_CACHE_SIZE = 16;                  // Edge of the list icons (in pixels).
+const UINT ICON_CACHE_MAX_IMAGES = 512;           // Images kept in the shared image list (1 KB each).
+const size_t ICON_DISK_CACHE_MAX_ENTRIES = 4096;  // Per-path icons kept in ICON_CACHE_FILE.
+
+// CLI fuzzy search (see FuzzySearch.h).
+const size_t FUZZY_SEARCH_MAX_RESULTS = 200;      // Best names kept per query.
+const size_t FUZZY_SEARCH_CHUNK_NAMES = 4096;     // Names scored between two checks for a newer query.
+const UINT FUZZY_SEARCH_PARTIAL_INTERVAL = 8;     // Scan time after which the best names so far are shown (in milliseconds).
+const float FUZZY_FRECENCY_WEIGHT = 24.0f;        // Rank added per doubling of a file's frecency (a matched character scores 16).
+
+// Frecency of opened files (see Frecency.h).
+const std::wstring FRECENCY_FILE = L"frecency.dat";
+const double FRECENCY_HALF_LIFE = 3.0 * 24 * 60 * 60 * 1000;  // Time in which a file's score halves (in milliseconds).
+const size_t FRECENCY_MAX_ENTRIES = 1024;                      // Files kept; the lowest score gives way.
+
+// Startup milestones, one JSON line per start (see StartupMetrics.h).
+const std::wstring STARTUP_METRICS_FILE = L"startup_metrics.jsonl";
+
+// Integrated browser (see WebViewEnvironment.h and BrowserPanel.h).
+const wchar_t BROWSER_USER_DATA_FOLDER[] = L"MYexplorer\\WebView2"; // WebView2 profile, under %LOCALAPPDATA%.
+const UINT BROWSER_PREWARM_DELAY = 500;       // Time after the first paint before the environment and pool are created (in milliseconds).
+const UINT BROWSER_CONTROLLER_POOL_SIZE = 2;  // Hidden controllers kept ready for new tabs.
+const size_t BROWSER_MAX_TABS = 8;            // Further URLs reuse the least recently used tab.
+const int BROWSER_TAB_HEIGHT = 24;            // Height of the browser tab strip (in pixels).
+
+// UI and launcher bar settings.
 const int ID_CLOSE_WINDOW = 2001;
-const int MAX_LAUNCHER_BUTTONS = 5;
-const int ID_LAUNCHER_BUTTON_BASE = 3000;
+const UINT ID_LAUNCHER_BUTTON_BASE = 3000;
+const UINT LAUNCHER_COMMAND_COUNT = 1000;     // Command IDs reserved for launchers, i.e. the most that can be pinned.
 
-// Layout constants for the dynamic launcher buttons.
-const int BUTTON_ROW_Y = 850;
+// Layout constants for the launcher bar (under the panels, scrolled when wider than the window).
 const int BUTTON_X_START = 10;
 const int BUTTON_WIDTH = 120;
 const int BUTTON_HEIGHT = 30;
-const int BUTTON_X_GAP = 10;
+const int LAUNCHER_STATE_STRIP_HEIGHT = 3;    // Launch state strip under a launcher's label (in pixels).
+const int LAUNCHER_STATE_STRIP_INSET = 6;
 
 #endif // CONFIG_H
 
-// End of file: Config.h (Version: 1.1)
+// End of file: Config.h (Version: 1.16)
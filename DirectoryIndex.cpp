@@ -0,0 +1,503 @@
+// File: DirectoryIndex.cpp
+// Version: 1.4
+// -------------------------------------------------------------------------
+// This file implements DirectoryIndex (see DirectoryIndex.h).
+//
+// Changes in Version 1.4:
+//  - ApplyPendingChanges() counts the roots whose listing is in progress
+//    (IsListing()).
+//
+// Changes in Version 1.3:
+//  - One watcher thread per root, watching the whole tree. Listings are
+//    recursive and queued in batches; a folder that is added or renamed
+//    into a tree is listed the same way, and a removed folder removes the
+//    files under it.
+//
+// Changes in Version 1.2:
+//  - The initial listing runs on the watcher thread, after the first
+//    ReadDirectoryChangesW is issued, so no change between the two is lost.
+//
+// Changes in Version 1.1:
+//  - Full listings are traced as the DirectoryScan phase (Tracing.h).
+// -------------------------------------------------------------------------
+
+#include "DirectoryIndex.h"
+#include "Config.h"
+#include "Tracing.h"
+#include <algorithm>
+#include <cwchar>
+
+// ReadDirectoryChangesW cannot return more than 64 KB over the network.
+static const DWORD WATCH_BUFFER_SIZE = 64 * 1024;
+
+static ULONGLONG FileTimeToULL(const FILETIME &ft) {
+    return (static_cast<ULONGLONG>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime;
+}
+
+static bool EntryLess(const DirectoryEntry &a, const DirectoryEntry &b) {
+    if (a.root != b.root)
+        return a.root < b.root;
+    return _wcsicmp(a.name.c_str(), b.name.c_str()) < 0;
+}
+
+static bool SameEntry(const DirectoryEntry &a, const DirectoryEntry &b) {
+    return a.root == b.root && _wcsicmp(a.name.c_str(), b.name.c_str()) == 0;
+}
+
+static bool StartsWithNoCase(const std::wstring &text, const std::wstring &prefix) {
+    return text.size() >= prefix.size() && _wcsnicmp(text.c_str(), prefix.c_str(), prefix.size()) == 0;
+}
+
+DirectoryIndex::DirectoryIndex()
+    : m_generation(0)
+    , m_loadedRoots(0)
+    , m_listingRoots(0)
+    , m_hwndNotify(nullptr)
+    , m_notifyMsg(0)
+    , m_stopEvent(nullptr)
+    , m_notifyPending(false)
+{
+}
+
+DirectoryIndex::~DirectoryIndex() {
+    Stop();
+}
+
+bool DirectoryIndex::ListShard(const Shard &shard, const std::wstring &relativeDir, bool full) {
+    TraceActivity activity;
+    if (full) {
+        TraceStart(activity, TracePhase::DirectoryScan);
+        QueueReset(shard.root);
+    }
+    std::vector<DirectoryEntry> batch;
+    UINT listed = 0;
+    ULONGLONG lastFlush = GetTickCount64();
+    bool ok = true;
+
+    // Depth first over relative directory paths; the root itself is "".
+    std::vector<std::wstring> pending(1, relativeDir);
+    std::wstring pattern;
+    std::wstring relative;
+    while (!pending.empty()) {
+        if (m_stopEvent && WaitForSingleObject(m_stopEvent, 0) == WAIT_OBJECT_0) {
+            ok = false;
+            break;
+        }
+        std::wstring dir = std::move(pending.back());
+        pending.pop_back();
+        pattern = shard.folder;
+        if (!dir.empty()) {
+            pattern += L'\\';
+            pattern += dir;
+        }
+        pattern += L"\\*";
+        WIN32_FIND_DATAW fd;
+        // Basic info skips the short names; large fetch asks for bigger directory reads.
+        HANDLE hFind = FindFirstFileExW(pattern.c_str(), FindExInfoBasic, &fd, FindExSearchNameMatch,
+                                        nullptr, FIND_FIRST_EX_LARGE_FETCH);
+        if (hFind == INVALID_HANDLE_VALUE) {
+            // An empty directory is listed; a missing root is not. Subfolders may vanish meanwhile.
+            if (dir == relativeDir && GetLastError() != ERROR_FILE_NOT_FOUND)
+                ok = false;
+            continue;
+        }
+        do {
+            if (fd.cFileName[0] == L'.' &&
+                (fd.cFileName[1] == L'\0' || (fd.cFileName[1] == L'.' && fd.cFileName[2] == L'\0')))
+                continue;
+            relative = dir;
+            if (!relative.empty())
+                relative += L'\\';
+            relative += fd.cFileName;
+            if (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+                // Junctions and symbolic links may loop back into the tree.
+                if (!(fd.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT))
+                    pending.push_back(relative);
+                continue;
+            }
+            batch.push_back(DirectoryEntry{ shard.prefix + relative, FileTimeToULL(fd.ftLastWriteTime), shard.root });
+        } while (FindNextFileW(hFind, &fd));
+        FindClose(hFind);
+
+        ULONGLONG now = GetTickCount64();
+        if (batch.size() >= DIRECTORY_SCAN_BATCH_FILES ||
+            (!batch.empty() && now - lastFlush >= DIRECTORY_SCAN_FLUSH_INTERVAL)) {
+            listed += static_cast<UINT>(batch.size());
+            QueueListed(shard.root, batch, false);
+            batch.clear();
+            lastFlush = now;
+        }
+    }
+    listed += static_cast<UINT>(batch.size());
+    // A stopped listing is not complete, but the index is discarded with it.
+    QueueListed(shard.root, batch, full);
+    if (full)
+        TraceDirectoryScanStop(activity, listed);
+    return ok;
+}
+
+bool DirectoryIndex::Start(const std::vector<std::wstring> &roots, HWND hwndNotify, UINT notifyMsg) {
+    Stop();
+    m_roots = roots;
+    m_hwndNotify = hwndNotify;
+    m_notifyMsg = notifyMsg;
+    m_entries.clear();
+    m_loadedRoots = 0;
+    m_listingRoots = 0;
+    ++m_generation;
+
+    m_shards.clear();
+    m_shards.resize(m_roots.size());
+    bool anyRoot = false;
+    for (size_t i = 0; i < m_roots.size(); ++i) {
+        Shard &shard = m_shards[i];
+        shard.root = static_cast<UINT>(i);
+        shard.folder = m_roots[i];
+        shard.listing = false;
+        while (shard.folder.size() > 3 && shard.folder.back() == L'\\')
+            shard.folder.pop_back();
+        if (i > 0)
+            shard.prefix = shard.folder + L"\\";
+        DWORD attributes = GetFileAttributesW(shard.folder.c_str());
+        shard.loaded = (attributes == INVALID_FILE_ATTRIBUTES || !(attributes & FILE_ATTRIBUTE_DIRECTORY));
+        if (shard.loaded)
+            ++m_loadedRoots; // Nothing to list.
+        else
+            anyRoot = true;
+    }
+    if (!anyRoot)
+        return false;
+
+    m_stopEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+    if (m_stopEvent) {
+        for (size_t i = 0; i < m_shards.size(); ++i) {
+            if (!m_shards[i].loaded)
+                m_shards[i].thread = std::thread(&DirectoryIndex::WatchThread, this, i);
+        }
+        return true;
+    }
+    // Without the watchers the roots are listed here, once, one after the other.
+    for (const Shard &shard : m_shards) {
+        if (!shard.loaded)
+            ListShard(shard, std::wstring(), true);
+    }
+    ApplyPendingChanges();
+    return true;
+}
+
+void DirectoryIndex::Stop() {
+    if (m_stopEvent) {
+        SetEvent(m_stopEvent);
+        for (Shard &shard : m_shards) {
+            if (shard.thread.joinable())
+                shard.thread.join();
+        }
+        CloseHandle(m_stopEvent);
+        m_stopEvent = nullptr;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pending.clear();
+    m_notifyPending = false;
+}
+
+void DirectoryIndex::NotifyLocked() {
+    if (!m_notifyPending && m_hwndNotify) {
+        m_notifyPending = true;
+        PostMessage(m_hwndNotify, m_notifyMsg, 0, 0);
+    }
+}
+
+void DirectoryIndex::QueueDelta(const DirectoryDelta &delta) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pending.push_back(PendingChange{ delta, std::vector<DirectoryEntry>(), false });
+    NotifyLocked();
+}
+
+void DirectoryIndex::QueueReset(UINT root) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // Whatever is still queued for the root is superseded by the new listing.
+    m_pending.erase(std::remove_if(m_pending.begin(), m_pending.end(),
+                                   [root](const PendingChange &p) { return p.delta.root == root; }),
+                    m_pending.end());
+    m_pending.push_back(PendingChange{ DirectoryDelta{ DirectoryChange::Reset, std::wstring(), std::wstring(), 0, root },
+                                       std::vector<DirectoryEntry>(), false });
+    NotifyLocked();
+}
+
+void DirectoryIndex::QueueListed(UINT root, std::vector<DirectoryEntry> &entries, bool complete) {
+    if (entries.empty() && !complete)
+        return;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pending.push_back(PendingChange{ DirectoryDelta{ DirectoryChange::Listed, std::wstring(), std::wstring(), 0, root },
+                                       std::vector<DirectoryEntry>(), complete });
+    m_pending.back().entries.swap(entries);
+    NotifyLocked();
+}
+
+void DirectoryIndex::WatchThread(size_t shardIndex) {
+    const Shard &shard = m_shards[shardIndex];
+    HANDLE hDir = CreateFileW(shard.folder.c_str(), FILE_LIST_DIRECTORY,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                              OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+    OVERLAPPED ov = {0};
+    if (hDir != INVALID_HANDLE_VALUE)
+        ov.hEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+    std::vector<DWORD> buffer(WATCH_BUFFER_SIZE / sizeof(DWORD)); // DWORD-aligned, as required.
+    // Folder names too, so that folders moved into or out of the tree are noticed.
+    const DWORD filter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE;
+    std::wstring pendingOldName;
+
+    // Watch first, then list: a change made during the listing is also reported as a
+    // delta, which applies to the listed entries without harm.
+    bool armed = ov.hEvent && ReadDirectoryChangesW(hDir, buffer.data(), WATCH_BUFFER_SIZE, TRUE,
+                                                    filter, nullptr, &ov, nullptr);
+    ListShard(shard, std::wstring(), true);
+    if (!armed) {
+        // The tree stays listed but is no longer followed.
+        if (ov.hEvent)
+            CloseHandle(ov.hEvent);
+        if (hDir != INVALID_HANDLE_VALUE)
+            CloseHandle(hDir);
+        return;
+    }
+
+    for (;;) {
+        if (!armed) {
+            ResetEvent(ov.hEvent);
+            if (!ReadDirectoryChangesW(hDir, buffer.data(), WATCH_BUFFER_SIZE, TRUE, filter,
+                                       nullptr, &ov, nullptr))
+                break;
+        }
+        armed = false;
+
+        HANDLE handles[2] = { m_stopEvent, ov.hEvent };
+        DWORD wait = WaitForMultipleObjects(2, handles, FALSE, INFINITE);
+        DWORD bytes = 0;
+        if (wait != WAIT_OBJECT_0 + 1) {
+            CancelIoEx(hDir, &ov);
+            GetOverlappedResult(hDir, &ov, &bytes, TRUE);
+            break;
+        }
+        bool overflow = false;
+        if (!GetOverlappedResult(hDir, &ov, &bytes, FALSE)) {
+            if (GetLastError() != ERROR_NOTIFY_ENUM_DIR)
+                break;
+            overflow = true;
+        }
+        if (bytes == 0)
+            overflow = true;
+
+        if (overflow) {
+            // Too many changes to report individually; rebuild from a fresh listing.
+            // Changes meanwhile are queued by the request issued first.
+            ResetEvent(ov.hEvent);
+            armed = ReadDirectoryChangesW(hDir, buffer.data(), WATCH_BUFFER_SIZE, TRUE, filter,
+                                          nullptr, &ov, nullptr) != FALSE;
+            ListShard(shard, std::wstring(), true);
+            if (!armed)
+                break;
+            continue;
+        }
+
+        const BYTE *p = reinterpret_cast<const BYTE*>(buffer.data());
+        for (;;) {
+            const FILE_NOTIFY_INFORMATION *info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(p);
+            std::wstring relative(info->FileName, info->FileNameLength / sizeof(WCHAR));
+            std::wstring name = shard.prefix + relative;
+            std::wstring path = shard.folder + L"\\" + relative;
+            WIN32_FILE_ATTRIBUTE_DATA attrs;
+            bool exists = GetFileAttributesExW(path.c_str(), GetFileExInfoStandard, &attrs) != FALSE;
+            bool isFile = exists && !(attrs.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY);
+            bool isFolder = exists && !isFile && !(attrs.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT);
+            ULONGLONG lastWrite = isFile ? FileTimeToULL(attrs.ftLastWriteTime) : 0;
+
+            switch (info->Action) {
+            case FILE_ACTION_ADDED:
+                if (isFile)
+                    QueueDelta(DirectoryDelta{ DirectoryChange::Added, name, std::wstring(), lastWrite, shard.root });
+                else if (isFolder)
+                    ListShard(shard, relative, false); // Moved in with its files.
+                break;
+            case FILE_ACTION_REMOVED:
+                QueueDelta(DirectoryDelta{ DirectoryChange::Removed, name, std::wstring(), 0, shard.root });
+                break;
+            case FILE_ACTION_MODIFIED:
+                if (isFile)
+                    QueueDelta(DirectoryDelta{ DirectoryChange::Modified, name, std::wstring(), lastWrite, shard.root });
+                break;
+            case FILE_ACTION_RENAMED_OLD_NAME:
+                pendingOldName = name;
+                break;
+            case FILE_ACTION_RENAMED_NEW_NAME:
+                if (isFile && !pendingOldName.empty())
+                    QueueDelta(DirectoryDelta{ DirectoryChange::Renamed, name, pendingOldName, lastWrite, shard.root });
+                else if (isFile)
+                    QueueDelta(DirectoryDelta{ DirectoryChange::Added, name, std::wstring(), lastWrite, shard.root });
+                else {
+                    // A renamed folder: its files leave under the old names and are listed under the new.
+                    if (!pendingOldName.empty())
+                        QueueDelta(DirectoryDelta{ DirectoryChange::Removed, pendingOldName, std::wstring(), 0, shard.root });
+                    if (isFolder)
+                        ListShard(shard, relative, false);
+                }
+                pendingOldName.clear();
+                break;
+            }
+            if (info->NextEntryOffset == 0)
+                break;
+            p += info->NextEntryOffset;
+        }
+    }
+
+    CloseHandle(ov.hEvent);
+    CloseHandle(hDir);
+}
+
+UINT DirectoryIndex::GetRootOfName(const std::wstring &name) const {
+    if (!IsFullPath(name))
+        return 0;
+    for (size_t i = 1; i < m_shards.size(); ++i) {
+        if (StartsWithNoCase(name, m_shards[i].prefix))
+            return static_cast<UINT>(i);
+    }
+    return 0;
+}
+
+std::wstring DirectoryIndex::GetName(const std::wstring &filePath) const {
+    for (size_t i = 0; i < m_shards.size(); ++i) {
+        const Shard &shard = m_shards[i];
+        if (filePath.size() > shard.folder.size() + 1 && filePath[shard.folder.size()] == L'\\' &&
+            StartsWithNoCase(filePath, shard.folder))
+            return (i == 0) ? filePath.substr(shard.folder.size() + 1) : filePath;
+    }
+    return std::wstring();
+}
+
+int DirectoryIndex::Find(const std::wstring &name) const {
+    DirectoryEntry key{ name, 0, GetRootOfName(name) };
+    auto it = std::lower_bound(m_entries.begin(), m_entries.end(), key, EntryLess);
+    if (it != m_entries.end() && SameEntry(*it, key))
+        return static_cast<int>(it - m_entries.begin());
+    return -1;
+}
+
+void DirectoryIndex::Upsert(UINT root, const std::wstring &name, ULONGLONG lastWriteTime) {
+    DirectoryEntry entry{ name, lastWriteTime, root };
+    auto it = std::lower_bound(m_entries.begin(), m_entries.end(), entry, EntryLess);
+    if (it != m_entries.end() && SameEntry(*it, entry)) {
+        it->name = name;
+        it->lastWriteTime = lastWriteTime;
+        return;
+    }
+    m_entries.insert(it, std::move(entry));
+}
+
+bool DirectoryIndex::Remove(const std::wstring &name) {
+    int index = Find(name);
+    if (index < 0)
+        return false;
+    m_entries.erase(m_entries.begin() + index);
+    return true;
+}
+
+bool DirectoryIndex::RemoveFolder(UINT root, const std::wstring &folderName) {
+    // Names under the folder sort next to each other, right after its prefix.
+    DirectoryEntry key{ folderName + L"\\", 0, root };
+    auto first = std::lower_bound(m_entries.begin(), m_entries.end(), key, EntryLess);
+    auto last = first;
+    while (last != m_entries.end() && last->root == root && StartsWithNoCase(last->name, key.name))
+        ++last;
+    if (first == last)
+        return false;
+    m_entries.erase(first, last);
+    return true;
+}
+
+void DirectoryIndex::RemoveRoot(UINT root) {
+    auto first = std::find_if(m_entries.begin(), m_entries.end(), [root](const DirectoryEntry &e) { return e.root == root; });
+    auto last = std::find_if(first, m_entries.end(), [root](const DirectoryEntry &e) { return e.root != root; });
+    m_entries.erase(first, last);
+}
+
+void DirectoryIndex::Merge(std::vector<DirectoryEntry> &entries) {
+    std::sort(entries.begin(), entries.end(), EntryLess);
+    if (m_entries.empty()) {
+        m_entries.swap(entries);
+        return;
+    }
+    size_t middle = m_entries.size();
+    m_entries.insert(m_entries.end(), std::make_move_iterator(entries.begin()), std::make_move_iterator(entries.end()));
+    // Stable: of two equal names the listed one comes second and replaces the indexed one.
+    std::inplace_merge(m_entries.begin(), m_entries.begin() + middle, m_entries.end(), EntryLess);
+    size_t out = 0;
+    for (size_t i = 0; i < m_entries.size(); ++i) {
+        if (out > 0 && SameEntry(m_entries[out - 1], m_entries[i]))
+            --out;
+        if (out != i)
+            m_entries[out] = std::move(m_entries[i]);
+        ++out;
+    }
+    m_entries.resize(out);
+}
+
+std::vector<DirectoryDelta> DirectoryIndex::ApplyPendingChanges() {
+    std::vector<PendingChange> pending;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        pending.swap(m_pending);
+        m_notifyPending = false;
+    }
+
+    std::vector<DirectoryDelta> deltas;
+    deltas.reserve(pending.size());
+    bool namesChanged = false;
+    for (auto &change : pending) {
+        const DirectoryDelta &delta = change.delta;
+        switch (delta.change) {
+        case DirectoryChange::Added:
+            Upsert(delta.root, delta.name, delta.lastWriteTime);
+            namesChanged = true;
+            break;
+        case DirectoryChange::Removed:
+            namesChanged |= Remove(delta.name);
+            namesChanged |= RemoveFolder(delta.root, delta.name);
+            break;
+        case DirectoryChange::Renamed:
+            Remove(delta.oldName);
+            Upsert(delta.root, delta.name, delta.lastWriteTime);
+            namesChanged = true;
+            break;
+        case DirectoryChange::Modified:
+            if (Find(delta.name) >= 0)
+                Upsert(delta.root, delta.name, delta.lastWriteTime);
+            break;
+        case DirectoryChange::Reset:
+            RemoveRoot(delta.root);
+            if (delta.root < m_shards.size() && !m_shards[delta.root].listing) {
+                m_shards[delta.root].listing = true;
+                ++m_listingRoots;
+            }
+            namesChanged = true;
+            break;
+        case DirectoryChange::Listed:
+            namesChanged |= !change.entries.empty();
+            Merge(change.entries);
+            if (change.complete && delta.root < m_shards.size() && m_shards[delta.root].listing) {
+                m_shards[delta.root].listing = false;
+                --m_listingRoots;
+            }
+            if (change.complete && delta.root < m_shards.size() && !m_shards[delta.root].loaded) {
+                m_shards[delta.root].loaded = true;
+                ++m_loadedRoots;
+                namesChanged = true; // IsLoaded() may have changed; let the owner look.
+            }
+            break;
+        }
+        deltas.push_back(std::move(change.delta));
+    }
+    if (namesChanged)
+        ++m_generation;
+    return deltas;
+}
+
+// End of file: DirectoryIndex.cpp (Version: 1.4)
@@ -0,0 +1,173 @@
+// File: DirectoryIndex.h
+// Version: 1.3
+// -------------------------------------------------------------------------
+// This header declares DirectoryIndex, a persistent in-memory index of the
+// regular files under the project roots (PROJECT_ROOTS).
+//
+// Every root is a shard with a background thread of its own. The thread
+// starts watching its tree with overlapped ReadDirectoryChangesW, lists it
+// recursively once, and then queues add, remove, rename and modify deltas.
+// The first listing arrives like the listing after a watcher overflow: a
+// Reset delta for the shard followed by Listed batches, flushed every
+// DIRECTORY_SCAN_BATCH_FILES files or DIRECTORY_SCAN_FLUSH_INTERVAL, so the
+// lists fill while a deep tree is still being listed and Start() returns
+// without touching the folder contents. The owner window is notified with
+// a single posted message; on the UI thread ApplyPendingChanges() folds the
+// queued deltas into the index and returns them, so the views never touch
+// the disk themselves.
+//
+// Files under the first root are named by their path relative to it
+// ("Report.docx", "Drafts\Report.docx"), as the single project folder named
+// them before; files under the other roots by their full path. A file's
+// name, and so its path, does not depend on the order the shards list in.
+//
+// Changes in Version 1.3:
+//  - Added IsListing(), so owners can coalesce the work they do per batch.
+// Changes in Version 1.2:
+//  - Several roots, each listed and watched by its own shard thread, and
+//    listed recursively with FindFirstFileExW (FindExInfoBasic,
+//    FIND_FIRST_EX_LARGE_FETCH). Listings stream in as Listed batches.
+//  - Entries carry the root they are under; Reset deltas apply to one root.
+// Changes in Version 1.1:
+//  - The initial enumeration moved from Start() to the watcher thread; added
+//    IsLoaded().
+// -------------------------------------------------------------------------
+
+#ifndef DIRECTORYINDEX_H
+#define DIRECTORYINDEX_H
+
+#include <windows.h>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <thread>
+
+/**
+ * @struct DirectoryEntry
+ * @brief One regular file under a project root.
+ */
+struct DirectoryEntry {
+    std::wstring name;        ///< Relative to the first root, else the full path.
+    ULONGLONG lastWriteTime;  ///< Last write time as a FILETIME value.
+    UINT root;                ///< Index of the root the file is under.
+};
+
+enum class DirectoryChange {
+    Added,
+    Removed,   ///< name is a file, or a folder whose files were all removed.
+    Renamed,   ///< name is the new name, oldName the previous one.
+    Modified,
+    Reset,     ///< The root's entries were dropped; its listing follows (initial listing, watcher overflow).
+    Listed     ///< A batch of the root's listing was merged into the index.
+};
+
+struct DirectoryDelta {
+    DirectoryChange change;
+    std::wstring name;
+    std::wstring oldName;
+    ULONGLONG lastWriteTime;
+    UINT root;
+};
+
+class DirectoryIndex {
+public:
+    DirectoryIndex();
+    ~DirectoryIndex();
+
+    // Starts watching and listing every root in the background. notifyMsg is posted
+    // to hwndNotify when deltas (the first being each root's Reset and listing) are
+    // pending. Roots that are not existing directories stay empty. Returns false if
+    // none of them is.
+    bool Start(const std::vector<std::wstring> &roots, HWND hwndNotify, UINT notifyMsg);
+    bool Start(const std::wstring &folder, HWND hwndNotify, UINT notifyMsg) {
+        return Start(std::vector<std::wstring>(1, folder), hwndNotify, notifyMsg);
+    }
+    void Stop();
+
+    // Applies queued deltas to the index (UI thread) and returns them.
+    std::vector<DirectoryDelta> ApplyPendingChanges();
+
+    // Entries sorted by root, then case-insensitively by name.
+    const std::vector<DirectoryEntry>& GetEntries() const { return m_entries; }
+    const std::vector<std::wstring>& GetRoots() const { return m_roots; }
+
+    // Returns the index of the entry with the given name, or -1.
+    int Find(const std::wstring &name) const;
+
+    // Name of the file at filePath (see above), or an empty string if it is under no root.
+    std::wstring GetName(const std::wstring &filePath) const;
+
+    // True if name is a full path, i.e. the name of a file under a root other than the first.
+    static bool IsFullPath(const std::wstring &name) {
+        return name.size() > 1 && (name[1] == L':' || (name[0] == L'\\' && name[1] == L'\\'));
+    }
+
+    // True once the initial listing of every root was applied (UI thread).
+    bool IsLoaded() const { return m_loadedRoots == m_shards.size(); }
+
+    // True while the listing of a root (its Reset received, its last batch not
+    // yet) is being applied (UI thread).
+    bool IsListing() const { return m_listingRoots > 0; }
+
+    // Incremented whenever the set of names changes.
+    ULONGLONG GetGeneration() const { return m_generation; }
+
+private:
+    struct Shard {
+        UINT root;
+        std::wstring folder;    ///< Root directory, without a trailing backslash.
+        std::wstring prefix;    ///< Prepended to relative paths to form names.
+        bool loaded;            ///< UI thread: the initial listing was applied.
+        bool listing;           ///< UI thread: a listing is being applied.
+        std::thread thread;
+    };
+    struct PendingChange {
+        DirectoryDelta delta;
+        std::vector<DirectoryEntry> entries;    ///< Listed only.
+        bool complete;                          ///< Listed only: last batch of a full listing.
+    };
+
+    // Lists the files under relativeDir of shard (all of it if empty) and queues
+    // them in Listed batches; a full listing starts with the shard's Reset.
+    // Returns false if stopped or if the directory cannot be listed.
+    bool ListShard(const Shard &shard, const std::wstring &relativeDir, bool full);
+
+    // Shard thread body.
+    void WatchThread(size_t shard);
+
+    // Queue a change and notify the owner once per ApplyPendingChanges().
+    void QueueDelta(const DirectoryDelta &delta);
+    // Drops what is queued for root; its listing follows.
+    void QueueReset(UINT root);
+    void QueueListed(UINT root, std::vector<DirectoryEntry> &entries, bool complete);
+    void NotifyLocked();
+
+    // Root index of a name (0 unless it is a full path under another root).
+    UINT GetRootOfName(const std::wstring &name) const;
+
+    // Index operations, keeping m_entries sorted.
+    void Upsert(UINT root, const std::wstring &name, ULONGLONG lastWriteTime);
+    bool Remove(const std::wstring &name);
+    bool RemoveFolder(UINT root, const std::wstring &folderName);
+    void RemoveRoot(UINT root);
+    void Merge(std::vector<DirectoryEntry> &entries);
+
+    std::vector<std::wstring> m_roots;
+    std::vector<Shard> m_shards;            // Sized in Start() only.
+    std::vector<DirectoryEntry> m_entries;  // UI thread only.
+    ULONGLONG m_generation;
+    size_t m_loadedRoots;                   // UI thread only.
+    size_t m_listingRoots;                  // UI thread only.
+
+    HWND m_hwndNotify;
+    UINT m_notifyMsg;
+    HANDLE m_stopEvent;
+
+    std::mutex m_mutex;                     // Guards the members below.
+    std::vector<PendingChange> m_pending;
+    bool m_notifyPending;
+};
+
+#endif // DIRECTORYINDEX_H
+
+// End of file: DirectoryIndex.h (Version: 1.3)
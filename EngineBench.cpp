@@ -0,0 +1,688 @@
+// File: EngineBench.cpp
+// Version: 1.1
+// -------------------------------------------------------------------------
+// Synthetic-load benchmark suite for the engine (built by the "Benchmark
+// engine (MSVC)" task against TrackerEngine.lib, not part of MYexplorer.exe).
+//
+// For every window count N the suite starts a copy of itself with
+// --window-host N, which creates N visible top-level windows (off screen,
+// tool windows, four window classes) titled "bench_000042.docx - Synthetic
+// Editor", and pumps their messages so title reads from this process are
+// answered. For every file count M it fills a temporary folder with M empty
+// files bench_000000.docx ..., so file i matches window i. The engine code
+// takes the folder as a parameter (DirectoryIndex) or works on file names,
+// so PROJECT_FOLDER itself is not touched.
+//
+// Benchmarks (each sample is one call of the whole operation):
+//   enumerate_windows        WindowMonitor::EnumerateWindows()              N
+//   consistency_sweep        WindowMonitor::Resync()                        N
+//   get_fingerprint          GetFingerprint(HWND) for every host window     N
+//   compare_fingerprints     CompareFingerprints() for every host window    N
+//   folder_enumeration       DirectoryIndex start to applied first listing  M
+//   save_tracking            SaveTrackingEntries() with M entries           M
+//   read_tracking            ReadTrackingFile() of that file                M
+//   cli_index_build          PrefixIndex::Build() over the M names          M
+//   cli_filter               typing "bench_0000" a key at a time, copying
+//                            each range like FilterCLIListView()            M
+//   cli_fuzzy_filter         typing "bench42" a key at a time into a
+//                            started FuzzySearcher, each query waited for
+//                            until its complete result arrived             M
+//   get_window_handle_by_file_name  a sample of up to 20 names, N x M
+//   snapshot_cycle           the refresh that replaced the WM_TIMER cycle:
+//                            RequestSnapshot() until the snapshot is
+//                            published, then TitleMatcher::Match() with the
+//                            M files                                       N x M
+//   rehydrate_tracking       RehydrateTrackingMapping() of M entries
+//                            against that snapshot                          N x M
+//
+// A benchmark runs until BENCH_TIME_BUDGET_MS or BENCH_MAX_ITERATIONS
+// samples, whichever comes first, and at least once. Results go to stdout as
+// a table and to --out (default engine_bench.json) as JSON, one result
+// object per line:
+//
+//   {"benchmark":"snapshot_cycle","windows":500,"files":10000,"items":531,
+//    "iterations":50,"minUs":812.0,"medianUs":905.3,"meanUs":930.1,"maxUs":1404.9}
+//
+// --baseline old.json compares every median with the result of the same
+// benchmark and scale in old.json and exits with 2 if one is slower than
+// --tolerance (default 1.25) times the baseline.
+//
+// Changes in Version 1.1:
+//  - Added cli_fuzzy_filter (FuzzySearch.h).
+//
+// Usage: EngineBench [--windows 50,500,5000] [--files 100,10000,100000]
+//                    [--out file] [--baseline file] [--tolerance x] [--keep]
+// -------------------------------------------------------------------------
+
+#include <windows.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cwchar>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <functional>
+#include "Config.h"
+#include "WindowMonitor.h"
+#include "WindowUtils.h"
+#include "FingerprintUtils.h"
+#include "FileUtils.h"
+#include "DirectoryIndex.h"
+#include "WindowSnapshotWorker.h"
+#include "TitleMatcher.h"
+#include "PrefixIndex.h"
+#include "FuzzySearch.h"
+#include <memory>
+
+static const double BENCH_TIME_BUDGET_MS = 500.0;   // Per benchmark and scale.
+static const int BENCH_MAX_ITERATIONS = 50;
+static const size_t BENCH_LOOKUP_SAMPLE = 20;       // GetWindowHandleByFileName() calls per sample.
+static const int BENCH_CLASS_COUNT = 4;             // Window classes of the host windows.
+static const DWORD BENCH_WAIT_TIMEOUT = 120000;     // Host start-up and engine notifications (in milliseconds).
+static const wchar_t BENCH_CLI_INPUT[] = L"bench_0000";
+static const wchar_t BENCH_FUZZY_INPUT[] = L"bench42";
+
+// -------------------------------------------------------------------------
+// Synthetic names
+// -------------------------------------------------------------------------
+static std::wstring BenchFileName(size_t index) {
+    wchar_t name[32];
+    swprintf_s(name, L"bench_%06zu.docx", index);
+    return name;
+}
+
+static std::wstring BenchWindowTitle(size_t index) {
+    return BenchFileName(index) + L" - Synthetic Editor";
+}
+
+static std::wstring BenchClassName(int index) {
+    return L"MYexplorerBench.Window" + std::to_wstring(index);
+}
+
+// -------------------------------------------------------------------------
+// Window host (the helper process)
+// -------------------------------------------------------------------------
+static int RunWindowHost(size_t count, const wchar_t *readyName, const wchar_t *doneName) {
+    HANDLE ready = OpenEventW(EVENT_MODIFY_STATE, FALSE, readyName);
+    HANDLE done = OpenEventW(SYNCHRONIZE, FALSE, doneName);
+    if (!ready || !done)
+        return 1;
+    HINSTANCE instance = GetModuleHandle(nullptr);
+    std::vector<std::wstring> classNames;
+    for (int c = 0; c < BENCH_CLASS_COUNT; ++c) {
+        classNames.push_back(BenchClassName(c));
+        WNDCLASSW wc = {};
+        wc.lpfnWndProc = DefWindowProcW;
+        wc.hInstance = instance;
+        wc.lpszClassName = classNames.back().c_str();
+        RegisterClassW(&wc);
+    }
+    // Visible (the window table skips hidden windows), but off screen and out of the taskbar.
+    std::vector<HWND> windows;
+    windows.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        HWND hwnd = CreateWindowExW(WS_EX_TOOLWINDOW | WS_EX_NOACTIVATE, classNames[i % BENCH_CLASS_COUNT].c_str(),
+                                    BenchWindowTitle(i).c_str(), WS_POPUP | WS_VISIBLE,
+                                    -20000 + static_cast<int>(i % 100) * 8, -20000, 64, 48,
+                                    nullptr, nullptr, instance, nullptr);
+        if (hwnd)
+            windows.push_back(hwnd);
+    }
+    SetEvent(ready);
+
+    // Title reads from the benchmark (WM_GETTEXT) are answered while this thread pumps.
+    for (;;) {
+        DWORD wait = MsgWaitForMultipleObjects(1, &done, FALSE, INFINITE, QS_ALLINPUT);
+        if (wait != WAIT_OBJECT_0 + 1)
+            break;
+        MSG msg;
+        while (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE)) {
+            TranslateMessage(&msg);
+            DispatchMessage(&msg);
+        }
+    }
+    for (HWND hwnd : windows)
+        DestroyWindow(hwnd);
+    CloseHandle(ready);
+    CloseHandle(done);
+    return 0;
+}
+
+// Starts and stops a window host; Windows() lists the windows it created.
+class WindowHost {
+public:
+    WindowHost() : m_ready(nullptr), m_done(nullptr), m_process(nullptr), m_processId(0) {}
+    ~WindowHost() { Stop(); }
+
+    bool Start(size_t count) {
+        std::wstring suffix = std::to_wstring(GetCurrentProcessId()) + L"-" + std::to_wstring(count);
+        std::wstring readyName = L"Local\\MYexplorerBench-ready-" + suffix;
+        std::wstring doneName = L"Local\\MYexplorerBench-done-" + suffix;
+        m_ready = CreateEventW(nullptr, TRUE, FALSE, readyName.c_str());
+        m_done = CreateEventW(nullptr, TRUE, FALSE, doneName.c_str());
+        if (!m_ready || !m_done)
+            return false;
+
+        wchar_t exePath[MAX_PATH];
+        GetModuleFileNameW(nullptr, exePath, MAX_PATH);
+        std::wstring commandLine = L"\"" + std::wstring(exePath) + L"\" --window-host " + std::to_wstring(count) +
+                                   L" " + readyName + L" " + doneName;
+        STARTUPINFOW si = { sizeof(si) };
+        PROCESS_INFORMATION pi = {};
+        if (!CreateProcessW(nullptr, &commandLine[0], nullptr, nullptr, FALSE, 0, nullptr, nullptr, &si, &pi))
+            return false;
+        CloseHandle(pi.hThread);
+        m_process = pi.hProcess;
+        m_processId = pi.dwProcessId;
+        HANDLE handles[2] = { m_ready, m_process };
+        return WaitForMultipleObjects(2, handles, FALSE, BENCH_WAIT_TIMEOUT) == WAIT_OBJECT_0;
+    }
+
+    void Stop() {
+        if (m_process) {
+            SetEvent(m_done);
+            if (WaitForSingleObject(m_process, BENCH_WAIT_TIMEOUT) != WAIT_OBJECT_0)
+                TerminateProcess(m_process, 1);
+            CloseHandle(m_process);
+            m_process = nullptr;
+        }
+        if (m_ready) { CloseHandle(m_ready); m_ready = nullptr; }
+        if (m_done) { CloseHandle(m_done); m_done = nullptr; }
+    }
+
+    std::vector<HWND> Windows() const {
+        struct Search { DWORD processId; std::vector<HWND> found; } search = { m_processId, {} };
+        EnumWindows([](HWND hwnd, LPARAM lParam) -> BOOL {
+            Search *s = reinterpret_cast<Search*>(lParam);
+            DWORD pid = 0;
+            GetWindowThreadProcessId(hwnd, &pid);
+            if (pid == s->processId && IsWindowVisible(hwnd))
+                s->found.push_back(hwnd);
+            return TRUE;
+        }, reinterpret_cast<LPARAM>(&search));
+        return search.found;
+    }
+
+private:
+    HANDLE m_ready;
+    HANDLE m_done;
+    HANDLE m_process;
+    DWORD m_processId;
+};
+
+// -------------------------------------------------------------------------
+// Measurement
+// -------------------------------------------------------------------------
+struct BenchResult {
+    std::string benchmark;
+    size_t windows;     ///< Synthetic windows (0 if the benchmark does not use them).
+    size_t files;       ///< Synthetic files (0 if the benchmark does not use them).
+    size_t items;       ///< Work items of one sample (windows seen, entries, calls...).
+    int iterations;
+    double minUs;
+    double medianUs;
+    double meanUs;
+    double maxUs;
+};
+
+static double NowUs() {
+    static const double frequency = [] {
+        LARGE_INTEGER f;
+        QueryPerformanceFrequency(&f);
+        return static_cast<double>(f.QuadPart);
+    }();
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return counter.QuadPart * 1e6 / frequency;
+}
+
+// Runs body (which returns the items it processed) until the time budget or
+// the iteration limit is reached.
+static BenchResult Measure(const char *name, size_t windows, size_t files, const std::function<size_t()> &body) {
+    std::vector<double> samples;
+    size_t items = 0;
+    double total = 0;
+    while (samples.empty() ||
+           (samples.size() < static_cast<size_t>(BENCH_MAX_ITERATIONS) && total < BENCH_TIME_BUDGET_MS * 1000)) {
+        double start = NowUs();
+        items = body();
+        double elapsed = NowUs() - start;
+        samples.push_back(elapsed);
+        total += elapsed;
+    }
+    std::vector<double> sorted = samples;
+    std::sort(sorted.begin(), sorted.end());
+    BenchResult result;
+    result.benchmark = name;
+    result.windows = windows;
+    result.files = files;
+    result.items = items;
+    result.iterations = static_cast<int>(samples.size());
+    result.minUs = sorted.front();
+    result.maxUs = sorted.back();
+    result.medianUs = (sorted.size() % 2) ? sorted[sorted.size() / 2]
+                                          : (sorted[sorted.size() / 2 - 1] + sorted[sorted.size() / 2]) / 2;
+    result.meanUs = total / samples.size();
+    printf("  %-32s %6zu windows %7zu files %7zu items  median %12.1f us  min %12.1f us  (%d runs)\n",
+           name, windows, files, items, result.medianUs, result.minUs, result.iterations);
+    return result;
+}
+
+// Pumps this thread until msg arrives for hwnd. Returns false on timeout.
+static bool WaitForNotify(HWND hwnd, UINT msg) {
+    ULONGLONG deadline = GetTickCount64() + BENCH_WAIT_TIMEOUT;
+    for (;;) {
+        MSG m;
+        while (PeekMessage(&m, nullptr, 0, 0, PM_REMOVE)) {
+            if (m.hwnd == hwnd && m.message == msg)
+                return true;
+            TranslateMessage(&m);
+            DispatchMessage(&m);
+        }
+        ULONGLONG now = GetTickCount64();
+        if (now >= deadline)
+            return false;
+        MsgWaitForMultipleObjects(0, nullptr, FALSE, static_cast<DWORD>(deadline - now), QS_ALLINPUT);
+    }
+}
+
+// Pumps this thread until searcher published the complete result of token.
+static bool WaitForSearch(FuzzySearcher &searcher, HWND hwnd, ULONGLONG token) {
+    FuzzySearchResult result;
+    for (;;) {
+        if (!WaitForNotify(hwnd, WM_APP_SEARCH_RESULTS))
+            return false;
+        if (searcher.TakeResult(result) && result.token == token && result.complete)
+            return true;
+    }
+}
+
+// -------------------------------------------------------------------------
+// Synthetic files and tracking entries
+// -------------------------------------------------------------------------
+static bool PrepareFolder(const std::wstring &folder, size_t count) {
+    CreateDirectoryW(folder.c_str(), nullptr);
+    for (size_t i = 0; i < count; ++i) {
+        HANDLE file = CreateFileW((folder + L"\\" + BenchFileName(i)).c_str(), GENERIC_WRITE, 0, nullptr,
+                                  CREATE_NEW, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file != INVALID_HANDLE_VALUE)
+            CloseHandle(file);
+        else if (GetLastError() != ERROR_FILE_EXISTS)
+            return false;
+    }
+    return true;
+}
+
+static void RemoveFolder(const std::wstring &folder, size_t count) {
+    for (size_t i = 0; i < count; ++i)
+        DeleteFileW((folder + L"\\" + BenchFileName(i)).c_str());
+    RemoveDirectoryW(folder.c_str());
+}
+
+// Entry i carries the fingerprint of host window i if there is one, else a
+// fingerprint no window matches.
+static std::vector<StoredTrackedWindow> MakeEntries(const std::wstring &folder, size_t count,
+                                                    const std::vector<TrackedWindow> &fingerprints) {
+    std::vector<StoredTrackedWindow> entries(count);
+    for (size_t i = 0; i < count; ++i) {
+        StoredTrackedWindow &entry = entries[i];
+        entry.filePath = folder + L"\\" + BenchFileName(i);
+        entry.processCreateTime = 0;
+        if (i < fingerprints.size()) {
+            entry.window = fingerprints[i];
+            continue;
+        }
+        TrackedWindow &tw = entry.window;
+        tw.processId = 0;
+        tw.hwnd = nullptr;
+        tw.rect = RECT{ 0, 0, 800, 600 };
+        SetFingerprintClassName(tw, L"OpusApp");
+        SetFingerprintTitle(tw, BenchWindowTitle(i));
+        tw.failCount = 0;
+        tw.launchTime = 0;
+    }
+    return entries;
+}
+
+// -------------------------------------------------------------------------
+// Results (JSON) and the baseline comparison
+// -------------------------------------------------------------------------
+static std::string ResultToJson(const BenchResult &r) {
+    char line[512];
+    sprintf_s(line, sizeof(line),
+              "{\"benchmark\":\"%s\",\"windows\":%zu,\"files\":%zu,\"items\":%zu,\"iterations\":%d,"
+              "\"minUs\":%.1f,\"medianUs\":%.1f,\"meanUs\":%.1f,\"maxUs\":%.1f}",
+              r.benchmark.c_str(), r.windows, r.files, r.items, r.iterations,
+              r.minUs, r.medianUs, r.meanUs, r.maxUs);
+    return line;
+}
+
+static bool WriteResults(const std::wstring &path, const std::vector<BenchResult> &results) {
+    FILE *file = nullptr;
+    if (_wfopen_s(&file, path.c_str(), L"wb") != 0 || !file)
+        return false;
+    SYSTEMTIME now;
+    GetSystemTime(&now);
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    fprintf(file, "{\n\"suite\":\"EngineBench\",\"formatVersion\":1,"
+                  "\"startedUtc\":\"%04u-%02u-%02uT%02u:%02u:%02uZ\",\"build\":\"%s %s\",\"processors\":%lu,\n"
+                  "\"results\":[\n",
+            now.wYear, now.wMonth, now.wDay, now.wHour, now.wMinute, now.wSecond,
+            __DATE__, __TIME__, info.dwNumberOfProcessors);
+    for (size_t i = 0; i < results.size(); ++i)
+        fprintf(file, "%s%s\n", ResultToJson(results[i]).c_str(), (i + 1 < results.size()) ? "," : "");
+    fprintf(file, "]\n}\n");
+    fclose(file);
+    return true;
+}
+
+// Value of "key": in a result line written by ResultToJson().
+static bool FindField(const std::string &line, const char *key, std::string &value) {
+    std::string pattern = std::string("\"") + key + "\":";
+    size_t pos = line.find(pattern);
+    if (pos == std::string::npos)
+        return false;
+    pos += pattern.size();
+    if (pos < line.size() && line[pos] == '"') {
+        size_t end = line.find('"', pos + 1);
+        if (end == std::string::npos)
+            return false;
+        value = line.substr(pos + 1, end - pos - 1);
+        return true;
+    }
+    size_t end = line.find_first_of(",}", pos);
+    value = line.substr(pos, end == std::string::npos ? std::string::npos : end - pos);
+    return true;
+}
+
+static std::string ResultKey(const std::string &benchmark, size_t windows, size_t files) {
+    return benchmark + "/" + std::to_string(windows) + "/" + std::to_string(files);
+}
+
+// Medians of a previous results file, by ResultKey().
+static bool ReadBaseline(const std::wstring &path, std::map<std::string, double> &medians) {
+    FILE *file = nullptr;
+    if (_wfopen_s(&file, path.c_str(), L"rb") != 0 || !file)
+        return false;
+    char buffer[1024];
+    while (fgets(buffer, sizeof(buffer), file)) {
+        std::string line(buffer);
+        std::string benchmark, windows, files, median;
+        if (FindField(line, "benchmark", benchmark) && FindField(line, "windows", windows) &&
+            FindField(line, "files", files) && FindField(line, "medianUs", median))
+            medians[ResultKey(benchmark, strtoull(windows.c_str(), nullptr, 10),
+                              strtoull(files.c_str(), nullptr, 10))] = atof(median.c_str());
+    }
+    fclose(file);
+    return true;
+}
+
+// -------------------------------------------------------------------------
+// Suite
+// -------------------------------------------------------------------------
+static std::vector<size_t> ParseList(const wchar_t *text) {
+    std::vector<size_t> values;
+    while (*text) {
+        wchar_t *end = nullptr;
+        unsigned long long value = wcstoull(text, &end, 10);
+        if (end == text)
+            break;
+        values.push_back(static_cast<size_t>(value));
+        text = (*end == L',') ? end + 1 : end;
+    }
+    return values;
+}
+
+// Benchmarks that only depend on the file count.
+static void RunFileBenchmarks(const std::wstring &folder, const std::wstring &trackingFile, size_t files,
+                              HWND hwndNotify, std::vector<BenchResult> &results) {
+    results.push_back(Measure("folder_enumeration", 0, files, [&]() -> size_t {
+        DirectoryIndex index;
+        if (!index.Start(folder, hwndNotify, WM_APP_DIRECTORY_CHANGED))
+            return 0;
+        // The listing arrives in batches; the last one marks the index loaded.
+        while (!index.IsLoaded()) {
+            if (!WaitForNotify(hwndNotify, WM_APP_DIRECTORY_CHANGED))
+                return 0;
+            index.ApplyPendingChanges();
+        }
+        size_t count = index.GetEntries().size();
+        index.Stop();
+        return count;
+    }));
+
+    std::vector<StoredTrackedWindow> entries = MakeEntries(folder, files, std::vector<TrackedWindow>());
+    results.push_back(Measure("save_tracking", 0, files, [&]() -> size_t {
+        return SaveTrackingEntries(trackingFile, entries) ? entries.size() : 0;
+    }));
+    std::vector<StoredTrackedWindow> read;
+    results.push_back(Measure("read_tracking", 0, files, [&]() -> size_t {
+        return ReadTrackingFile(trackingFile, read) ? read.size() : 0;
+    }));
+    DeleteFileW(trackingFile.c_str());
+
+    std::vector<std::wstring> names;
+    names.reserve(files);
+    for (size_t i = 0; i < files; ++i)
+        names.push_back(BenchFileName(i));
+    PrefixIndex prefixIndex;
+    results.push_back(Measure("cli_index_build", 0, files, [&]() -> size_t {
+        prefixIndex.Build(names);
+        return prefixIndex.GetCount();
+    }));
+    std::wstring input = BENCH_CLI_INPUT;
+    std::vector<std::wstring> shown;
+    results.push_back(Measure("cli_filter", 0, files, [&]() -> size_t {
+        // One Narrow() and one copy of the visible range per key, then the input is cleared.
+        for (size_t length = 1; length <= input.size(); ++length) {
+            prefixIndex.Narrow(input.substr(0, length));
+            shown.clear();
+            for (size_t pos = prefixIndex.GetRangeBegin(); pos < prefixIndex.GetRangeEnd(); ++pos)
+                shown.push_back(prefixIndex.GetName(pos));
+        }
+        prefixIndex.Narrow(std::wstring());
+        return input.size();
+    }));
+
+    FuzzySearcher searcher;
+    searcher.Start(hwndNotify, WM_APP_SEARCH_RESULTS);
+    searcher.SetNames(std::make_shared<const std::vector<std::wstring>>(names));
+    std::wstring fuzzyInput = BENCH_FUZZY_INPUT;
+    results.push_back(Measure("cli_fuzzy_filter", 0, files, [&]() -> size_t {
+        // Like cli_filter: one query per key, then the input is cleared.
+        for (size_t length = 1; length <= fuzzyInput.size(); ++length) {
+            if (!WaitForSearch(searcher, hwndNotify, searcher.Submit(fuzzyInput.substr(0, length))))
+                return 0;
+        }
+        if (!WaitForSearch(searcher, hwndNotify, searcher.Submit(std::wstring())))
+            return 0;
+        return fuzzyInput.size();
+    }));
+    searcher.Stop();
+}
+
+// Benchmarks that depend on the window count, and on both counts.
+static void RunWindowBenchmarks(size_t windows, const std::vector<size_t> &fileCounts,
+                                const std::map<size_t, std::wstring> &folders, HWND hwndNotify,
+                                std::vector<BenchResult> &results) {
+    WindowHost host;
+    if (!host.Start(windows)) {
+        printf("  window host with %zu windows did not start; skipped\n", windows);
+        return;
+    }
+    std::vector<HWND> hostWindows = host.Windows();
+
+    WindowMonitor monitor;
+    results.push_back(Measure("enumerate_windows", windows, 0, [&]() -> size_t {
+        return monitor.EnumerateWindows().size();
+    }));
+    results.push_back(Measure("consistency_sweep", windows, 0, [&]() -> size_t {
+        monitor.Resync();
+        return monitor.GetWindows().size();
+    }));
+    std::vector<TrackedWindow> fingerprints(hostWindows.size());
+    results.push_back(Measure("get_fingerprint", windows, 0, [&]() -> size_t {
+        for (size_t i = 0; i < hostWindows.size(); ++i)
+            fingerprints[i] = GetFingerprint(hostWindows[i]);
+        return hostWindows.size();
+    }));
+    std::vector<TrackedWindow> current = fingerprints;
+    results.push_back(Measure("compare_fingerprints", windows, 0, [&]() -> size_t {
+        size_t matches = 0;
+        for (size_t i = 0; i < current.size(); ++i)
+            matches += CompareFingerprints(fingerprints[i], current[i]);
+        return matches;
+    }));
+    // Host windows in creation order, so fingerprint i belongs to file i.
+    std::sort(fingerprints.begin(), fingerprints.end(), [](const TrackedWindow &a, const TrackedWindow &b) {
+        return a.windowTitle < b.windowTitle;
+    });
+
+    WindowSnapshotWorker worker;
+    bool workerStarted = worker.Start(hwndNotify, WM_APP_SNAPSHOT_READY) &&
+                         WaitForNotify(hwndNotify, WM_APP_SNAPSHOT_READY);
+    if (workerStarted)
+        worker.TakeLatest();
+
+    for (size_t files : fileCounts) {
+        // Half of the sampled names have a window, half do not.
+        size_t sample = (std::min)(files, BENCH_LOOKUP_SAMPLE);
+        std::vector<std::wstring> lookups;
+        for (size_t i = 0; i < sample; ++i)
+            lookups.push_back(BenchFileName((i % 2) ? (windows + i) % files : (i * windows / sample) % files));
+        results.push_back(Measure("get_window_handle_by_file_name", windows, files, [&]() -> size_t {
+            for (const auto &name : lookups)
+                GetWindowHandleByFileName(name);
+            return lookups.size();
+        }));
+
+        if (!workerStarted)
+            continue;
+        std::vector<std::wstring> names;
+        names.reserve(files);
+        for (size_t i = 0; i < files; ++i)
+            names.push_back(BenchFileName(i));
+        TitleMatcher matcher;
+        matcher.Build(names);
+        TitleMatchResult matches;
+        const WindowSnapshot *snapshot = &worker.GetCurrent();
+        results.push_back(Measure("snapshot_cycle", windows, files, [&]() -> size_t {
+            worker.RequestSnapshot();
+            if (!WaitForNotify(hwndNotify, WM_APP_SNAPSHOT_READY))
+                return 0;
+            const WindowSnapshot *latest = worker.TakeLatest();
+            snapshot = latest ? latest : &worker.GetCurrent();
+            matcher.Match(snapshot->windows, matches);
+            return static_cast<size_t>(snapshot->windows.GetCount());
+        }));
+
+        std::vector<StoredTrackedWindow> entries = MakeEntries(folders.at(files), files, fingerprints);
+        std::map<std::wstring, TrackedWindow> fileWindowMap;
+        results.push_back(Measure("rehydrate_tracking", windows, files, [&]() -> size_t {
+            fileWindowMap.clear();
+            RehydrateTrackingMapping(entries, worker.GetCurrent().windows, fileWindowMap);
+            return entries.size();
+        }));
+    }
+    worker.Stop();
+    host.Stop();
+}
+
+int wmain(int argc, wchar_t **argv) {
+    if (argc == 5 && wcscmp(argv[1], L"--window-host") == 0)
+        return RunWindowHost(static_cast<size_t>(wcstoull(argv[2], nullptr, 10)), argv[3], argv[4]);
+
+    std::vector<size_t> windowCounts = { 50, 500, 5000 };
+    std::vector<size_t> fileCounts = { 100, 10000, 100000 };
+    std::wstring outPath = L"engine_bench.json";
+    std::wstring baselinePath;
+    double tolerance = 1.25;
+    bool keep = false;
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (wcscmp(argv[i], L"--windows") == 0 && hasValue)
+            windowCounts = ParseList(argv[++i]);
+        else if (wcscmp(argv[i], L"--files") == 0 && hasValue)
+            fileCounts = ParseList(argv[++i]);
+        else if (wcscmp(argv[i], L"--out") == 0 && hasValue)
+            outPath = argv[++i];
+        else if (wcscmp(argv[i], L"--baseline") == 0 && hasValue)
+            baselinePath = argv[++i];
+        else if (wcscmp(argv[i], L"--tolerance") == 0 && hasValue)
+            tolerance = _wtof(argv[++i]);
+        else if (wcscmp(argv[i], L"--keep") == 0)
+            keep = true;
+        else {
+            printf("Usage: EngineBench [--windows 50,500,5000] [--files 100,10000,100000]\n"
+                   "                   [--out file] [--baseline file] [--tolerance x] [--keep]\n");
+            return 1;
+        }
+    }
+
+    // Engine notifications arrive at a message-only window of this thread.
+    HWND hwndNotify = CreateWindowExW(0, L"STATIC", L"", 0, 0, 0, 0, 0, HWND_MESSAGE, nullptr,
+                                      GetModuleHandle(nullptr), nullptr);
+    if (!hwndNotify)
+        return 1;
+
+    wchar_t tempPath[MAX_PATH];
+    GetTempPathW(MAX_PATH, tempPath);
+    std::wstring root = std::wstring(tempPath) + L"MYexplorerBench";
+    CreateDirectoryW(root.c_str(), nullptr);
+    std::wstring trackingFile = root + L"\\tracking.bench.dat";
+
+    std::vector<BenchResult> results;
+    std::map<size_t, std::wstring> folders;
+    for (size_t files : fileCounts) {
+        std::wstring folder = root + L"\\files_" + std::to_wstring(files);
+        printf("Preparing %zu files in %ls\n", files, folder.c_str());
+        if (!PrepareFolder(folder, files)) {
+            printf("  could not create the files; aborted\n");
+            return 1;
+        }
+        folders[files] = folder;
+        RunFileBenchmarks(folder, trackingFile, files, hwndNotify, results);
+    }
+    for (size_t windows : windowCounts) {
+        printf("Starting %zu synthetic windows\n", windows);
+        RunWindowBenchmarks(windows, fileCounts, folders, hwndNotify, results);
+    }
+    if (!keep) {
+        for (const auto &folder : folders)
+            RemoveFolder(folder.second, folder.first);
+        RemoveDirectoryW(root.c_str());
+    }
+    DestroyWindow(hwndNotify);
+
+    if (!WriteResults(outPath, results)) {
+        printf("Could not write %ls\n", outPath.c_str());
+        return 1;
+    }
+    printf("Wrote %zu results to %ls\n", results.size(), outPath.c_str());
+
+    if (baselinePath.empty())
+        return 0;
+    std::map<std::string, double> baseline;
+    if (!ReadBaseline(baselinePath, baseline)) {
+        printf("Could not read baseline %ls\n", baselinePath.c_str());
+        return 1;
+    }
+    int regressions = 0;
+    for (const auto &r : results) {
+        auto it = baseline.find(ResultKey(r.benchmark, r.windows, r.files));
+        if (it == baseline.end() || it->second <= 0)
+            continue;
+        double ratio = r.medianUs / it->second;
+        if (ratio > tolerance) {
+            printf("REGRESSION %s (%zu windows, %zu files): median %.1f us vs %.1f us (x%.2f)\n",
+                   r.benchmark.c_str(), r.windows, r.files, r.medianUs, it->second, ratio);
+            ++regressions;
+        }
+    }
+    printf("%d regression(s) beyond x%.2f of %ls\n", regressions, tolerance, baselinePath.c_str());
+    return regressions ? 2 : 0;
+}
+
+// End of file: EngineBench.cpp (Version: 1.1)
@@ -1,85 +1,332 @@
 // File: FileUtils.cpp
-// Version: 1.1
+// Version: 1.6
 // -------------------------------------------------------------------------
-// This file implements functions for launching files and managing the
-// tracking mapping persistence. Logging functionality has been removed.
+// This file implements functions for managing the tracking mapping
+// persistence. Logging functionality has been removed.
+// Changes in Version 1.6:
+//  - SaveTrackingEntries() writes stored entries with their recorded process
+//    creation times; SaveTrackingMapping() builds the entries and calls it.
+// Changes in Version 1.5:
+//  - RehydrateTrackingMapping() reads the columnar WindowTable of a snapshot.
+//  - Fingerprints are filled through SetFingerprintClassName() and
+//    SetFingerprintTitle() so the interned class ID and hashes are set.
+// Changes in Version 1.4:
+//  - LoadTrackingMapping() (up to two EnumWindows per entry) was replaced by
+//    RehydrateTrackingMapping(), which resolves every entry against a single
+//    window snapshot using a PID index and a TitleMatcher.
+// Changes in Version 1.3:
+//  - tracking.dat is a versioned binary file with full fingerprints, read
+//    through a memory-mapped view. The old text format is still read.
+// Changes in Version 1.2:
+//  - LaunchFile() was replaced by the asynchronous LaunchService.
 // -------------------------------------------------------------------------
 
 #include "FileUtils.h"
-#include "WindowUtils.h"   // For GetMainWindowHandle() and GetWindowHandleByFileName()
+#include "TitleMatcher.h"  // For matching stored file names in window titles
 #include "FingerprintUtils.h"
+#include "ProcessCache.h"  // For process creation times
 #include <fstream>
-#include <sstream>
-#include <thread>
-#include <chrono>
-#include <shellapi.h>
-
-void LaunchFile(const std::wstring &filePath, HWND hwnd, std::map<std::wstring, TrackedWindow>& fileWindowMap) {
-    SHELLEXECUTEINFOW sei = {0};
-    sei.cbSize = sizeof(sei);
-    sei.fMask = SEE_MASK_NOCLOSEPROCESS;
-    sei.hwnd = hwnd;
-    sei.lpVerb = L"open";
-    sei.lpFile = filePath.c_str();
-    sei.nShow = SW_SHOWNORMAL;
-    if (ShellExecuteExW(&sei)) {
-        const int pollInterval = 250;
-        const int maxPollTime = 1000;
-        int elapsed = 0;
-        HWND hwndLaunched = nullptr;
-        while (elapsed < maxPollTime) {
-            hwndLaunched = GetMainWindowHandle(GetProcessId(sei.hProcess));
-            if (hwndLaunched)
-                break;
-            std::this_thread::sleep_for(std::chrono::milliseconds(pollInterval));
-            elapsed += pollInterval;
-        }
-        if (hwndLaunched)
-            fileWindowMap[filePath] = GetFingerprint(hwndLaunched);
-        CloseHandle(sei.hProcess);
-    } else {
-        // Removed logging call.
-        MessageBox(hwnd, L"Failed to launch file.", L"Error", MB_OK | MB_ICONERROR);
+#include <unordered_map>
+#include <cstdint>
+#include <cstring>
+#include <cwchar>
+
+// -------------------------------------------------------------------------
+// Binary tracking file layout (all fields little-endian, naturally aligned):
+//   TrackingFileHeader
+//   TrackingRecord[recordCount]
+//   WCHAR stringTable[stringTableLength]
+// Strings are referenced by (offset, length) in WCHARs into the string
+// table; equal strings (e.g. class names) are stored once.
+// -------------------------------------------------------------------------
+static const uint32_t TRACKING_FILE_MAGIC = 0x5254594D; // "MYTR"
+static const uint16_t TRACKING_FILE_VERSION = 1;
+
+struct TrackingFileHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t recordCount;
+    uint32_t recordSize;
+    uint32_t stringTableOffset;  ///< Byte offset of the string table.
+    uint32_t stringTableLength;  ///< Length of the string table in WCHARs.
+    uint32_t checksum;           ///< FNV-1a over everything after the header.
+    uint32_t reserved;
+};
+
+struct TrackingRecord {
+    uint32_t pathOffset;
+    uint32_t pathLength;
+    uint32_t classOffset;
+    uint32_t classLength;
+    uint32_t titleOffset;
+    uint32_t titleLength;
+    uint32_t processId;
+    int32_t failCount;
+    int32_t left;
+    int32_t top;
+    int32_t right;
+    int32_t bottom;
+    uint64_t hwnd;
+    uint64_t launchTime;
+    uint64_t processCreateTime;
+};
+
+static_assert(sizeof(TrackingFileHeader) == 32, "TrackingFileHeader layout changed");
+static_assert(sizeof(TrackingRecord) == 72, "TrackingRecord layout changed");
+
+static uint32_t Fnv1a32(const BYTE *data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 16777619u;
     }
+    return hash;
 }
 
-void SaveTrackingMapping(const std::wstring &trackingFile, const std::map<std::wstring, TrackedWindow>& fileWindowMap) {
-    std::wofstream ofs(trackingFile.c_str());
-    if (!ofs) {
-        // Removed logging call.
-        return;
+// Builds the deduplicated string table while records are written.
+class StringTableBuilder {
+public:
+    void Add(const std::wstring &text, uint32_t &offset, uint32_t &length) {
+        auto it = m_offsets.find(text);
+        if (it == m_offsets.end()) {
+            it = m_offsets.emplace(text, static_cast<uint32_t>(m_chars.size())).first;
+            m_chars.insert(m_chars.end(), text.begin(), text.end());
+        }
+        offset = it->second;
+        length = static_cast<uint32_t>(text.size());
+    }
+    const std::vector<WCHAR>& GetChars() const { return m_chars; }
+
+private:
+    std::unordered_map<std::wstring, uint32_t> m_offsets;
+    std::vector<WCHAR> m_chars;
+};
+
+bool SaveTrackingEntries(const std::wstring &trackingFile, const std::vector<StoredTrackedWindow> &entries) {
+    StringTableBuilder strings;
+    std::vector<TrackingRecord> records;
+    records.reserve(entries.size());
+    for (const auto &entry : entries) {
+        const TrackedWindow &tw = entry.window;
+        TrackingRecord rec = {};
+        strings.Add(entry.filePath, rec.pathOffset, rec.pathLength);
+        strings.Add(GetInternedClassName(tw.classId), rec.classOffset, rec.classLength);
+        strings.Add(tw.windowTitle, rec.titleOffset, rec.titleLength);
+        rec.processId = tw.processId;
+        rec.failCount = tw.failCount;
+        rec.left = tw.rect.left;
+        rec.top = tw.rect.top;
+        rec.right = tw.rect.right;
+        rec.bottom = tw.rect.bottom;
+        rec.hwnd = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(tw.hwnd));
+        rec.launchTime = tw.launchTime;
+        rec.processCreateTime = entry.processCreateTime;
+        records.push_back(rec);
+    }
+
+    const std::vector<WCHAR> &chars = strings.GetChars();
+    size_t recordBytes = records.size() * sizeof(TrackingRecord);
+    size_t stringBytes = chars.size() * sizeof(WCHAR);
+    std::vector<BYTE> buffer(sizeof(TrackingFileHeader) + recordBytes + stringBytes);
+    BYTE *body = buffer.data() + sizeof(TrackingFileHeader);
+    if (recordBytes)
+        memcpy(body, records.data(), recordBytes);
+    if (stringBytes)
+        memcpy(body + recordBytes, chars.data(), stringBytes);
+
+    TrackingFileHeader header = {};
+    header.magic = TRACKING_FILE_MAGIC;
+    header.version = TRACKING_FILE_VERSION;
+    header.headerSize = sizeof(TrackingFileHeader);
+    header.recordCount = static_cast<uint32_t>(records.size());
+    header.recordSize = sizeof(TrackingRecord);
+    header.stringTableOffset = static_cast<uint32_t>(sizeof(TrackingFileHeader) + recordBytes);
+    header.stringTableLength = static_cast<uint32_t>(chars.size());
+    header.checksum = Fnv1a32(body, recordBytes + stringBytes);
+    memcpy(buffer.data(), &header, sizeof(header));
+
+    // Write to a temporary file and swap it in, so a crash never leaves a half-written file.
+    std::wstring tempFile = trackingFile + L".tmp";
+    HANDLE hFile = CreateFileW(tempFile.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                               FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (hFile == INVALID_HANDLE_VALUE)
+        return false;
+    DWORD written = 0;
+    BOOL ok = WriteFile(hFile, buffer.data(), static_cast<DWORD>(buffer.size()), &written, nullptr) &&
+              written == buffer.size();
+    CloseHandle(hFile);
+    if (!ok || !MoveFileExW(tempFile.c_str(), trackingFile.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+        DeleteFileW(tempFile.c_str());
+        return false;
     }
+    return true;
+}
+
+bool SaveTrackingMapping(const std::wstring &trackingFile, const std::map<std::wstring, TrackedWindow>& fileWindowMap) {
+    std::vector<StoredTrackedWindow> entries;
+    entries.reserve(fileWindowMap.size());
     for (const auto& pair : fileWindowMap) {
-        ofs << pair.first << L"\t" << pair.second.processId << std::endl;
+        const TrackedWindow &tw = pair.second;
+        entries.push_back({ pair.first, tw, tw.processId ? ProcessCache::Shared().GetCreationTime(tw.processId) : 0 });
     }
-    ofs.close();
+    return SaveTrackingEntries(trackingFile, entries);
 }
 
-void LoadTrackingMapping(const std::wstring &trackingFile, std::map<std::wstring, TrackedWindow>& fileWindowMap, HWND hwnd) {
-    std::wifstream ifs(trackingFile.c_str());
-    if (!ifs) {
-        // Removed logging call.
-        return;
+// Parses a mapped binary tracking file. Returns false if it is not valid.
+static bool ParseTrackingImage(const BYTE *data, size_t size, std::vector<StoredTrackedWindow> &entries) {
+    if (size < sizeof(TrackingFileHeader))
+        return false;
+    TrackingFileHeader header;
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != TRACKING_FILE_MAGIC || header.version != TRACKING_FILE_VERSION ||
+        header.headerSize < sizeof(TrackingFileHeader) || header.recordSize < sizeof(TrackingRecord))
+        return false;
+    uint64_t recordsEnd = uint64_t(header.headerSize) + uint64_t(header.recordCount) * header.recordSize;
+    uint64_t stringsEnd = uint64_t(header.stringTableOffset) + uint64_t(header.stringTableLength) * sizeof(WCHAR);
+    if (recordsEnd > header.stringTableOffset || stringsEnd != size)
+        return false;
+    if (Fnv1a32(data + sizeof(TrackingFileHeader), size - sizeof(TrackingFileHeader)) != header.checksum)
+        return false;
+
+    const BYTE *stringBase = data + header.stringTableOffset;
+    auto getString = [&](uint32_t offset, uint32_t length, std::wstring &out) -> bool {
+        if (uint64_t(offset) + length > header.stringTableLength)
+            return false;
+        out.assign(length, L'\0');
+        if (length)
+            memcpy(&out[0], stringBase + size_t(offset) * sizeof(WCHAR), length * sizeof(WCHAR));
+        return true;
+    };
+
+    entries.reserve(entries.size() + header.recordCount);
+    for (uint32_t i = 0; i < header.recordCount; ++i) {
+        TrackingRecord rec;
+        memcpy(&rec, data + header.headerSize + size_t(i) * header.recordSize, sizeof(rec));
+        StoredTrackedWindow entry;
+        std::wstring className, title;
+        if (!getString(rec.pathOffset, rec.pathLength, entry.filePath) ||
+            !getString(rec.classOffset, rec.classLength, className) ||
+            !getString(rec.titleOffset, rec.titleLength, title))
+            return false;
+        SetFingerprintClassName(entry.window, className);
+        SetFingerprintTitle(entry.window, title);
+        entry.window.processId = rec.processId;
+        entry.window.hwnd = reinterpret_cast<HWND>(static_cast<uintptr_t>(rec.hwnd));
+        entry.window.rect = { rec.left, rec.top, rec.right, rec.bottom };
+        entry.window.failCount = rec.failCount;
+        entry.window.launchTime = rec.launchTime;
+        entry.processCreateTime = rec.processCreateTime;
+        entries.push_back(entry);
     }
+    return true;
+}
+
+// Reads the pre-1.3 "path<TAB>PID" text format.
+static bool ReadLegacyTrackingFile(const std::wstring &trackingFile, std::vector<StoredTrackedWindow> &entries) {
+    std::wifstream ifs(trackingFile.c_str());
+    if (!ifs)
+        return false;
     std::wstring line;
     while (std::getline(ifs, line)) {
-        std::wistringstream iss(line);
-        std::wstring filePath;
-        DWORD processId;
-        if (iss >> filePath >> processId) {
-            HWND hwndTracked = GetMainWindowHandle(processId);
-            if (!hwndTracked) {
-                size_t pos = filePath.rfind(L'\\');
-                if (pos != std::wstring::npos) {
-                    std::wstring fileName = filePath.substr(pos + 1);
-                    hwndTracked = GetWindowHandleByFileName(fileName);
-                }
+        // Paths may contain spaces (and, in theory, tabs); the PID follows the last tab.
+        size_t tab = line.rfind(L'\t');
+        if (tab == std::wstring::npos || tab == 0)
+            continue;
+        wchar_t *end = nullptr;
+        unsigned long processId = wcstoul(line.c_str() + tab + 1, &end, 10);
+        if (end == line.c_str() + tab + 1)
+            continue;
+        StoredTrackedWindow entry = {};
+        entry.filePath = line.substr(0, tab);
+        entry.window.processId = static_cast<DWORD>(processId);
+        entries.push_back(entry);
+    }
+    return true;
+}
+
+bool ReadTrackingFile(const std::wstring &trackingFile, std::vector<StoredTrackedWindow> &entries) {
+    HANDLE hFile = CreateFileW(trackingFile.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                               FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (hFile == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER fileSize = {};
+    if (!GetFileSizeEx(hFile, &fileSize) || fileSize.QuadPart == 0 || fileSize.QuadPart > 0x7FFFFFFF) {
+        CloseHandle(hFile);
+        return false;
+    }
+
+    bool parsed = false;
+    bool isBinary = false;
+    HANDLE hMapping = CreateFileMappingW(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (hMapping) {
+        const BYTE *view = static_cast<const BYTE*>(MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0));
+        if (view) {
+            size_t size = static_cast<size_t>(fileSize.QuadPart);
+            uint32_t magic = 0;
+            if (size >= sizeof(magic))
+                memcpy(&magic, view, sizeof(magic));
+            isBinary = (magic == TRACKING_FILE_MAGIC);
+            if (isBinary) {
+                std::vector<StoredTrackedWindow> loaded;
+                parsed = ParseTrackingImage(view, size, loaded);
+                if (parsed)
+                    entries.swap(loaded);
             }
-            if (hwndTracked)
-                fileWindowMap[filePath] = GetFingerprint(hwndTracked);
+            UnmapViewOfFile(view);
+        }
+        CloseHandle(hMapping);
+    }
+    CloseHandle(hFile);
+
+    if (!isBinary)
+        parsed = ReadLegacyTrackingFile(trackingFile, entries);
+    return parsed;
+}
+
+int RehydrateTrackingMapping(const std::vector<StoredTrackedWindow> &entries, const WindowTable &windows,
+                             std::map<std::wstring, TrackedWindow>& fileWindowMap) {
+    // PID -> first window in z-order, which is what GetMainWindowHandle() picked.
+    std::unordered_map<DWORD, int> windowByPid;
+    windowByPid.reserve(windows.GetCount());
+    for (int i = 0; i < windows.GetCount(); ++i)
+        windowByPid.emplace(windows.GetPid(i), i);
+
+    // Title fallback: one matcher pass over the snapshot for all stored file names.
+    std::vector<std::wstring> fileNames;
+    fileNames.reserve(entries.size());
+    for (const auto &entry : entries) {
+        size_t pos = entry.filePath.rfind(L'\\');
+        fileNames.push_back(pos != std::wstring::npos ? entry.filePath.substr(pos + 1) : std::wstring());
+    }
+    TitleMatcher matcher;
+    matcher.Build(fileNames);
+    TitleMatchResult matches;
+    matcher.Match(windows, matches);
+
+    int resolved = 0;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const StoredTrackedWindow &entry = entries[i];
+        int windowIndex = -1;
+        DWORD processId = entry.window.processId;
+        auto byPid = processId ? windowByPid.find(processId) : windowByPid.end();
+        // A PID whose creation time changed belongs to a different process now.
+        if (byPid != windowByPid.end() &&
+            (entry.processCreateTime == 0 ||
+             ProcessCache::Shared().GetCreationTime(processId) == entry.processCreateTime))
+            windowIndex = byPid->second;
+        if (windowIndex < 0 && !fileNames[i].empty()) {
+            int fileIndex = matcher.GetFileIndex(fileNames[i]);
+            if (fileIndex >= 0 && matches.fileWindows[fileIndex]) {
+                windowIndex = windows.Find(matches.fileWindows[fileIndex]);
+            }
+        }
+        if (windowIndex >= 0) {
+            fileWindowMap[entry.filePath] = GetFingerprint(windows, windowIndex);
+            ++resolved;
         }
     }
-    ifs.close();
+    return resolved;
 }
 
-// End of file: FileUtils.cpp (Version: 1.1)
+// End of file: FileUtils.cpp (Version: 1.6)
@@ -1,14 +1,22 @@
 // File: FileUtils.h
-// Version: 1.0 (Phase 3.3: File Launching & Persistence modularized)
+// Version: 1.5 (Saving stored entries for the tracking journal)
 // -------------------------------------------------------------------------
-// This header declares functions for launching files and managing the
-// tracking persistence mapping.
+// This header declares functions for managing the tracking persistence
+// mapping. Files are launched asynchronously by LaunchService.
 // Functions include:
-//   - LaunchFile()
 //   - SaveTrackingMapping()
-//   - LoadTrackingMapping()
-// The functions use FingerprintUtils to capture window fingerprints and
-// WindowUtils to locate windows.
+//   - SaveTrackingEntries()
+//   - ReadTrackingFile()
+//   - RehydrateTrackingMapping()
+// RehydrateTrackingMapping() resolves all stored entries against one window
+// snapshot instead of enumerating the desktop per entry.
+//
+// The tracking file is a versioned binary file: a fixed header, fixed-size
+// records holding every TrackedWindow field plus the process creation time,
+// and a shared UTF-16 string table. A checksum over records and strings
+// rejects truncated or corrupt files. It is read through a memory-mapped
+// view. Files in the old "path<TAB>PID" text format are still accepted and
+// are rewritten in the binary format on the next save.
 // -------------------------------------------------------------------------
 
 #ifndef FILEUTILS_H
@@ -17,20 +25,40 @@
 #include <windows.h>
 #include <string>
 #include <map>
+#include <vector>
 #include "FingerprintUtils.h" // For TrackedWindow
+#include "WindowTable.h"      // For WindowTable
 
-// Launches the file specified by filePath using ShellExecuteExW.
-// The parent window is specified by hwnd, and upon success, updates the
-// fileWindowMap with the tracked window fingerprint.
-void LaunchFile(const std::wstring &filePath, HWND hwnd, std::map<std::wstring, TrackedWindow>& fileWindowMap);
+/**
+ * @struct StoredTrackedWindow
+ * @brief One entry of the tracking file as stored on disk.
+ */
+struct StoredTrackedWindow {
+    std::wstring filePath;
+    TrackedWindow window;         ///< Fingerprint at save time (text files only carry processId).
+    ULONGLONG processCreateTime;  ///< Creation time of window.processId at save time (0 if unknown).
+};
 
-// Saves the tracking mapping (file path and process ID) to the given trackingFile.
-void SaveTrackingMapping(const std::wstring &trackingFile, const std::map<std::wstring, TrackedWindow>& fileWindowMap);
+// Saves the tracking mapping (file path and full fingerprint) to the given trackingFile.
+// Returns false if the file could not be written; the previous file is then left intact.
+bool SaveTrackingMapping(const std::wstring &trackingFile, const std::map<std::wstring, TrackedWindow>& fileWindowMap);
 
-// Loads the tracking mapping from the given trackingFile and updates fileWindowMap.
-// Uses window utility functions to locate the corresponding window handles.
-void LoadTrackingMapping(const std::wstring &trackingFile, std::map<std::wstring, TrackedWindow>& fileWindowMap, HWND hwnd);
+// Saves stored entries as they are, with their recorded process creation
+// times (the compaction of TrackingJournal). Same failure behaviour as
+// SaveTrackingMapping().
+bool SaveTrackingEntries(const std::wstring &trackingFile, const std::vector<StoredTrackedWindow> &entries);
+
+// Reads all entries of trackingFile (binary or legacy text format).
+// Returns false if the file is missing or corrupt.
+bool ReadTrackingFile(const std::wstring &trackingFile, std::vector<StoredTrackedWindow> &entries);
+
+// Resolves stored entries against a window snapshot in one pass: first by
+// process ID (if the process is still the same instance), then by file name
+// in window titles. Resolved entries are added to fileWindowMap.
+// Returns the number of entries resolved.
+int RehydrateTrackingMapping(const std::vector<StoredTrackedWindow> &entries, const WindowTable &windows,
+                             std::map<std::wstring, TrackedWindow>& fileWindowMap);
 
 #endif // FILEUTILS_H
 
-// End of file: FileUtils.h (Version: 1.0)
+// End of file: FileUtils.h (Version: 1.5)
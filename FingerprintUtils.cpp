@@ -1,31 +1,78 @@
 // File: FingerprintUtils.cpp
-// Version: 1.0 (Phase 3.1: Fingerprint Utilities extracted)
+// Version: 1.4 (Shared case-insensitive matching)
 // -------------------------------------------------------------------------
 // This file implements the composite fingerprinting functions.
 // It encapsulates logic to capture and compare window fingerprints.
 // -------------------------------------------------------------------------
 
 #include "FingerprintUtils.h"
+#include "StringInterner.h"
+#include "TextMatch.h"  // For FoldCharNoCase() and EqualsNoCase()
 #include <cwchar>
+#include <cwctype>
+
+UINT InternClassName(const wchar_t *className, size_t length) {
+    return StringInterner::ClassNames().Intern(className, length);
+}
+
+const std::wstring& GetInternedClassName(UINT classId) {
+    return StringInterner::ClassNames().Get(classId);
+}
+
+ULONGLONG HashNormalized(const wchar_t *text, size_t length) {
+    ULONGLONG hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < length; ++i) {
+        hash ^= static_cast<ULONGLONG>(FoldCharNoCase(text[i]));
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+void SetFingerprintTitle(TrackedWindow &tw, const wchar_t *title, size_t length) {
+    tw.windowTitle.assign(title, length);
+    tw.titleHash = HashNormalized(title, length);
+}
+
+void SetFingerprintClassName(TrackedWindow &tw, const std::wstring &className) {
+    tw.classId = InternClassName(className);
+    tw.classHash = HashNormalized(className.c_str(), className.size());
+}
 
 // Implementation of GetFingerprint()
 TrackedWindow GetFingerprint(HWND hwnd) {
     TrackedWindow tw;
-    tw.processId = GetProcessId(hwnd);
+    DWORD pid = 0;
+    GetWindowThreadProcessId(hwnd, &pid);
+    tw.processId = pid;
     tw.hwnd = hwnd;
     GetWindowRect(hwnd, &tw.rect);
     wchar_t classBuf[256] = {0};
-    GetClassName(hwnd, classBuf, 256);
-    tw.className = classBuf;
+    int classLen = GetClassName(hwnd, classBuf, 256);
+    tw.classId = InternClassName(classBuf, classLen > 0 ? classLen : 0);
+    tw.classHash = HashNormalized(classBuf, classLen > 0 ? classLen : 0);
     int titleLen = GetWindowTextLength(hwnd);
+    std::wstring title;
     if (titleLen > 0) {
-        std::wstring title(titleLen + 1, L'\0');
+        title.assign(titleLen + 1, L'\0');
         GetWindowText(hwnd, &title[0], titleLen + 1);
         title.resize(wcslen(title.c_str()));
-        tw.windowTitle = title;
-    } else {
-        tw.windowTitle = L"";
     }
+    SetFingerprintTitle(tw, title);
+    tw.failCount = 0;
+    tw.launchTime = GetTickCount64();
+    return tw;
+}
+
+// Implementation of GetFingerprint() for a captured window table row
+TrackedWindow GetFingerprint(const WindowTable &windows, int index) {
+    TrackedWindow tw;
+    tw.processId = windows.GetPid(index);
+    tw.hwnd = windows.GetHwnd(index);
+    tw.rect = windows.GetRect(index);
+    tw.classId = windows.GetClassId(index);
+    const std::wstring &className = windows.GetWindowClass(index);
+    tw.classHash = HashNormalized(className.c_str(), className.size());
+    SetFingerprintTitle(tw, windows.GetTitle(index), windows.GetTitleLength(index));
     tw.failCount = 0;
     tw.launchTime = GetTickCount64();
     return tw;
@@ -35,24 +82,24 @@ TrackedWindow GetFingerprint(HWND hwnd) {
 bool CompareFingerprints(const TrackedWindow &twStored, const TrackedWindow &twCurrent) {
     if (twStored.processId != twCurrent.processId)
         return false;
-    if (twStored.className != twCurrent.className)
+    if (twStored.classId != twCurrent.classId)
         return false;
     if (twStored.rect.left != twCurrent.rect.left ||
         twStored.rect.top != twCurrent.rect.top ||
         twStored.rect.right != twCurrent.rect.right ||
         twStored.rect.bottom != twCurrent.rect.bottom)
         return false;
-    std::wstring storedTitle = twStored.windowTitle;
-    std::wstring currentTitle = twCurrent.windowTitle;
-    for (auto &c : storedTitle) c = towlower(c);
-    for (auto &c : currentTitle) c = towlower(c);
-    return (storedTitle == currentTitle);
+    if (twStored.titleHash != twCurrent.titleHash)
+        return false;
+    // Equal hashes: confirm with the full titles to rule out a collision.
+    return EqualsNoCase(twStored.windowTitle, twCurrent.windowTitle);
 }
 
 // Implementation of CompareStableAttributes()
 bool CompareStableAttributes(const TrackedWindow &stored, const TrackedWindow &current) {
+    // Interned IDs are equal exactly when the class names are equal.
     return (stored.processId == current.processId &&
-            stored.className == current.className);
+            stored.classId == current.classId);
 }
 
-// End of file: FingerprintUtils.cpp (Version: 1.0)
+// End of file: FingerprintUtils.cpp (Version: 1.4)
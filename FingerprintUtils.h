@@ -1,9 +1,25 @@
 // File: FingerprintUtils.h
-// Version: 1.0 (Phase 3.1: Fingerprint Utilities extracted)
+// Version: 1.5 (Shared case-insensitive matching)
 // -------------------------------------------------------------------------
 // This header declares functions for composite fingerprinting.
 // Functions include GetFingerprint(), CompareFingerprints(), and CompareStableAttributes().
 // These functions encapsulate the window tracking logic.
+//
+// Changes in Version 1.5:
+//  - Title hashing and the final title comparison use the folding and the
+//    vectorized EqualsNoCase() from TextMatch.h.
+//
+// Changes in Version 1.4:
+//  - GetFingerprint() builds fingerprints from a WindowTable row instead of
+//    a WindowInfo; class names are interned through StringInterner.
+//
+// Changes in Version 1.3:
+//  - Class names are interned into small integer IDs, and fingerprints
+//    carry 64-bit hashes of the lowercased title and class name. The
+//    comparisons check PID, class ID and hashes first and only compare
+//    the full titles when the hashes are equal.
+//  - GetFingerprint() now reads the process ID with GetWindowThreadProcessId()
+//    (GetProcessId() expects a process handle, not a window handle).
 // -------------------------------------------------------------------------
 
 #ifndef FINGERPRINTUTILS_H
@@ -11,17 +27,43 @@
 
 #include <windows.h>
 #include <string>
-#include "MainWindow.h" // For TrackedWindow definition
+#include "TrackedWindow.h" // For TrackedWindow definition
+#include "WindowTable.h"   // For WindowTable
 
 // Captures composite fingerprint details of the given window.
 TrackedWindow GetFingerprint(HWND hwnd);
 
+// Builds a fingerprint from an already captured window table row,
+// without querying the window again.
+TrackedWindow GetFingerprint(const WindowTable &windows, int index);
+
+// Sets the title of a fingerprint and recomputes its hash.
+void SetFingerprintTitle(TrackedWindow &tw, const wchar_t *title, size_t length);
+inline void SetFingerprintTitle(TrackedWindow &tw, const std::wstring &title) {
+    SetFingerprintTitle(tw, title.c_str(), title.size());
+}
+
+// Sets the class name of a fingerprint (interned) and its hash.
+void SetFingerprintClassName(TrackedWindow &tw, const std::wstring &className);
+
 // Compares two window fingerprints in detail.
 bool CompareFingerprints(const TrackedWindow &twStored, const TrackedWindow &twCurrent);
 
 // Compares stable attributes of two fingerprints (process ID and class name).
 bool CompareStableAttributes(const TrackedWindow &stored, const TrackedWindow &current);
 
+// Returns the process-wide ID of a class name; equal names get equal IDs.
+UINT InternClassName(const wchar_t *className, size_t length);
+inline UINT InternClassName(const std::wstring &className) {
+    return InternClassName(className.c_str(), className.size());
+}
+
+// Returns the class name for an interned ID (empty for unknown IDs).
+const std::wstring& GetInternedClassName(UINT classId);
+
+// 64-bit FNV-1a hash of text folded with FoldCharNoCase() (the normalization used for fingerprints).
+ULONGLONG HashNormalized(const wchar_t *text, size_t length);
+
 #endif // FINGERPRINTUTILS_H
 
-// End of file: FingerprintUtils.h (Version: 1.0)
+// End of file: FingerprintUtils.h (Version: 1.5)
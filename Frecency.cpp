@@ -0,0 +1,173 @@
+// File: Frecency.cpp
+// Version: 1.0
+// -------------------------------------------------------------------------
+// This file implements FrecencyTable (see Frecency.h).
+// -------------------------------------------------------------------------
+
+#include "Frecency.h"
+#include "Config.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <vector>
+
+static const uint32_t FRECENCY_FILE_MAGIC = 0x3146574D; // "MWF1"
+static const uint32_t FRECENCY_FILE_VERSION = 1;
+
+#pragma pack(push, 1)
+struct FrecencyFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t count;
+};
+struct FrecencyFileRecord {
+    double score;
+    uint64_t time;
+    uint32_t pathLength;    ///< UTF-16 units following the record.
+};
+#pragma pack(pop)
+
+FrecencyTable::FrecencyTable()
+    : m_generation(0)
+{
+}
+
+ULONGLONG FrecencyTable::FrecencyNow() {
+    FILETIME ft;
+    GetSystemTimeAsFileTime(&ft);
+    ULARGE_INTEGER value;
+    value.LowPart = ft.dwLowDateTime;
+    value.HighPart = ft.dwHighDateTime;
+    return value.QuadPart / 10000;
+}
+
+double FrecencyTable::Decay(const Entry &entry, ULONGLONG now) {
+    if (now <= entry.time)
+        return entry.score;
+    return entry.score * std::exp2(-static_cast<double>(now - entry.time) / FRECENCY_HALF_LIFE);
+}
+
+void FrecencyTable::Record(const std::wstring &filePath) {
+    ULONGLONG now = FrecencyNow();
+    auto it = m_entries.find(filePath);
+    if (it == m_entries.end()) {
+        m_entries.emplace(filePath, Entry{ 1.0, now });
+        Trim(now);
+    } else {
+        it->second.score = Decay(it->second, now) + 1.0;
+        it->second.time = now;
+    }
+    ++m_generation;
+}
+
+void FrecencyTable::Rename(const std::wstring &oldPath, const std::wstring &newPath) {
+    auto it = m_entries.find(oldPath);
+    if (it == m_entries.end())
+        return;
+    Entry entry = it->second;
+    m_entries.erase(it);
+    m_entries[newPath] = entry;
+    ++m_generation;
+}
+
+double FrecencyTable::GetScore(const std::wstring &filePath, ULONGLONG now) const {
+    auto it = m_entries.find(filePath);
+    return (it != m_entries.end()) ? Decay(it->second, now) : 0.0;
+}
+
+void FrecencyTable::Trim(ULONGLONG now) {
+    // Runs only when a new file is recorded over the bound, so a linear scan is fine.
+    while (m_entries.size() > FRECENCY_MAX_ENTRIES) {
+        auto lowest = m_entries.begin();
+        double lowestScore = Decay(lowest->second, now);
+        for (auto it = std::next(lowest); it != m_entries.end(); ++it) {
+            double score = Decay(it->second, now);
+            if (score < lowestScore) {
+                lowest = it;
+                lowestScore = score;
+            }
+        }
+        m_entries.erase(lowest);
+    }
+}
+
+bool FrecencyTable::Load(const std::wstring &fileName) {
+    m_entries.clear();
+    ++m_generation;
+    HANDLE hFile = CreateFileW(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                               FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (hFile == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER size;
+    std::vector<BYTE> buffer;
+    DWORD read = 0;
+    bool ok = GetFileSizeEx(hFile, &size) && size.QuadPart >= static_cast<LONGLONG>(sizeof(FrecencyFileHeader)) &&
+              size.QuadPart <= 64 * 1024 * 1024;
+    if (ok) {
+        buffer.resize(static_cast<size_t>(size.QuadPart));
+        ok = ReadFile(hFile, buffer.data(), static_cast<DWORD>(buffer.size()), &read, nullptr) && read == buffer.size();
+    }
+    CloseHandle(hFile);
+    if (!ok)
+        return false;
+
+    FrecencyFileHeader header;
+    memcpy(&header, buffer.data(), sizeof(header));
+    if (header.magic != FRECENCY_FILE_MAGIC || header.version != FRECENCY_FILE_VERSION)
+        return false;
+    size_t offset = sizeof(header);
+    std::wstring path;
+    for (uint32_t i = 0; i < header.count; ++i) {
+        FrecencyFileRecord record;
+        if (buffer.size() - offset < sizeof(record))
+            break;
+        memcpy(&record, buffer.data() + offset, sizeof(record));
+        offset += sizeof(record);
+        if ((buffer.size() - offset) / sizeof(wchar_t) < record.pathLength)
+            break;
+        path.assign(record.pathLength, L'\0');
+        if (record.pathLength)
+            memcpy(&path[0], buffer.data() + offset, record.pathLength * sizeof(wchar_t));
+        offset += record.pathLength * sizeof(wchar_t);
+        m_entries[path] = Entry{ record.score, record.time };
+    }
+    if (m_entries.size() != header.count || offset != buffer.size()) {
+        m_entries.clear();
+        return false;
+    }
+    Trim(FrecencyNow());
+    return true;
+}
+
+bool FrecencyTable::Save(const std::wstring &fileName) const {
+    std::vector<BYTE> buffer(sizeof(FrecencyFileHeader));
+    FrecencyFileHeader header = { FRECENCY_FILE_MAGIC, FRECENCY_FILE_VERSION, static_cast<uint32_t>(m_entries.size()) };
+    memcpy(buffer.data(), &header, sizeof(header));
+    for (const auto &pair : m_entries) {
+        FrecencyFileRecord record = { pair.second.score, pair.second.time, static_cast<uint32_t>(pair.first.size()) };
+        size_t offset = buffer.size();
+        buffer.resize(offset + sizeof(record) + pair.first.size() * sizeof(wchar_t));
+        memcpy(buffer.data() + offset, &record, sizeof(record));
+        if (!pair.first.empty())
+            memcpy(buffer.data() + offset + sizeof(record), pair.first.data(), pair.first.size() * sizeof(wchar_t));
+    }
+
+    // Write to a temporary file and swap it in, so a crash never leaves a half-written file.
+    std::wstring tempFile = fileName + L".tmp";
+    HANDLE hFile = CreateFileW(tempFile.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                               FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (hFile == INVALID_HANDLE_VALUE)
+        return false;
+    DWORD written = 0;
+    BOOL ok = WriteFile(hFile, buffer.data(), static_cast<DWORD>(buffer.size()), &written, nullptr) &&
+              written == buffer.size();
+    CloseHandle(hFile);
+    if (!ok || !MoveFileExW(tempFile.c_str(), fileName.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+        DeleteFileW(tempFile.c_str());
+        return false;
+    }
+    return true;
+}
+
+// End of file: Frecency.cpp (Version: 1.0)
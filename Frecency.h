@@ -0,0 +1,76 @@
+// File: Frecency.h
+// Version: 1.0
+// -------------------------------------------------------------------------
+// This header declares FrecencyTable, the per-file "frequently and recently
+// opened" score that ranks the CLI search results (FuzzySearch.h).
+//
+// Every activation through TrackerEngine::OpenFile() adds one to the score
+// of the file, and the score halves every FRECENCY_HALF_LIFE. Each entry
+// stores its score at the time it was last recorded, so recording and
+// reading are O(1) and nothing has to be aged in the background. At most
+// FRECENCY_MAX_ENTRIES files are kept; the lowest score gives way.
+//
+// The table is persisted in FRECENCY_FILE: a small versioned binary file,
+// read in TrackerEngine::Start() and written (through a temporary file) in
+// Stop().
+//
+// All methods are called on the engine's thread.
+// -------------------------------------------------------------------------
+
+#ifndef FRECENCY_H
+#define FRECENCY_H
+
+#include <windows.h>
+#include <string>
+#include <unordered_map>
+
+class FrecencyTable {
+public:
+    FrecencyTable();
+
+    // Counts one activation of filePath now.
+    void Record(const std::wstring &filePath);
+
+    // Moves the score of a renamed file.
+    void Rename(const std::wstring &oldPath, const std::wstring &newPath);
+
+    // Score of filePath at now (FrecencyNow()); 0 for files never opened.
+    double GetScore(const std::wstring &filePath, ULONGLONG now) const;
+
+    // Calls visit(filePath, score) for every entry, with scores at now.
+    template <class Visitor>
+    void ForEach(ULONGLONG now, Visitor visit) const {
+        for (const auto &pair : m_entries)
+            visit(pair.first, Decay(pair.second, now));
+    }
+
+    size_t GetCount() const { return m_entries.size(); }
+
+    // Incremented by every change.
+    ULONGLONG GetGeneration() const { return m_generation; }
+
+    // Reads or writes the table. Load() returns false (and leaves the table
+    // empty) if the file is missing or not valid.
+    bool Load(const std::wstring &fileName);
+    bool Save(const std::wstring &fileName) const;
+
+    // UTC milliseconds since 1601, the time base of the scores.
+    static ULONGLONG FrecencyNow();
+
+private:
+    struct Entry {
+        double score;      ///< Score at time.
+        ULONGLONG time;    ///< When score was recorded (FrecencyNow()).
+    };
+
+    static double Decay(const Entry &entry, ULONGLONG now);
+    // Drops the lowest entry while over FRECENCY_MAX_ENTRIES.
+    void Trim(ULONGLONG now);
+
+    std::unordered_map<std::wstring, Entry> m_entries;  ///< By file path.
+    ULONGLONG m_generation;
+};
+
+#endif // FRECENCY_H
+
+// End of file: Frecency.h (Version: 1.0)
@@ -0,0 +1,400 @@
+// File: FuzzySearch.cpp
+// Version: 1.0
+// -------------------------------------------------------------------------
+// This file implements FuzzyScore() and FuzzySearcher (see FuzzySearch.h).
+// -------------------------------------------------------------------------
+
+#include "FuzzySearch.h"
+#include "TextMatch.h"  // For FoldCharNoCase() and FoldNoCase()
+#include "Config.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+// Score of a matched character, and what is added or taken for its position.
+static const int FUZZY_SCORE_MATCH = 16;
+static const int FUZZY_BONUS_BOUNDARY = 8;         // First character of the name or of a word.
+static const int FUZZY_BONUS_CAMEL = 7;            // Lower-to-upper case change, or the first digit.
+static const int FUZZY_BONUS_CONSECUTIVE = 4;      // Minimum for every character of a run after the first.
+static const int FUZZY_BONUS_LEAF = 16;            // The whole match is inside the leaf name.
+static const int FUZZY_PENALTY_GAP_START = 3;
+static const int FUZZY_PENALTY_GAP_EXTENSION = 1;
+
+static bool IsWordSeparator(wchar_t c) {
+    return c == L'\\' || c == L'/' || c == L'_' || c == L'-' || c == L'.' || c == L' ';
+}
+
+// Position bonus of a match at text[k].
+static int GetPositionBonus(const wchar_t *text, size_t k) {
+    if (k == 0 || IsWordSeparator(text[k - 1]))
+        return FUZZY_BONUS_BOUNDARY;
+    wchar_t previous = text[k - 1];
+    wchar_t current = text[k];
+    if (iswlower(previous) && iswupper(current))
+        return FUZZY_BONUS_CAMEL;
+    if (!iswdigit(previous) && iswdigit(current))
+        return FUZZY_BONUS_CAMEL;
+    return 0;
+}
+
+// Finds the shortest window [start, end] of folded[from, length) that ends
+// where the first occurrence of query as a subsequence ends.
+static bool FindMatchWindow(const wchar_t *query, size_t queryLength, const wchar_t *folded, size_t length,
+                            size_t from, size_t &start, size_t &end) {
+    size_t q = 0;
+    size_t k = from;
+    for (; k < length; ++k) {
+        if (folded[k] == query[q] && ++q == queryLength)
+            break;
+    }
+    if (q < queryLength)
+        return false;
+    end = k;
+    // Walk back from the end so that the window starts as late as possible.
+    for (q = queryLength; ; --k) {
+        if (folded[k] == query[q - 1] && --q == 0)
+            break;
+    }
+    start = k;
+    return true;
+}
+
+int FuzzyScore(const wchar_t *query, size_t queryLength, const wchar_t *text, const wchar_t *folded,
+               size_t length, size_t leaf) {
+    if (queryLength == 0)
+        return 0;
+    if (queryLength > length)
+        return FUZZY_NO_MATCH;
+    size_t start = 0;
+    size_t end = 0;
+    // A match inside the leaf name is preferred over one through the folders.
+    bool inLeaf = leaf > 0 && leaf < length && FindMatchWindow(query, queryLength, folded, length, leaf, start, end);
+    if (!inLeaf) {
+        if (!FindMatchWindow(query, queryLength, folded, length, 0, start, end))
+            return FUZZY_NO_MATCH;
+        inLeaf = start >= leaf;
+    }
+
+    int score = inLeaf ? FUZZY_BONUS_LEAF : 0;
+    int runBonus = 0;   // Bonus of the first character of the current run.
+    bool inRun = false;
+    bool inGap = false;
+    size_t q = 0;
+    for (size_t k = start; k <= end; ++k) {
+        if (q < queryLength && folded[k] == query[q]) {
+            int bonus = GetPositionBonus(text, k);
+            if (!inRun) {
+                runBonus = bonus;
+            } else {
+                // A run keeps the bonus of its start: "rep" in "Report" scores like the "R".
+                runBonus = (std::max)(runBonus, bonus);
+                bonus = (std::max)((std::max)(bonus, runBonus), FUZZY_BONUS_CONSECUTIVE);
+            }
+            score += FUZZY_SCORE_MATCH + (q == 0 ? 2 * bonus : bonus);
+            inRun = true;
+            inGap = false;
+            ++q;
+        } else {
+            score -= inGap ? FUZZY_PENALTY_GAP_EXTENSION : FUZZY_PENALTY_GAP_START;
+            inRun = false;
+            inGap = true;
+        }
+    }
+    return (std::max)(score, 0);
+}
+
+// -------------------------------------------------------------------------
+// FuzzySearcher
+// -------------------------------------------------------------------------
+FuzzySearcher::FuzzySearcher()
+    : m_hwndNotify(nullptr)
+    , m_notifyMsg(0)
+    , m_nextToken(0)
+    , m_latestToken(0)
+    , m_wakeEvent(nullptr)
+    , m_stopEvent(nullptr)
+    , m_requestPending(false)
+    , m_resultPending(false)
+    , m_notifyPending(false)
+    , m_lastValid(false)
+{
+}
+
+FuzzySearcher::~FuzzySearcher() {
+    Stop();
+}
+
+bool FuzzySearcher::Start(HWND hwndNotify, UINT notifyMsg) {
+    Stop();
+    m_hwndNotify = hwndNotify;
+    m_notifyMsg = notifyMsg;
+    m_stopEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+    m_wakeEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    if (m_stopEvent && m_wakeEvent)
+        m_thread = std::thread(&FuzzySearcher::Run, this);
+    return m_thread.joinable();
+}
+
+void FuzzySearcher::Stop() {
+    // Cancels a running search before the worker is told to stop.
+    m_latestToken.store(0);
+    if (m_stopEvent) {
+        SetEvent(m_stopEvent);
+        if (m_thread.joinable())
+            m_thread.join();
+        CloseHandle(m_stopEvent);
+        m_stopEvent = nullptr;
+    }
+    if (m_wakeEvent) {
+        CloseHandle(m_wakeEvent);
+        m_wakeEvent = nullptr;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_request = Request();
+    m_requestPending = false;
+    m_pendingNames.reset();
+    m_result = FuzzySearchResult();
+    m_resultPending = false;
+    m_notifyPending = false;
+}
+
+void FuzzySearcher::SetNames(std::shared_ptr<const std::vector<std::wstring>> names) {
+    m_names = std::move(names);
+    if (!m_thread.joinable())
+        return;
+    // Build the keys now, so that the next keystroke does not wait for them.
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pendingNames = m_names;
+    }
+    SetEvent(m_wakeEvent);
+}
+
+void FuzzySearcher::SetFrecency(std::shared_ptr<const std::vector<float>> frecency) {
+    m_frecency = std::move(frecency);
+}
+
+ULONGLONG FuzzySearcher::Submit(const std::wstring &query) {
+    ULONGLONG token = ++m_nextToken;
+    m_latestToken.store(token);
+    Request request = { token, query, m_names, m_frecency };
+    if (!m_thread.joinable()) {
+        Search(request);
+        return token;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_request = std::move(request);
+        m_requestPending = true;
+    }
+    SetEvent(m_wakeEvent);
+    return token;
+}
+
+bool FuzzySearcher::TakeResult(FuzzySearchResult &result) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_notifyPending = false;
+    if (!m_resultPending)
+        return false;
+    result = std::move(m_result);
+    m_resultPending = false;
+    return true;
+}
+
+// -------------------------------------------------------------------------
+// Worker thread
+// -------------------------------------------------------------------------
+void FuzzySearcher::Run() {
+    HANDLE handles[2] = { m_stopEvent, m_wakeEvent };
+    while (WaitForMultipleObjects(2, handles, FALSE, INFINITE) == WAIT_OBJECT_0 + 1) {
+        Request request;
+        std::shared_ptr<const std::vector<std::wstring>> names;
+        bool search = false;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            names.swap(m_pendingNames);
+            if (m_requestPending) {
+                request = std::move(m_request);
+                m_requestPending = false;
+                search = true;
+            }
+        }
+        if (search)
+            Search(request);
+        else if (names && names != m_keyedNames)
+            BuildKeys(names);
+    }
+}
+
+uint64_t FuzzySearcher::GetCharMask(wchar_t folded) {
+    if (folded >= L'a' && folded <= L'z')
+        return 1ull << (folded - L'a');
+    if (folded >= L'0' && folded <= L'9')
+        return 1ull << (26 + (folded - L'0'));
+    return 1ull << (36 + folded % 28);
+}
+
+bool FuzzySearcher::IsBetter(const Candidate &a, const Candidate &b) {
+    if (a.rank != b.rank)
+        return a.rank > b.rank;
+    if (a.length != b.length)
+        return a.length < b.length;
+    return a.name < b.name;
+}
+
+void FuzzySearcher::BuildKeys(const std::shared_ptr<const std::vector<std::wstring>> &names) {
+    m_keyedNames = names;
+    m_lastValid = false;
+    m_keyChars.clear();
+    m_keyOffsets.clear();
+    m_keyLeaves.clear();
+    m_keyMasks.clear();
+    size_t count = names ? names->size() : 0;
+    size_t chars = 0;
+    for (size_t i = 0; i < count; ++i)
+        chars += (*names)[i].size();
+    m_keyChars.resize(chars);
+    m_keyOffsets.resize(count + 1);
+    m_keyLeaves.resize(count);
+    m_keyMasks.resize(count);
+    wchar_t *out = m_keyChars.data();
+    for (size_t i = 0; i < count; ++i) {
+        const std::wstring &name = (*names)[i];
+        m_keyOffsets[i] = static_cast<UINT>(out - m_keyChars.data());
+        m_keyLeaves[i] = 0;
+        uint64_t mask = 0;
+        for (size_t k = 0; k < name.size(); ++k) {
+            wchar_t c = name[k];
+            if (c == L'\\')
+                m_keyLeaves[i] = static_cast<UINT>(k + 1);
+            wchar_t folded = FoldCharNoCase(c);
+            *out++ = folded;
+            mask |= GetCharMask(folded);
+        }
+        m_keyMasks[i] = mask;
+    }
+    m_keyOffsets[count] = static_cast<UINT>(chars);
+}
+
+void FuzzySearcher::Publish(const Request &request, std::vector<Candidate> heap, size_t matched, bool complete) {
+    std::sort_heap(heap.begin(), heap.end(), IsBetter);
+    std::vector<UINT> hits;
+    hits.reserve(heap.size());
+    for (const auto &candidate : heap)
+        hits.push_back(candidate.name);
+    PublishHits(request, hits, matched, complete);
+}
+
+void FuzzySearcher::PublishHits(const Request &request, std::vector<UINT> &hits, size_t matched, bool complete) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (IsCancelled(request.token))
+        return;
+    m_result.token = request.token;
+    m_result.query = request.query;
+    m_result.names = request.names;
+    m_result.hits.swap(hits);
+    m_result.matched = matched;
+    m_result.complete = complete;
+    m_resultPending = true;
+    if (!m_notifyPending && m_hwndNotify) {
+        m_notifyPending = true;
+        PostMessage(m_hwndNotify, m_notifyMsg, 0, 0);
+    }
+}
+
+bool FuzzySearcher::Search(const Request &request) {
+    if (request.names != m_keyedNames)
+        BuildKeys(request.names);
+    if (IsCancelled(request.token))
+        return false;
+    size_t count = m_keyMasks.size();
+    const std::vector<float> *frecency = request.frecency.get();
+    auto getFrecency = [frecency](UINT name) -> float {
+        return (frecency && name < frecency->size()) ? (*frecency)[name] : 0.0f;
+    };
+
+    std::wstring query = request.query;
+    FoldNoCase(query);
+    if (query.empty()) {
+        // Every name: the frecent ones by rank, then the rest in table order.
+        std::vector<Candidate> ranked;
+        for (UINT i = 0; i < count; ++i) {
+            float score = getFrecency(i);
+            if (score > 0.0f)
+                ranked.push_back(Candidate{ score, m_keyOffsets[i + 1] - m_keyOffsets[i], i });
+        }
+        std::sort(ranked.begin(), ranked.end(), IsBetter);
+        std::vector<bool> listed(count, false);
+        std::vector<UINT> hits;
+        hits.reserve(count);
+        for (const auto &candidate : ranked) {
+            hits.push_back(candidate.name);
+            listed[candidate.name] = true;
+        }
+        for (UINT i = 0; i < count; ++i) {
+            if (!listed[i])
+                hits.push_back(i);
+        }
+        m_lastValid = false;
+        PublishHits(request, hits, count, true);
+        return true;
+    }
+
+    // Every match of a longer query is a match of its prefix.
+    bool narrow = m_lastValid && !m_lastQuery.empty() && query.size() >= m_lastQuery.size() &&
+                  query.compare(0, m_lastQuery.size(), m_lastQuery) == 0;
+    size_t candidates = narrow ? m_lastMatches.size() : count;
+    uint64_t queryMask = 0;
+    for (wchar_t c : query)
+        queryMask |= GetCharMask(c);
+
+    std::vector<Candidate> heap;
+    heap.reserve(FUZZY_SEARCH_MAX_RESULTS);
+    std::vector<UINT> matches;
+    const auto started = std::chrono::steady_clock::now();
+    bool publishedPartial = false;
+    for (size_t pos = 0; pos < candidates; ++pos) {
+        if (pos > 0 && pos % FUZZY_SEARCH_CHUNK_NAMES == 0) {
+            if (IsCancelled(request.token))
+                return false;
+            if (!publishedPartial && std::chrono::steady_clock::now() - started >=
+                                     std::chrono::milliseconds(FUZZY_SEARCH_PARTIAL_INTERVAL)) {
+                Publish(request, heap, matches.size(), false);
+                publishedPartial = true;
+            }
+        }
+        UINT i = narrow ? m_lastMatches[pos] : static_cast<UINT>(pos);
+        if ((m_keyMasks[i] & queryMask) != queryMask)
+            continue;
+        UINT offset = m_keyOffsets[i];
+        UINT length = m_keyOffsets[i + 1] - offset;
+        int score = FuzzyScore(query.c_str(), query.size(), (*request.names)[i].c_str(),
+                               m_keyChars.data() + offset, length, m_keyLeaves[i]);
+        if (score == FUZZY_NO_MATCH)
+            continue;
+        matches.push_back(i);
+        float frecencyScore = getFrecency(i);
+        float rank = static_cast<float>(score);
+        if (frecencyScore > 0.0f)
+            rank += FUZZY_FRECENCY_WEIGHT * std::log2(1.0f + frecencyScore);
+        Candidate candidate = { rank, length, i };
+        if (heap.size() < FUZZY_SEARCH_MAX_RESULTS) {
+            heap.push_back(candidate);
+            std::push_heap(heap.begin(), heap.end(), IsBetter);
+        } else if (IsBetter(candidate, heap.front())) {
+            // The front is the worst name kept.
+            std::pop_heap(heap.begin(), heap.end(), IsBetter);
+            heap.back() = candidate;
+            std::push_heap(heap.begin(), heap.end(), IsBetter);
+        }
+    }
+    if (IsCancelled(request.token))
+        return false;
+    m_lastQuery = query;
+    m_lastMatches.swap(matches);
+    m_lastValid = true;
+    Publish(request, std::move(heap), m_lastMatches.size(), true);
+    return true;
+}
+
+// End of file: FuzzySearch.cpp (Version: 1.0)
@@ -0,0 +1,151 @@
+// File: FuzzySearch.h
+// Version: 1.0
+// -------------------------------------------------------------------------
+// This header declares FuzzySearcher, the ranked fuzzy file search of the
+// CLI panel.
+//
+// A query matches a name if its characters appear in the name in order,
+// case-insensitively ("rpt25" matches "Drafts\Report_2025.docx").
+// FuzzyScore() rates a match: matched characters at the start of a word
+// (after a separator, or a lower-to-upper case change) and consecutive runs
+// score higher, gaps cost a little, and a match inside the leaf name beats
+// one that runs through the folders. The rank of a name adds the file's
+// frecency (Frecency.h), so files opened often and lately come first, with
+// ties going to the shorter name.
+//
+// Searches run on a worker thread over an immutable name table shared with
+// the engine. The per-name lowercase keys and character masks are built
+// once per table, as soon as SetNames() hands it over. Submit() returns a
+// token and supersedes every earlier query: the worker checks the token
+// every FUZZY_SEARCH_CHUNK_NAMES names and abandons a stale search. A query
+// that extends the last completed one only rescans that query's matches.
+// Only the best FUZZY_SEARCH_MAX_RESULTS names are kept (a bounded heap),
+// and if a scan takes longer than FUZZY_SEARCH_PARTIAL_INTERVAL the best
+// names found so far are published first, so the list keeps up with typing
+// even in very large workspaces.
+// The empty query lists every name, most frecent first.
+//
+// The worker posts notifyMsg when a result is ready; TakeResult() returns
+// the newest one. Without the thread, Submit() searches inline.
+//
+// All public methods are called on the UI thread.
+// -------------------------------------------------------------------------
+
+#ifndef FUZZYSEARCH_H
+#define FUZZYSEARCH_H
+
+#include <windows.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <cstdint>
+
+// Returned by FuzzyScore() for names that do not contain the query.
+const int FUZZY_NO_MATCH = -1;
+
+// Scores a folded (FoldNoCase) query against a name: text is the name as
+// shown, folded its folded copy, both of length characters; leaf is the
+// offset of the file name after the last backslash. Returns FUZZY_NO_MATCH
+// unless the query is a subsequence of the name.
+int FuzzyScore(const wchar_t *query, size_t queryLength, const wchar_t *text, const wchar_t *folded,
+               size_t length, size_t leaf);
+
+/**
+ * @struct FuzzySearchResult
+ * @brief Ranked names for one query.
+ */
+struct FuzzySearchResult {
+    ULONGLONG token;                                    ///< Submit() token of the query.
+    std::wstring query;
+    std::shared_ptr<const std::vector<std::wstring>> names; ///< Table the hits index.
+    std::vector<UINT> hits;                             ///< Name indices, best first.
+    size_t matched;                                     ///< Names matching the query (so far, if partial).
+    bool complete;                                      ///< false: the scan is still running.
+    FuzzySearchResult() : token(0), matched(0), complete(false) {}
+};
+
+class FuzzySearcher {
+public:
+    FuzzySearcher();
+    ~FuzzySearcher();
+
+    // Starts the worker; notifyMsg is posted to hwndNotify when a result is
+    // ready. Returns false if the thread could not be started (Submit() then
+    // searches inline).
+    bool Start(HWND hwndNotify, UINT notifyMsg);
+    void Stop();
+
+    // Name table and frecency scores by name index (may be shorter or null).
+    // Used from the next Submit() on.
+    void SetNames(std::shared_ptr<const std::vector<std::wstring>> names);
+    void SetFrecency(std::shared_ptr<const std::vector<float>> frecency);
+
+    // Queues a search and cancels the previous one. Returns its token.
+    ULONGLONG Submit(const std::wstring &query);
+
+    // Moves the newest published result into result. Returns false if none
+    // was published since the last call.
+    bool TakeResult(FuzzySearchResult &result);
+
+private:
+    struct Request {
+        ULONGLONG token;
+        std::wstring query;
+        std::shared_ptr<const std::vector<std::wstring>> names;
+        std::shared_ptr<const std::vector<float>> frecency;
+    };
+    struct Candidate {
+        float rank;
+        UINT length;
+        UINT name;
+    };
+
+    // Worker thread body.
+    void Run();
+    // Runs one search; returns false if it was cancelled.
+    bool Search(const Request &request);
+    // Builds the keys of a new name table.
+    void BuildKeys(const std::shared_ptr<const std::vector<std::wstring>> &names);
+    // Hands a result to the UI thread unless its query was superseded.
+    void Publish(const Request &request, std::vector<Candidate> heap, size_t matched, bool complete);
+    void PublishHits(const Request &request, std::vector<UINT> &hits, size_t matched, bool complete);
+    bool IsCancelled(ULONGLONG token) const { return m_latestToken.load(std::memory_order_relaxed) != token; }
+
+    static bool IsBetter(const Candidate &a, const Candidate &b);
+    static uint64_t GetCharMask(wchar_t folded);
+
+    HWND m_hwndNotify;
+    UINT m_notifyMsg;
+    std::shared_ptr<const std::vector<std::wstring>> m_names;   // UI thread only.
+    std::shared_ptr<const std::vector<float>> m_frecency;       // UI thread only.
+    ULONGLONG m_nextToken;                                      // UI thread only.
+    std::atomic<ULONGLONG> m_latestToken;                       // Token of the newest query; 0 after Stop().
+
+    HANDLE m_wakeEvent;
+    HANDLE m_stopEvent;
+    std::thread m_thread;
+    std::mutex m_mutex;                                         // Guards the members below.
+    Request m_request;
+    bool m_requestPending;
+    std::shared_ptr<const std::vector<std::wstring>> m_pendingNames; ///< Table to build keys for ahead of a search.
+    FuzzySearchResult m_result;
+    bool m_resultPending;
+    bool m_notifyPending;
+
+    // Worker thread only (or the inline search).
+    std::shared_ptr<const std::vector<std::wstring>> m_keyedNames; ///< Table the keys below were built for.
+    std::vector<wchar_t> m_keyChars;                            ///< Folded names, back to back.
+    std::vector<UINT> m_keyOffsets;                             ///< Start of name i in m_keyChars; one extra at the end.
+    std::vector<UINT> m_keyLeaves;                              ///< Offset of the leaf name within name i.
+    std::vector<uint64_t> m_keyMasks;                           ///< GetCharMask() bits of the characters of name i.
+    std::wstring m_lastQuery;                                   ///< Folded query of the last completed search.
+    std::vector<UINT> m_lastMatches;                            ///< Every name it matched, in table order.
+    bool m_lastValid;                                           ///< m_lastMatches belong to m_keyedNames.
+};
+
+#endif // FUZZYSEARCH_H
+
+// End of file: FuzzySearch.h (Version: 1.0)
@@ -0,0 +1,88 @@
+// File: HeadlessHost.cpp
+// Version: 1.1
+// -------------------------------------------------------------------------
+// This file implements HeadlessHost (see HeadlessHost.h).
+// -------------------------------------------------------------------------
+
+#include "HeadlessHost.h"
+
+HeadlessHost::HeadlessHost()
+    : m_hwnd(nullptr)
+{
+}
+
+bool HeadlessHost::Create(const std::vector<std::wstring> &filesToOpen) {
+    m_filesToOpen = filesToOpen;
+    WNDCLASS wc = {0};
+    wc.lpfnWndProc = HeadlessHost::WindowProc;
+    wc.hInstance = GetModuleHandle(nullptr);
+    wc.lpszClassName = L"MYexplorerHeadlessClass";
+    RegisterClass(&wc);
+    // A hidden top-level window rather than a message-only one, so that
+    // taskkill and session end reach it with WM_CLOSE / WM_ENDSESSION.
+    m_hwnd = CreateWindowEx(0, wc.lpszClassName, L"MYexplorer (headless)", WS_OVERLAPPED,
+                            0, 0, 0, 0, nullptr, nullptr, GetModuleHandle(nullptr), this);
+    if (!m_hwnd)
+        return false;
+    if (!m_engine.Start(m_hwnd, this)) {
+        DestroyWindow(m_hwnd);
+        return false;
+    }
+    return true;
+}
+
+LRESULT CALLBACK HeadlessHost::WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
+    HeadlessHost* pThis = nullptr;
+    if (uMsg == WM_NCCREATE) {
+        CREATESTRUCT* pCreate = reinterpret_cast<CREATESTRUCT*>(lParam);
+        pThis = reinterpret_cast<HeadlessHost*>(pCreate->lpCreateParams);
+        SetWindowLongPtr(hwnd, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(pThis));
+        pThis->m_hwnd = hwnd;
+    } else {
+        pThis = reinterpret_cast<HeadlessHost*>(GetWindowLongPtr(hwnd, GWLP_USERDATA));
+    }
+    if (pThis)
+        return pThis->HandleMessage(uMsg, wParam, lParam);
+    return DefWindowProc(hwnd, uMsg, wParam, lParam);
+}
+
+LRESULT HeadlessHost::HandleMessage(UINT uMsg, WPARAM wParam, LPARAM lParam) {
+    switch (uMsg) {
+    case WM_ENDSESSION:
+        // The process may be terminated without WM_DESTROY; commit the journal now.
+        if (wParam)
+            m_engine.Stop();
+        return 0;
+
+    case WM_DESTROY:
+        // Commits the tracking journal and stops the engine's workers.
+        m_engine.Stop();
+        PostQuitMessage(0);
+        return 0;
+
+    default:
+        if (m_engine.HandleMessage(uMsg, wParam, lParam))
+            return 0;
+        return DefWindowProc(m_hwnd, uMsg, wParam, lParam);
+    }
+}
+
+void HeadlessHost::OnSnapshotUpdated() {
+    // Wait until tracking.dat is resolved, so tracked windows are reused.
+    if (!m_engine.IsTrackingResolved())
+        return;
+    std::vector<std::wstring> files;
+    files.swap(m_filesToOpen);
+    for (const auto &fileName : files)
+        m_engine.OpenFile(TrackerEngine::GetFilePath(fileName));
+}
+
+void HeadlessHost::OnFolderChanged(const std::vector<DirectoryDelta> &) {
+    // Nothing to render; the engine already follows renamed files.
+}
+
+void HeadlessHost::OnLaunchComplete(const LaunchResult &) {
+    // Launched windows are tracked by the engine; there is no one to tell about failures.
+}
+
+// End of file: HeadlessHost.cpp (Version: 1.1)
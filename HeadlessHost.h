@@ -0,0 +1,54 @@
+// File: HeadlessHost.h
+// Version: 1.1
+// -------------------------------------------------------------------------
+// This header declares HeadlessHost, the client of TrackerEngine used by
+// "MYexplorer.exe --headless [file ...]".
+//
+// The host creates one hidden top-level window to receive the engine's
+// messages and nothing else: no common controls, ListViews or WebView2.
+// Tracking, rehydration and tracking.dat behave as in the UI. Files named
+// on the command line (relative to PROJECT_FOLDER) are activated or
+// launched once the stored tracking has been resolved against a window
+// snapshot. Tracking changes are journaled as they happen; the host commits
+// the last ones and exits when its window is closed (e.g. "taskkill /IM
+// MYexplorer.exe" without /F) or the session ends.
+//
+// Changes in Version 1.1:
+//  - Files are opened once TrackerEngine::IsTrackingResolved(), which may be
+//    after the first snapshot now that tracking.dat loads on a worker thread.
+// -------------------------------------------------------------------------
+
+#ifndef HEADLESSHOST_H
+#define HEADLESSHOST_H
+
+#include <windows.h>
+#include <string>
+#include <vector>
+#include "TrackerEngine.h"
+
+class HeadlessHost : private TrackerEngineListener {
+public:
+    HeadlessHost();
+
+    // Creates the hidden window and starts the engine. Returns false if
+    // either fails.
+    bool Create(const std::vector<std::wstring> &filesToOpen);
+    HWND GetHwnd() const { return m_hwnd; }
+
+private:
+    static LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
+    LRESULT HandleMessage(UINT uMsg, WPARAM wParam, LPARAM lParam);
+
+    // TrackerEngineListener
+    void OnSnapshotUpdated() override;
+    void OnFolderChanged(const std::vector<DirectoryDelta> &deltas) override;
+    void OnLaunchComplete(const LaunchResult &result) override;
+
+    HWND m_hwnd;
+    TrackerEngine m_engine;
+    std::vector<std::wstring> m_filesToOpen;  ///< Opened after the first snapshot.
+};
+
+#endif // HEADLESSHOST_H
+
+// End of file: HeadlessHost.h (Version: 1.1)
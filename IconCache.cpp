@@ -0,0 +1,614 @@
+// File: IconCache.cpp
+// Version: 1.1
+// -------------------------------------------------------------------------
+// This file implements IconCache (see IconCache.h).
+//
+// Changes in Version 1.1:
+//  - AppendDiskIcon() compacts the disk cache once it holds twice
+//    ICON_DISK_CACHE_MAX_ENTRIES records and truncates a torn append.
+//  - CompactDiskCache() checks every write and drops the temporary file if
+//    one comes up short.
+// -------------------------------------------------------------------------
+
+#include "IconCache.h"
+#include "TextMatch.h"  // For EqualsNoCase()
+#include "Config.h"
+#include <shellapi.h>
+#include <shobjidl.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <cwctype>
+
+// -------------------------------------------------------------------------
+// Disk cache layout (little-endian):
+//   IconCacheFileHeader
+//   records: IconCacheRecordHeader, WCHAR key[keyLength],
+//            DWORD pixels[ICON_CACHE_SIZE * ICON_CACHE_SIZE]
+// A newer record of a key supersedes older ones; a torn or corrupt record
+// ends the file.
+// -------------------------------------------------------------------------
+static const uint32_t ICON_CACHE_FILE_MAGIC = 0x4349594D; // "MYIC"
+static const uint16_t ICON_CACHE_FILE_VERSION = 1;
+
+struct IconCacheFileHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t iconSize;
+};
+
+struct IconCacheRecordHeader {
+    uint32_t size;           ///< Bytes of the record including this header.
+    uint32_t checksum;       ///< FNV-1a over the key and the pixels.
+    uint64_t lastWriteTime;
+    uint32_t keyLength;      ///< In WCHARs.
+    uint32_t reserved;
+};
+
+static_assert(sizeof(IconCacheFileHeader) == 8, "IconCacheFileHeader layout changed");
+static_assert(sizeof(IconCacheRecordHeader) == 24, "IconCacheRecordHeader layout changed");
+
+static const size_t ICON_PIXEL_COUNT = static_cast<size_t>(ICON_CACHE_SIZE) * ICON_CACHE_SIZE;
+
+static uint32_t Fnv1a32(const BYTE *data, size_t size, uint32_t hash = 2166136261u) {
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static uint32_t GetRecordChecksum(const wchar_t *key, size_t keyLength, const DWORD *pixels) {
+    uint32_t hash = Fnv1a32(reinterpret_cast<const BYTE*>(key), keyLength * sizeof(wchar_t));
+    return Fnv1a32(reinterpret_cast<const BYTE*>(pixels), ICON_PIXEL_COUNT * sizeof(DWORD), hash);
+}
+
+// Files whose icon is their own (or a thumbnail of them) rather than their type's.
+static bool HasOwnIcon(const wchar_t *extension, size_t length) {
+    static const wchar_t *const extensions[] = {
+        L".exe", L".lnk", L".url", L".ico", L".cur", L".ani",
+        L".png", L".jpg", L".jpeg", L".bmp", L".gif"
+    };
+    for (const wchar_t *candidate : extensions) {
+        if (wcslen(candidate) == length && EqualsNoCase(extension, candidate, length))
+            return true;
+    }
+    return false;
+}
+
+static BITMAPINFO GetIconBitmapInfo() {
+    BITMAPINFO bmi = {};
+    bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bmi.bmiHeader.biWidth = ICON_CACHE_SIZE;
+    bmi.bmiHeader.biHeight = -static_cast<LONG>(ICON_CACHE_SIZE); // Top-down.
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = 32;
+    bmi.bmiHeader.biCompression = BI_RGB;
+    return bmi;
+}
+
+// Renders hIcon into BGRA pixels; icons without an alpha channel get one from their mask.
+static bool RenderIcon(HICON hIcon, std::vector<DWORD> &pixels) {
+    BITMAPINFO bmi = GetIconBitmapInfo();
+    void *bits = nullptr;
+    HDC hdc = CreateCompatibleDC(nullptr);
+    HBITMAP hbmp = hdc ? CreateDIBSection(hdc, &bmi, DIB_RGB_COLORS, &bits, nullptr, 0) : nullptr;
+    if (!hbmp) {
+        if (hdc)
+            DeleteDC(hdc);
+        return false;
+    }
+    HGDIOBJ old = SelectObject(hdc, hbmp);
+    memset(bits, 0, ICON_PIXEL_COUNT * sizeof(DWORD));
+    bool ok = DrawIconEx(hdc, 0, 0, hIcon, ICON_CACHE_SIZE, ICON_CACHE_SIZE, 0, nullptr, DI_NORMAL) != FALSE;
+    if (ok) {
+        GdiFlush();
+        pixels.assign(static_cast<const DWORD*>(bits), static_cast<const DWORD*>(bits) + ICON_PIXEL_COUNT);
+        bool hasAlpha = std::any_of(pixels.begin(), pixels.end(), [](DWORD p) { return (p >> 24) != 0; });
+        if (!hasAlpha) {
+            // The mask is black where the icon is opaque.
+            memset(bits, 0, ICON_PIXEL_COUNT * sizeof(DWORD));
+            DrawIconEx(hdc, 0, 0, hIcon, ICON_CACHE_SIZE, ICON_CACHE_SIZE, 0, nullptr, DI_MASK);
+            GdiFlush();
+            const DWORD *mask = static_cast<const DWORD*>(bits);
+            for (size_t i = 0; i < ICON_PIXEL_COUNT; ++i)
+                pixels[i] = (mask[i] & 0x00FFFFFF) ? 0 : (pixels[i] | 0xFF000000);
+        }
+    }
+    SelectObject(hdc, old);
+    DeleteObject(hbmp);
+    DeleteDC(hdc);
+    return ok;
+}
+
+// Copies a bitmap returned by IShellItemImageFactory into BGRA pixels.
+static bool ReadBitmap(HBITMAP hbmp, std::vector<DWORD> &pixels) {
+    BITMAPINFO bmi = GetIconBitmapInfo();
+    pixels.assign(ICON_PIXEL_COUNT, 0);
+    HDC hdc = GetDC(nullptr);
+    int lines = GetDIBits(hdc, hbmp, 0, ICON_CACHE_SIZE, pixels.data(), &bmi, DIB_RGB_COLORS);
+    ReleaseDC(nullptr, hdc);
+    return lines == static_cast<int>(ICON_CACHE_SIZE);
+}
+
+static ULONGLONG GetFileWriteTime(const std::wstring &path) {
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExW(path.c_str(), GetFileExInfoStandard, &data))
+        return 0;
+    return (static_cast<ULONGLONG>(data.ftLastWriteTime.dwHighDateTime) << 32) | data.ftLastWriteTime.dwLowDateTime;
+}
+
+IconCache::IconCache()
+    : m_hwndNotify(nullptr)
+    , m_notifyMsg(0)
+    , m_imageList(nullptr)
+    , m_stopEvent(nullptr)
+    , m_wakeEvent(nullptr)
+    , m_notifyPending(false)
+    , m_diskCache(INVALID_HANDLE_VALUE)
+    , m_diskRecords(0)
+{
+}
+
+IconCache::~IconCache() {
+    Stop();
+}
+
+bool IconCache::Start(HWND hwndNotify, UINT notifyMsg, const std::wstring &diskCacheFile) {
+    Stop();
+    m_hwndNotify = hwndNotify;
+    m_notifyMsg = notifyMsg;
+    m_diskCacheFile = diskCacheFile;
+    m_imageList = ImageList_Create(ICON_CACHE_SIZE, ICON_CACHE_SIZE, ILC_COLOR32, 64, 64);
+    if (!m_imageList)
+        return false;
+    m_stopEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+    m_wakeEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    if (m_stopEvent && m_wakeEvent)
+        m_thread = std::thread(&IconCache::Run, this);
+    return true;
+}
+
+void IconCache::Stop() {
+    if (m_stopEvent) {
+        SetEvent(m_stopEvent);
+        if (m_thread.joinable())
+            m_thread.join();
+        CloseHandle(m_stopEvent);
+        m_stopEvent = nullptr;
+    }
+    if (m_wakeEvent) {
+        CloseHandle(m_wakeEvent);
+        m_wakeEvent = nullptr;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_requests.clear();
+        m_results.clear();
+        m_notifyPending = false;
+    }
+    m_slots.clear();
+    m_lru.clear();
+    m_waitingLists.clear();
+    m_lists.clear();
+    if (m_imageList) {
+        ImageList_Destroy(m_imageList);
+        m_imageList = nullptr;
+    }
+}
+
+// -------------------------------------------------------------------------
+// UI thread
+// -------------------------------------------------------------------------
+int IconCache::GetFileIcon(const std::wstring &filePath, ULONGLONG lastWriteTime, HWND hListView) {
+    size_t name = filePath.find_last_of(L'\\');
+    name = (name == std::wstring::npos) ? 0 : name + 1;
+    size_t dot = filePath.find_last_of(L'.');
+    if (dot == std::wstring::npos || dot < name)
+        dot = filePath.size();
+    const wchar_t *extension = filePath.c_str() + dot;
+    size_t extensionLength = filePath.size() - dot;
+    if (HasOwnIcon(extension, extensionLength)) {
+        m_scratchKey.assign(L"file|");
+        m_scratchKey.append(filePath);
+        return GetIcon(m_scratchKey, filePath, IconSource::File, lastWriteTime, hListView);
+    }
+    // Extensions are case-insensitive; fold them so ".DOCX" and ".docx" share a slot.
+    m_scratchKey.assign(L"type|");
+    for (size_t i = 0; i < extensionLength; ++i)
+        m_scratchKey.push_back(static_cast<wchar_t>(towlower(extension[i])));
+    return GetIcon(m_scratchKey, m_scratchKey.substr(5), IconSource::FileType, 0, hListView);
+}
+
+int IconCache::GetProcessIcon(const std::wstring &imagePath, HWND hListView) {
+    if (imagePath.empty())
+        return I_IMAGENONE;
+    m_scratchKey.assign(L"proc|");
+    m_scratchKey.append(imagePath);
+    return GetIcon(m_scratchKey, imagePath, IconSource::Process, 0, hListView);
+}
+
+int IconCache::GetIcon(const std::wstring &key, const std::wstring &path, IconSource source,
+                       ULONGLONG lastWriteTime, HWND hListView) {
+    if (!m_imageList || !m_wakeEvent)
+        return I_IMAGENONE;
+    auto it = m_slots.find(key);
+    if (it == m_slots.end()) {
+        Slot slot;
+        slot.image = I_IMAGENONE;
+        slot.pending = false;
+        slot.resolved = false;
+        slot.lastWriteTime = lastWriteTime;
+        slot.lru = m_lru.end();
+        it = m_slots.emplace(key, slot).first;
+    } else if (it->second.image != I_IMAGENONE) {
+        m_lru.splice(m_lru.begin(), m_lru, it->second.lru);
+        m_lists.insert(hListView);
+    }
+    Slot &slot = it->second;
+    bool stale = (source == IconSource::File && lastWriteTime != 0 && slot.lastWriteTime != lastWriteTime);
+    if (!slot.pending && (!slot.resolved || stale)) {
+        // Unknown key, or a file changed since its image was made. The old image
+        // stays visible until the new one arrives.
+        slot.pending = true;
+        slot.lastWriteTime = lastWriteTime;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_requests.push_back({ key, path, source, lastWriteTime });
+        }
+        SetEvent(m_wakeEvent);
+    }
+    if (slot.pending)
+        m_waitingLists.insert(hListView);
+    return slot.image;
+}
+
+int IconCache::AllocateImage() {
+    int count = ImageList_GetImageCount(m_imageList);
+    if (count < static_cast<int>(ICON_CACHE_MAX_IMAGES) || m_lru.empty())
+        return count;
+    // Full: take the slot of the least recently painted key.
+    auto victim = m_slots.find(m_lru.back());
+    m_lru.pop_back();
+    int image = victim->second.image;
+    if (victim->second.pending) {
+        victim->second.image = I_IMAGENONE;
+        victim->second.lru = m_lru.end();
+    } else {
+        m_slots.erase(victim); // Painting it again asks the worker (and its disk cache).
+    }
+    return image;
+}
+
+void IconCache::OnIconsReady() {
+    std::vector<Result> results;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        results.swap(m_results);
+        m_notifyPending = false;
+    }
+    if (!m_imageList)
+        return;
+    BITMAPINFO bmi = GetIconBitmapInfo();
+    HDC hdc = GetDC(nullptr);
+    bool reused = false;
+    for (Result &result : results) {
+        auto it = m_slots.find(result.key);
+        if (it == m_slots.end())
+            continue; // Evicted while pending and repainted since; a new request follows.
+        Slot &slot = it->second;
+        slot.pending = false;
+        slot.resolved = true;
+        if (!result.extracted)
+            continue;
+        void *bits = nullptr;
+        HBITMAP hbmp = CreateDIBSection(hdc, &bmi, DIB_RGB_COLORS, &bits, nullptr, 0);
+        if (!hbmp)
+            continue;
+        memcpy(bits, result.pixels.data(), ICON_PIXEL_COUNT * sizeof(DWORD));
+        if (slot.image == I_IMAGENONE) {
+            int count = ImageList_GetImageCount(m_imageList);
+            int image = AllocateImage();
+            if (image < count) {
+                reused = true;
+                slot.image = ImageList_Replace(m_imageList, image, hbmp, nullptr) ? image : I_IMAGENONE;
+            } else {
+                slot.image = ImageList_Add(m_imageList, hbmp, nullptr);
+            }
+            if (slot.image >= 0) {
+                m_lru.push_front(result.key);
+                slot.lru = m_lru.begin();
+            } else {
+                slot.image = I_IMAGENONE;
+                slot.lru = m_lru.end();
+            }
+        } else {
+            // A changed file: same slot, new picture, so rows showing it repaint.
+            ImageList_Replace(m_imageList, slot.image, hbmp, nullptr);
+            reused = true;
+        }
+        DeleteObject(hbmp);
+    }
+    ReleaseDC(nullptr, hdc);
+    // A reused image index now shows another key in every list that painted it.
+    if (reused)
+        m_waitingLists.insert(m_lists.begin(), m_lists.end());
+    RepaintLists(m_waitingLists);
+    m_waitingLists.clear();
+}
+
+void IconCache::RepaintLists(const std::set<HWND> &lists) {
+    // Only the visible rows are asked for their images again.
+    for (HWND hListView : lists) {
+        if (IsWindow(hListView))
+            InvalidateRect(hListView, nullptr, FALSE);
+    }
+}
+
+// -------------------------------------------------------------------------
+// Worker thread
+// -------------------------------------------------------------------------
+void IconCache::Run() {
+    // Shell extraction and thumbnail handlers expect an STA.
+    HRESULT hrCom = CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED | COINIT_DISABLE_OLE1DDE);
+    LoadDiskCache();
+    HANDLE handles[2] = { m_stopEvent, m_wakeEvent };
+    bool stopping = false;
+    while (!stopping) {
+        DWORD wait = MsgWaitForMultipleObjects(2, handles, FALSE, INFINITE, QS_ALLINPUT);
+        if (wait == WAIT_OBJECT_0 + 2) {
+            // An STA must pump; shell components may post to this thread.
+            MSG msg;
+            while (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE)) {
+                TranslateMessage(&msg);
+                DispatchMessage(&msg);
+            }
+            continue;
+        }
+        if (wait != WAIT_OBJECT_0 + 1)
+            break;
+        for (;;) {
+            if (WaitForSingleObject(m_stopEvent, 0) == WAIT_OBJECT_0) {
+                stopping = true;
+                break;
+            }
+            Request request;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_requests.empty())
+                    break;
+                request = std::move(m_requests.back());
+                m_requests.pop_back();
+            }
+            Result result;
+            result.key = request.key;
+            result.lastWriteTime = request.lastWriteTime;
+            result.extracted = Extract(request, result);
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_results.push_back(std::move(result));
+            if (!m_notifyPending && m_hwndNotify) {
+                m_notifyPending = true;
+                PostMessage(m_hwndNotify, m_notifyMsg, 0, 0);
+            }
+        }
+    }
+    if (m_diskCache != INVALID_HANDLE_VALUE) {
+        CloseHandle(m_diskCache);
+        m_diskCache = INVALID_HANDLE_VALUE;
+    }
+    m_diskEntries.clear();
+    if (SUCCEEDED(hrCom))
+        CoUninitialize();
+}
+
+bool IconCache::Extract(const Request &request, Result &result) {
+    if (request.source == IconSource::FileType) {
+        SHFILEINFOW info = {};
+        if (!SHGetFileInfoW(request.path.c_str(), FILE_ATTRIBUTE_NORMAL, &info, sizeof(info),
+                            SHGFI_USEFILEATTRIBUTES | SHGFI_ICON | SHGFI_SMALLICON) || !info.hIcon)
+            return false;
+        bool ok = RenderIcon(info.hIcon, result.pixels);
+        DestroyIcon(info.hIcon);
+        return ok;
+    }
+
+    if (request.source == IconSource::Process)
+        result.lastWriteTime = GetFileWriteTime(request.path);
+    auto cached = m_diskEntries.find(request.key);
+    if (cached != m_diskEntries.end() && result.lastWriteTime != 0 &&
+        cached->second.lastWriteTime == result.lastWriteTime && ReadDiskIcon(cached->second, result.pixels))
+        return true;
+
+    bool ok = false;
+    IShellItemImageFactory *factory = nullptr;
+    if (SUCCEEDED(SHCreateItemFromParsingName(request.path.c_str(), nullptr, IID_PPV_ARGS(&factory)))) {
+        SIZE size = { static_cast<LONG>(ICON_CACHE_SIZE), static_cast<LONG>(ICON_CACHE_SIZE) };
+        // Pictures get a thumbnail; programs and shortcuts their own icon.
+        SIIGBF flags = (request.source == IconSource::Process) ? (SIIGBF_RESIZETOFIT | SIIGBF_ICONONLY) : SIIGBF_RESIZETOFIT;
+        HBITMAP hbmp = nullptr;
+        if (SUCCEEDED(factory->GetImage(size, flags, &hbmp)) && hbmp) {
+            ok = ReadBitmap(hbmp, result.pixels);
+            DeleteObject(hbmp);
+        }
+        factory->Release();
+    }
+    if (!ok) {
+        SHFILEINFOW info = {};
+        if (SHGetFileInfoW(request.path.c_str(), 0, &info, sizeof(info), SHGFI_ICON | SHGFI_SMALLICON) && info.hIcon) {
+            ok = RenderIcon(info.hIcon, result.pixels);
+            DestroyIcon(info.hIcon);
+        }
+    }
+    if (ok && result.lastWriteTime != 0)
+        AppendDiskIcon(request.key, result.lastWriteTime, result.pixels);
+    return ok;
+}
+
+void IconCache::LoadDiskCache() {
+    m_diskEntries.clear();
+    m_diskRecords = 0;
+    m_diskCache = CreateFileW(m_diskCacheFile.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                              OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_diskCache == INVALID_HANDLE_VALUE)
+        return;
+    IconCacheFileHeader header = {};
+    DWORD read = 0;
+    bool valid = ReadFile(m_diskCache, &header, sizeof(header), &read, nullptr) && read == sizeof(header) &&
+                 header.magic == ICON_CACHE_FILE_MAGIC && header.version == ICON_CACHE_FILE_VERSION &&
+                 header.iconSize == ICON_CACHE_SIZE;
+    LONGLONG offset = sizeof(header);
+    if (valid) {
+        // Index the records; pixels are read when a key is asked for.
+        std::vector<wchar_t> key;
+        std::vector<DWORD> pixels(ICON_PIXEL_COUNT);
+        for (;;) {
+            IconCacheRecordHeader rec;
+            if (!ReadFile(m_diskCache, &rec, sizeof(rec), &read, nullptr) || read != sizeof(rec) ||
+                rec.keyLength == 0 || rec.keyLength > 0x8000 ||
+                rec.size != sizeof(rec) + rec.keyLength * sizeof(wchar_t) + ICON_PIXEL_COUNT * sizeof(DWORD))
+                break;
+            key.resize(rec.keyLength);
+            DWORD keyBytes = rec.keyLength * sizeof(wchar_t);
+            DWORD pixelBytes = static_cast<DWORD>(ICON_PIXEL_COUNT * sizeof(DWORD));
+            if (!ReadFile(m_diskCache, key.data(), keyBytes, &read, nullptr) || read != keyBytes ||
+                !ReadFile(m_diskCache, pixels.data(), pixelBytes, &read, nullptr) || read != pixelBytes ||
+                GetRecordChecksum(key.data(), key.size(), pixels.data()) != rec.checksum)
+                break;
+            m_diskEntries[std::wstring(key.data(), key.size())] = { rec.lastWriteTime, offset };
+            ++m_diskRecords;
+            offset += rec.size;
+        }
+    }
+    if (!valid || m_diskRecords > 2 * m_diskEntries.size() || m_diskEntries.size() > ICON_DISK_CACHE_MAX_ENTRIES) {
+        CompactDiskCache();
+        return;
+    }
+    // Drop a torn tail so appended records stay reachable.
+    LARGE_INTEGER end = {};
+    end.QuadPart = offset;
+    if (!SetFilePointerEx(m_diskCache, end, nullptr, FILE_BEGIN) || !SetEndOfFile(m_diskCache)) {
+        CloseHandle(m_diskCache);
+        m_diskCache = INVALID_HANDLE_VALUE;
+        m_diskEntries.clear();
+    }
+}
+
+bool IconCache::ReadDiskIcon(const DiskEntry &entry, std::vector<DWORD> &pixels) {
+    if (m_diskCache == INVALID_HANDLE_VALUE)
+        return false;
+    IconCacheRecordHeader rec;
+    OVERLAPPED at = {};
+    at.Offset = static_cast<DWORD>(entry.offset);
+    at.OffsetHigh = static_cast<DWORD>(entry.offset >> 32);
+    DWORD read = 0;
+    if (!ReadFile(m_diskCache, &rec, sizeof(rec), &read, &at) || read != sizeof(rec) || rec.keyLength > 0x8000 ||
+        rec.size != sizeof(rec) + rec.keyLength * sizeof(wchar_t) + ICON_PIXEL_COUNT * sizeof(DWORD))
+        return false;
+    std::vector<BYTE> body(rec.size - sizeof(rec));
+    LONGLONG bodyOffset = entry.offset + sizeof(rec);
+    at = {};
+    at.Offset = static_cast<DWORD>(bodyOffset);
+    at.OffsetHigh = static_cast<DWORD>(bodyOffset >> 32);
+    if (!ReadFile(m_diskCache, body.data(), static_cast<DWORD>(body.size()), &read, &at) || read != body.size())
+        return false;
+    const wchar_t *key = reinterpret_cast<const wchar_t*>(body.data());
+    const DWORD *source = reinterpret_cast<const DWORD*>(body.data() + rec.keyLength * sizeof(wchar_t));
+    if (GetRecordChecksum(key, rec.keyLength, source) != rec.checksum)
+        return false;
+    pixels.assign(source, source + ICON_PIXEL_COUNT);
+    return true;
+}
+
+void IconCache::AppendDiskIcon(const std::wstring &key, ULONGLONG lastWriteTime, const std::vector<DWORD> &pixels) {
+    if (m_diskCache == INVALID_HANDLE_VALUE || key.size() > 0x8000)
+        return;
+    IconCacheRecordHeader rec = {};
+    rec.keyLength = static_cast<uint32_t>(key.size());
+    rec.size = static_cast<uint32_t>(sizeof(rec) + key.size() * sizeof(wchar_t) + ICON_PIXEL_COUNT * sizeof(DWORD));
+    rec.lastWriteTime = lastWriteTime;
+    rec.checksum = GetRecordChecksum(key.c_str(), key.size(), pixels.data());
+    std::vector<BYTE> buffer(rec.size);
+    memcpy(buffer.data(), &rec, sizeof(rec));
+    memcpy(buffer.data() + sizeof(rec), key.c_str(), key.size() * sizeof(wchar_t));
+    memcpy(buffer.data() + sizeof(rec) + key.size() * sizeof(wchar_t), pixels.data(), ICON_PIXEL_COUNT * sizeof(DWORD));
+
+    LARGE_INTEGER zero = {}, end = {};
+    DWORD written = 0;
+    if (!SetFilePointerEx(m_diskCache, zero, &end, FILE_END))
+        return;
+    if (!WriteFile(m_diskCache, buffer.data(), rec.size, &written, nullptr) || written != rec.size) {
+        // A torn record would hide every record appended after it from the next load.
+        if (!SetFilePointerEx(m_diskCache, end, nullptr, FILE_BEGIN) || !SetEndOfFile(m_diskCache)) {
+            CloseHandle(m_diskCache);
+            m_diskCache = INVALID_HANDLE_VALUE;
+            m_diskEntries.clear();
+        }
+        return;
+    }
+    m_diskEntries[key] = { lastWriteTime, end.QuadPart };
+    ++m_diskRecords;
+    // Compacting at load alone lets a long session grow the file without bound;
+    // at twice the bound, compaction runs at most once per ICON_DISK_CACHE_MAX_ENTRIES appends.
+    if (m_diskRecords >= 2 * ICON_DISK_CACHE_MAX_ENTRIES)
+        CompactDiskCache();
+}
+
+void IconCache::CompactDiskCache() {
+    // Keep the newest ICON_DISK_CACHE_MAX_ENTRIES live records (the highest offsets).
+    std::vector<std::pair<std::wstring, DiskEntry>> live(m_diskEntries.begin(), m_diskEntries.end());
+    std::sort(live.begin(), live.end(),
+              [](const std::pair<std::wstring, DiskEntry> &a, const std::pair<std::wstring, DiskEntry> &b) {
+                  return a.second.offset > b.second.offset;
+              });
+    if (live.size() > ICON_DISK_CACHE_MAX_ENTRIES)
+        live.resize(ICON_DISK_CACHE_MAX_ENTRIES);
+
+    std::wstring tempFile = m_diskCacheFile + L".tmp";
+    HANDLE hTemp = CreateFileW(tempFile.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    std::unordered_map<std::wstring, DiskEntry> kept;
+    bool ok = hTemp != INVALID_HANDLE_VALUE;
+    if (ok) {
+        IconCacheFileHeader header = { ICON_CACHE_FILE_MAGIC, ICON_CACHE_FILE_VERSION, static_cast<uint16_t>(ICON_CACHE_SIZE) };
+        DWORD written = 0;
+        ok = WriteFile(hTemp, &header, sizeof(header), &written, nullptr) && written == sizeof(header);
+        LONGLONG offset = sizeof(header);
+        std::vector<DWORD> pixels;
+        for (size_t i = live.size(); ok && i-- > 0;) {
+            // Oldest first, so the newest keep the highest offsets next time.
+            if (!ReadDiskIcon(live[i].second, pixels))
+                continue;
+            const std::wstring &key = live[i].first;
+            IconCacheRecordHeader rec = {};
+            rec.keyLength = static_cast<uint32_t>(key.size());
+            rec.size = static_cast<uint32_t>(sizeof(rec) + key.size() * sizeof(wchar_t) + ICON_PIXEL_COUNT * sizeof(DWORD));
+            rec.lastWriteTime = live[i].second.lastWriteTime;
+            rec.checksum = GetRecordChecksum(key.c_str(), key.size(), pixels.data());
+            DWORD keyBytes = rec.keyLength * sizeof(wchar_t);
+            DWORD pixelBytes = static_cast<DWORD>(ICON_PIXEL_COUNT * sizeof(DWORD));
+            ok = WriteFile(hTemp, &rec, sizeof(rec), &written, nullptr) && written == sizeof(rec) &&
+                 WriteFile(hTemp, key.c_str(), keyBytes, &written, nullptr) && written == keyBytes &&
+                 WriteFile(hTemp, pixels.data(), pixelBytes, &written, nullptr) && written == pixelBytes;
+            kept[key] = { rec.lastWriteTime, offset };
+            offset += rec.size;
+        }
+        CloseHandle(hTemp);
+    }
+    if (m_diskCache != INVALID_HANDLE_VALUE) {
+        CloseHandle(m_diskCache);
+        m_diskCache = INVALID_HANDLE_VALUE;
+    }
+    if (!ok || !MoveFileExW(tempFile.c_str(), m_diskCacheFile.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+        DeleteFileW(tempFile.c_str());
+        m_diskEntries.clear();
+        m_diskRecords = 0;
+        return; // Run without a disk cache rather than append to a file we cannot read back.
+    }
+    m_diskEntries.swap(kept);
+    m_diskRecords = m_diskEntries.size();
+    m_diskCache = CreateFileW(m_diskCacheFile.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_diskCache == INVALID_HANDLE_VALUE)
+        m_diskEntries.clear();
+}
+
+// End of file: IconCache.cpp (Version: 1.1)
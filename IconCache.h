@@ -0,0 +1,144 @@
+// File: IconCache.h
+// Version: 1.0
+// -------------------------------------------------------------------------
+// This header declares IconCache, which supplies the small icons of the
+// owner-data ListViews without extracting anything on the UI thread.
+//
+// The ListViews ask for an icon through LVN_GETDISPINFO (LVIF_IMAGE), i.e.
+// only for rows that are being painted. GetFileIcon() and GetProcessIcon()
+// answer from a shared HIMAGELIST; a key that is not loaded yet returns
+// I_IMAGENONE and is queued for a background STA thread, which extracts it
+// with the shell (SHGetFileInfo for file types, IShellItemImageFactory for
+// files that carry their own icon or thumbnail, and for process images).
+// The worker posts notifyMsg once per batch; OnIconsReady() then adds the
+// images and repaints the lists that asked for them.
+//
+// Keys are deduplicated: ordinary files share the icon of their extension
+// (no disk access, so network folders cost nothing), while executables,
+// shortcuts, icons and pictures are keyed by full path, and windows by
+// their process image path. The image list holds at most
+// ICON_CACHE_MAX_IMAGES images; the least recently painted key gives up
+// its slot when a new one arrives.
+//
+// Per-path icons are persisted in ICON_CACHE_FILE, keyed by path and last
+// write time, so a restart shows them without asking the shell again. The
+// file is read, appended to and compacted only by the worker.
+//
+// All public methods are called on the UI thread.
+// -------------------------------------------------------------------------
+
+#ifndef ICONCACHE_H
+#define ICONCACHE_H
+
+#include <windows.h>
+#include <commctrl.h>
+#include <string>
+#include <vector>
+#include <list>
+#include <set>
+#include <unordered_map>
+#include <mutex>
+#include <thread>
+
+class IconCache {
+public:
+    IconCache();
+    ~IconCache();
+
+    // Creates the image list and starts the worker, which loads diskCacheFile.
+    // Returns false if the image list could not be created.
+    bool Start(HWND hwndNotify, UINT notifyMsg, const std::wstring &diskCacheFile);
+
+    // Stops the worker and destroys the image list.
+    void Stop();
+
+    // Shared small image list; set it on lists created with LVS_SHAREIMAGELISTS.
+    HIMAGELIST GetImageList() const { return m_imageList; }
+
+    // Image list index of the icon of a project file (filePath with its last
+    // write time, 0 if unknown) or of a process image, or I_IMAGENONE while
+    // it is being extracted; hListView is repainted when it arrives.
+    int GetFileIcon(const std::wstring &filePath, ULONGLONG lastWriteTime, HWND hListView);
+    int GetProcessIcon(const std::wstring &imagePath, HWND hListView);
+
+    // Handles notifyMsg: adds the extracted images and repaints waiting lists.
+    void OnIconsReady();
+
+private:
+    enum class IconSource {
+        FileType,   ///< Icon of an extension; never persisted.
+        File,       ///< Icon or thumbnail of one file, keyed by path and write time.
+        Process     ///< Icon of a process image; the worker reads its write time.
+    };
+
+    struct Request {
+        std::wstring key;
+        std::wstring path;          ///< Extension for FileType, else the full path.
+        IconSource source;
+        ULONGLONG lastWriteTime;
+    };
+
+    struct Result {
+        std::wstring key;
+        ULONGLONG lastWriteTime;
+        bool extracted;             ///< false: the shell had no icon; the key stays blank.
+        std::vector<DWORD> pixels;  ///< ICON_CACHE_SIZE^2 BGRA pixels, top-down.
+    };
+
+    struct Slot {
+        int image;                  ///< Image list index, or I_IMAGENONE.
+        bool pending;               ///< A request is queued or being extracted.
+        bool resolved;              ///< A result arrived (possibly without an image).
+        ULONGLONG lastWriteTime;    ///< Write time the image was extracted for.
+        std::list<std::wstring>::iterator lru;
+    };
+
+    // Persisted icon of a path: its write time and the record offset in the disk cache.
+    struct DiskEntry {
+        ULONGLONG lastWriteTime;
+        LONGLONG offset;
+    };
+
+    int GetIcon(const std::wstring &key, const std::wstring &path, IconSource source,
+                ULONGLONG lastWriteTime, HWND hListView);
+    // Reuses the least recently painted image, or adds one while under the bound.
+    int AllocateImage();
+    void RepaintLists(const std::set<HWND> &lists);
+
+    // Worker thread body and its helpers.
+    void Run();
+    bool Extract(const Request &request, Result &result);
+    void LoadDiskCache();
+    bool ReadDiskIcon(const DiskEntry &entry, std::vector<DWORD> &pixels);
+    void AppendDiskIcon(const std::wstring &key, ULONGLONG lastWriteTime, const std::vector<DWORD> &pixels);
+    void CompactDiskCache();
+
+    HWND m_hwndNotify;
+    UINT m_notifyMsg;
+    std::wstring m_diskCacheFile;
+    HIMAGELIST m_imageList;
+
+    // UI thread only.
+    std::unordered_map<std::wstring, Slot> m_slots;  ///< By key.
+    std::list<std::wstring> m_lru;                   ///< Keys with an image, most recently painted first.
+    std::set<HWND> m_waitingLists;                   ///< Lists that painted a pending key.
+    std::set<HWND> m_lists;                          ///< Every list that showed an image.
+    std::wstring m_scratchKey;
+
+    HANDLE m_stopEvent;
+    HANDLE m_wakeEvent;
+    std::thread m_thread;
+    std::mutex m_mutex;                              ///< Guards the members below.
+    std::vector<Request> m_requests;                 ///< Served newest first: the rows painted last.
+    std::vector<Result> m_results;
+    bool m_notifyPending;
+
+    // Worker thread only.
+    HANDLE m_diskCache;
+    std::unordered_map<std::wstring, DiskEntry> m_diskEntries;
+    size_t m_diskRecords;                            ///< Records in the file, including superseded ones.
+};
+
+#endif // ICONCACHE_H
+
+// End of file: IconCache.h (Version: 1.0)
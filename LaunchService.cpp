@@ -0,0 +1,313 @@
+// File: LaunchService.cpp
+// Version: 1.4
+// -------------------------------------------------------------------------
+// This file implements LaunchService (see LaunchService.h).
+//
+// Changes in Version 1.4:
+//  - Without a usable process the wait also accepts a window that meets the
+//    file's WindowResolverRegistry rule (e.g. "Report - Word" for an
+//    Office document handed to the running instance), in the hooks and in the
+//    same enumeration pass as the title match.
+// Changes in Version 1.3:
+//  - Each launch is traced as the Launch phase, from ShellExecuteExW until
+//    the window appeared or the wait gave up (Tracing.h).
+// Changes in Version 1.2:
+//  - The title fallback matches with ContainsNoCase() instead of copying and
+//    lowercasing each shown window's title.
+// -------------------------------------------------------------------------
+
+#include "LaunchService.h"
+#include "WindowUtils.h"   // For GetMainWindowHandle() and StripLnkExtension()
+#include "WindowResolver.h" // For WindowResolverRegistry
+#include "FingerprintUtils.h"  // For GetFingerprint()
+#include "TextMatch.h"     // For FoldNoCase() and ContainsNoCase()
+#include "Config.h"
+#include "Tracing.h"
+#include <shellapi.h>
+#include <objbase.h>
+#include <algorithm>
+#include <cwctype>
+#include <vector>
+
+namespace {
+
+// State shared with the WinEvent callback of the waiting worker thread.
+struct WaitContext {
+    DWORD processId;       // Match windows of this process, or by title if 0.
+    std::wstring fileLower;
+    int rule;              // WindowResolverRegistry rule of the file, or -1.
+    std::wstring ruleKey;  // GetTitleKey() of the file for rule.
+    HWND found;
+};
+
+thread_local WaitContext *t_waitContext = nullptr;
+
+bool IsCandidateWindow(HWND hwnd) {
+    return hwnd && GetAncestor(hwnd, GA_ROOT) == hwnd && IsWindowVisible(hwnd) &&
+           GetWindow(hwnd, GW_OWNER) == nullptr;
+}
+
+// Title mode: the title contains the file name, or the window meets the file's resolver rule.
+bool MatchesTitle(const WaitContext &ctx, HWND hwnd) {
+    int len = GetWindowTextLength(hwnd);
+    if (len <= 0 || ctx.fileLower.empty())
+        return false;
+    thread_local std::vector<wchar_t> title;
+    if (title.size() < static_cast<size_t>(len) + 1)
+        title.resize(len + 1);
+    int copied = GetWindowText(hwnd, title.data(), len + 1);
+    if (copied > 0 && ContainsNoCase(title.data(), copied, ctx.fileLower))
+        return true;
+    return ctx.rule >= 0 && WindowResolverRegistry::Shared().MatchesWindow(ctx.rule, hwnd, ctx.ruleKey);
+}
+
+void CALLBACK LaunchWinEventProc(HWINEVENTHOOK, DWORD, HWND hwnd, LONG idObject, LONG idChild, DWORD, DWORD) {
+    WaitContext *ctx = t_waitContext;
+    if (!ctx || ctx->found || idObject != OBJID_WINDOW || idChild != CHILDID_SELF || !IsCandidateWindow(hwnd))
+        return;
+    if (ctx->processId) {
+        DWORD pid = 0;
+        GetWindowThreadProcessId(hwnd, &pid);
+        if (pid == ctx->processId)
+            ctx->found = hwnd;
+        return;
+    }
+    if (MatchesTitle(*ctx, hwnd))
+        ctx->found = hwnd;
+}
+
+struct TitledSearch {
+    const WaitContext *ctx;
+    HWND found;
+};
+
+BOOL CALLBACK EnumProcTitled(HWND hwnd, LPARAM lParam) {
+    TitledSearch *search = reinterpret_cast<TitledSearch*>(lParam);
+    if (MatchesTitle(*search->ctx, hwnd)) {
+        search->found = hwnd;
+        return FALSE;
+    }
+    return TRUE;
+}
+
+// One pass over the top-level windows with MatchesTitle().
+HWND FindTitledWindow(const WaitContext &ctx) {
+    TitledSearch search = { &ctx, nullptr };
+    if (!ctx.fileLower.empty())
+        EnumWindows(EnumProcTitled, reinterpret_cast<LPARAM>(&search));
+    return search.found;
+}
+
+// Installs the hooks for the context's matching mode. Returns the hook count.
+int InstallLaunchHooks(const WaitContext &ctx, HWINEVENTHOOK hooks[2]) {
+    int count = 0;
+    if (ctx.processId) {
+        hooks[count] = SetWinEventHook(EVENT_OBJECT_SHOW, EVENT_OBJECT_SHOW, nullptr, LaunchWinEventProc,
+                                       ctx.processId, 0, WINEVENT_OUTOFCONTEXT);
+        if (hooks[count])
+            ++count;
+    } else {
+        hooks[count] = SetWinEventHook(EVENT_OBJECT_SHOW, EVENT_OBJECT_SHOW, nullptr, LaunchWinEventProc,
+                                       0, 0, WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+        if (hooks[count])
+            ++count;
+        hooks[count] = SetWinEventHook(EVENT_OBJECT_NAMECHANGE, EVENT_OBJECT_NAMECHANGE, nullptr, LaunchWinEventProc,
+                                       0, 0, WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+        if (hooks[count])
+            ++count;
+    }
+    return count;
+}
+
+void RemoveLaunchHooks(HWINEVENTHOOK hooks[2], int &count) {
+    for (int i = 0; i < count; ++i)
+        UnhookWinEvent(hooks[i]);
+    count = 0;
+}
+
+} // namespace
+
+LaunchService::LaunchService()
+    : m_hwndNotify(nullptr)
+    , m_notifyMsg(0)
+    , m_stopEvent(nullptr)
+{
+}
+
+LaunchService::~LaunchService() {
+    Stop();
+}
+
+bool LaunchService::Start(HWND hwndNotify, UINT notifyMsg) {
+    Stop();
+    m_stopEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+    if (!m_stopEvent)
+        return false;
+    m_hwndNotify = hwndNotify;
+    m_notifyMsg = notifyMsg;
+    return true;
+}
+
+void LaunchService::Stop() {
+    if (!m_stopEvent)
+        return;
+    SetEvent(m_stopEvent);
+    std::list<std::unique_ptr<Worker>> workers;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        workers.swap(m_workers);
+        m_pending.clear();
+    }
+    for (auto &worker : workers) {
+        if (worker->thread.joinable())
+            worker->thread.join();
+    }
+    CloseHandle(m_stopEvent);
+    m_stopEvent = nullptr;
+}
+
+void LaunchService::ReapFinished() {
+    std::list<std::unique_ptr<Worker>> finished;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto it = m_workers.begin(); it != m_workers.end();) {
+            if ((*it)->done) {
+                finished.push_back(std::move(*it));
+                it = m_workers.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    for (auto &worker : finished)
+        worker->thread.join();
+}
+
+bool LaunchService::Launch(const std::wstring &filePath) {
+    if (!m_stopEvent)
+        return false;
+    ReapFinished();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_pending.insert(filePath).second)
+        return true; // Already in flight; a second click must not open it twice.
+    std::unique_ptr<Worker> worker(new Worker());
+    worker->thread = std::thread(&LaunchService::Run, this, filePath, worker.get());
+    m_workers.push_back(std::move(worker));
+    return true;
+}
+
+bool LaunchService::IsPending(const std::wstring &filePath) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pending.count(filePath) != 0;
+}
+
+void LaunchService::Run(std::wstring filePath, Worker *worker) {
+    // ShellExecuteEx may use COM components that require an STA.
+    HRESULT hrCom = CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED | COINIT_DISABLE_OLE1DDE);
+
+    LaunchResult *result = new LaunchResult{ filePath, false, 0, 0, nullptr, TrackedWindow() };
+    SHELLEXECUTEINFOW sei = {0};
+    sei.cbSize = sizeof(sei);
+    sei.fMask = SEE_MASK_NOCLOSEPROCESS | SEE_MASK_NOASYNC | SEE_MASK_FLAG_NO_UI;
+    sei.lpVerb = L"open";
+    sei.lpFile = filePath.c_str();
+    sei.nShow = SW_SHOWNORMAL;
+    TraceActivity activity;
+    TraceStart(activity, TracePhase::Launch);
+    if (ShellExecuteExW(&sei)) {
+        result->launched = true;
+        result->processId = sei.hProcess ? GetProcessId(sei.hProcess) : 0;
+        result->hwnd = WaitForLaunchedWindow(sei.hProcess, filePath);
+        if (result->hwnd)
+            result->fingerprint = GetFingerprint(result->hwnd);
+        if (sei.hProcess)
+            CloseHandle(sei.hProcess);
+    } else {
+        result->error = GetLastError();
+    }
+    TraceLaunchStop(activity, result->launched, result->hwnd != nullptr);
+
+    if (SUCCEEDED(hrCom))
+        CoUninitialize();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending.erase(filePath);
+    }
+    bool stopped = WaitForSingleObject(m_stopEvent, 0) == WAIT_OBJECT_0;
+    if (stopped || !PostMessage(m_hwndNotify, m_notifyMsg, 0, reinterpret_cast<LPARAM>(result)))
+        delete result;
+    worker->done = true;
+}
+
+HWND LaunchService::WaitForLaunchedWindow(HANDLE hProcess, const std::wstring &filePath) {
+    size_t pos = filePath.find_last_of(L"\\");
+    WaitContext ctx;
+    ctx.processId = hProcess ? GetProcessId(hProcess) : 0;
+    ctx.fileLower = (pos != std::wstring::npos) ? filePath.substr(pos + 1) : filePath;
+    FoldNoCase(ctx.fileLower);
+    ctx.fileLower = StripLnkExtension(ctx.fileLower);
+    ctx.rule = WindowResolverRegistry::Shared().FindRule(filePath);
+    if (ctx.rule >= 0)
+        ctx.ruleKey = WindowResolverRegistry::Shared().GetTitleKey(ctx.rule, ctx.fileLower);
+    ctx.found = nullptr;
+    t_waitContext = &ctx;
+
+    HWINEVENTHOOK hooks[2];
+    int hookCount = InstallLaunchHooks(ctx, hooks);
+    // The window may have appeared before the hook was installed.
+    ctx.found = ctx.processId ? GetMainWindowHandle(ctx.processId) : FindTitledWindow(ctx);
+
+    const ULONGLONG deadline = GetTickCount64() + LAUNCH_WINDOW_TIMEOUT;
+    bool idleChecked = (ctx.processId == 0);
+    bool stopped = false;
+    while (!ctx.found) {
+        ULONGLONG now = GetTickCount64();
+        if (now >= deadline)
+            break;
+        DWORD timeout = static_cast<DWORD>(deadline - now);
+        if (!idleChecked)
+            timeout = std::min<DWORD>(timeout, LAUNCH_IDLE_POLL_INTERVAL);
+        HANDLE handles[2] = { m_stopEvent, hProcess };
+        DWORD handleCount = ctx.processId ? 2 : 1;
+        DWORD wait = MsgWaitForMultipleObjects(handleCount, handles, FALSE, timeout, QS_ALLINPUT);
+        if (wait == WAIT_OBJECT_0) {
+            stopped = true;
+            break;
+        }
+        if (wait == WAIT_OBJECT_0 + 1 && ctx.processId) {
+            // The process exited, typically after handing the file to a running
+            // instance; look for a window titled after the file instead.
+            RemoveLaunchHooks(hooks, hookCount);
+            ctx.processId = 0;
+            idleChecked = true;
+            hookCount = InstallLaunchHooks(ctx, hooks);
+            ctx.found = FindTitledWindow(ctx);
+            continue;
+        }
+        if (wait == WAIT_OBJECT_0 + handleCount) {
+            // Hook callbacks are delivered while messages are retrieved.
+            MSG msg;
+            while (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE)) {
+                TranslateMessage(&msg);
+                DispatchMessage(&msg);
+            }
+        }
+        if (!idleChecked) {
+            DWORD idle = WaitForInputIdle(hProcess, 0);
+            if (idle != WAIT_TIMEOUT)
+                idleChecked = true; // Idle, or a process without a message queue.
+            // First idle point: the main window, if any, normally exists by now.
+            if (idle == 0 && !ctx.found)
+                ctx.found = GetMainWindowHandle(ctx.processId);
+        }
+    }
+    if (!ctx.found && !stopped)
+        ctx.found = FindTitledWindow(ctx);
+
+    RemoveLaunchHooks(hooks, hookCount);
+    t_waitContext = nullptr;
+    return ctx.found;
+}
+
+// End of file: LaunchService.cpp (Version: 1.4)
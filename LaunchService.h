@@ -0,0 +1,93 @@
+// File: LaunchService.h
+// Version: 1.1
+// -------------------------------------------------------------------------
+// This header declares LaunchService, which opens files off the UI thread.
+//
+// Each Launch() runs on its own worker thread: the worker calls
+// ShellExecuteExW, then waits for the launched process to show a top-level
+// window (a WinEvent hook filtered by PID, with WaitForInputIdle as an extra
+// checkpoint) until LAUNCH_WINDOW_TIMEOUT expires. When the process hands
+// the file to an already running instance and exits, the worker falls back
+// to matching window titles against the file name. The outcome is posted to
+// the owner as a heap-allocated LaunchResult that the receiver must delete.
+// Several launches can be in flight at once.
+//
+// Changes in Version 1.1:
+//  - LaunchResult carries the window fingerprint so the UI thread does not
+//    query the new window itself.
+// -------------------------------------------------------------------------
+
+#ifndef LAUNCHSERVICE_H
+#define LAUNCHSERVICE_H
+
+#include <windows.h>
+#include <string>
+#include <list>
+#include <set>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include "TrackedWindow.h"
+
+/**
+ * @struct LaunchResult
+ * @brief Outcome of one launch, posted with WM_APP_LAUNCH_COMPLETE (LPARAM).
+ */
+struct LaunchResult {
+    std::wstring filePath;
+    bool launched;      ///< ShellExecuteExW succeeded.
+    DWORD error;        ///< GetLastError() of a failed ShellExecuteExW.
+    DWORD processId;    ///< Launched process, or 0 if the shell did not return one.
+    HWND hwnd;          ///< Window that appeared for the file, or nullptr on timeout.
+    TrackedWindow fingerprint;  ///< GetFingerprint(hwnd), captured on the launch thread.
+};
+
+class LaunchService {
+public:
+    LaunchService();
+    ~LaunchService();
+
+    // Sets the window that receives notifyMsg for every completed launch.
+    bool Start(HWND hwndNotify, UINT notifyMsg);
+
+    // Cancels pending waits and joins all workers. No result is posted afterwards.
+    void Stop();
+
+    // Starts launching filePath on a worker thread. A file that is already
+    // being launched is not launched a second time. Returns false if the
+    // service is not running.
+    bool Launch(const std::wstring &filePath);
+
+    // Returns true while filePath has a launch in flight.
+    bool IsPending(const std::wstring &filePath);
+
+private:
+    struct Worker {
+        std::thread thread;
+        std::atomic<bool> done;
+        Worker() : done(false) {}
+    };
+
+    // Worker thread body.
+    void Run(std::wstring filePath, Worker *worker);
+
+    // Waits for a window of the launched process (or, with no process, one
+    // whose title contains the file name) until the deadline or Stop().
+    HWND WaitForLaunchedWindow(HANDLE hProcess, const std::wstring &filePath);
+
+    // Joins workers that have finished.
+    void ReapFinished();
+
+    HWND m_hwndNotify;
+    UINT m_notifyMsg;
+    HANDLE m_stopEvent;
+
+    std::mutex m_mutex;  // Guards the members below.
+    std::list<std::unique_ptr<Worker>> m_workers;
+    std::set<std::wstring> m_pending;
+};
+
+#endif // LAUNCHSERVICE_H
+
+// End of file: LaunchService.h (Version: 1.1)
@@ -0,0 +1,246 @@
+// File: LauncherBar.cpp
+// Version: 1.2
+// -------------------------------------------------------------------------
+// This file implements LauncherBar (see LauncherBar.h).
+// -------------------------------------------------------------------------
+
+#include "LauncherBar.h"
+#include <cwchar>
+#include <iterator>
+
+LauncherBar::LauncherBar()
+    : m_hwndPager(nullptr), m_hwndToolbar(nullptr), m_nextCommand(ID_LAUNCHER_BUTTON_BASE)
+{
+}
+
+LauncherBar::~LauncherBar()
+{
+    // The windows are children of the main window and go with it.
+}
+
+bool LauncherBar::Create(HWND hwndParent, const RECT &bounds)
+{
+    HINSTANCE instance = GetModuleHandle(nullptr);
+    m_hwndPager = CreateWindowEx(0, WC_PAGESCROLLER, nullptr, WS_CHILD | WS_VISIBLE | PGS_HORZ,
+                                 bounds.left, bounds.top, bounds.right - bounds.left, bounds.bottom - bounds.top,
+                                 hwndParent, nullptr, instance, nullptr);
+    if (!m_hwndPager)
+        return false;
+    m_hwndToolbar = CreateWindowEx(0, TOOLBARCLASSNAME, nullptr,
+                                   WS_CHILD | WS_VISIBLE | TBSTYLE_FLAT | TBSTYLE_LIST | TBSTYLE_TOOLTIPS |
+                                   CCS_NORESIZE | CCS_NODIVIDER | CCS_NOPARENTALIGN,
+                                   0, 0, 0, bounds.bottom - bounds.top,
+                                   m_hwndPager, nullptr, instance, nullptr);
+    if (!m_hwndToolbar) {
+        DestroyWindow(m_hwndPager);
+        m_hwndPager = nullptr;
+        return false;
+    }
+    SendMessage(m_hwndToolbar, TB_BUTTONSTRUCTSIZE, sizeof(TBBUTTON), 0);
+    SendMessage(m_hwndToolbar, TB_SETIMAGELIST, 0, 0);
+    SendMessage(m_hwndToolbar, TB_SETBUTTONWIDTH, 0, MAKELPARAM(BUTTON_WIDTH, BUTTON_WIDTH));
+    SendMessage(m_hwndToolbar, TB_SETBUTTONSIZE, 0, MAKELPARAM(BUTTON_WIDTH, BUTTON_HEIGHT));
+    SendMessage(m_hwndToolbar, TB_SETDRAWTEXTFLAGS, DT_END_ELLIPSIS | DT_SINGLELINE,
+                DT_END_ELLIPSIS | DT_SINGLELINE);
+    // Clicks and custom draw go straight to the main window, not to the pager.
+    SendMessage(m_hwndToolbar, TB_SETPARENT, reinterpret_cast<WPARAM>(hwndParent), 0);
+    Pager_SetChild(m_hwndPager, m_hwndToolbar);
+    return true;
+}
+
+void LauncherBar::SetBounds(const RECT &bounds)
+{
+    if (!m_hwndPager)
+        return;
+    SetWindowPos(m_hwndPager, nullptr, bounds.left, bounds.top, bounds.right - bounds.left,
+                 bounds.bottom - bounds.top, SWP_NOZORDER | SWP_NOACTIVATE);
+}
+
+void LauncherBar::Show(bool show)
+{
+    if (m_hwndPager)
+        ShowWindow(m_hwndPager, show ? SW_SHOW : SW_HIDE);
+}
+
+int LauncherBar::GetButtonIndex(std::map<std::wstring, Launcher>::const_iterator it) const
+{
+    return static_cast<int>(std::distance(m_launchers.begin(), it));
+}
+
+void LauncherBar::Reconcile(const std::map<std::wstring, bool> &launcherMap, const TrackerEngine &engine)
+{
+    if (!m_hwndToolbar)
+        return;
+    bool changed = false;
+
+    // Unchecked or removed files lose their button.
+    for (auto it = m_launchers.begin(); it != m_launchers.end(); ) {
+        auto wanted = launcherMap.find(it->first);
+        if (wanted != launcherMap.end() && wanted->second) {
+            ++it;
+            continue;
+        }
+        LRESULT index = SendMessage(m_hwndToolbar, TB_COMMANDTOINDEX, it->second.command, 0);
+        if (index >= 0)
+            SendMessage(m_hwndToolbar, TB_DELETEBUTTON, index, 0);
+        m_commands.erase(it->second.command);
+        m_freeCommands.push_back(it->second.command);
+        it = m_launchers.erase(it);
+        changed = true;
+    }
+
+    // Newly checked files get a button at their place in path order.
+    for (const auto &entry : launcherMap) {
+        if (!entry.second || m_launchers.count(entry.first))
+            continue;
+        UINT command;
+        if (!m_freeCommands.empty()) {
+            command = m_freeCommands.back();
+            m_freeCommands.pop_back();
+        } else if (m_nextCommand < ID_LAUNCHER_BUTTON_BASE + LAUNCHER_COMMAND_COUNT) {
+            command = m_nextCommand++;
+        } else {
+            break; // Every launcher command is in use.
+        }
+        const std::wstring &filePath = entry.first;
+        size_t pos = filePath.find_last_of(L'\\');
+        Launcher launcher;
+        launcher.command = command;
+        launcher.label = (pos != std::wstring::npos) ? filePath.substr(pos + 1) : filePath;
+        launcher.name = engine.GetFileName(filePath);
+        launcher.state = nullptr;
+        launcher.generation = 0;
+        launcher.stateRead = false;
+        auto it = m_launchers.emplace(filePath, launcher).first;
+        m_commands[command] = filePath;
+
+        TBBUTTON button = {};
+        button.iBitmap = I_IMAGENONE;
+        button.idCommand = static_cast<int>(command);
+        button.fsState = TBSTATE_ENABLED;
+        button.fsStyle = BTNS_BUTTON | BTNS_NOPREFIX | BTNS_SHOWTEXT;
+        button.iString = reinterpret_cast<INT_PTR>(it->second.label.c_str());
+        SendMessage(m_hwndToolbar, TB_INSERTBUTTON, GetButtonIndex(it), reinterpret_cast<LPARAM>(&button));
+        changed = true;
+    }
+
+    if (changed) {
+        SIZE size = {};
+        SendMessage(m_hwndToolbar, TB_GETMAXSIZE, 0, reinterpret_cast<LPARAM>(&size));
+        RECT rc;
+        GetClientRect(m_hwndPager, &rc);
+        SetWindowPos(m_hwndToolbar, nullptr, 0, 0, size.cx, rc.bottom, SWP_NOZORDER | SWP_NOACTIVATE | SWP_NOMOVE);
+        Pager_RecalcSize(m_hwndPager);
+    }
+}
+
+void LauncherBar::UpdateStates(TrackerEngine &engine)
+{
+    ULONGLONG generation = engine.GetSnapshot().generation;
+    for (auto &pair : m_launchers) {
+        Launcher &launcher = pair.second;
+        if (launcher.stateRead && launcher.generation == generation)
+            continue;
+        const wchar_t *state = launcher.name.empty() ? nullptr : engine.GetFileState(launcher.name);
+        launcher.generation = generation;
+        launcher.stateRead = true;
+        if (state != launcher.state) {
+            launcher.state = state;
+            InvalidateButton(launcher.command);
+        }
+    }
+}
+
+void LauncherBar::InvalidateStates()
+{
+    for (auto &pair : m_launchers)
+        pair.second.stateRead = false;
+}
+
+const LauncherBar::Launcher* LauncherBar::FindLauncher(UINT command) const
+{
+    auto it = m_commands.find(command);
+    if (it == m_commands.end())
+        return nullptr;
+    auto launcher = m_launchers.find(it->second);
+    return (launcher != m_launchers.end()) ? &launcher->second : nullptr;
+}
+
+const std::wstring* LauncherBar::FindCommand(UINT command) const
+{
+    auto it = m_commands.find(command);
+    return (it != m_commands.end()) ? &it->second : nullptr;
+}
+
+void LauncherBar::InvalidateButton(UINT command)
+{
+    RECT rc;
+    if (SendMessage(m_hwndToolbar, TB_GETRECT, command, reinterpret_cast<LPARAM>(&rc)))
+        InvalidateRect(m_hwndToolbar, &rc, FALSE);
+}
+
+bool LauncherBar::OnNotify(const NMHDR *pnmh, LRESULT &result)
+{
+    if (!pnmh || (pnmh->hwndFrom != m_hwndToolbar && pnmh->hwndFrom != m_hwndPager))
+        return false;
+
+    if (pnmh->code == PGN_CALCSIZE) {
+        NMPGCALCSIZE *calc = reinterpret_cast<NMPGCALCSIZE*>(const_cast<NMHDR*>(pnmh));
+        if (calc->dwFlag == PGF_CALCWIDTH) {
+            SIZE size = {};
+            SendMessage(m_hwndToolbar, TB_GETMAXSIZE, 0, reinterpret_cast<LPARAM>(&size));
+            calc->iWidth = size.cx;
+        }
+        result = 0;
+        return true;
+    }
+
+    if (pnmh->code == TBN_GETINFOTIP) {
+        NMTBGETINFOTIP *tip = reinterpret_cast<NMTBGETINFOTIP*>(const_cast<NMHDR*>(pnmh));
+        const std::wstring *filePath = FindCommand(static_cast<UINT>(tip->iItem));
+        const Launcher *launcher = FindLauncher(static_cast<UINT>(tip->iItem));
+        if (filePath && launcher && tip->pszText && tip->cchTextMax > 0)
+            swprintf(tip->pszText, tip->cchTextMax, L"%s\n%s", filePath->c_str(),
+                     launcher->state ? launcher->state : L"Not launched");
+        result = 0;
+        return true;
+    }
+
+    if (pnmh->code == NM_CUSTOMDRAW && pnmh->hwndFrom == m_hwndToolbar) {
+        NMTBCUSTOMDRAW *draw = reinterpret_cast<NMTBCUSTOMDRAW*>(const_cast<NMHDR*>(pnmh));
+        switch (draw->nmcd.dwDrawStage) {
+            case CDDS_PREPAINT:
+                result = CDRF_NOTIFYITEMDRAW;
+                return true;
+            case CDDS_ITEMPREPAINT: {
+                const Launcher *launcher = FindLauncher(static_cast<UINT>(draw->nmcd.dwItemSpec));
+                result = (launcher && launcher->state) ? CDRF_NOTIFYPOSTPAINT : CDRF_DODEFAULT;
+                return true;
+            }
+            case CDDS_ITEMPOSTPAINT: {
+                // Launched files get a strip under the label: the highlight colour while
+                // focused, grey while minimized, the hot-track colour otherwise.
+                const Launcher *launcher = FindLauncher(static_cast<UINT>(draw->nmcd.dwItemSpec));
+                if (launcher && launcher->state) {
+                    int color = COLOR_HOTLIGHT;
+                    if (wcsstr(launcher->state, L"(Focused)"))
+                        color = COLOR_HIGHLIGHT;
+                    else if (wcsncmp(launcher->state, L"Minimized", 9) == 0)
+                        color = COLOR_GRAYTEXT;
+                    RECT strip = draw->nmcd.rc;
+                    InflateRect(&strip, -LAUNCHER_STATE_STRIP_INSET, 0);
+                    strip.top = strip.bottom - LAUNCHER_STATE_STRIP_HEIGHT;
+                    FillRect(draw->nmcd.hdc, &strip, GetSysColorBrush(color));
+                }
+                result = CDRF_DODEFAULT;
+                return true;
+            }
+            default:
+                result = CDRF_DODEFAULT;
+                return true;
+        }
+    }
+    return false;
+}
+
+// End of file: LauncherBar.cpp (Version: 1.2)
@@ -0,0 +1,102 @@
+// File: LauncherBar.h
+// Version: 1.2
+// -------------------------------------------------------------------------
+// This header declares LauncherBar, the row of launchers under the panels.
+//
+// The launchers used to be one BUTTON window each, all destroyed and created
+// again on every check box toggle and capped at five. The bar is a single
+// toolbar inside a pager control: launchers are toolbar buttons (no window
+// of their own), and the pager scrolls the row when it is wider than the
+// main window, so any number of files can be pinned.
+//
+// Reconcile() is keyed by file path: it deletes the buttons of launchers
+// that were unchecked and inserts the new ones at their place in path order;
+// the other buttons are not touched. Each launcher caches the state text
+// the engine reported for its file with the snapshot generation it was read
+// at, the same key ActivationService verifies windows with, so
+// UpdateStates() asks the engine again and repaints a button only once per
+// new snapshot. The state is drawn as a strip under the label and shown in
+// the tooltip.
+//
+// The toolbar's parent is set to the main window, which forwards the
+// launchers' WM_COMMAND (IsCommand()/FindCommand()) and the bar's WM_NOTIFY
+// (OnNotify()) here. All methods are called on the UI thread.
+//
+// Changes in Version 1.2:
+//  - Added InvalidateStates(), so a finished launch shows without waiting
+//    for the next snapshot.
+// Changes in Version 1.1:
+//  - States are read by the files' project names, not their labels, so
+//    launchers of same-named files in different folders are told apart.
+// -------------------------------------------------------------------------
+
+#ifndef LAUNCHERBAR_H
+#define LAUNCHERBAR_H
+
+#include <windows.h>
+#include <commctrl.h>
+#include <string>
+#include <map>
+#include <vector>
+#include "Config.h"
+#include "TrackerEngine.h"  // For GetFileState() and the snapshot generation
+
+class LauncherBar {
+public:
+    LauncherBar();
+    ~LauncherBar();
+
+    // Creates the pager and the toolbar at bounds in hwndParent.
+    bool Create(HWND hwndParent, const RECT &bounds);
+    void SetBounds(const RECT &bounds);
+    void Show(bool show);
+
+    // Makes the buttons match the files marked true in launcherMap, in map order.
+    // The engine maps each new file path to the name its state is read by.
+    void Reconcile(const std::map<std::wstring, bool> &launcherMap, const TrackerEngine &engine);
+
+    // Re-reads the state of launchers not read at the current snapshot generation.
+    void UpdateStates(TrackerEngine &engine);
+    // Makes the next UpdateStates() re-read every launcher, e.g. after a launch
+    // changed the engine's tracking map within the same snapshot generation.
+    void InvalidateStates();
+
+    // True if command is in the launcher command range.
+    static bool IsCommand(UINT command) {
+        return command >= ID_LAUNCHER_BUTTON_BASE && command < ID_LAUNCHER_BUTTON_BASE + LAUNCHER_COMMAND_COUNT;
+    }
+    // File path of a launcher command, or nullptr.
+    const std::wstring* FindCommand(UINT command) const;
+
+    // Handles the bar's NM_CUSTOMDRAW, TBN_GETINFOTIP and PGN_CALCSIZE.
+    // Returns true with the message result in result if pnmh was one of them.
+    bool OnNotify(const NMHDR *pnmh, LRESULT &result);
+
+    size_t GetCount() const { return m_launchers.size(); }
+
+private:
+    struct Launcher {
+        UINT command;
+        std::wstring label;         ///< Leaf file name, the button text.
+        std::wstring name;          ///< Project file name (GetFileName()), the GetFileState() key.
+        const wchar_t *state;       ///< GetFileState() result (static text), nullptr if not launched.
+        ULONGLONG generation;       ///< Snapshot generation state was read at.
+        bool stateRead;             ///< False until the first UpdateStates().
+    };
+
+    // Positions in the toolbar follow m_launchers.
+    int GetButtonIndex(std::map<std::wstring, Launcher>::const_iterator it) const;
+    const Launcher* FindLauncher(UINT command) const;
+    void InvalidateButton(UINT command);
+
+    HWND m_hwndPager;
+    HWND m_hwndToolbar;
+    std::map<std::wstring, Launcher> m_launchers;   ///< By file path, in button order.
+    std::map<UINT, std::wstring> m_commands;        ///< Command ID to file path.
+    std::vector<UINT> m_freeCommands;               ///< Commands of removed launchers.
+    UINT m_nextCommand;                             ///< Next never used command.
+};
+
+#endif // LAUNCHERBAR_H
+
+// End of file: LauncherBar.h (Version: 1.2)
@@ -0,0 +1,141 @@
+// File: ListViewModel.cpp
+// Version: 1.2
+// -------------------------------------------------------------------------
+// This file implements ListViewModel (see ListViewModel.h).
+// -------------------------------------------------------------------------
+
+#include "ListViewModel.h"
+#include <algorithm>
+#include <cwchar>
+#include <cwctype>
+
+ListViewModel::ListViewModel()
+    : m_hListView(nullptr)
+    , m_columnCount(0)
+    , m_checkboxes(false)
+    , m_committedCount(0)
+{
+}
+
+void ListViewModel::Attach(HWND hListView, int columnCount, bool checkboxes) {
+    m_hListView = hListView;
+    m_columnCount = columnCount;
+    m_checkboxes = checkboxes;
+    m_committedCount = 0;
+    m_rows.clear();
+    m_dirtyRows.clear();
+    if (m_hListView && m_checkboxes)
+        ListView_SetCallbackMask(m_hListView, LVIS_STATEIMAGEMASK);
+}
+
+void ListViewModel::Resize(int count) {
+    size_t oldCount = m_rows.size();
+    m_rows.resize(count);
+    for (size_t i = oldCount; i < m_rows.size(); ++i) {
+        Row &row = m_rows[i];
+        row.columns.assign(m_columnCount, std::wstring());
+        row.checked = false;
+        // The item count change in Commit() paints new rows; later changes mark them dirty.
+        row.generation = 1;
+        row.paintedGeneration = 1;
+    }
+    // Drop dirty marks for rows that no longer exist.
+    m_dirtyRows.erase(std::remove_if(m_dirtyRows.begin(), m_dirtyRows.end(),
+                                     [count](int row) { return row >= count; }),
+                      m_dirtyRows.end());
+}
+
+void ListViewModel::MarkDirty(int row) {
+    Row &r = m_rows[row];
+    if (r.generation == r.paintedGeneration)
+        m_dirtyRows.push_back(row);
+    ++r.generation;
+}
+
+bool ListViewModel::SetText(int row, int column, const wchar_t *text, size_t length) {
+    std::wstring &cell = m_rows[row].columns[column];
+    if (cell.size() == length && cell.compare(0, length, text, length) == 0)
+        return false;
+    cell.assign(text, length);
+    MarkDirty(row);
+    return true;
+}
+
+bool ListViewModel::SetChecked(int row, bool checked) {
+    if (m_rows[row].checked == checked)
+        return false;
+    m_rows[row].checked = checked;
+    MarkDirty(row);
+    return true;
+}
+
+void ListViewModel::Commit() {
+    if (!m_hListView)
+        return;
+    int count = GetCount();
+    if (count != m_committedCount) {
+        // Rows that are added or removed are repainted by the control itself.
+        ListView_SetItemCountEx(m_hListView, count, LVSICF_NOINVALIDATEALL | LVSICF_NOSCROLL);
+        m_committedCount = count;
+    }
+    if (m_dirtyRows.empty())
+        return;
+
+    // Redraw contiguous runs of changed rows.
+    std::sort(m_dirtyRows.begin(), m_dirtyRows.end());
+    size_t i = 0;
+    while (i < m_dirtyRows.size()) {
+        int first = m_dirtyRows[i];
+        int last = first;
+        while (i + 1 < m_dirtyRows.size() && m_dirtyRows[i + 1] == last + 1)
+            last = m_dirtyRows[++i];
+        ++i;
+        ListView_RedrawItems(m_hListView, first, last);
+    }
+    for (int row : m_dirtyRows)
+        m_rows[row].paintedGeneration = m_rows[row].generation;
+    m_dirtyRows.clear();
+}
+
+void ListViewModel::OnGetDispInfo(NMLVDISPINFO *pDispInfo) const {
+    LVITEM &item = pDispInfo->item;
+    if (item.iItem < 0 || item.iItem >= GetCount())
+        return;
+    const Row &row = m_rows[item.iItem];
+    if ((item.mask & LVIF_TEXT) && item.pszText && item.cchTextMax > 0) {
+        if (item.iSubItem >= 0 && item.iSubItem < m_columnCount)
+            wcsncpy_s(item.pszText, item.cchTextMax, row.columns[item.iSubItem].c_str(), _TRUNCATE);
+        else
+            item.pszText[0] = L'\0';
+    }
+    if ((item.mask & LVIF_STATE) && m_checkboxes) {
+        item.state = (item.state & ~LVIS_STATEIMAGEMASK) | INDEXTOSTATEIMAGEMASK(row.checked ? 2 : 1);
+        item.stateMask |= LVIS_STATEIMAGEMASK;
+    }
+}
+
+int ListViewModel::OnFindItem(const NMLVFINDITEM *pFindItem) const {
+    const LVFINDINFO &info = pFindItem->lvfi;
+    if (!(info.flags & (LVFI_STRING | LVFI_PARTIAL)) || !info.psz)
+        return -1;
+    size_t len = wcslen(info.psz);
+    int count = GetCount();
+    if (count == 0)
+        return -1;
+    int start = (pFindItem->iStart >= 0 && pFindItem->iStart < count) ? pFindItem->iStart : 0;
+    for (int n = 0; n < count; ++n) {
+        int row = (start + n) % count;
+        if (row < start && !(info.flags & LVFI_WRAP))
+            break;
+        const std::wstring &text = m_rows[row].columns[0];
+        if (text.size() < len)
+            continue;
+        bool match = (info.flags & LVFI_PARTIAL) ? (_wcsnicmp(text.c_str(), info.psz, len) == 0)
+                                                 : (_wcsicmp(text.c_str(), info.psz) == 0);
+        if (match)
+            return row;
+    }
+    return -1;
+}
+
+// End of file: ListViewModel.cpp (Version: 1.2)
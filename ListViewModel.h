@@ -0,0 +1,83 @@
+// File: ListViewModel.h
+// Version: 1.2
+// -------------------------------------------------------------------------
+// This header declares ListViewModel, the in-memory row model behind an
+// owner-data (LVS_OWNERDATA) ListView.
+//
+// The control never holds a copy of the strings: it asks for them through
+// LVN_GETDISPINFO, which OnGetDispInfo() answers from the cached rows.
+// Setters compare before assigning and bump a per-row generation when the
+// content changes; Commit() then pushes the new item count and redraws
+// only the rows whose generation changed since the previous commit.
+//
+// Changes in Version 1.2:
+//  - Rows added by Resize() start out painted, so later changes to them are
+//    queued and redrawn like those of any other row.
+// Changes in Version 1.1:
+//  - SetText() accepts character ranges, so callers formatting from arenas
+//    or static strings do not build a temporary std::wstring per cell.
+// -------------------------------------------------------------------------
+
+#ifndef LISTVIEWMODEL_H
+#define LISTVIEWMODEL_H
+
+#include <windows.h>
+#include <commctrl.h>
+#include <string>
+#include <cwchar>
+#include <vector>
+
+class ListViewModel {
+public:
+    ListViewModel();
+
+    // Binds the model to an LVS_OWNERDATA ListView with the given column count.
+    // If checkboxes is true, check states are served through the callback mask.
+    void Attach(HWND hListView, int columnCount, bool checkboxes);
+
+    HWND GetHwnd() const { return m_hListView; }
+    int GetCount() const { return static_cast<int>(m_rows.size()); }
+
+    // Grows or shrinks the row set. New rows are empty and unchecked.
+    void Resize(int count);
+
+    // Updates a cell; returns true (and marks the row dirty) if the text changed.
+    bool SetText(int row, int column, const wchar_t *text, size_t length);
+    bool SetText(int row, int column, const std::wstring &text) { return SetText(row, column, text.c_str(), text.size()); }
+    bool SetText(int row, int column, const wchar_t *text) { return SetText(row, column, text, wcslen(text)); }
+    const std::wstring& GetText(int row, int column) const { return m_rows[row].columns[column]; }
+
+    // Check state for LVS_EX_CHECKBOXES lists.
+    bool SetChecked(int row, bool checked);
+    bool IsChecked(int row) const { return m_rows[row].checked; }
+
+    // Pushes the item count to the control and redraws dirty rows only.
+    void Commit();
+
+    // Answers LVN_GETDISPINFO from the cached rows.
+    void OnGetDispInfo(NMLVDISPINFO *pDispInfo) const;
+
+    // Answers LVN_ODFINDITEM (keyboard type-ahead) with a prefix search on column 0.
+    int OnFindItem(const NMLVFINDITEM *pFindItem) const;
+
+private:
+    struct Row {
+        std::vector<std::wstring> columns;
+        bool checked;
+        unsigned generation;         ///< Incremented on every content change.
+        unsigned paintedGeneration;  ///< Generation the control last redrew.
+    };
+
+    void MarkDirty(int row);
+
+    HWND m_hListView;
+    int m_columnCount;
+    bool m_checkboxes;
+    int m_committedCount;          ///< Item count last pushed to the control.
+    std::vector<Row> m_rows;
+    std::vector<int> m_dirtyRows;  ///< Rows changed since the last Commit().
+};
+
+#endif // LISTVIEWMODEL_H
+
+// End of file: ListViewModel.h (Version: 1.2)
@@ -1,10 +1,156 @@
 // ============================ 
 // File: MainWindow.cpp
-// Version: 1.61.0 (Added .url detection and ShowIntegratedBrowser call)
+// Version: 1.83.0 (Launcher states after a launch)
 // -------------------------------------------------------------------------
 // This file implements the MainWindow class for MYexplorer.
 //
-// Changes in this version (1.61.0):
+// Changes in this version (1.83.0):
+// 1) OnLaunchComplete() re-reads the launcher states at once (LauncherBar::InvalidateStates()),
+//    so a finished launch no longer waits for the next snapshot to show on its button.
+//
+// Changes in version 1.82.0:
+// 1) Enter resolves the best match against the query it was pressed for. The text is
+//    submitted first if its key-up has not filtered it yet, and until the final result
+//    of that query is shown, OpenCLIInput() waits for it (m_cliOpenPending) instead of
+//    opening the first row, which may still belong to an earlier query.
+//
+// Changes in version 1.81.0:
+// 1) The CLI list shows ranked fuzzy matches instead of the names starting with the input.
+//    Every keystroke submits the input to m_cliSearch (FuzzySearcher), which scores the
+//    engine's file names on its own thread, boosted by the engine's frecency, and posts
+//    WM_APP_SEARCH_RESULTS; OnCLISearchResults() renders only the newest query's result,
+//    first the best names found within FUZZY_SEARCH_PARTIAL_INTERVAL, then the final ones.
+// 2) Enter opens the top match when the input is not the name of a project file.
+//    Tab completion still uses m_cliPrefixIndex.
+//
+// Changes in version 1.80.0:
+// 1) File names may contain folders or be full paths (files under the other PROJECT_ROOTS);
+//    launcher and icon paths come from TrackerEngine::GetFilePath() instead of being joined
+//    to PROJECT_FOLDER here. The lists fill as the engine's listing batches arrive.
+//
+// Changes in version 1.79.0:
+// 1) The launcher buttons are m_launcherBar, one toolbar in a pager at the bottom of the
+//    window instead of up to five BUTTON windows at a fixed row. A check box toggle or a
+//    renamed launcher reconciles only the changed buttons, any number of launchers can be
+//    pinned (the pager scrolls them), and the bar repaints launch states once per snapshot
+//    from its per-launcher cache.
+//
+// Changes in version 1.78.0:
+// 1) Only the visible File Tracking panel is built in OnCreate(). The Window Monitoring
+//    and CLI panels, their controls and columns are created by EnsurePanel() on their
+//    first SwitchPanel(); until then RefreshViews() and folder changes skip them.
+// 2) The project folder listing no longer runs in WM_CREATE: the engine's directory
+//    thread delivers it through OnFolderChanged(), like the tracking entries.
+// 3) m_startupMetrics records the time to first paint (first post-paint of the File
+//    Tracking list, via NM_CUSTOMDRAW) and to interactive (folder listed, tracking
+//    resolved and a snapshot rendered) and appends them to STARTUP_METRICS_FILE.
+//
+// Changes in version 1.77.0:
+// 1) The integrated browser panel is created hidden BROWSER_PREWARM_DELAY after the
+//    first paint (BROWSER_PREWARM_TIMER_ID), which creates the shared WebView2 environment
+//    and the panel's controller pool in the background. ShowIntegratedBrowser() only
+//    shows the panel and opens the URL in a tab; the split layout follows the panel's
+//    visibility instead of its existence.
+//
+// Changes in version 1.76.0:
+// 1) The lists show file type, per-file and process icons. LVN_GETDISPINFO asks
+//    m_iconCache for the image of each painted row; extraction runs on the cache's STA
+//    thread and WM_APP_ICONS_READY repaints the lists that waited for it. The three
+//    lists share the cache's image list (LVS_SHAREIMAGELISTS).
+//
+// Changes in version 1.75.0:
+// 1) WM_DESTROY no longer saves tracking.dat: the engine journals every tracking change as
+//    it happens (TrackingJournal), so Stop() only commits the last group.
+//
+// Changes in version 1.74.0:
+// 1) Every panel refresh in RefreshViews() is traced as a ListViewUpdate phase (Tracing.h).
+//
+// Changes in version 1.73.0:
+// 1) OpenFile() no longer parses .url files itself. TrackerEngine::OpenFile() resolves
+//    every activation through its ActivationService cache and returns the URL= target of
+//    a .url file, which is shown in the integrated browser as before.
+//
+// Changes in version 1.72.0:
+// 1) Window resolution, fingerprint refresh, launching, the folder index and persistence
+//    moved to TrackerEngine (see TrackerEngine.h). MainWindow forwards the engine's
+//    messages to m_engine.HandleMessage() and renders what OnSnapshotUpdated(),
+//    OnFolderChanged() and OnLaunchComplete() report.
+// 2) The four copies of the activate-or-launch sequence (CLI Enter, launcher buttons and
+//    both double-click handlers) are one OpenFile(), which keeps the .url handling for
+//    the integrated browser and hands everything else to TrackerEngine::OpenFile().
+//
+// Changes in version 1.71.0:
+// 1) "Restore workspace" (system menu) treats m_fileWindowMap as the working set: open
+//    windows get their stored rectangles and are stacked in one ApplyWorkspaceLayout()
+//    batch with a single activation, and files without a window are launched through
+//    m_launchService; their windows are moved to the stored rectangle on arrival.
+//
+// Changes in version 1.70.0:
+// 1) A new snapshot no longer re-renders all three lists. m_refreshScheduler refreshes
+//    the visible panel on every snapshot (or at the configured rate) and lets hidden
+//    panels decay to a slow rate; REFRESH_TIMER_ID catches up panels whose turn comes
+//    after the snapshot arrived. A tab switch renders the new panel immediately.
+// 2) While the window is minimized or the session is locked (WTS session notifications)
+//    nothing is rendered and m_snapshotWorker is paused; restore and unlock catch up.
+// 3) The system menu offers "Normal refresh" and "Battery saver refresh" rates, which
+//    replace the fixed TIMER_INTERVAL sweep and the per-snapshot refresh of hidden panels.
+//
+// Changes in version 1.69.0:
+// 1) Views render from the columnar WindowTable of the snapshot. WindowListsEqual() and
+//    the m_prevWindowList copy are gone: the Window Monitoring list is skipped when the
+//    table's content hash, the foreground window and the matches are unchanged, and
+//    otherwise diffs against the HWND and rectangle of each previously rendered row.
+// 2) Title matching, the status column and SyncTrackedWindows() reuse their buffers,
+//    and state texts are static strings, so a refresh with nothing new does not allocate.
+//
+// Changes in version 1.68.0:
+// 1) WM_CREATE only reads tracking.dat. The stored entries are resolved in one pass
+//    against the first window snapshot (RehydrateTrackedWindows), so startup no longer
+//    runs up to two EnumWindows per tracked file before the first paint.
+//
+// Changes in version 1.67.0:
+// 1) Window enumeration, the consistency sweep, fingerprint refreshes and status strings
+//    run on m_snapshotWorker's thread. The UI renders the newest published WindowSnapshot
+//    when WM_APP_SNAPSHOT_READY arrives, so a hung application cannot stall the message
+//    loop during a refresh. The UI timers are gone; the worker owns the cadence.
+// 2) SyncTrackedWindows() hands the tracked HWNDs to the worker after every refresh.
+//
+// Changes in version 1.66.0:
+// 1) Files are opened by m_launchService on worker threads instead of the blocking
+//    LaunchFile() poll loop. WM_APP_LAUNCH_COMPLETE delivers the launched window, which
+//    is fingerprinted into m_fileWindowMap, or reports a failed launch.
+//
+// Changes in version 1.65.0:
+// 1) The CLI filter and Tab completion use m_cliPrefixIndex, a sorted table of lowercase
+//    names built with the file list. Each keystroke narrows the previous match range and
+//    Tab reads the common prefix from the range bounds instead of scanning every row.
+//
+// Changes in version 1.64.0:
+// 1) PROJECT_FOLDER is enumerated once into m_directoryIndex, which watches it with
+//    ReadDirectoryChangesW. PopulateListView() and FilterCLIListView() read the index
+//    instead of walking the folder, so typing in the CLI no longer touches the disk.
+// 2) WM_APP_DIRECTORY_CHANGED applies the watcher's deltas; renamed files keep their
+//    tracking and launcher entries.
+//
+// Changes in version 1.63.0:
+// 1) All three ListViews are LVS_OWNERDATA lists backed by ListViewModel row models.
+//    LVN_GETDISPINFO is answered from cached strings, and only rows whose content
+//    changed are redrawn (ListView_RedrawItems) instead of rewriting every cell and
+//    invalidating the whole list each refresh.
+// 2) Check boxes are toggled by hand (NM_CLICK on the state icon, or Space) and are
+//    mirrored from m_launcherMap into both file lists.
+// 3) Numeric Window Monitoring columns are only reformatted when their value changed.
+//
+// Changes in version 1.62.0:
+// 1) The window lists are refreshed from m_windowMonitor's event-fed table. WindowMonitor
+//    posts WM_APP_WINDOWS_CHANGED, which arms a short one-shot timer so that bursts of
+//    events (e.g. dragging a window) result in a single RefreshViews().
+// 2) The TIMER_ID timer is now only a slow consistency sweep that resyncs the table.
+// 3) Status lookups for untracked files and the "Associated Files" column come from a
+//    single TitleMatcher pass over the window table instead of a GetWindowHandleByFileName
+//    (a full EnumWindows) per file. The matcher is rebuilt in PopulateListView().
+//
+// Changes in version 1.61.0:
 // 1) Added a ShowIntegratedBrowser(const std::wstring &url) method, which creates a BrowserPanel
 //    and navigates to the given URL in an embedded WebView2 browser.
 // 2) In both the CLI and File Tracking double-click logic, if the file ends with ".url",
@@ -23,7 +169,19 @@
 #include "FileUtils.h"            // For file launching & persistence functions
 #include "Config.h"               // Externalized configuration constants
 #include "BrowserPanel.h"         // For the integrated browser feature
+#include "TitleMatcher.h"         // For single-pass file/title matching
+#include "ListViewModel.h"        // For owner-data ListView row models
+#include "DirectoryIndex.h"       // For the watched project folder index
+#include "PrefixIndex.h"          // For CLI Tab completion
+#include "FuzzySearch.h"          // For the ranked CLI search
+#include "LaunchService.h"        // For asynchronous file launching
+#include "WindowSnapshotWorker.h" // For off-thread window snapshots
+#include "RefreshScheduler.h"     // For visibility-aware panel refreshes
+#include "TrackerEngine.h"        // For the UI-independent tracking core
+#include "Tracing.h"              // For ETW phase events
+#include "IconCache.h"            // For the list icons
 #include <commctrl.h>
+#include <wtsapi32.h>
 #include <filesystem>
 #include <string>
 #include <vector>
@@ -31,10 +189,10 @@
 #include <shellapi.h>
 #include <chrono>
 #include <thread>
-#include <fstream>
 #include <sstream>
 #include <cwctype>
 #include <windowsx.h>
+#include <memory>
 
 namespace fs = std::filesystem;
 
@@ -55,53 +213,6 @@ namespace fs = std::filesystem;
 // -------------------------------------------------------------------------
 static const int TAB_CONTROL_HEIGHT = 30;
 
-// Helper for returning a string describing the window's current state.
-static std::wstring GetStateString(HWND hwnd) {
-    WINDOWPLACEMENT wp{};
-    wp.length = sizeof(WINDOWPLACEMENT);
-    std::wstring stateStr;
-    if (GetWindowPlacement(hwnd, &wp)) {
-        if (wp.showCmd == SW_SHOWMINIMIZED)
-            stateStr = L"Minimized";
-        else if (wp.showCmd == SW_SHOWMAXIMIZED)
-            stateStr = L"Maximized";
-        else
-            stateStr = L"Normal";
-    } else {
-        stateStr = L"Unknown";
-    }
-    if (hwnd == GetForegroundWindow())
-        stateStr += L" (Focused)";
-    return stateStr;
-}
-
-// Compare two window lists for equality
-static bool WindowListsEqual(const std::vector<WindowInfo>& a, const std::vector<WindowInfo>& b) {
-    if (a.size() != b.size())
-        return false;
-    for (size_t i = 0; i < a.size(); ++i) {
-        if (a[i].title       != b[i].title       ||
-            a[i].processName != b[i].processName ||
-            a[i].state       != b[i].state       ||
-            a[i].className   != b[i].className   ||
-            a[i].rect.left   != b[i].rect.left   ||
-            a[i].rect.top    != b[i].rect.top    ||
-            a[i].rect.right  != b[i].rect.right  ||
-            a[i].rect.bottom != b[i].rect.bottom)
-            return false;
-    }
-    return true;
-}
-
-// -------------------------------------------------------------------------
-// Helper for Window Activation
-// -------------------------------------------------------------------------
-static void ActivateTrackedWindow(TrackedWindow &tw) {
-    if (IsIconic(tw.hwnd))
-        ShowWindow(tw.hwnd, SW_RESTORE);
-    SetForegroundWindow(tw.hwnd);
-}
-
 // -------------------------------------------------------------------------
 // PanelSubclassProc: Forward WM_NOTIFY messages from container panel to main window.
 // -------------------------------------------------------------------------
@@ -116,21 +227,16 @@ static LRESULT CALLBACK PanelSubclassProc(HWND hWnd, UINT uMsg, WPARAM wParam, L
 
 // -------------------------------------------------------------------------
 // MainWindow: ShowIntegratedBrowser
-// Creates a new BrowserPanel (WebView2) on the right side, in a split view.
+// Shows the BrowserPanel (WebView2) on the right side, in a split view, and opens
+// url in one of its tabs.
 // -------------------------------------------------------------------------
 void MainWindow::ShowIntegratedBrowser(const std::wstring &url) {
-    if (!m_browserPanel) {
-        m_browserPanel = new BrowserPanel();
-        RECT rc;
-        GetClientRect(m_hwnd, &rc);
-        int leftPaneWidth = rc.right / 3; // left pane = 1/3 width
-        RECT browserRect = { leftPaneWidth, TAB_CONTROL_HEIGHT, rc.right, rc.bottom };
-        if (!m_browserPanel->Create(m_hwnd, browserRect)) {
-            delete m_browserPanel;
-            m_browserPanel = nullptr;
-            MessageBox(m_hwnd, L"Failed to create integrated browser panel.", L"Error", MB_OK | MB_ICONERROR);
-            return;
-        }
+    if (!EnsureBrowserPanel()) {
+        MessageBox(m_hwnd, L"Failed to create integrated browser panel.", L"Error", MB_OK | MB_ICONERROR);
+        return;
+    }
+    if (!m_browserPanel->IsVisible()) {
+        m_browserPanel->Show(true);
         // Optionally hide other panels to emphasize the split view
         ShowWindow(m_hPanelFileTracking, SW_SHOW); // keep file tracking visible
         ShowWindow(m_hPanelWindowMonitoring, SW_HIDE);
@@ -141,6 +247,48 @@ void MainWindow::ShowIntegratedBrowser(const std::wstring &url) {
     SendMessage(m_hwnd, WM_SIZE, 0, 0);
 }
 
+// -------------------------------------------------------------------------
+// MainWindow: EnsureBrowserPanel
+// Creates the hidden BrowserPanel, which starts the shared WebView2 environment
+// and fills its controller pool. Returns false if the panel could not be created.
+// -------------------------------------------------------------------------
+bool MainWindow::EnsureBrowserPanel() {
+    KillTimer(m_hwnd, BROWSER_PREWARM_TIMER_ID);
+    if (m_browserPanel)
+        return true;
+    m_browserPanel = new BrowserPanel();
+    RECT rc;
+    GetClientRect(m_hwnd, &rc);
+    int leftPaneWidth = rc.right / 3; // left pane = 1/3 width
+    RECT browserRect = { leftPaneWidth, TAB_CONTROL_HEIGHT, rc.right, rc.bottom };
+    if (!m_browserPanel->Create(m_hwnd, browserRect)) {
+        delete m_browserPanel;
+        m_browserPanel = nullptr;
+        return false;
+    }
+    return true;
+}
+
+// -------------------------------------------------------------------------
+// OpenFile: Show a .url file in the integrated browser, else activate or launch
+// -------------------------------------------------------------------------
+bool MainWindow::OpenFile(const std::wstring &filePath) {
+    std::wstring url;
+    switch (m_engine.OpenFile(filePath, &url)) {
+    case OpenOutcome::ShowUrl:
+        ShowIntegratedBrowser(url);
+        return true;
+    case OpenOutcome::UrlUnreadable:
+        MessageBox(m_hwnd, L"Failed to open .url file.", L"Error", MB_OK | MB_ICONERROR);
+        return false;
+    case OpenOutcome::Failed:
+        MessageBox(m_hwnd, L"Failed to launch file.", L"Error", MB_OK | MB_ICONERROR);
+        return true;
+    default:
+        return true;
+    }
+}
+
 // -------------------------------------------------------------------------
 // CLIEditSubclassProc: Handle key input in the CLI edit control.
 // -------------------------------------------------------------------------
@@ -162,52 +310,10 @@ LRESULT CALLBACK MainWindow::CLIEditSubclassProc(HWND hWnd, UINT uMsg, WPARAM wP
                 MessageBox(pThis->GetHwnd(), L"Please enter a file name.", L"Error", MB_OK | MB_ICONERROR);
                 return 0;
             }
-            // Check if file is .url
-            std::wstring filePath = PROJECT_FOLDER + L"\\" + input;
-            std::wstring fileLower = filePath;
-            for (auto &c : fileLower) c = towlower(c);
-            if (fileLower.size() >= 4 && fileLower.rfind(L".url") == fileLower.size() - 4) {
-                // It's a .url file; read the URL= line and show integrated browser
-                std::wifstream ifs(filePath.c_str());
-                if (!ifs) {
-                    MessageBox(pThis->GetHwnd(), L"Failed to open .url file.", L"Error", MB_OK | MB_ICONERROR);
-                    return 0;
-                }
-                std::wstring line, url;
-                while (std::getline(ifs, line)) {
-                    if (line.find(L"URL=") == 0) {
-                        url = line.substr(4);
-                        break;
-                    }
-                }
-                ifs.close();
-                if (!url.empty()) {
-                    pThis->ShowIntegratedBrowser(url);
-                    // Clear the edit control and reset the CLI ListView.
-                    SetWindowText(hWnd, L"");
-                    pThis->PopulateCLIListView();
-                    return 0;
-                }
-                // If we fail to parse URL=, fallback to normal logic
-            }
-            // Otherwise, do normal logic
-            auto it = pThis->m_fileWindowMap.find(filePath);
-            if (it != pThis->m_fileWindowMap.end() && IsWindow(it->second.hwnd)) {
-                TrackedWindow currentFp = GetFingerprint(it->second.hwnd);
-                if (!CompareStableAttributes(it->second, currentFp))
-                    it->second = currentFp;
-                ActivateTrackedWindow(it->second);
-            } else {
-                HWND hwndFound = GetWindowHandleByFileName(input);
-                if (hwndFound) {
-                    ActivateTrackedWindow(pThis->m_fileWindowMap[filePath] = GetFingerprint(hwndFound));
-                } else {
-                    LaunchFile(filePath, pThis->GetHwnd(), pThis->m_fileWindowMap);
-                }
-            }
-            // Clear the edit control and reset the CLI ListView.
-            SetWindowText(hWnd, L"");
-            pThis->PopulateCLIListView();
+            // Enter may come before the key-up that would have filtered the last keystroke.
+            if (input != pThis->m_cliFilter)
+                pThis->FilterCLIListView(input);
+            pThis->OpenCLIInput();
             return 0;
         }
         else if (wParam == VK_TAB) {
@@ -224,38 +330,10 @@ LRESULT CALLBACK MainWindow::CLIEditSubclassProc(HWND hWnd, UINT uMsg, WPARAM wP
             if (input.empty()) {
                 return 0;
             }
-            int count = ListView_GetItemCount(pThis->m_hCLIListView);
-            if (count == 0)
+            // The common prefix of all matches comes straight from the prefix index.
+            if (pThis->m_cliPrefixIndex.Narrow(input) == 0)
                 return 0;
-            std::wstring commonPrefix;
-            {
-                wchar_t itemText[256] = {0};
-                LVITEM lvi = {0};
-                lvi.mask = LVIF_TEXT;
-                lvi.iItem = 0;
-                lvi.iSubItem = 0;
-                lvi.pszText = itemText;
-                lvi.cchTextMax = 256;
-                ListView_GetItem(pThis->m_hCLIListView, &lvi);
-                commonPrefix = itemText;
-            }
-            for (int i = 1; i < count; ++i) {
-                wchar_t itemText[256] = {0};
-                LVITEM lvi = {0};
-                lvi.mask = LVIF_TEXT;
-                lvi.iItem = i;
-                lvi.iSubItem = 0;
-                lvi.pszText = itemText;
-                lvi.cchTextMax = 256;
-                ListView_GetItem(pThis->m_hCLIListView, &lvi);
-                std::wstring currentItem(itemText);
-                size_t j = 0;
-                while (j < commonPrefix.size() && j < currentItem.size() &&
-                       towlower(commonPrefix[j]) == towlower(currentItem[j])) {
-                    ++j;
-                }
-                commonPrefix = commonPrefix.substr(0, j);
-            }
+            std::wstring commonPrefix = pThis->m_cliPrefixIndex.GetCommonPrefix();
             if (commonPrefix.size() > input.size()) {
                 SetWindowText(hWnd, commonPrefix.c_str());
                 int len = GetWindowTextLength(hWnd);
@@ -275,97 +353,119 @@ LRESULT CALLBACK MainWindow::CLIEditSubclassProc(HWND hWnd, UINT uMsg, WPARAM wP
                 currentText = currentText.substr(start, end - start + 1);
             else
                 currentText = L"";
-            pThis->FilterCLIListView(currentText);
+            // Keys that do not edit the text (arrows, Shift, ...) leave the search alone.
+            if (currentText != pThis->m_cliFilter)
+                pThis->FilterCLIListView(currentText);
         }
     }
     return DefSubclassProc(hWnd, uMsg, wParam, lParam);
 }
 
 // -------------------------------------------------------------------------
-// FilterCLIListView: Rebuild the CLI ListView with files matching the filter.
+// FilterCLIListView: Search the files matching the filter; the rows follow.
 // -------------------------------------------------------------------------
 void MainWindow::FilterCLIListView(const std::wstring &filter) {
-    ListView_DeleteAllItems(m_hCLIListView);
-    int index = 0;
-    try {
-        for (const auto &entry : fs::directory_iterator(PROJECT_FOLDER)) {
-            if (entry.is_regular_file()) {
-                std::wstring fileName = entry.path().filename().wstring();
-                std::wstring fileNameLower = fileName;
-                std::wstring filterLower = filter;
-                for (auto &c : fileNameLower)
-                    c = towlower(c);
-                for (auto &c : filterLower)
-                    c = towlower(c);
-                if (filterLower.empty() || fileNameLower.find(filterLower) == 0) {
-                    LVITEM item = {0};
-                    item.mask = LVIF_TEXT;
-                    item.iItem = index;
-                    item.iSubItem = 0;
-                    item.pszText = const_cast<LPWSTR>(fileName.c_str());
-                    ListView_InsertItem(m_hCLIListView, &item);
-                    LVITEM statusItem = {0};
-                    statusItem.mask = LVIF_TEXT;
-                    statusItem.iItem = index;
-                    statusItem.iSubItem = 1;
-                    statusItem.pszText = const_cast<LPWSTR>(L"Not launched");
-                    ListView_SetItem(m_hCLIListView, &statusItem);
-                    ++index;
-                }
-            }
+    // A pending Enter was for the previous text; a re-run of the same text keeps it.
+    if (filter != m_cliFilter)
+        m_cliOpenPending = false;
+    m_cliFilter = filter;
+    m_cliShownFinal = false;
+    // Supersedes the previous query; its result is dropped if it arrives later.
+    m_cliSearch.SetFrecency(m_engine.GetFrecencyScores());
+    m_cliSearchToken = m_cliSearch.Submit(filter);
+}
+
+// -------------------------------------------------------------------------
+// OnCLISearchResults: Rebuild the CLI row model from the newest search result.
+// -------------------------------------------------------------------------
+void MainWindow::OnCLISearchResults() {
+    FuzzySearchResult result;
+    if (!m_cliSearch.TakeResult(result) || result.token != m_cliSearchToken || !m_hCLIListView)
+        return;
+    size_t count = result.names ? result.hits.size() : 0;
+    m_cliModel.Resize(static_cast<int>(count));
+    for (size_t i = 0; i < count; ++i)
+        m_cliModel.SetText(static_cast<int>(i), 0, (*result.names)[result.hits[i]]);
+    ApplyLauncherChecks(m_cliModel);
+    UpdateStatusColumn(m_cliModel);
+    // A new query starts at its best match; a re-run of the same query keeps the scroll position.
+    if (result.query != m_cliShownQuery && count > 0)
+        ListView_EnsureVisible(m_hCLIListView, 0, FALSE);
+    m_cliShownQuery = result.query;
+    m_cliShownFinal = result.complete;
+    if (m_cliOpenPending && result.complete) {
+        m_cliOpenPending = false;
+        OpenCLIInput();
+    }
+}
+
+// -------------------------------------------------------------------------
+// OpenCLIInput: Open the CLI input, or else the best match of its query
+// -------------------------------------------------------------------------
+void MainWindow::OpenCLIInput() {
+    std::wstring filePath = TrackerEngine::GetFilePath(m_cliFilter);
+    if (m_engine.GetLastWriteTime(filePath) == 0) {
+        // Not a project file: open the best match instead, once the rows show the
+        // final ranking of this query rather than an earlier or partial one.
+        if (!m_cliShownFinal) {
+            m_cliOpenPending = true;
+            return;
         }
+        if (m_cliModel.GetCount() > 0)
+            filePath = TrackerEngine::GetFilePath(m_cliModel.GetText(0, 0));
     }
-    catch (const std::exception &e) {
-        MessageBox(m_hwnd, L"Failed to enumerate project folder for CLI. Please check the PROJECT_FOLDER path.",
-                   L"Error", MB_OK | MB_ICONERROR);
+    if (!OpenFile(filePath))
+        return;
+    // Clear the edit control and reset the CLI ListView.
+    SetWindowText(m_hCLIEdit, L"");
+    PopulateCLIListView();
+}
+
+// -------------------------------------------------------------------------
+// ApplyLauncherChecks: Mirror m_launcherMap into a list's check boxes.
+// -------------------------------------------------------------------------
+void MainWindow::ApplyLauncherChecks(ListViewModel &model) {
+    std::wstring filePath;
+    for (int i = 0; i < model.GetCount(); ++i) {
+        TrackerEngine::GetFilePath(model.GetText(i, 0), filePath);
+        auto it = m_launcherMap.find(filePath);
+        model.SetChecked(i, it != m_launcherMap.end() && it->second);
     }
 }
 
 // -------------------------------------------------------------------------
-// RefreshLauncherButtons (Dynamic launcher buttons)
+// ToggleLauncher: Owner-data lists do not toggle check boxes themselves.
+// -------------------------------------------------------------------------
+void MainWindow::ToggleLauncher(ListViewModel &model, int row) {
+    if (row < 0 || row >= model.GetCount())
+        return;
+    m_launcherMap[TrackerEngine::GetFilePath(model.GetText(row, 0))] = !model.IsChecked(row);
+    ApplyLauncherChecks(m_fileTrackingModel);
+    ApplyLauncherChecks(m_cliModel);
+    m_fileTrackingModel.Commit();
+    m_cliModel.Commit();
+    RefreshLauncherButtons();
+}
+
+// -------------------------------------------------------------------------
+// RefreshLauncherButtons: Reconcile the launcher bar with m_launcherMap
 // -------------------------------------------------------------------------
 void MainWindow::RefreshLauncherButtons() {
-    // Clear existing buttons
-    for (const auto &pair : m_fileButtons) {
-        if (IsWindow(pair.second))
-            DestroyWindow(pair.second);
-    }
-    m_fileButtons.clear();
-    m_launcherButtonMap.clear();
-    int buttonIndex = 0;
-    for (const auto &entry : m_launcherMap) {
-        if (entry.second) {
-            if (buttonIndex >= MAX_LAUNCHER_BUTTONS)
-                break;
-            int xPos = BUTTON_X_START + buttonIndex * (BUTTON_WIDTH + BUTTON_X_GAP);
-            int yPos = BUTTON_ROW_Y;
-            const std::wstring &filePath = entry.first;
-            size_t pos = filePath.find_last_of(L"\\");
-            std::wstring buttonLabel = (pos != std::wstring::npos) ? filePath.substr(pos + 1) : filePath;
-            UINT ctrlId = ID_LAUNCHER_BUTTON_BASE + buttonIndex;
-
-            HWND hButton = CreateWindowEx(
-                0,
-                L"BUTTON",
-                buttonLabel.c_str(),
-                WS_TABSTOP | WS_VISIBLE | WS_CHILD | BS_DEFPUSHBUTTON,
-                xPos,
-                yPos,
-                BUTTON_WIDTH,
-                BUTTON_HEIGHT,
-                m_hwnd,
-                (HMENU)(UINT_PTR)(ctrlId),
-                GetModuleHandle(nullptr),
-                nullptr
-            );
-
-            if (hButton) {
-                m_fileButtons[filePath] = hButton;
-                m_launcherButtonMap[ctrlId] = filePath;
-            }
-            ++buttonIndex;
-        }
-    }
+    // Only launchers that were checked or unchecked since the last call change.
+    m_launcherBar.Reconcile(m_launcherMap, m_engine);
+    m_launcherBar.UpdateStates(m_engine);
+}
+
+// -------------------------------------------------------------------------
+// GetLauncherBarBounds: The launcher area under the panels
+// -------------------------------------------------------------------------
+RECT MainWindow::GetLauncherBarBounds() const {
+    RECT rc;
+    GetClientRect(m_hwnd, &rc);
+    int launcherAreaHeight = BUTTON_HEIGHT + 10;
+    RECT bounds = { BUTTON_X_START, rc.bottom - launcherAreaHeight + 5,
+                    (std::max)(rc.right - BUTTON_X_START, static_cast<LONG>(BUTTON_X_START)), rc.bottom - 5 };
+    return bounds;
 }
 
 // -------------------------------------------------------------------------
@@ -393,6 +493,8 @@ void MainWindow::CreateTabControl() {
 }
 
 void MainWindow::SwitchPanel(int tabIndex) {
+    EnsurePanel(tabIndex);
+    m_refreshScheduler.SetVisiblePanel(tabIndex);
     if (tabIndex == 0) {
          ShowWindow(m_hPanelFileTracking, SW_SHOW);
          ShowWindow(m_hPanelWindowMonitoring, SW_HIDE);
@@ -410,112 +512,338 @@ void MainWindow::SwitchPanel(int tabIndex) {
 }
 
 // -------------------------------------------------------------------------
-// InitListViewControls: Initialize columns for ListView controls
+// EnsurePanel: Build the Window Monitoring or CLI panel on its first display
 // -------------------------------------------------------------------------
-void MainWindow::InitListViewControls() {
-    // File Tracking ListView: 2 columns
+void MainWindow::EnsurePanel(int tabIndex) {
+    if ((tabIndex == 1 && m_hPanelWindowMonitoring) || (tabIndex == 2 && m_hPanelCLI) ||
+        (tabIndex != 1 && tabIndex != 2))
+        return;
+    RECT rc;
+    GetClientRect(m_hwnd, &rc);
+    int panelY = TAB_CONTROL_HEIGHT;
+    int launcherAreaHeight = BUTTON_HEIGHT + 10;
+    int panelHeight = rc.bottom - panelY - launcherAreaHeight;
+    HIMAGELIST imageList = m_iconCache.GetImageList();
     LVCOLUMN lvc = {0};
     lvc.mask = LVCF_TEXT | LVCF_WIDTH;
-    lvc.pszText = const_cast<LPWSTR>(L"File Name");
-    lvc.cx = 200;
-    ListView_InsertColumn(m_hListViewFileTracking, 0, &lvc);
-    lvc.pszText = const_cast<LPWSTR>(L"Status");
-    lvc.cx = 150;
-    ListView_InsertColumn(m_hListViewFileTracking, 1, &lvc);
 
-    // Window Monitoring ListView: 10 columns
-    const wchar_t* wmCols[10] = {
-        L"Associated Files", L"Window Title", L"Process Name", L"State",
-        L"HWND", L"Class Name", L"Left", L"Top", L"Right", L"Bottom"
-    };
-    int wmColWidths[10] = { 150, 200, 200, 100, 100, 150, 50, 50, 50, 50 };
-    for (int i = 0; i < 10; ++i) {
-        lvc.mask = LVCF_TEXT | LVCF_WIDTH;
-        lvc.pszText = const_cast<LPWSTR>(wmCols[i]);
-        lvc.cx = wmColWidths[i];
-        ListView_InsertColumn(m_hListViewWindowMonitoring, i, &lvc);
+    if (tabIndex == 1) {
+        m_hPanelWindowMonitoring = CreateWindowEx(0, L"STATIC", L"WindowMonitoringPanel", WS_CHILD,
+                                                   0, panelY, rc.right, panelHeight,
+                                                   m_hwnd, nullptr, GetModuleHandle(nullptr), nullptr);
+        // The owner-data monitoring list needs its LVN_GETDISPINFO forwarded too.
+        SetWindowSubclass(m_hPanelWindowMonitoring, PanelSubclassProc, 1, 0);
+        m_hListViewWindowMonitoring = CreateWindowEx(0, WC_LISTVIEW, L"",
+                        WS_CHILD | WS_VISIBLE | LVS_REPORT | LVS_SINGLESEL | LVS_OWNERDATA | LVS_SHAREIMAGELISTS,
+                        0, 0, rc.right, panelHeight,
+                        m_hPanelWindowMonitoring, nullptr, GetModuleHandle(nullptr), nullptr);
+
+        // Window Monitoring ListView: 10 columns
+        const wchar_t* wmCols[10] = {
+            L"Associated Files", L"Window Title", L"Process Name", L"State",
+            L"HWND", L"Class Name", L"Left", L"Top", L"Right", L"Bottom"
+        };
+        int wmColWidths[10] = { 150, 200, 200, 100, 100, 150, 50, 50, 50, 50 };
+        for (int i = 0; i < 10; ++i) {
+            lvc.pszText = const_cast<LPWSTR>(wmCols[i]);
+            lvc.cx = wmColWidths[i];
+            ListView_InsertColumn(m_hListViewWindowMonitoring, i, &lvc);
+        }
+        m_windowMonitoringModel.Attach(m_hListViewWindowMonitoring, 10, false);
+        if (imageList)
+            ListView_SetImageList(m_hListViewWindowMonitoring, imageList, LVSIL_SMALL);
+        // The refresh that follows the tab switch fills every row.
+        m_prevWindowRows.clear();
+        m_windowRowsStale = true;
+        return;
     }
 
+    m_hPanelCLI = CreateWindowEx(0, L"STATIC", L"CLI Panel", WS_CHILD,
+                                  0, panelY, rc.right, panelHeight,
+                                  m_hwnd, nullptr, GetModuleHandle(nullptr), nullptr);
+    // Subclass the CLI panel
+    SetWindowSubclass(m_hPanelCLI, PanelSubclassProc, 1, 0);
+    m_hCLIEdit = CreateWindowEx(WS_EX_CLIENTEDGE, L"EDIT", L"",
+                    WS_CHILD | WS_VISIBLE | ES_AUTOHSCROLL | ES_MULTILINE | ES_WANTRETURN,
+                    0, 0, rc.right, 25,
+                    m_hPanelCLI, nullptr, GetModuleHandle(nullptr), nullptr);
+    m_hCLIListView = CreateWindowEx(0, WC_LISTVIEW, L"",
+                    WS_CHILD | WS_VISIBLE | LVS_REPORT | LVS_SINGLESEL | LVS_OWNERDATA | LVS_SHAREIMAGELISTS,
+                    0, 25, rc.right, panelHeight - 25,
+                    m_hPanelCLI, nullptr, GetModuleHandle(nullptr), nullptr);
+    // Enable checkboxes
+    ListView_SetExtendedListViewStyleEx(m_hCLIListView, LVS_EX_CHECKBOXES, LVS_EX_CHECKBOXES);
+
     // CLI ListView: 2 columns (File Name, Status)
-    lvc.mask = LVCF_TEXT | LVCF_WIDTH;
     lvc.pszText = const_cast<LPWSTR>(L"File Name");
     lvc.cx = 200;
     ListView_InsertColumn(m_hCLIListView, 0, &lvc);
     lvc.pszText = const_cast<LPWSTR>(L"Status");
     lvc.cx = 150;
     ListView_InsertColumn(m_hCLIListView, 1, &lvc);
+    m_cliModel.Attach(m_hCLIListView, 2, true);
+    if (imageList)
+        ListView_SetImageList(m_hCLIListView, imageList, LVSIL_SMALL);
+    // Subclass the CLI edit
+    SetWindowSubclass(m_hCLIEdit, MainWindow::CLIEditSubclassProc, 1, reinterpret_cast<DWORD_PTR>(this));
+    // Without the thread every keystroke searches inline.
+    m_cliSearch.Start(m_hwnd, WM_APP_SEARCH_RESULTS);
+    PopulateCLIListView();
+}
+
+// -------------------------------------------------------------------------
+// InitListViewControls: Initialize the columns of the File Tracking ListView
+// -------------------------------------------------------------------------
+void MainWindow::InitListViewControls() {
+    // File Tracking ListView: 2 columns
+    LVCOLUMN lvc = {0};
+    lvc.mask = LVCF_TEXT | LVCF_WIDTH;
+    lvc.pszText = const_cast<LPWSTR>(L"File Name");
+    lvc.cx = 200;
+    ListView_InsertColumn(m_hListViewFileTracking, 0, &lvc);
+    lvc.pszText = const_cast<LPWSTR>(L"Status");
+    lvc.cx = 150;
+    ListView_InsertColumn(m_hListViewFileTracking, 1, &lvc);
 }
 
 // -------------------------------------------------------------------------
-// PopulateListView: Populate the File Tracking ListView with files
+// PopulateListView: Populate the File Tracking row model with files
 // -------------------------------------------------------------------------
 void MainWindow::PopulateListView() {
-    ListView_DeleteAllItems(m_hListViewFileTracking);
-    int index = 0;
-    try {
-        for (const auto &entry : fs::directory_iterator(PROJECT_FOLDER)) {
-            if (entry.is_regular_file()) {
-                std::wstring fileName = entry.path().filename().wstring();
-                LVITEM item = {0};
-                item.mask = LVIF_TEXT;
-                item.iItem = index;
-                item.iSubItem = 0;
-                item.pszText = const_cast<LPWSTR>(fileName.c_str());
-                ListView_InsertItem(m_hListViewFileTracking, &item);
-
-                LVITEM statusItem = {0};
-                statusItem.mask = LVIF_TEXT;
-                statusItem.iItem = index;
-                statusItem.iSubItem = 1;
-                statusItem.pszText = const_cast<LPWSTR>(L"Not launched");
-                ListView_SetItem(m_hListViewFileTracking, &statusItem);
-
-                ListView_SetCheckState(m_hListViewFileTracking, index, FALSE);
-                ++index;
-            }
+    // The folder contents changed; the engine rebuilt its title matcher, rebuild
+    // the CLI prefix index and hand the search the new name table.
+    const std::vector<std::wstring> &fileNames = m_engine.GetFileNames();
+    m_cliPrefixIndex.Build(fileNames);
+    m_cliSearch.SetNames(m_engine.GetFileNameTable());
+    m_windowRowsStale = true; // Associated files may have changed.
+
+    m_fileTrackingModel.Resize(static_cast<int>(fileNames.size()));
+    for (int i = 0; i < static_cast<int>(fileNames.size()); ++i)
+        m_fileTrackingModel.SetText(i, 0, fileNames[i]);
+    ApplyLauncherChecks(m_fileTrackingModel);
+    UpdateStatusColumn(m_fileTrackingModel);
+}
+
+// -------------------------------------------------------------------------
+// PopulateCLIListView: Populate the CLI row model with files from the project folder
+// -------------------------------------------------------------------------
+void MainWindow::PopulateCLIListView() {
+    FilterCLIListView(L"");
+}
+
+// -------------------------------------------------------------------------
+// OnLaunchComplete: A launch started by the engine finished
+// -------------------------------------------------------------------------
+void MainWindow::OnLaunchComplete(const LaunchResult &result) {
+    // A window that appeared is already in the engine's tracking map; the launcher
+    // states were read at this snapshot generation, before it was tracked.
+    m_launcherBar.InvalidateStates();
+    m_launcherBar.UpdateStates(m_engine);
+    if (!result.launched)
+        MessageBox(m_hwnd, L"Failed to launch file.", L"Error", MB_OK | MB_ICONERROR);
+}
+
+// -------------------------------------------------------------------------
+// OnSnapshotUpdated: A new window snapshot is current
+// -------------------------------------------------------------------------
+void MainWindow::OnSnapshotUpdated() {
+    m_refreshScheduler.Invalidate();
+    RunScheduledRefresh();
+}
+
+// -------------------------------------------------------------------------
+// CheckInteractive: Record the time to interactive once startup has settled
+// -------------------------------------------------------------------------
+void MainWindow::CheckInteractive() {
+    // Interactive: painted, the folder listed, the stored tracking resolved and a
+    // snapshot rendered (the visible panel renders as soon as one arrives).
+    if (m_startupMetrics.IsInteractive() || !m_startupMetrics.HasFirstPaint())
+        return;
+    if (!m_engine.IsFolderLoaded() || !m_engine.IsTrackingResolved() || !m_engine.HasSnapshot())
+        return;
+    m_startupMetrics.MarkInteractive(m_engine.GetFileNames().size());
+}
+
+// -------------------------------------------------------------------------
+// OnFolderChanged: Refresh the file lists after the engine applied folder deltas
+// -------------------------------------------------------------------------
+void MainWindow::OnFolderChanged(const std::vector<DirectoryDelta> &deltas) {
+    bool launchersChanged = false;
+    for (const auto &delta : deltas) {
+        if (delta.change != DirectoryChange::Renamed)
+            continue;
+        // Keep launcher state attached to a renamed file; the engine moved its tracking.
+        auto launcher = m_launcherMap.find(TrackerEngine::GetFilePath(delta.oldName));
+        if (launcher != m_launcherMap.end()) {
+            m_launcherMap[TrackerEngine::GetFilePath(delta.name)] = launcher->second;
+            m_launcherMap.erase(launcher);
+            launchersChanged = true;
         }
     }
-    catch (const std::exception &e) {
-        MessageBox(m_hwnd, L"Failed to enumerate project folder. Please check the PROJECT_FOLDER path.",
-                   L"Error", MB_OK | MB_ICONERROR);
+    PopulateListView();
+    // An unbuilt CLI panel is filled when it is first shown.
+    if (m_hCLIListView)
+        FilterCLIListView(m_cliFilter);
+    m_fileTrackingModel.Commit();
+    m_cliModel.Commit();
+    if (launchersChanged)
+        RefreshLauncherButtons();
+}
+
+// -------------------------------------------------------------------------
+// UpdateStatusColumn: Recompute the Status column of a file list
+// -------------------------------------------------------------------------
+void MainWindow::UpdateStatusColumn(ListViewModel &model) {
+    // States come from the engine's snapshot; nothing here talks to other
+    // processes' windows.
+    for (int i = 0; i < model.GetCount(); ++i) {
+        const wchar_t *state = m_engine.GetFileState(model.GetText(i, 0));
+        model.SetText(i, 1, state ? state : L"Not launched");
     }
+    model.Commit();
 }
 
 // -------------------------------------------------------------------------
-// PopulateCLIListView: Populate the CLI ListView with files from the project folder
+// UpdateWindowMonitoringList: Diff the window table into the monitoring rows
 // -------------------------------------------------------------------------
-void MainWindow::PopulateCLIListView() {
-    ListView_DeleteAllItems(m_hCLIListView);
-    int index = 0;
-    try {
-        for (const auto &entry : fs::directory_iterator(PROJECT_FOLDER)) {
-            if (entry.is_regular_file()) {
-                std::wstring fileName = entry.path().filename().wstring();
-                LVITEM item = {0};
-                item.mask = LVIF_TEXT;
-                item.iItem = index;
-                item.iSubItem = 0;
-                item.pszText = const_cast<LPWSTR>(fileName.c_str());
-                ListView_InsertItem(m_hCLIListView, &item);
-
-                LVITEM statusItem = {0};
-                statusItem.mask = LVIF_TEXT;
-                statusItem.iItem = index;
-                statusItem.iSubItem = 1;
-                statusItem.pszText = const_cast<LPWSTR>(L"Not launched");
-                ListView_SetItem(m_hCLIListView, &statusItem);
-
-                ListView_SetCheckState(m_hCLIListView, index, FALSE);
-                ++index;
-            }
+void MainWindow::UpdateWindowMonitoringList(const WindowTable &windows) {
+    HWND hwndForeground = m_engine.GetSnapshot().hwndForeground;
+    const TitleMatchResult &matches = m_engine.GetMatches();
+    const TitleMatcher &titleMatcher = m_engine.GetTitleMatcher();
+    int prevCount = m_windowMonitoringModel.GetCount();
+    int newCount = windows.GetCount();
+    // Same table, same focus and same matches: every row is already up to date.
+    if (!m_windowRowsStale && newCount == prevCount &&
+        windows.GetContentHash() == m_prevWindowHash && hwndForeground == m_prevForeground)
+        return;
+
+    // Rows still hold the values of m_prevWindowRows; numeric columns are only
+    // reformatted when the underlying value changed.
+    m_windowMonitoringModel.Resize(newCount);
+    std::wstring &associatedFiles = m_scratchText;
+    for (int i = 0; i < newCount; ++i) {
+        HWND hwnd = windows.GetHwnd(i);
+        const RECT &rect = windows.GetRect(i);
+        const MonitoredRow *old = (i < prevCount && i < static_cast<int>(m_prevWindowRows.size())) ? &m_prevWindowRows[i] : nullptr;
+        associatedFiles.clear();
+        for (int fileIndex : matches.windowFiles[i]) {
+            if (!associatedFiles.empty())
+                associatedFiles += L", ";
+            associatedFiles += titleMatcher.GetFileName(fileIndex);
         }
+        m_windowMonitoringModel.SetText(i, 0, associatedFiles);
+        m_windowMonitoringModel.SetText(i, 1, windows.GetTitle(i), windows.GetTitleLength(i));
+        m_windowMonitoringModel.SetText(i, 2, windows.GetProcessName(i));
+        m_windowMonitoringModel.SetText(i, 3, GetWindowStateText(windows.GetState(i), hwnd == hwndForeground));
+        if (!old || old->hwnd != hwnd)
+            m_windowMonitoringModel.SetText(i, 4, std::to_wstring(reinterpret_cast<uintptr_t>(hwnd)));
+        m_windowMonitoringModel.SetText(i, 5, windows.GetWindowClass(i));
+        if (!old || old->rect.left != rect.left)
+            m_windowMonitoringModel.SetText(i, 6, std::to_wstring(rect.left));
+        if (!old || old->rect.top != rect.top)
+            m_windowMonitoringModel.SetText(i, 7, std::to_wstring(rect.top));
+        if (!old || old->rect.right != rect.right)
+            m_windowMonitoringModel.SetText(i, 8, std::to_wstring(rect.right));
+        if (!old || old->rect.bottom != rect.bottom)
+            m_windowMonitoringModel.SetText(i, 9, std::to_wstring(rect.bottom));
     }
-    catch (const std::exception &e) {
-        MessageBox(m_hwnd, L"Failed to enumerate project folder for CLI. Please check the PROJECT_FOLDER path.",
-                   L"Error", MB_OK | MB_ICONERROR);
+    m_prevWindowRows.resize(newCount);
+    for (int i = 0; i < newCount; ++i) {
+        m_prevWindowRows[i].hwnd = windows.GetHwnd(i);
+        m_prevWindowRows[i].rect = windows.GetRect(i);
+    }
+    m_prevWindowHash = windows.GetContentHash();
+    m_prevForeground = hwndForeground;
+    m_windowRowsStale = false;
+    m_windowMonitoringModel.Commit();
+}
+
+// -------------------------------------------------------------------------
+// SetFileImage / SetProcessImage: Icons of painted rows, from m_iconCache
+// -------------------------------------------------------------------------
+void MainWindow::SetFileImage(const ListViewModel &model, NMLVDISPINFO *pDispInfo) {
+    LVITEM &item = pDispInfo->item;
+    if (!(item.mask & LVIF_IMAGE) || item.iSubItem != 0 || item.iItem < 0 || item.iItem >= model.GetCount())
+        return;
+    TrackerEngine::GetFilePath(model.GetText(item.iItem, 0), m_scratchIconPath);
+    item.iImage = m_iconCache.GetFileIcon(m_scratchIconPath, m_engine.GetLastWriteTime(m_scratchIconPath), model.GetHwnd());
+}
+
+void MainWindow::SetProcessImage(const ListViewModel &model, NMLVDISPINFO *pDispInfo) {
+    LVITEM &item = pDispInfo->item;
+    if (!(item.mask & LVIF_IMAGE) || item.iSubItem != 0 || item.iItem < 0 || item.iItem >= model.GetCount())
+        return;
+    // Column 2 holds the process image path.
+    item.iImage = m_iconCache.GetProcessIcon(model.GetText(item.iItem, 2), model.GetHwnd());
+}
+
+// -------------------------------------------------------------------------
+// RefreshViews: Update the given panels (RefreshPanelBit mask) from the window table
+// -------------------------------------------------------------------------
+void MainWindow::RefreshViews(unsigned panels) {
+    if (!panels)
+        return;
+    // The launcher bar is visible on every tab; it re-reads states once per snapshot.
+    m_launcherBar.UpdateStates(m_engine);
+    // The engine runs one matcher pass per snapshot for all three lists.
+    const WindowTable &windows = m_engine.GetSnapshot().windows;
+    TraceActivity activity;
+    if (panels & RefreshPanelBit(REFRESH_PANEL_FILE_TRACKING)) {
+        TraceStart(activity, TracePhase::ListViewUpdate);
+        UpdateStatusColumn(m_fileTrackingModel);
+        TraceListViewUpdateStop(activity, REFRESH_PANEL_FILE_TRACKING, m_fileTrackingModel.GetCount());
+    }
+    // Panels that were never shown have no controls yet.
+    if (!m_hCLIListView)
+        panels &= ~RefreshPanelBit(REFRESH_PANEL_CLI);
+    if (!m_hListViewWindowMonitoring)
+        panels &= ~RefreshPanelBit(REFRESH_PANEL_WINDOW_MONITORING);
+    if (panels & RefreshPanelBit(REFRESH_PANEL_CLI)) {
+        TraceStart(activity, TracePhase::ListViewUpdate);
+        UpdateStatusColumn(m_cliModel);
+        TraceListViewUpdateStop(activity, REFRESH_PANEL_CLI, m_cliModel.GetCount());
+    }
+    if (panels & RefreshPanelBit(REFRESH_PANEL_WINDOW_MONITORING)) {
+        TraceStart(activity, TracePhase::ListViewUpdate);
+        UpdateWindowMonitoringList(windows);
+        TraceListViewUpdateStop(activity, REFRESH_PANEL_WINDOW_MONITORING, m_windowMonitoringModel.GetCount());
     }
 }
 
+// -------------------------------------------------------------------------
+// RunScheduledRefresh: Render the panels that are due and arm the refresh timer
+// -------------------------------------------------------------------------
+void MainWindow::RunScheduledRefresh() {
+    ULONGLONG now = GetTickCount64();
+    RefreshViews(m_refreshScheduler.TakeDuePanels(now));
+    DWORD delay = m_refreshScheduler.GetNextDelay(now);
+    if (delay == INFINITE)
+        KillTimer(m_hwnd, REFRESH_TIMER_ID);
+    else
+        SetTimer(m_hwnd, REFRESH_TIMER_ID, (std::max)(delay, static_cast<DWORD>(USER_TIMER_MINIMUM)), nullptr);
+}
+
+// -------------------------------------------------------------------------
+// UpdateSuspension: Pause the snapshot worker while nothing can be seen
+// -------------------------------------------------------------------------
+void MainWindow::UpdateSuspension() {
+    m_engine.SetPaused(m_refreshScheduler.IsSuspended());
+    RunScheduledRefresh();
+}
+
+// -------------------------------------------------------------------------
+// ApplyRefreshRates: Switch the panel and sweep rates at run time
+// -------------------------------------------------------------------------
+void MainWindow::ApplyRefreshRates(const RefreshRates &rates) {
+    m_refreshScheduler.SetRates(rates);
+    m_engine.SetSweepInterval(rates.sweepInterval);
+    bool batterySaver = rates.visibleInterval == BATTERY_VISIBLE_INTERVAL &&
+                        rates.hiddenInterval == BATTERY_HIDDEN_INTERVAL;
+    CheckMenuRadioItem(GetSystemMenu(m_hwnd, FALSE), IDM_REFRESH_NORMAL, IDM_REFRESH_BATTERY_SAVER,
+                       batterySaver ? IDM_REFRESH_BATTERY_SAVER : IDM_REFRESH_NORMAL, MF_BYCOMMAND);
+    RunScheduledRefresh();
+}
+
 // -------------------------------------------------------------------------
 // MainWindow Implementation
 // -------------------------------------------------------------------------
@@ -529,9 +857,14 @@ MainWindow::MainWindow()
     , m_hListViewWindowMonitoring(nullptr)
     , m_hCLIEdit(nullptr)
     , m_hCLIListView(nullptr)
+    , m_prevWindowHash(0)
+    , m_prevForeground(nullptr)
+    , m_windowRowsStale(true)
+    , m_cliSearchToken(0)
+    , m_cliShownFinal(false)
+    , m_cliOpenPending(false)
     , m_browserPanel(nullptr) // for integrated WebView2
 {
-    m_prevWindowList.clear();
 }
 
 MainWindow::~MainWindow() {
@@ -606,15 +939,33 @@ LRESULT CALLBACK MainWindow::HandleMessage(UINT uMsg, WPARAM wParam, LPARAM lPar
     switch (uMsg) {
     case WM_CREATE:
         OnCreate();
-        SetTimer(m_hwnd, TIMER_ID, TIMER_INTERVAL, nullptr);
-        LoadTrackingMapping(TRACKING_FILE, m_fileWindowMap, m_hwnd);
+        // Lock and unlock arrive as WM_WTSSESSION_CHANGE; without them only minimizing suspends.
+        WTSRegisterSessionNotification(m_hwnd, NOTIFY_FOR_THIS_SESSION);
+        {
+            HMENU hSysMenu = GetSystemMenu(m_hwnd, FALSE);
+            AppendMenu(hSysMenu, MF_SEPARATOR, 0, nullptr);
+            AppendMenu(hSysMenu, MF_STRING, IDM_REFRESH_NORMAL, L"Normal refresh");
+            AppendMenu(hSysMenu, MF_STRING, IDM_REFRESH_BATTERY_SAVER, L"Battery saver refresh");
+            AppendMenu(hSysMenu, MF_SEPARATOR, 0, nullptr);
+            AppendMenu(hSysMenu, MF_STRING, IDM_RESTORE_WORKSPACE, L"Restore workspace");
+            CheckMenuRadioItem(hSysMenu, IDM_REFRESH_NORMAL, IDM_REFRESH_BATTERY_SAVER, IDM_REFRESH_NORMAL, MF_BYCOMMAND);
+        }
+        RunScheduledRefresh();
         return 0;
 
     case WM_SIZE: {
+            // Nothing is rendered while minimized; restoring catches up at once.
+            bool minimized = (wParam == SIZE_MINIMIZED);
+            if (minimized != m_refreshScheduler.IsMinimized()) {
+                m_refreshScheduler.SetMinimized(minimized);
+                UpdateSuspension();
+            }
+            if (minimized)
+                break;
             RECT rc;
             GetClientRect(m_hwnd, &rc);
             SetWindowPos(m_hTabControl, NULL, 0, 0, rc.right, TAB_CONTROL_HEIGHT, SWP_NOZORDER);
-            if (m_browserPanel) {
+            if (m_browserPanel && m_browserPanel->IsVisible()) {
                 // Split view layout
                 int leftPaneWidth = rc.right / 3;
                 int panelY = TAB_CONTROL_HEIGHT;
@@ -625,6 +976,7 @@ LRESULT CALLBACK MainWindow::HandleMessage(UINT uMsg, WPARAM wParam, LPARAM lPar
                 // Position browser panel on right side
                 RECT browserRect = { leftPaneWidth, panelY, rc.right, rc.bottom };
                 m_browserPanel->SetBounds(browserRect);
+                m_launcherBar.Show(false);
             } else {
                 // Normal layout
                 int panelY = TAB_CONTROL_HEIGHT;
@@ -644,54 +996,20 @@ LRESULT CALLBACK MainWindow::HandleMessage(UINT uMsg, WPARAM wParam, LPARAM lPar
                     SetWindowPos(m_hCLIEdit, NULL, 0, 0, rc.right, cliEditHeight, SWP_NOZORDER);
                     SetWindowPos(m_hCLIListView, NULL, 0, cliEditHeight, rc.right, panelHeight - cliEditHeight, SWP_NOZORDER);
                 }
+                m_launcherBar.SetBounds(GetLauncherBarBounds());
+                m_launcherBar.Show(true);
             }
         }
         break;
 
     case WM_COMMAND: {
             int wmId = LOWORD(wParam);
-            if (wmId >= ID_LAUNCHER_BUTTON_BASE && wmId < (ID_LAUNCHER_BUTTON_BASE + MAX_LAUNCHER_BUTTONS)) {
-                auto itButton = m_launcherButtonMap.find(wmId);
-                if (itButton != m_launcherButtonMap.end()) {
-                    std::wstring filePath = itButton->second;
-                    // If .url, read and show integrated browser
-                    std::wstring lowerPath = filePath;
-                    for (auto &c : lowerPath) c = towlower(c);
-                    if (lowerPath.size() >= 4 && lowerPath.rfind(L".url") == lowerPath.size() - 4) {
-                        std::wifstream ifs(filePath.c_str());
-                        if (!ifs) {
-                            MessageBox(m_hwnd, L"Failed to open .url file.", L"Error", MB_OK | MB_ICONERROR);
-                            return 0;
-                        }
-                        std::wstring line, url;
-                        while (std::getline(ifs, line)) {
-                            if (line.find(L"URL=") == 0) {
-                                url = line.substr(4);
-                                break;
-                            }
-                        }
-                        ifs.close();
-                        if (!url.empty()) {
-                            ShowIntegratedBrowser(url);
-                            return 0;
-                        }
-                        // fallback to normal logic
-                    }
-                    // Normal logic
-                    auto it = m_fileWindowMap.find(filePath);
-                    if (it != m_fileWindowMap.end() && IsWindow(it->second.hwnd)) {
-                        TrackedWindow currentFp = GetFingerprint(it->second.hwnd);
-                        if (!CompareStableAttributes(it->second, currentFp))
-                            it->second = currentFp;
-                        ActivateTrackedWindow(it->second);
-                    } else {
-                        std::wstring fileName = filePath.substr(filePath.find_last_of(L'\\') + 1);
-                        HWND hwndFound = GetWindowHandleByFileName(fileName);
-                        if (hwndFound)
-                            ActivateTrackedWindow(m_fileWindowMap[filePath] = GetFingerprint(hwndFound));
-                        else
-                            LaunchFile(filePath, m_hwnd, m_fileWindowMap);
-                    }
+            if (LauncherBar::IsCommand(wmId)) {
+                const std::wstring *filePath = m_launcherBar.FindCommand(wmId);
+                if (filePath) {
+                    // OpenFile() may reconcile the bar; keep the path.
+                    std::wstring path = *filePath;
+                    OpenFile(path);
                 }
             }
             else if (wmId == 1001) {
@@ -699,21 +1017,9 @@ LRESULT CALLBACK MainWindow::HandleMessage(UINT uMsg, WPARAM wParam, LPARAM lPar
             }
             else if (wmId == ID_CLOSE_WINDOW) {
                 int iSel = ListView_GetNextItem(m_hListViewFileTracking, -1, LVNI_SELECTED);
-                if (iSel != -1) {
-                    wchar_t buffer[256] = {0};
-                    LVITEM item = {0};
-                    item.mask = LVIF_TEXT;
-                    item.iItem = iSel;
-                    item.iSubItem = 0;
-                    item.pszText = buffer;
-                    item.cchTextMax = 256;
-                    ListView_GetItem(m_hListViewFileTracking, &item);
-                    std::wstring fileName(buffer);
-                    std::wstring filePath = PROJECT_FOLDER + L"\\" + fileName;
-                    auto it = m_fileWindowMap.find(filePath);
-                    if (it != m_fileWindowMap.end() && IsWindow(it->second.hwnd)) {
-                        PostMessage(it->second.hwnd, WM_CLOSE, 0, 0);
-                    }
+                if (iSel != -1 && iSel < m_fileTrackingModel.GetCount()) {
+                    std::wstring fileName = m_fileTrackingModel.GetText(iSel, 0);
+                    m_engine.CloseFileWindow(TrackerEngine::GetFilePath(fileName));
                 }
             }
         }
@@ -721,33 +1027,47 @@ LRESULT CALLBACK MainWindow::HandleMessage(UINT uMsg, WPARAM wParam, LPARAM lPar
 
     case WM_NOTIFY: {
             LPNMHDR pnmh = reinterpret_cast<LPNMHDR>(lParam);
+            LRESULT launcherResult = 0;
+            if (m_launcherBar.OnNotify(pnmh, launcherResult))
+                return launcherResult;
             if (pnmh->hwndFrom == m_hTabControl) {
                 if (pnmh->code == TCN_SELCHANGE) {
                     int sel = TabCtrl_GetCurSel(m_hTabControl);
                     SwitchPanel(sel);
+                    RunScheduledRefresh();
                 }
             }
             else if (pnmh->hwndFrom == m_hListViewFileTracking) {
-                if (pnmh->code == LVN_ITEMCHANGED) {
-                    LPNMLISTVIEW pnmv = reinterpret_cast<LPNMLISTVIEW>(lParam);
-                    if ((pnmv->uChanged & LVIF_STATE) && (pnmv->uNewState & LVIS_STATEIMAGEMASK)) {
-                        int iItem = pnmv->iItem;
-                        if (iItem >= 0) {
-                            BOOL checked = ListView_GetCheckState(m_hListViewFileTracking, iItem);
-                            wchar_t buffer[256] = {0};
-                            LVITEM lvItem = {0};
-                            lvItem.mask = LVIF_TEXT;
-                            lvItem.iItem = iItem;
-                            lvItem.iSubItem = 0;
-                            lvItem.pszText = buffer;
-                            lvItem.cchTextMax = 256;
-                            ListView_GetItem(m_hListViewFileTracking, &lvItem);
-                            std::wstring fileName(buffer);
-                            std::wstring filePath = PROJECT_FOLDER + L"\\" + fileName;
-                            m_launcherMap[filePath] = (checked != 0);
-                            RefreshLauncherButtons();
-                        }
+                if (pnmh->code == LVN_GETDISPINFO) {
+                    m_fileTrackingModel.OnGetDispInfo(reinterpret_cast<NMLVDISPINFO*>(lParam));
+                    SetFileImage(m_fileTrackingModel, reinterpret_cast<NMLVDISPINFO*>(lParam));
+                }
+                else if (pnmh->code == LVN_ODFINDITEM) {
+                    return m_fileTrackingModel.OnFindItem(reinterpret_cast<NMLVFINDITEM*>(lParam));
+                }
+                else if (pnmh->code == NM_CUSTOMDRAW && !m_startupMetrics.HasFirstPaint()) {
+                    // Only the first paint asks for a post-paint notification.
+                    LPNMLVCUSTOMDRAW pcd = reinterpret_cast<LPNMLVCUSTOMDRAW>(lParam);
+                    if (pcd->nmcd.dwDrawStage == CDDS_PREPAINT)
+                        return CDRF_NOTIFYPOSTPAINT;
+                    if (pcd->nmcd.dwDrawStage == CDDS_POSTPAINT) {
+                        m_startupMetrics.MarkFirstPaint();
+                        CheckInteractive();
                     }
+                    return CDRF_DODEFAULT;
+                }
+                else if (pnmh->code == NM_CLICK) {
+                    // Check boxes of owner-data lists are toggled by hand.
+                    LPNMITEMACTIVATE pnmia = reinterpret_cast<LPNMITEMACTIVATE>(lParam);
+                    LVHITTESTINFO ht = {0};
+                    ht.pt = pnmia->ptAction;
+                    int iItem = ListView_HitTest(m_hListViewFileTracking, &ht);
+                    if (iItem >= 0 && (ht.flags & LVHT_ONITEMSTATEICON))
+                        ToggleLauncher(m_fileTrackingModel, iItem);
+                }
+                else if (pnmh->code == LVN_KEYDOWN) {
+                    if (reinterpret_cast<LPNMLVKEYDOWN>(lParam)->wVKey == VK_SPACE)
+                        ToggleLauncher(m_fileTrackingModel, ListView_GetNextItem(m_hListViewFileTracking, -1, LVNI_FOCUSED));
                 }
                 else if (pnmh->code == NM_DBLCLK) {
                     POINT pt;
@@ -756,85 +1076,46 @@ LRESULT CALLBACK MainWindow::HandleMessage(UINT uMsg, WPARAM wParam, LPARAM lPar
                     LVHITTESTINFO ht = {0};
                     ht.pt = pt;
                     int rowIndex = ListView_HitTest(m_hListViewFileTracking, &ht);
-                    if (rowIndex != -1) {
-                        wchar_t buffer[256] = {0};
-                        LVITEM lvItem = {0};
-                        lvItem.mask = LVIF_TEXT;
-                        lvItem.iItem = rowIndex;
-                        lvItem.iSubItem = 0;
-                        lvItem.pszText = buffer;
-                        lvItem.cchTextMax = 256;
-                        ListView_GetItem(m_hListViewFileTracking, &lvItem);
-                        std::wstring fileName(buffer);
+                    if (rowIndex != -1 && rowIndex < m_fileTrackingModel.GetCount()) {
+                        std::wstring fileName = m_fileTrackingModel.GetText(rowIndex, 0);
                         if (!fileName.empty()) {
                             size_t start = fileName.find_first_not_of(L" \t");
                             size_t end   = fileName.find_last_not_of(L" \t");
                             if (start != std::wstring::npos && end != std::wstring::npos)
                                 fileName = fileName.substr(start, end - start + 1);
-                            std::wstring filePath = PROJECT_FOLDER + L"\\" + fileName;
-                            // Check if .url
-                            std::wstring lowerPath = filePath;
-                            for (auto &c : lowerPath) c = towlower(c);
-                            if (lowerPath.size() >= 4 && lowerPath.rfind(L".url") == lowerPath.size() - 4) {
-                                // Read URL= and show integrated browser
-                                std::wifstream ifs(filePath.c_str());
-                                if (!ifs) {
-                                    MessageBox(m_hwnd, L"Failed to open .url file.", L"Error", MB_OK | MB_ICONERROR);
-                                    return 0;
-                                }
-                                std::wstring line, url;
-                                while (std::getline(ifs, line)) {
-                                    if (line.find(L"URL=") == 0) {
-                                        url = line.substr(4);
-                                        break;
-                                    }
-                                }
-                                ifs.close();
-                                if (!url.empty()) {
-                                    ShowIntegratedBrowser(url);
-                                    return 0;
-                                }
-                                // fallback to normal logic
-                            }
-                            // Normal logic
-                            auto it = m_fileWindowMap.find(filePath);
-                            if (it != m_fileWindowMap.end() && IsWindow(it->second.hwnd)) {
-                                TrackedWindow currentFp = GetFingerprint(it->second.hwnd);
-                                if (!CompareStableAttributes(it->second, currentFp))
-                                    it->second = currentFp;
-                                ActivateTrackedWindow(it->second);
-                            } else {
-                                HWND hwndFound = GetWindowHandleByFileName(fileName);
-                                if (hwndFound)
-                                    ActivateTrackedWindow(m_fileWindowMap[filePath] = GetFingerprint(hwndFound));
-                                else
-                                    LaunchFile(filePath, m_hwnd, m_fileWindowMap);
-                            }
+                            OpenFile(TrackerEngine::GetFilePath(fileName));
                         }
                     }
                 }
             }
+            else if (pnmh->hwndFrom == m_hListViewWindowMonitoring) {
+                if (pnmh->code == LVN_GETDISPINFO) {
+                    m_windowMonitoringModel.OnGetDispInfo(reinterpret_cast<NMLVDISPINFO*>(lParam));
+                    SetProcessImage(m_windowMonitoringModel, reinterpret_cast<NMLVDISPINFO*>(lParam));
+                }
+                else if (pnmh->code == LVN_ODFINDITEM)
+                    return m_windowMonitoringModel.OnFindItem(reinterpret_cast<NMLVFINDITEM*>(lParam));
+            }
             else if (pnmh->hwndFrom == m_hCLIListView) {
-                if (pnmh->code == LVN_ITEMCHANGED) {
-                    LPNMLISTVIEW pnmv = reinterpret_cast<LPNMLISTVIEW>(lParam);
-                    if ((pnmv->uChanged & LVIF_STATE) && (pnmv->uNewState & LVIS_STATEIMAGEMASK)) {
-                        int iItem = pnmv->iItem;
-                        if (iItem >= 0) {
-                            BOOL checked = ListView_GetCheckState(m_hCLIListView, iItem);
-                            wchar_t buffer[256] = {0};
-                            LVITEM lvItem = {0};
-                            lvItem.mask = LVIF_TEXT;
-                            lvItem.iItem = iItem;
-                            lvItem.iSubItem = 0;
-                            lvItem.pszText = buffer;
-                            lvItem.cchTextMax = 256;
-                            ListView_GetItem(m_hCLIListView, &lvItem);
-                            std::wstring fileName(buffer);
-                            std::wstring filePath = PROJECT_FOLDER + L"\\" + fileName;
-                            m_launcherMap[filePath] = (checked != 0);
-                            RefreshLauncherButtons();
-                        }
-                    }
+                if (pnmh->code == LVN_GETDISPINFO) {
+                    m_cliModel.OnGetDispInfo(reinterpret_cast<NMLVDISPINFO*>(lParam));
+                    SetFileImage(m_cliModel, reinterpret_cast<NMLVDISPINFO*>(lParam));
+                }
+                else if (pnmh->code == LVN_ODFINDITEM) {
+                    return m_cliModel.OnFindItem(reinterpret_cast<NMLVFINDITEM*>(lParam));
+                }
+                else if (pnmh->code == NM_CLICK) {
+                    // Check boxes of owner-data lists are toggled by hand.
+                    LPNMITEMACTIVATE pnmia = reinterpret_cast<LPNMITEMACTIVATE>(lParam);
+                    LVHITTESTINFO ht = {0};
+                    ht.pt = pnmia->ptAction;
+                    int iItem = ListView_HitTest(m_hCLIListView, &ht);
+                    if (iItem >= 0 && (ht.flags & LVHT_ONITEMSTATEICON))
+                        ToggleLauncher(m_cliModel, iItem);
+                }
+                else if (pnmh->code == LVN_KEYDOWN) {
+                    if (reinterpret_cast<LPNMLVKEYDOWN>(lParam)->wVKey == VK_SPACE)
+                        ToggleLauncher(m_cliModel, ListView_GetNextItem(m_hCLIListView, -1, LVNI_FOCUSED));
                 }
                 else if (pnmh->code == NM_DBLCLK) {
                     POINT pt;
@@ -843,59 +1124,14 @@ LRESULT CALLBACK MainWindow::HandleMessage(UINT uMsg, WPARAM wParam, LPARAM lPar
                     LVHITTESTINFO ht = {0};
                     ht.pt = pt;
                     int rowIndex = ListView_HitTest(m_hCLIListView, &ht);
-                    if (rowIndex != -1) {
-                        wchar_t buffer[256] = {0};
-                        LVITEM lvItem = {0};
-                        lvItem.mask = LVIF_TEXT;
-                        lvItem.iItem = rowIndex;
-                        lvItem.iSubItem = 0;
-                        lvItem.pszText = buffer;
-                        lvItem.cchTextMax = 256;
-                        ListView_GetItem(m_hCLIListView, &lvItem);
-                        std::wstring fileName(buffer);
+                    if (rowIndex != -1 && rowIndex < m_cliModel.GetCount()) {
+                        std::wstring fileName = m_cliModel.GetText(rowIndex, 0);
                         if (!fileName.empty()) {
                             size_t start = fileName.find_first_not_of(L" \t");
                             size_t end   = fileName.find_last_not_of(L" \t");
                             if (start != std::wstring::npos && end != std::wstring::npos)
                                 fileName = fileName.substr(start, end - start + 1);
-                            std::wstring filePath = PROJECT_FOLDER + L"\\" + fileName;
-                            // Check if .url
-                            std::wstring lowerPath = filePath;
-                            for (auto &c : lowerPath) c = towlower(c);
-                            if (lowerPath.size() >= 4 && lowerPath.rfind(L".url") == lowerPath.size() - 4) {
-                                std::wifstream ifs(filePath.c_str());
-                                if (!ifs) {
-                                    MessageBox(m_hwnd, L"Failed to open .url file.", L"Error", MB_OK | MB_ICONERROR);
-                                    return 0;
-                                }
-                                std::wstring line, url;
-                                while (std::getline(ifs, line)) {
-                                    if (line.find(L"URL=") == 0) {
-                                        url = line.substr(4);
-                                        break;
-                                    }
-                                }
-                                ifs.close();
-                                if (!url.empty()) {
-                                    ShowIntegratedBrowser(url);
-                                    return 0;
-                                }
-                                // fallback
-                            }
-                            // Normal logic
-                            auto it = m_fileWindowMap.find(filePath);
-                            if (it != m_fileWindowMap.end() && IsWindow(it->second.hwnd)) {
-                                TrackedWindow currentFp = GetFingerprint(it->second.hwnd);
-                                if (!CompareStableAttributes(it->second, currentFp))
-                                    it->second = currentFp;
-                                ActivateTrackedWindow(it->second);
-                            } else {
-                                HWND hwndFound = GetWindowHandleByFileName(fileName);
-                                if (hwndFound)
-                                    ActivateTrackedWindow(m_fileWindowMap[filePath] = GetFingerprint(hwndFound));
-                                else
-                                    LaunchFile(filePath, m_hwnd, m_fileWindowMap);
-                            }
+                            OpenFile(TrackerEngine::GetFilePath(fileName));
                         }
                     }
                 }
@@ -904,175 +1140,73 @@ LRESULT CALLBACK MainWindow::HandleMessage(UINT uMsg, WPARAM wParam, LPARAM lPar
         break;
 
     case WM_TIMER:
-        {
-            // Update File Tracking ListView statuses
-            int count = ListView_GetItemCount(m_hListViewFileTracking);
-            for (int i = 0; i < count; ++i) {
-                wchar_t buffer[256] = {0};
-                LVITEM item = {0};
-                item.mask = LVIF_TEXT;
-                item.iItem = i;
-                item.iSubItem = 0;
-                item.pszText = buffer;
-                item.cchTextMax = 256;
-                ListView_GetItem(m_hListViewFileTracking, &item);
-                std::wstring fileName(buffer);
-                std::wstring status;
-                std::wstring filePath = PROJECT_FOLDER + L"\\" + fileName;
-                HWND hwndFound = nullptr;
-                auto it = m_fileWindowMap.find(filePath);
-                if (it != m_fileWindowMap.end() && IsWindow(it->second.hwnd)) {
-                    TrackedWindow currentFp = GetFingerprint(it->second.hwnd);
-                    if (CompareStableAttributes(it->second, currentFp))
-                        hwndFound = it->second.hwnd;
-                    else {
-                        it->second = currentFp;
-                        hwndFound = currentFp.hwnd;
-                    }
-                } else {
-                    hwndFound = GetWindowHandleByFileName(fileName);
-                }
-                status = (hwndFound) ? GetStateString(hwndFound) : L"Not launched";
-                LVITEM statusItem = {0};
-                statusItem.mask = LVIF_TEXT;
-                statusItem.iItem = i;
-                statusItem.iSubItem = 1;
-                statusItem.pszText = const_cast<LPWSTR>(status.c_str());
-                ListView_SetItem(m_hListViewFileTracking, &statusItem);
-            }
+        if (wParam == REFRESH_TIMER_ID) {
+            KillTimer(m_hwnd, REFRESH_TIMER_ID);
+            RunScheduledRefresh();
+            return 0;
+        }
+        if (wParam == BROWSER_PREWARM_TIMER_ID) {
+            // A failure is reported if the user opens a .url file.
+            EnsureBrowserPanel();
+            return 0;
+        }
+        break;
 
-            // Update CLI ListView statuses
-            int cliCount = ListView_GetItemCount(m_hCLIListView);
-            for (int i = 0; i < cliCount; ++i) {
-                wchar_t buffer[256] = {0};
-                LVITEM item = {0};
-                item.mask = LVIF_TEXT;
-                item.iItem = i;
-                item.iSubItem = 0;
-                item.pszText = buffer;
-                item.cchTextMax = 256;
-                ListView_GetItem(m_hCLIListView, &item);
-                std::wstring fileName(buffer);
-                std::wstring status;
-                std::wstring filePath = PROJECT_FOLDER + L"\\" + fileName;
-                HWND hwndFound = nullptr;
-                auto it = m_fileWindowMap.find(filePath);
-                if (it != m_fileWindowMap.end() && IsWindow(it->second.hwnd)) {
-                    TrackedWindow currentFp = GetFingerprint(it->second.hwnd);
-                    if (CompareStableAttributes(it->second, currentFp))
-                        hwndFound = it->second.hwnd;
-                    else {
-                        it->second = currentFp;
-                        hwndFound = currentFp.hwnd;
-                    }
-                } else {
-                    hwndFound = GetWindowHandleByFileName(fileName);
-                }
-                status = (hwndFound) ? GetStateString(hwndFound) : L"Not launched";
-                LVITEM statusItem = {0};
-                statusItem.mask = LVIF_TEXT;
-                statusItem.iItem = i;
-                statusItem.iSubItem = 1;
-                statusItem.pszText = const_cast<LPWSTR>(status.c_str());
-                ListView_SetItem(m_hCLIListView, &statusItem);
-            }
+    case WM_WTSSESSION_CHANGE:
+        if (wParam == WTS_SESSION_LOCK || wParam == WTS_SESSION_UNLOCK) {
+            m_refreshScheduler.SetSessionLocked(wParam == WTS_SESSION_LOCK);
+            UpdateSuspension();
+        }
+        return 0;
 
-            // Update Window Monitoring ListView
-            WindowMonitor monitor;
-            std::vector<WindowInfo> windows = monitor.EnumerateWindows();
-            if (!WindowListsEqual(windows, m_prevWindowList))
-                m_prevWindowList = windows;
-            ListView_SetRedraw(m_hListViewWindowMonitoring, FALSE);
-            int currentCount = ListView_GetItemCount(m_hListViewWindowMonitoring);
-            int newCount = static_cast<int>(windows.size());
-            for (int i = 0; i < newCount; ++i) {
-                const auto &win = windows[i];
-                std::wstring title = win.title;
-                std::wstring processName = win.processName;
-                std::wstring stateStr;
-                switch (win.state) {
-                    case WindowState::Normal:     stateStr = L"Normal";     break;
-                    case WindowState::Minimized:  stateStr = L"Minimized";  break;
-                    case WindowState::Maximized:  stateStr = L"Maximized";  break;
-                    default:                      stateStr = L"Unknown";    break;
-                }
-                if (win.hwnd == GetForegroundWindow())
-                    stateStr += L" (Focused)";
-                std::wstring hwndStr = std::to_wstring(reinterpret_cast<uintptr_t>(win.hwnd));
-                std::wstring className = win.className;
-                std::wstring leftStr = std::to_wstring(win.rect.left);
-                std::wstring topStr = std::to_wstring(win.rect.top);
-                std::wstring rightStr = std::to_wstring(win.rect.right);
-                std::wstring bottomStr = std::to_wstring(win.rect.bottom);
-                std::wstring associatedFiles;
-                int topCount = ListView_GetItemCount(m_hListViewFileTracking);
-                std::wstring winTitleLower = title;
-                for (auto &c : winTitleLower)
-                    c = towlower(c);
-                for (int j = 0; j < topCount; ++j) {
-                    wchar_t fileBuf[256] = {0};
-                    LVITEM fileItem = {0};
-                    fileItem.mask = LVIF_TEXT;
-                    fileItem.iItem = j;
-                    fileItem.iSubItem = 0;
-                    fileItem.pszText = fileBuf;
-                    fileItem.cchTextMax = 256;
-                    ListView_GetItem(m_hListViewFileTracking, &fileItem);
-                    std::wstring fileName(fileBuf);
-                    std::wstring fileNameLower = fileName;
-                    for (auto &c : fileNameLower)
-                        c = towlower(c);
-                    fileNameLower = StripLnkExtension(fileNameLower);
-                    if (!fileNameLower.empty() && winTitleLower.find(fileNameLower) != std::wstring::npos) {
-                        if (!associatedFiles.empty())
-                            associatedFiles += L", ";
-                        associatedFiles += fileName;
-                    }
-                }
-                if (i < currentCount) {
-                    ListView_SetItemText(m_hListViewWindowMonitoring, i, 0, const_cast<LPWSTR>(associatedFiles.c_str()));
-                    ListView_SetItemText(m_hListViewWindowMonitoring, i, 1, const_cast<LPWSTR>(title.c_str()));
-                    ListView_SetItemText(m_hListViewWindowMonitoring, i, 2, const_cast<LPWSTR>(processName.c_str()));
-                    ListView_SetItemText(m_hListViewWindowMonitoring, i, 3, const_cast<LPWSTR>(stateStr.c_str()));
-                    ListView_SetItemText(m_hListViewWindowMonitoring, i, 4, const_cast<LPWSTR>(hwndStr.c_str()));
-                    ListView_SetItemText(m_hListViewWindowMonitoring, i, 5, const_cast<LPWSTR>(className.c_str()));
-                    ListView_SetItemText(m_hListViewWindowMonitoring, i, 6, const_cast<LPWSTR>(leftStr.c_str()));
-                    ListView_SetItemText(m_hListViewWindowMonitoring, i, 7, const_cast<LPWSTR>(topStr.c_str()));
-                    ListView_SetItemText(m_hListViewWindowMonitoring, i, 8, const_cast<LPWSTR>(rightStr.c_str()));
-                    ListView_SetItemText(m_hListViewWindowMonitoring, i, 9, const_cast<LPWSTR>(bottomStr.c_str()));
-                } else {
-                    LVITEM lvi = {0};
-                    lvi.mask = LVIF_TEXT;
-                    lvi.iItem = i;
-                    lvi.iSubItem = 0;
-                    lvi.pszText = const_cast<LPWSTR>(associatedFiles.c_str());
-                    ListView_InsertItem(m_hListViewWindowMonitoring, &lvi);
-                    ListView_SetItemText(m_hListViewWindowMonitoring, i, 1, const_cast<LPWSTR>(title.c_str()));
-                    ListView_SetItemText(m_hListViewWindowMonitoring, i, 2, const_cast<LPWSTR>(processName.c_str()));
-                    ListView_SetItemText(m_hListViewWindowMonitoring, i, 3, const_cast<LPWSTR>(stateStr.c_str()));
-                    ListView_SetItemText(m_hListViewWindowMonitoring, i, 4, const_cast<LPWSTR>(hwndStr.c_str()));
-                    ListView_SetItemText(m_hListViewWindowMonitoring, i, 5, const_cast<LPWSTR>(className.c_str()));
-                    ListView_SetItemText(m_hListViewWindowMonitoring, i, 6, const_cast<LPWSTR>(leftStr.c_str()));
-                    ListView_SetItemText(m_hListViewWindowMonitoring, i, 7, const_cast<LPWSTR>(topStr.c_str()));
-                    ListView_SetItemText(m_hListViewWindowMonitoring, i, 8, const_cast<LPWSTR>(rightStr.c_str()));
-                    ListView_SetItemText(m_hListViewWindowMonitoring, i, 9, const_cast<LPWSTR>(bottomStr.c_str()));
-                }
-            }
-            while (ListView_GetItemCount(m_hListViewWindowMonitoring) > newCount)
-                ListView_DeleteItem(m_hListViewWindowMonitoring, newCount);
-            ListView_SetRedraw(m_hListViewWindowMonitoring, TRUE);
-            InvalidateRect(m_hListViewWindowMonitoring, nullptr, TRUE);
-            UpdateWindow(m_hListViewWindowMonitoring);
+    case WM_SYSCOMMAND:
+        // The low four bits of wParam are used by the system.
+        if ((wParam & 0xFFF0) == IDM_REFRESH_NORMAL) {
+            ApplyRefreshRates({ REFRESH_VISIBLE_INTERVAL, REFRESH_HIDDEN_INTERVAL, TIMER_INTERVAL });
+            return 0;
         }
+        if ((wParam & 0xFFF0) == IDM_REFRESH_BATTERY_SAVER) {
+            ApplyRefreshRates({ BATTERY_VISIBLE_INTERVAL, BATTERY_HIDDEN_INTERVAL, BATTERY_SWEEP_INTERVAL });
+            return 0;
+        }
+        if ((wParam & 0xFFF0) == IDM_RESTORE_WORKSPACE) {
+            m_engine.RestoreWorkspace();
+            return 0;
+        }
+        return DefWindowProc(m_hwnd, uMsg, wParam, lParam);
+
+    case WM_APP_ICONS_READY:
+        m_iconCache.OnIconsReady();
+        return 0;
+
+    case WM_APP_SEARCH_RESULTS:
+        OnCLISearchResults();
         return 0;
 
     case WM_DESTROY:
-        SaveTrackingMapping(TRACKING_FILE, m_fileWindowMap);
-        KillTimer(m_hwnd, TIMER_ID);
+        KillTimer(m_hwnd, REFRESH_TIMER_ID);
+        KillTimer(m_hwnd, BROWSER_PREWARM_TIMER_ID);
+        WTSUnRegisterSessionNotification(m_hwnd);
+        // The lists outlive this message; detach the shared image list before it goes.
+        ListView_SetImageList(m_hListViewFileTracking, nullptr, LVSIL_SMALL);
+        if (m_hListViewWindowMonitoring)
+            ListView_SetImageList(m_hListViewWindowMonitoring, nullptr, LVSIL_SMALL);
+        if (m_hCLIListView)
+            ListView_SetImageList(m_hCLIListView, nullptr, LVSIL_SMALL);
+        m_iconCache.Stop();
+        m_cliSearch.Stop();
+        // Commits the tracking journal and stops the engine's workers.
+        m_engine.Stop();
         PostQuitMessage(0);
         return 0;
 
     default:
+        // WM_APP_SNAPSHOT_READY, WM_APP_DIRECTORY_CHANGED, WM_APP_LAUNCH_COMPLETE and
+        // WM_APP_TRACKING_LOADED belong to the engine, which calls back through TrackerEngineListener.
+        if (m_engine.HandleMessage(uMsg, wParam, lParam)) {
+            CheckInteractive();
+            return 0;
+        }
         return DefWindowProc(m_hwnd, uMsg, wParam, lParam);
     }
     return 0;
@@ -1091,46 +1225,35 @@ void MainWindow::OnCreate() {
                                            0, panelY, rc.right, panelHeight,
                                            m_hwnd, nullptr, GetModuleHandle(nullptr), nullptr);
     SetWindowSubclass(m_hPanelFileTracking, PanelSubclassProc, 1, 0);
-    m_hPanelWindowMonitoring = CreateWindowEx(0, L"STATIC", L"WindowMonitoringPanel", WS_CHILD,
-                                               0, panelY, rc.right, panelHeight,
-                                               m_hwnd, nullptr, GetModuleHandle(nullptr), nullptr);
-    m_hPanelCLI = CreateWindowEx(0, L"STATIC", L"CLI Panel", WS_CHILD,
-                                  0, panelY, rc.right, panelHeight,
-                                  m_hwnd, nullptr, GetModuleHandle(nullptr), nullptr);
-    // Subclass the CLI panel
-    SetWindowSubclass(m_hPanelCLI, PanelSubclassProc, 1, 0);
+    // The Window Monitoring and CLI panels are built by their first SwitchPanel().
     SwitchPanel(0);
 
     // Create embedded controls
     m_hListViewFileTracking = CreateWindowEx(0, WC_LISTVIEW, L"",
-                    WS_CHILD | WS_VISIBLE | LVS_REPORT | LVS_SINGLESEL,
+                    WS_CHILD | WS_VISIBLE | LVS_REPORT | LVS_SINGLESEL | LVS_OWNERDATA | LVS_SHAREIMAGELISTS,
                     0, 0, rc.right, panelHeight,
                     m_hPanelFileTracking, nullptr, GetModuleHandle(nullptr), nullptr);
     ListView_SetExtendedListViewStyleEx(m_hListViewFileTracking, LVS_EX_CHECKBOXES, LVS_EX_CHECKBOXES);
 
-    m_hListViewWindowMonitoring = CreateWindowEx(0, WC_LISTVIEW, L"",
-                    WS_CHILD | WS_VISIBLE | LVS_REPORT | LVS_SINGLESEL,
-                    0, 0, rc.right, panelHeight,
-                    m_hPanelWindowMonitoring, nullptr, GetModuleHandle(nullptr), nullptr);
-
-    m_hCLIEdit = CreateWindowEx(WS_EX_CLIENTEDGE, L"EDIT", L"",
-                    WS_CHILD | WS_VISIBLE | ES_AUTOHSCROLL | ES_MULTILINE | ES_WANTRETURN,
-                    0, 0, rc.right, 25,
-                    m_hPanelCLI, nullptr, GetModuleHandle(nullptr), nullptr);
-
-    m_hCLIListView = CreateWindowEx(0, WC_LISTVIEW, L"",
-                    WS_CHILD | WS_VISIBLE | LVS_REPORT | LVS_SINGLESEL,
-                    0, 25, rc.right, panelHeight - 25,
-                    m_hPanelCLI, nullptr, GetModuleHandle(nullptr), nullptr);
-    // Enable checkboxes
-    ListView_SetExtendedListViewStyleEx(m_hCLIListView, LVS_EX_CHECKBOXES, LVS_EX_CHECKBOXES);
+    // Without the bar the launcher check boxes still work; there is just nothing to click.
+    m_launcherBar.Create(m_hwnd, GetLauncherBarBounds());
 
     InitListViewControls();
+    m_fileTrackingModel.Attach(m_hListViewFileTracking, 2, true);
+    // Without an image list the lists simply stay text-only.
+    if (m_iconCache.Start(m_hwnd, WM_APP_ICONS_READY, ICON_CACHE_FILE))
+        ListView_SetImageList(m_hListViewFileTracking, m_iconCache.GetImageList(), LVSIL_SMALL);
+    bool monitoring = m_engine.Start(m_hwnd, this);
+    if (!m_engine.IsFolderAvailable())
+        MessageBox(m_hwnd, L"Failed to enumerate the project folders. Please check the PROJECT_ROOTS paths.",
+                   L"Error", MB_OK | MB_ICONERROR);
+    if (!monitoring)
+        MessageBox(m_hwnd, L"Failed to start window monitoring.", L"Error", MB_OK | MB_ICONERROR);
+    // Empty until the directory thread delivers the listing.
     PopulateListView();
-    PopulateCLIListView();
 
-    // Subclass the CLI edit
-    SetWindowSubclass(m_hCLIEdit, MainWindow::CLIEditSubclassProc, 1, reinterpret_cast<DWORD_PTR>(this));
+    // WM_TIMER is delivered after WM_PAINT, so the browser prewarm waits for the first paint.
+    SetTimer(m_hwnd, BROWSER_PREWARM_TIMER_ID, BROWSER_PREWARM_DELAY, nullptr);
 }
 
-// ---------------------------- End of file: MainWindow.cpp (Version: 1.61.0) ----------------------------
+// ---------------------------- End of file: MainWindow.cpp (Version: 1.83.0) ----------------------------
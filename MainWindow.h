@@ -1,9 +1,59 @@
 // ============================ 
 // File: MainWindow.h
-// Version: 1.59.7 (Added integrated browser feature with BrowserPanel integration)
+// Version: 1.76.0 (CLI Enter waits for its ranking)
 // -------------------------------------------------------------------------
 // This file declares the MainWindow class for MYexplorer.
-// Changes in this version:
+// Changes in version 1.76.0:
+// - Added OpenCLIInput() with m_cliShownFinal and m_cliOpenPending, so Enter opens the best
+//   match of the query it was pressed for.
+// Changes in version 1.75.0:
+// - Added m_cliSearch (FuzzySearcher) with m_cliSearchToken and OnCLISearchResults();
+//   m_cliPrefixIndex is only used for Tab completion.
+// Changes in version 1.74.0:
+// - m_fileButtons and m_launcherButtonMap were replaced by m_launcherBar (LauncherBar);
+//   added GetLauncherBarBounds().
+// Changes in version 1.73.0:
+// - Added EnsurePanel(), which builds the Window Monitoring and CLI panels on their first
+//   display, and m_startupMetrics with CheckInteractive() for the startup milestones.
+// Changes in version 1.72.0:
+// - Added EnsureBrowserPanel(), which creates the hidden browser panel (and so the
+//   shared WebView2 environment and controller pool) after the first paint.
+// Changes in version 1.71.0:
+// - Added m_iconCache, SetFileImage() and SetProcessImage(), which answer LVIF_IMAGE
+//   requests of the owner-data lists from the asynchronous IconCache.
+// Changes in version 1.70.0:
+// - The tracking map, stored entries, snapshot worker, directory index, launch service
+//   and title matcher moved into m_engine (TrackerEngine). MainWindow implements
+//   TrackerEngineListener and keeps only view state; OpenFile() replaces the copies of
+//   the activate-or-launch logic and StartLaunch().
+// Changes in version 1.69.0:
+// - Added RestoreWorkspace() and m_pendingRestoreRects for launches it started.
+// Changes in version 1.68.0:
+// - Added m_refreshScheduler; RefreshViews() takes the mask of panels to render and
+//   RunScheduledRefresh(), UpdateSuspension() and ApplyRefreshRates() drive it.
+// Changes in version 1.67.0:
+// - m_prevWindowList was replaced by m_prevWindowRows (HWND and rectangle per row) and
+//   the content hash of the last rendered WindowTable; scratch buffers are reused.
+// Changes in version 1.66.0:
+// - Added m_storedTrackedWindows / m_rehydrationPending and RehydrateTrackedWindows().
+// Changes in version 1.65.0:
+// - m_windowMonitor was replaced by m_snapshotWorker, which owns the monitor on its own
+//   thread; added SyncTrackedWindows().
+// - TrackedWindow moved to TrackedWindow.h.
+// Changes in version 1.64.0:
+// - Added m_launchService with StartLaunch() and OnLaunchComplete().
+// Changes in version 1.63.0:
+// - Added m_cliPrefixIndex for incremental CLI filtering and Tab completion.
+// Changes in version 1.62.0:
+// - Added m_directoryIndex, the watched listing of PROJECT_FOLDER, OnDirectoryChanged()
+//   and m_cliFilter so the CLI list can be re-filtered when the folder changes.
+// Changes in version 1.61.0:
+// - Added ListViewModel row models for the three owner-data ListViews.
+// Changes in version 1.60.0:
+// - Added m_windowMonitor, a long-lived WindowMonitor whose event-fed window table
+//   replaces the per-tick enumeration, and RefreshViews() which renders from it.
+// - Added m_titleMatcher, rebuilt when the folder is listed, for single-pass matching.
+// Changes in version 1.59.7:
 // - Added a new member variable, m_browserPanel, to manage an integrated browser.
 // - Added methods ShowIntegratedBrowser() and HideIntegratedBrowser() to display and hide the browser panel.
 // - Updated layout handling to support a split view when the browser is active.
@@ -17,24 +67,19 @@
 #include <map>
 #include <vector>
 #include "WindowMonitor.h"  // For WindowInfo definition
+#include "TrackedWindow.h"  // For TrackedWindow definition
 #include "BrowserPanel.h"   // For integrated browser feature
-
-/**
- * @struct TrackedWindow
- * @brief Extended fingerprint for a tracked window.
- *
- * Contains process ID, window handle, geometry, class name, window title,
- * a failure counter, and the launch time.
- */
-struct TrackedWindow {
-    DWORD processId;
-    HWND hwnd;
-    RECT rect;
-    std::wstring className;
-    std::wstring windowTitle;
-    int failCount;         ///< Initialized to 0 when a new entry is added.
-    ULONGLONG launchTime;  ///< Timestamp (in ms) when the window was first captured.
-};
+#include "TitleMatcher.h"   // For file name / window title matching
+#include "ListViewModel.h"  // For owner-data ListView row models
+#include "DirectoryIndex.h" // For the watched project folder listing
+#include "PrefixIndex.h"    // For CLI Tab completion
+#include "FuzzySearch.h"    // For the ranked CLI search
+#include "LaunchService.h"  // For asynchronous file launching
+#include "RefreshScheduler.h" // For visibility-aware panel refreshes
+#include "TrackerEngine.h"  // For the UI-independent tracking core
+#include "IconCache.h"      // For the list icons
+#include "StartupMetrics.h" // For time to first paint / interactive
+#include "LauncherBar.h"    // For the launcher toolbar
 
 /**
  * @class MainWindow
@@ -43,7 +88,7 @@ struct TrackedWindow {
  * Manages UI creation, tab-based layout (File Tracking, Window Monitoring, CLI),
  * file tracking, dynamic launcher buttons, window monitoring, and an integrated browser.
  */
-class MainWindow {
+class MainWindow : private TrackerEngineListener {
 public:
     MainWindow();
     ~MainWindow();
@@ -66,12 +111,36 @@ private:
     HWND m_hCLIEdit;                   ///< EDIT control for CLI input.
     HWND m_hCLIListView;               ///< ListView for file list in CLI.
 
-    std::map<std::wstring, TrackedWindow> m_fileWindowMap;  ///< Mapping from file path to window fingerprint.
-    std::vector<WindowInfo> m_prevWindowList;               ///< Previous window list for bottom panel.
+    TrackerEngine m_engine;                                 ///< Tracking map, snapshots, folder index and launches.
+    IconCache m_iconCache;                                  ///< File type and process icons of the lists.
+    StartupMetrics m_startupMetrics;                        ///< First paint and interactive milestones.
+    std::wstring m_scratchIconPath;                         ///< Reused by SetFileImage().
+    // Values the Window Monitoring rows were last formatted from.
+    struct MonitoredRow {
+        HWND hwnd;
+        RECT rect;
+    };
+    std::vector<MonitoredRow> m_prevWindowRows;             ///< Per row of the bottom panel.
+    ULONGLONG m_prevWindowHash;                             ///< WindowTable content hash last rendered.
+    HWND m_prevForeground;                                  ///< Foreground window last rendered.
+    bool m_windowRowsStale;                                 ///< Re-render even if the hash is unchanged.
+    std::wstring m_scratchText;                             ///< Reused by the per-refresh row formatting.
+    std::wstring m_cliFilter;                               ///< Current CLI filter text.
+    PrefixIndex m_cliPrefixIndex;                           ///< Sorted lowercase names for Tab completion.
+    FuzzySearcher m_cliSearch;                              ///< Ranks the CLI matches off the UI thread.
+    ULONGLONG m_cliSearchToken;                             ///< Token of the newest CLI query.
+    std::wstring m_cliShownQuery;                           ///< Query the CLI rows show.
+    bool m_cliShownFinal;                                   ///< The CLI rows are the final result of m_cliSearchToken.
+    bool m_cliOpenPending;                                  ///< Enter waits for that result to open its best match.
+    RefreshScheduler m_refreshScheduler;                    ///< Decides which panels re-render and when.
+
+    // Row models for the owner-data ListViews.
+    ListViewModel m_fileTrackingModel;
+    ListViewModel m_windowMonitoringModel;
+    ListViewModel m_cliModel;
 
     std::map<std::wstring, bool> m_launcherMap;             ///< Indicates which files are marked as launchers.
-    std::map<std::wstring, HWND> m_fileButtons;             ///< Mapping of file paths to dynamic launcher button HWNDs.
-    std::map<UINT, std::wstring> m_launcherButtonMap;       ///< Mapping of launcher button control IDs to file paths.
+    LauncherBar m_launcherBar;                              ///< Buttons of the files marked as launchers.
 
     // Integrated browser panel for URL files.
     BrowserPanel* m_browserPanel;
@@ -82,15 +151,51 @@ private:
     void OnCreate();
     void PopulateListView();       // Populates the File Tracking ListView.
     void PopulateCLIListView();    // Populates the CLI ListView.
-    void RefreshLauncherButtons();
-    void InitListViewControls();   // Initialize columns for ListView controls.
+    void RefreshLauncherButtons();  // Reconciles m_launcherBar with m_launcherMap.
+    RECT GetLauncherBarBounds() const;
+    void InitListViewControls();   // Initialize columns of the File Tracking ListView.
+
+    // Refreshes the given panels (RefreshPanelBit mask) from the window table.
+    void RefreshViews(unsigned panels);
+    // Renders the panels m_refreshScheduler reports due and arms REFRESH_TIMER_ID.
+    void RunScheduledRefresh();
+    // Pauses or resumes the snapshot worker after a minimize or session lock change.
+    void UpdateSuspension();
+    // Applies new refresh rates to the scheduler and the snapshot worker.
+    void ApplyRefreshRates(const RefreshRates &rates);
+    void UpdateStatusColumn(ListViewModel &model);
+    void UpdateWindowMonitoringList(const WindowTable &windows);
+    // Fill in the icon of an LVN_GETDISPINFO request (LVIF_IMAGE, first column).
+    void SetFileImage(const ListViewModel &model, NMLVDISPINFO *pDispInfo);
+    void SetProcessImage(const ListViewModel &model, NMLVDISPINFO *pDispInfo);
+
+    // Launcher check boxes of the owner-data file lists.
+    void ApplyLauncherChecks(ListViewModel &model);
+    void ToggleLauncher(ListViewModel &model, int row);
 
     // New: Filter the CLI ListView based on the current input.
     void FilterCLIListView(const std::wstring &filter);
+    // Renders the result FuzzySearcher posted WM_APP_SEARCH_RESULTS for.
+    void OnCLISearchResults();
+    // Opens the file named by m_cliFilter, or else its best match once it is ranked.
+    void OpenCLIInput();
+
+    // Opens a .url file in the integrated browser; anything else is activated or
+    // launched by the engine. Returns false if a .url file could not be read.
+    bool OpenFile(const std::wstring &filePath);
+
+    // TrackerEngineListener
+    void OnSnapshotUpdated() override;
+    void OnFolderChanged(const std::vector<DirectoryDelta> &deltas) override;
+    void OnLaunchComplete(const LaunchResult &result) override;
 
     // Methods for handling tab changes.
     void CreateTabControl();
     void SwitchPanel(int tabIndex);
+    // Builds the Window Monitoring (1) or CLI (2) panel unless it exists.
+    void EnsurePanel(int tabIndex);
+    // Records the time to interactive once the first paint and the startup data are in.
+    void CheckInteractive();
 
     // --- New: CLI edit control subclass procedure as a private static member ---
     static LRESULT CALLBACK CLIEditSubclassProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam,
@@ -103,10 +208,12 @@ private:
     // --- New: Integrated browser feature methods ---
     // Show the integrated browser with the given URL in a split view.
     void ShowIntegratedBrowser(const std::wstring &url);
+    // Create the hidden browser panel unless it exists; false if it could not be created.
+    bool EnsureBrowserPanel();
     // Hide the integrated browser and revert to the previous layout.
     void HideIntegratedBrowser();
 };
 
 #endif // MAINWINDOW_H
 
-// ---------------------------- End of file: MainWindow.h (Version: 1.59.7) ----------------------------
+// ---------------------------- End of file: MainWindow.h (Version: 1.76.0) ----------------------------
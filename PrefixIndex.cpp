@@ -0,0 +1,79 @@
+// File: PrefixIndex.cpp
+// Version: 1.0
+// -------------------------------------------------------------------------
+// This file implements PrefixIndex (see PrefixIndex.h).
+// -------------------------------------------------------------------------
+
+#include "PrefixIndex.h"
+#include <algorithm>
+#include <numeric>
+#include <cwctype>
+
+PrefixIndex::PrefixIndex()
+    : m_rangeBegin(0)
+    , m_rangeEnd(0)
+{
+}
+
+std::wstring PrefixIndex::ToLower(const std::wstring &text) {
+    std::wstring lower = text;
+    for (auto &c : lower)
+        c = towlower(c);
+    return lower;
+}
+
+void PrefixIndex::Build(const std::vector<std::wstring> &names) {
+    m_names = names;
+    std::vector<std::wstring> lowered;
+    lowered.reserve(m_names.size());
+    for (const auto &name : m_names)
+        lowered.push_back(ToLower(name));
+
+    m_order.resize(m_names.size());
+    std::iota(m_order.begin(), m_order.end(), size_t(0));
+    std::sort(m_order.begin(), m_order.end(), [&lowered](size_t a, size_t b) {
+        return lowered[a] < lowered[b];
+    });
+    m_keys.clear();
+    m_keys.reserve(m_order.size());
+    for (size_t index : m_order)
+        m_keys.push_back(std::move(lowered[index]));
+
+    m_prefix.clear();
+    m_rangeBegin = 0;
+    m_rangeEnd = m_keys.size();
+}
+
+size_t PrefixIndex::Narrow(const std::wstring &prefix) {
+    std::wstring lower = ToLower(prefix);
+    // Typing another character only needs the previous range; anything else restarts.
+    bool extends = lower.size() >= m_prefix.size() && lower.compare(0, m_prefix.size(), m_prefix) == 0;
+    size_t first = extends ? m_rangeBegin : 0;
+    size_t last = extends ? m_rangeEnd : m_keys.size();
+
+    auto begin = m_keys.begin() + first;
+    auto end = m_keys.begin() + last;
+    auto lo = std::lower_bound(begin, end, lower);
+    auto hi = std::upper_bound(lo, end, lower, [](const std::wstring &p, const std::wstring &key) {
+        return key.compare(0, p.size(), p) > 0;
+    });
+
+    m_prefix = lower;
+    m_rangeBegin = static_cast<size_t>(lo - m_keys.begin());
+    m_rangeEnd = static_cast<size_t>(hi - m_keys.begin());
+    return m_rangeEnd - m_rangeBegin;
+}
+
+std::wstring PrefixIndex::GetCommonPrefix() const {
+    if (m_rangeBegin >= m_rangeEnd)
+        return std::wstring();
+    // Keys are sorted, so the first and last keys bound every key in between.
+    const std::wstring &firstKey = m_keys[m_rangeBegin];
+    const std::wstring &lastKey = m_keys[m_rangeEnd - 1];
+    size_t len = 0;
+    while (len < firstKey.size() && len < lastKey.size() && firstKey[len] == lastKey[len])
+        ++len;
+    return GetName(m_rangeBegin).substr(0, len);
+}
+
+// End of file: PrefixIndex.cpp (Version: 1.0)
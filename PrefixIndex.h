@@ -0,0 +1,58 @@
+// File: PrefixIndex.h
+// Version: 1.0
+// -------------------------------------------------------------------------
+// This header declares PrefixIndex, a sorted, pre-lowercased name table used
+// by the CLI filter and Tab completion.
+//
+// Names are lowercased once in Build() and sorted by their lowercase key, so
+// all names sharing a prefix form one contiguous range that is found with two
+// binary searches (O(log n + k)). Narrow() remembers the last range: when the
+// new prefix extends the previous one, only that range is searched again.
+// The longest common prefix of a range is the common prefix of its first and
+// last keys, so Tab completion never scans the matches.
+// -------------------------------------------------------------------------
+
+#ifndef PREFIXINDEX_H
+#define PREFIXINDEX_H
+
+#include <string>
+#include <vector>
+
+class PrefixIndex {
+public:
+    PrefixIndex();
+
+    // Replaces the table with the given names. Resets the current range.
+    void Build(const std::vector<std::wstring> &names);
+
+    size_t GetCount() const { return m_names.size(); }
+
+    // Restricts the current range to names starting with prefix (case-insensitive).
+    // Returns the number of matches.
+    size_t Narrow(const std::wstring &prefix);
+
+    // Current range, as positions in sorted order.
+    size_t GetRangeBegin() const { return m_rangeBegin; }
+    size_t GetRangeEnd() const { return m_rangeEnd; }
+
+    // Original-case name at a sorted position.
+    const std::wstring& GetName(size_t pos) const { return m_names[m_order[pos]]; }
+
+    // Longest common prefix of the current range, in the case of its first name.
+    std::wstring GetCommonPrefix() const;
+
+private:
+    static std::wstring ToLower(const std::wstring &text);
+
+    std::vector<std::wstring> m_names;  // Original-case names, in Build() order.
+    std::vector<std::wstring> m_keys;   // Lowercase keys, sorted.
+    std::vector<size_t> m_order;        // m_order[pos] is the m_names index of m_keys[pos].
+
+    std::wstring m_prefix;              // Lowercase prefix of the current range.
+    size_t m_rangeBegin;
+    size_t m_rangeEnd;
+};
+
+#endif // PREFIXINDEX_H
+
+// End of file: PrefixIndex.h (Version: 1.0)
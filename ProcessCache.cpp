@@ -0,0 +1,137 @@
+// File: ProcessCache.cpp
+// Version: 1.2
+// -------------------------------------------------------------------------
+// This file implements ProcessCache (see ProcessCache.h).
+//
+// Changes in Version 1.2:
+//  - Cache misses are traced as the ProcessLookup phase (Tracing.h).
+// -------------------------------------------------------------------------
+
+#include "ProcessCache.h"
+#include "StringInterner.h"
+#include "Tracing.h"
+
+// Negative entries (processes we may not open) are retried after this delay.
+static const ULONGLONG NEGATIVE_ENTRY_RETRY_MS = 5000;
+
+ProcessCache::ProcessCache()
+    : m_hits(0)
+    , m_misses(0)
+{
+}
+
+ProcessCache::~ProcessCache() {
+    for (auto &pair : m_entries)
+        CloseEntry(pair.second);
+}
+
+ProcessCache& ProcessCache::Shared() {
+    static ProcessCache cache;
+    return cache;
+}
+
+void ProcessCache::CloseEntry(Entry &entry) {
+    if (entry.hProcess) {
+        CloseHandle(entry.hProcess);
+        entry.hProcess = nullptr;
+    }
+}
+
+void ProcessCache::Resolve(DWORD processId, Entry &entry) {
+    CloseEntry(entry);
+    entry.creationTime = 0;
+    entry.imagePath.clear();
+    entry.imagePathId = 0;
+
+    TraceActivity activity;
+    TraceStart(activity, TracePhase::ProcessLookup);
+    // Limited-query rights succeed for most protected and elevated processes.
+    entry.hProcess = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION | SYNCHRONIZE, FALSE, processId);
+    if (!entry.hProcess) {
+        TraceProcessLookupStop(activity, processId, false);
+        return;
+    }
+
+    FILETIME creation, exitTime, kernelTime, userTime;
+    if (GetProcessTimes(entry.hProcess, &creation, &exitTime, &kernelTime, &userTime))
+        entry.creationTime = (static_cast<ULONGLONG>(creation.dwHighDateTime) << 32) | creation.dwLowDateTime;
+
+    wchar_t path[MAX_PATH * 4] = {0};
+    DWORD size = static_cast<DWORD>(sizeof(path) / sizeof(path[0]));
+    if (QueryFullProcessImageNameW(entry.hProcess, 0, path, &size)) {
+        entry.imagePath.assign(path, size);
+        entry.imagePathId = StringInterner::ProcessNames().Intern(entry.imagePath);
+    }
+    TraceProcessLookupStop(activity, processId, entry.imagePathId != 0);
+}
+
+ProcessCache::Entry& ProcessCache::Acquire(DWORD processId) {
+    ULONGLONG now = GetTickCount64();
+    auto it = m_entries.find(processId);
+    bool valid = false;
+    if (it != m_entries.end()) {
+        Entry &entry = it->second;
+        if (entry.hProcess)
+            valid = (WaitForSingleObject(entry.hProcess, 0) == WAIT_TIMEOUT); // Still running.
+        else
+            valid = (now - entry.lastUsed < NEGATIVE_ENTRY_RETRY_MS);
+    } else {
+        it = m_entries.emplace(processId, Entry{ nullptr, 0, std::wstring(), 0, now }).first;
+    }
+
+    Entry &entry = it->second;
+    if (valid) {
+        ++m_hits;
+    } else {
+        ++m_misses;
+        Resolve(processId, entry);
+        entry.lastUsed = now;
+    }
+    if (entry.hProcess)
+        entry.lastUsed = now;
+    return entry;
+}
+
+bool ProcessCache::Lookup(DWORD processId, ProcessIdentity &identity) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Entry &entry = Acquire(processId);
+    identity.processId = processId;
+    identity.creationTime = entry.creationTime;
+    identity.imagePath = entry.imagePath;
+    return entry.hProcess != nullptr;
+}
+
+std::wstring ProcessCache::GetImagePath(DWORD processId) {
+    ProcessIdentity identity;
+    Lookup(processId, identity);
+    return identity.imagePath;
+}
+
+ULONGLONG ProcessCache::GetCreationTime(DWORD processId) {
+    ProcessIdentity identity;
+    Lookup(processId, identity);
+    return identity.creationTime;
+}
+
+UINT ProcessCache::GetImagePathId(DWORD processId) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return Acquire(processId).imagePathId;
+}
+
+void ProcessCache::Prune(ULONGLONG maxIdleMs) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ULONGLONG now = GetTickCount64();
+    for (auto it = m_entries.begin(); it != m_entries.end(); ) {
+        Entry &entry = it->second;
+        bool exited = entry.hProcess && WaitForSingleObject(entry.hProcess, 0) != WAIT_TIMEOUT;
+        bool idle = now - entry.lastUsed > maxIdleMs;
+        if (exited || idle) {
+            CloseEntry(entry);
+            it = m_entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+// End of file: ProcessCache.cpp (Version: 1.2)
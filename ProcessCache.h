@@ -0,0 +1,93 @@
+// File: ProcessCache.h
+// Version: 1.1
+// -------------------------------------------------------------------------
+// This header declares ProcessCache, a PID-keyed cache of process identity
+// (creation time and full image path) used by WindowMonitor.
+//
+// Each cached process keeps one PROCESS_QUERY_LIMITED_INFORMATION |
+// SYNCHRONIZE handle open. Holding the handle guarantees the PID is not
+// recycled while the entry is alive, and a zero-timeout wait on it is a
+// cheap liveness check that replaces the OpenProcess/GetModuleFileNameEx/
+// CloseHandle sequence previously done for every window on every tick.
+// An exited process is detected on lookup and re-resolved, so a reused PID
+// is reported with its new creation time.
+//
+// Changes in Version 1.1:
+//  - Added GetImagePathId(), which returns the image path interned in
+//    StringInterner::ProcessNames() without copying the string.
+// -------------------------------------------------------------------------
+
+#ifndef PROCESSCACHE_H
+#define PROCESSCACHE_H
+
+#include <windows.h>
+#include <string>
+#include <unordered_map>
+#include <mutex>
+
+/**
+ * @struct ProcessIdentity
+ * @brief Identifies a process instance; (processId, creationTime) is unique over time.
+ */
+struct ProcessIdentity {
+    DWORD processId;
+    ULONGLONG creationTime;  ///< Process creation time as a FILETIME value (0 if unknown).
+    std::wstring imagePath;  ///< Full path of the process image (empty if unknown).
+};
+
+class ProcessCache {
+public:
+    ProcessCache();
+    ~ProcessCache();
+
+    // Process-wide instance shared by WindowMonitor and the fingerprint helpers.
+    static ProcessCache& Shared();
+
+    // Returns the identity of the process currently using processId.
+    // Returns false if the process could not be opened.
+    bool Lookup(DWORD processId, ProcessIdentity &identity);
+
+    // Convenience accessors built on Lookup().
+    std::wstring GetImagePath(DWORD processId);
+    ULONGLONG GetCreationTime(DWORD processId);
+
+    // Interned image path of processId (0 if unknown); does not allocate on a hit.
+    UINT GetImagePathId(DWORD processId);
+
+    // Releases entries for processes that have exited or have not been
+    // looked up for maxIdleMs milliseconds.
+    void Prune(ULONGLONG maxIdleMs);
+
+    // Lookup statistics.
+    ULONGLONG GetHitCount() const { return m_hits; }
+    ULONGLONG GetMissCount() const { return m_misses; }
+
+private:
+    struct Entry {
+        HANDLE hProcess;         ///< Open handle, or nullptr for a negative entry.
+        ULONGLONG creationTime;
+        std::wstring imagePath;
+        UINT imagePathId;        ///< imagePath interned in StringInterner::ProcessNames().
+        ULONGLONG lastUsed;      ///< GetTickCount64() of the last lookup.
+    };
+
+    // Opens and queries processId. Must be called with m_mutex held.
+    void Resolve(DWORD processId, Entry &entry);
+
+    // Returns the up-to-date entry for processId. Must be called with m_mutex held.
+    Entry& Acquire(DWORD processId);
+
+    static void CloseEntry(Entry &entry);
+
+    std::unordered_map<DWORD, Entry> m_entries;
+    std::mutex m_mutex;
+    ULONGLONG m_hits;
+    ULONGLONG m_misses;
+
+    ProcessCache(const ProcessCache&) = delete;
+    ProcessCache& operator=(const ProcessCache&) = delete;
+};
+
+#endif // PROCESSCACHE_H
+
+// End of file: ProcessCache.h (Version: 1.1)
@@ -0,0 +1,105 @@
+// File: QueryProtocol.h
+// Version: 1.0
+// -------------------------------------------------------------------------
+// This header defines the binary request/response protocol of the tracker's
+// query pipe (QUERY_PIPE_NAME, served by QueryServer). Clients may include
+// it as is; it only depends on <cstdint>.
+//
+// The pipe is message-mode. Every request message is a batch:
+//
+//   QueryRequestHeader
+//   count x { QueryRequestRecord, nameLength UTF-16 units (no terminator) }
+//
+// and is answered by exactly one response message:
+//
+//   QueryResponseHeader
+//   count x { QueryResponseRecord, textLength UTF-16 units (no terminator) }
+//
+// with one response record per request record, in order. All integers are
+// little-endian; structures are packed and records follow each other
+// without padding. A message must not exceed QUERY_MAX_MESSAGE bytes.
+//
+// Operations:
+//   QUERY_OP_LOOKUP_FILE   name = file name in the project folder (or its
+//                          full path). Returns the window the tracker
+//                          associates with the file: the tracked window if
+//                          it is alive, else the first window whose title
+//                          contains the name. text = status text.
+//   QUERY_OP_ACTIVATE_FILE name as above. The file is activated (or
+//                          launched) on the tracker's UI thread after the
+//                          response was sent; status QUERY_STATUS_QUEUED.
+//   QUERY_OP_WINDOW_FILES  hwnd = top-level window. text = names of the
+//                          files found in its title, separated by '\n'.
+// Answers come from the tracker's latest window snapshot; generation in the
+// response header identifies it.
+// -------------------------------------------------------------------------
+
+#ifndef QUERYPROTOCOL_H
+#define QUERYPROTOCOL_H
+
+#include <cstdint>
+
+const uint32_t QUERY_REQUEST_MAGIC = 0x3151594D;   // "MYQ1"
+const uint32_t QUERY_RESPONSE_MAGIC = 0x3152594D;  // "MYR1"
+const uint16_t QUERY_PROTOCOL_VERSION = 1;
+const uint32_t QUERY_MAX_MESSAGE = 64 * 1024;
+const uint32_t QUERY_MAX_BATCH = 1024;
+
+enum QueryOp : uint8_t {
+    QUERY_OP_LOOKUP_FILE = 1,
+    QUERY_OP_ACTIVATE_FILE = 2,
+    QUERY_OP_WINDOW_FILES = 3
+};
+
+enum QueryStatus : uint8_t {
+    QUERY_STATUS_OK = 0,
+    QUERY_STATUS_NOT_FOUND = 1,    // Unknown file or window.
+    QUERY_STATUS_NOT_OPEN = 2,     // Known file without a window.
+    QUERY_STATUS_QUEUED = 3,       // Activation handed to the UI thread.
+    QUERY_STATUS_BAD_REQUEST = 4   // Malformed message or unknown operation.
+};
+
+#pragma pack(push, 1)
+
+struct QueryRequestHeader {
+    uint32_t magic;       // QUERY_REQUEST_MAGIC
+    uint16_t version;     // QUERY_PROTOCOL_VERSION
+    uint16_t reserved;
+    uint32_t count;       // Number of records, at most QUERY_MAX_BATCH.
+};
+
+struct QueryRequestRecord {
+    uint8_t op;           // QueryOp
+    uint8_t reserved;
+    uint16_t nameLength;  // UTF-16 units following the record.
+    uint32_t reserved2;
+    uint64_t hwnd;        // QUERY_OP_WINDOW_FILES only.
+};
+
+struct QueryResponseHeader {
+    uint32_t magic;       // QUERY_RESPONSE_MAGIC
+    uint16_t version;     // QUERY_PROTOCOL_VERSION
+    uint16_t status;      // QUERY_STATUS_BAD_REQUEST if the message was rejected (count is then 0).
+    uint32_t count;
+    uint64_t generation;  // Window snapshot the answers were taken from.
+};
+
+struct QueryResponseRecord {
+    uint8_t op;           // Echo of the request.
+    uint8_t status;       // QueryStatus
+    uint16_t textLength;  // UTF-16 units following the record.
+    uint32_t processId;
+    uint64_t hwnd;
+    int32_t left, top, right, bottom;  // Window rectangle (screen coordinates).
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(QueryRequestHeader) == 12, "QueryRequestHeader layout");
+static_assert(sizeof(QueryRequestRecord) == 16, "QueryRequestRecord layout");
+static_assert(sizeof(QueryResponseHeader) == 20, "QueryResponseHeader layout");
+static_assert(sizeof(QueryResponseRecord) == 32, "QueryResponseRecord layout");
+
+#endif // QUERYPROTOCOL_H
+
+// End of file: QueryProtocol.h (Version: 1.0)
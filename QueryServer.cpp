@@ -0,0 +1,409 @@
+// File: QueryServer.cpp
+// Version: 1.0
+// -------------------------------------------------------------------------
+// This file implements QueryServer and QueryIndex (see QueryServer.h).
+// -------------------------------------------------------------------------
+
+#include "QueryServer.h"
+#include "QueryProtocol.h"
+#include "TextMatch.h"  // For FoldNoCase()
+#include "Config.h"
+#include <algorithm>
+#include <cstring>
+
+// -------------------------------------------------------------------------
+// QueryIndex
+// -------------------------------------------------------------------------
+int QueryIndex::FindFile(const wchar_t *name, size_t length) const {
+    if (!files)
+        return -1;
+    // Server thread only; keeps lookups free of allocations after the first.
+    static thread_local std::wstring key;
+    key.assign(name, length);
+    FoldNoCase(key);
+    static thread_local std::wstring folderPrefix;
+    if (folderPrefix.empty()) {
+        folderPrefix = PROJECT_FOLDER + L"\\";
+        FoldNoCase(folderPrefix);
+    }
+    if (key.size() > folderPrefix.size() && key.compare(0, folderPrefix.size(), folderPrefix) == 0)
+        key.erase(0, folderPrefix.size());
+    auto it = files->byFoldedName.find(key);
+    return (it != files->byFoldedName.end()) ? static_cast<int>(it->second) : -1;
+}
+
+const QueryIndex::WindowFiles* QueryIndex::FindWindowFiles(HWND hwnd) const {
+    auto it = std::lower_bound(windows.begin(), windows.end(), hwnd,
+                               [](const WindowFiles &entry, HWND h) { return entry.hwnd < h; });
+    return (it != windows.end() && it->hwnd == hwnd) ? &*it : nullptr;
+}
+
+// -------------------------------------------------------------------------
+// Connections
+// -------------------------------------------------------------------------
+struct QueryServer::Connection {
+    OVERLAPPED overlapped;          // Of the one operation in flight.
+    HANDLE pipe;
+    enum State { Idle, Connecting, Reading, Writing } state;
+    std::vector<BYTE> request;      // Grows up to QUERY_MAX_MESSAGE.
+    DWORD requestSize;              // Bytes of the current message received so far.
+    std::vector<BYTE> response;
+};
+
+static const DWORD INITIAL_REQUEST_BUFFER = 4096;
+
+QueryServer::QueryServer()
+    : m_hwndNotify(nullptr)
+    , m_activateMsg(0)
+    , m_port(nullptr)
+    , m_pending(0)
+    , m_listening(0)
+{
+}
+
+QueryServer::~QueryServer() {
+    Stop();
+}
+
+bool QueryServer::Start(HWND hwndNotify, UINT activateMsg) {
+    if (IsRunning())
+        return true;
+    m_hwndNotify = hwndNotify;
+    m_activateMsg = activateMsg;
+    m_port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
+    if (!m_port)
+        return false;
+    // The first instance is created here so that a pipe name owned by another
+    // process is reported to the caller. The thread takes over from here on.
+    if (!AddInstance()) {
+        CloseHandle(m_port);
+        m_port = nullptr;
+        return false;
+    }
+    m_thread = std::thread(&QueryServer::Run, this);
+    return true;
+}
+
+void QueryServer::Stop() {
+    if (!IsRunning())
+        return;
+    // A packet without OVERLAPPED and key 0 asks the thread to quit.
+    PostQueuedCompletionStatus(m_port, 0, 0, nullptr);
+    m_thread.join();
+    CloseHandle(m_port);
+    m_port = nullptr;
+}
+
+void QueryServer::Publish(std::shared_ptr<const QueryIndex> index) {
+    std::lock_guard<std::mutex> lock(m_indexMutex);
+    m_index = std::move(index);
+}
+
+std::shared_ptr<const QueryIndex> QueryServer::GetIndex() {
+    std::lock_guard<std::mutex> lock(m_indexMutex);
+    return m_index;
+}
+
+bool QueryServer::AddInstance() {
+    DWORD openMode = PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED;
+    if (m_connections.empty())
+        openMode |= FILE_FLAG_FIRST_PIPE_INSTANCE;  // Never share the name with another tracker.
+    HANDLE pipe = CreateNamedPipeW(QUERY_PIPE_NAME, openMode,
+                                   PIPE_TYPE_MESSAGE | PIPE_READMODE_MESSAGE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+                                   QUERY_PIPE_MAX_INSTANCES, QUERY_MAX_MESSAGE, QUERY_MAX_MESSAGE, 0, nullptr);
+    if (pipe == INVALID_HANDLE_VALUE)
+        return false;
+    std::unique_ptr<Connection> connection(new Connection());
+    connection->pipe = pipe;
+    connection->state = Connection::Idle;
+    connection->request.resize(INITIAL_REQUEST_BUFFER);
+    connection->requestSize = 0;
+    if (!CreateIoCompletionPort(pipe, m_port, reinterpret_cast<ULONG_PTR>(connection.get()), 0)) {
+        CloseHandle(pipe);
+        return false;
+    }
+    m_connections.push_back(std::move(connection));
+    Listen(*m_connections.back());
+    return true;
+}
+
+void QueryServer::Listen(Connection &connection) {
+    ZeroMemory(&connection.overlapped, sizeof(connection.overlapped));
+    connection.state = Connection::Connecting;
+    if (!ConnectNamedPipe(connection.pipe, &connection.overlapped)) {
+        DWORD error = GetLastError();
+        if (error == ERROR_IO_PENDING) {
+            ++m_pending;
+            ++m_listening;
+            return;
+        }
+        if (error == ERROR_PIPE_CONNECTED) {
+            // The client connected between CreateNamedPipe/DisconnectNamedPipe
+            // and this call; no packet is queued, so queue one ourselves.
+            if (PostQueuedCompletionStatus(m_port, 0, reinterpret_cast<ULONG_PTR>(&connection), &connection.overlapped)) {
+                ++m_pending;
+                ++m_listening;
+                return;
+            }
+        }
+    } else {
+        // Overlapped ConnectNamedPipe reports through the port even on success.
+        ++m_pending;
+        ++m_listening;
+        return;
+    }
+    connection.state = Connection::Idle; // Broken instance; it stays unused.
+}
+
+void QueryServer::StartRead(Connection &connection) {
+    ZeroMemory(&connection.overlapped, sizeof(connection.overlapped));
+    connection.state = Connection::Reading;
+    if (ReadFile(connection.pipe, connection.request.data() + connection.requestSize,
+                 static_cast<DWORD>(connection.request.size()) - connection.requestSize,
+                 nullptr, &connection.overlapped)) {
+        ++m_pending;
+        return;
+    }
+    DWORD error = GetLastError();
+    if (error == ERROR_IO_PENDING || error == ERROR_MORE_DATA) {
+        ++m_pending;
+        return;
+    }
+    Reset(connection);
+}
+
+void QueryServer::StartWrite(Connection &connection) {
+    ZeroMemory(&connection.overlapped, sizeof(connection.overlapped));
+    connection.state = Connection::Writing;
+    if (WriteFile(connection.pipe, connection.response.data(), static_cast<DWORD>(connection.response.size()),
+                  nullptr, &connection.overlapped) || GetLastError() == ERROR_IO_PENDING) {
+        ++m_pending;
+        return;
+    }
+    Reset(connection);
+}
+
+void QueryServer::Reset(Connection &connection) {
+    // Drops the client (or a broken message) and waits for the next one.
+    DisconnectNamedPipe(connection.pipe);
+    connection.requestSize = 0;
+    Listen(connection);
+}
+
+void QueryServer::OnCompletion(Connection &connection, DWORD bytes, DWORD error) {
+    switch (connection.state) {
+    case Connection::Connecting:
+        --m_listening;
+        if (error != ERROR_SUCCESS) {
+            Reset(connection);
+            return;
+        }
+        // Keep one instance listening while there is room for more clients.
+        if (m_listening == 0 && m_connections.size() < QUERY_PIPE_MAX_INSTANCES)
+            AddInstance();
+        connection.requestSize = 0;
+        StartRead(connection);
+        return;
+
+    case Connection::Reading:
+        connection.requestSize += bytes;
+        if (error == ERROR_MORE_DATA) {
+            if (connection.request.size() >= QUERY_MAX_MESSAGE) {
+                Reset(connection); // Oversized message.
+                return;
+            }
+            connection.request.resize((std::min)(connection.request.size() * 2, static_cast<size_t>(QUERY_MAX_MESSAGE)));
+            StartRead(connection);
+            return;
+        }
+        if (error != ERROR_SUCCESS) {
+            Reset(connection);
+            return;
+        }
+        Process(connection);
+        StartWrite(connection);
+        return;
+
+    case Connection::Writing:
+        if (error != ERROR_SUCCESS) {
+            Reset(connection);
+            return;
+        }
+        connection.requestSize = 0;
+        StartRead(connection);
+        return;
+
+    default:
+        return;
+    }
+}
+
+void QueryServer::Run() {
+    for (;;) {
+        DWORD bytes = 0;
+        ULONG_PTR key = 0;
+        OVERLAPPED *overlapped = nullptr;
+        BOOL ok = GetQueuedCompletionStatus(m_port, &bytes, &key, &overlapped, INFINITE);
+        if (!overlapped) {
+            if (ok && key == 0)
+                break;  // Stop()
+            continue;
+        }
+        --m_pending;
+        OnCompletion(*reinterpret_cast<Connection*>(key), bytes, ok ? ERROR_SUCCESS : GetLastError());
+    }
+    // The connections' buffers must outlive their operations: cancel
+    // everything and wait for the cancelled completions before closing.
+    for (const auto &connection : m_connections)
+        CancelIoEx(connection->pipe, nullptr);
+    while (m_pending > 0) {
+        DWORD bytes = 0;
+        ULONG_PTR key = 0;
+        OVERLAPPED *overlapped = nullptr;
+        GetQueuedCompletionStatus(m_port, &bytes, &key, &overlapped, INFINITE);
+        if (overlapped)
+            --m_pending;
+    }
+    for (const auto &connection : m_connections) {
+        DisconnectNamedPipe(connection->pipe);
+        CloseHandle(connection->pipe);
+    }
+    m_connections.clear();
+    m_listening = 0;
+}
+
+// -------------------------------------------------------------------------
+// Requests
+// -------------------------------------------------------------------------
+template <typename T>
+static void AppendBytes(std::vector<BYTE> &out, const T &value) {
+    const BYTE *bytes = reinterpret_cast<const BYTE*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+static void FillWindow(QueryResponseRecord &record, const QueryIndex::FileState &state) {
+    record.hwnd = reinterpret_cast<uint64_t>(state.hwnd);
+    record.processId = state.processId;
+    record.left = state.rect.left;
+    record.top = state.rect.top;
+    record.right = state.rect.right;
+    record.bottom = state.rect.bottom;
+}
+
+void QueryServer::Process(Connection &connection) {
+    std::shared_ptr<const QueryIndex> index = GetIndex();
+    QueryResponseHeader header{};
+    header.magic = QUERY_RESPONSE_MAGIC;
+    header.version = QUERY_PROTOCOL_VERSION;
+    header.status = QUERY_STATUS_OK;
+    header.generation = index ? index->generation : 0;
+    connection.response.assign(sizeof(header), 0);
+    if (!AnswerBatch(connection.request.data(), connection.requestSize, index.get(), connection.response, header.count)) {
+        header.status = QUERY_STATUS_BAD_REQUEST;
+        header.count = 0;
+        connection.response.resize(sizeof(header));
+    }
+    memcpy(connection.response.data(), &header, sizeof(header));
+}
+
+bool QueryServer::AnswerBatch(const BYTE *message, size_t size, const QueryIndex *index,
+                              std::vector<BYTE> &response, uint32_t &count) {
+    QueryRequestHeader request{};
+    if (size < sizeof(request))
+        return false;
+    memcpy(&request, message, sizeof(request));
+    if (request.magic != QUERY_REQUEST_MAGIC || request.version != QUERY_PROTOCOL_VERSION ||
+        request.count > QUERY_MAX_BATCH)
+        return false;
+
+    std::unique_ptr<QueryActivation> activation;
+    size_t offset = sizeof(request);
+    for (uint32_t i = 0; i < request.count; ++i) {
+        QueryRequestRecord record{};
+        if (size - offset < sizeof(record))
+            return false;
+        memcpy(&record, message + offset, sizeof(record));
+        offset += sizeof(record);
+        size_t nameBytes = record.nameLength * sizeof(wchar_t);
+        if (size - offset < nameBytes)
+            return false;
+        m_scratchName.resize(record.nameLength);
+        if (nameBytes)
+            memcpy(&m_scratchName[0], message + offset, nameBytes);
+        offset += nameBytes;
+
+        QueryResponseRecord out{};
+        out.op = record.op;
+        out.status = QUERY_STATUS_NOT_FOUND;
+        m_scratchText.clear();
+        switch (record.op) {
+        case QUERY_OP_LOOKUP_FILE: {
+                int fileIndex = index ? index->FindFile(m_scratchName.c_str(), m_scratchName.size()) : -1;
+                if (fileIndex < 0)
+                    break;
+                const QueryIndex::FileState &state = index->states[fileIndex];
+                if (!state.hwnd) {
+                    out.status = QUERY_STATUS_NOT_OPEN;
+                    break;
+                }
+                out.status = QUERY_STATUS_OK;
+                FillWindow(out, state);
+                if (state.state)
+                    m_scratchText.assign(state.state);
+            }
+            break;
+
+        case QUERY_OP_ACTIVATE_FILE: {
+                int fileIndex = index ? index->FindFile(m_scratchName.c_str(), m_scratchName.size()) : -1;
+                if (fileIndex < 0)
+                    break;
+                if (!activation)
+                    activation.reset(new QueryActivation());
+                activation->fileNames.push_back(index->files->names[fileIndex]);
+                out.status = QUERY_STATUS_QUEUED;
+                FillWindow(out, index->states[fileIndex]);
+            }
+            break;
+
+        case QUERY_OP_WINDOW_FILES: {
+                HWND hwnd = reinterpret_cast<HWND>(static_cast<ULONG_PTR>(record.hwnd));
+                out.hwnd = record.hwnd;
+                const QueryIndex::WindowFiles *entry = index ? index->FindWindowFiles(hwnd) : nullptr;
+                if (!entry)
+                    break;
+                out.status = QUERY_STATUS_OK;
+                for (UINT j = 0; j < entry->count; ++j) {
+                    if (j)
+                        m_scratchText += L'\n';
+                    m_scratchText += index->files->names[index->fileIndices[entry->first + j]];
+                }
+            }
+            break;
+
+        default:
+            out.status = QUERY_STATUS_BAD_REQUEST;
+            break;
+        }
+
+        size_t textLength = (std::min)(m_scratchText.size(), static_cast<size_t>(0xFFFF));
+        out.textLength = static_cast<uint16_t>(textLength);
+        if (response.size() + sizeof(out) + textLength * sizeof(wchar_t) > QUERY_MAX_MESSAGE)
+            return false; // The answers do not fit one message; the client must split the batch.
+        AppendBytes(response, out);
+        const BYTE *text = reinterpret_cast<const BYTE*>(m_scratchText.data());
+        response.insert(response.end(), text, text + textLength * sizeof(wchar_t));
+    }
+    if (offset != size)
+        return false;
+
+    // Activations of a rejected message are dropped with it.
+    if (activation) {
+        // The UI thread takes ownership of the batch.
+        if (PostMessage(m_hwndNotify, m_activateMsg, 0, reinterpret_cast<LPARAM>(activation.get())))
+            activation.release();
+    }
+    count = request.count;
+    return true;
+}
+
+// End of file: QueryServer.cpp (Version: 1.0)
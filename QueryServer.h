@@ -0,0 +1,140 @@
+// File: QueryServer.h
+// Version: 1.1
+// -------------------------------------------------------------------------
+// This header declares QueryServer, which answers QueryProtocol.h requests
+// on the named pipe QUERY_PIPE_NAME, and QueryIndex, the immutable view of
+// the tracker it answers from.
+//
+// The server runs on one thread around an I/O completion port. Every pipe
+// instance is a small state machine (connecting, reading, writing) driven
+// by overlapped ConnectNamedPipe / ReadFile / WriteFile, so any number of
+// clients (up to QUERY_PIPE_MAX_INSTANCES at once) are served without one
+// thread per client. A new listening instance is created whenever the last
+// idle one gets a client.
+//
+// The UI thread publishes a QueryIndex after every window snapshot and file
+// list change: per file, the window the engine associates with it, and per
+// window, the files found in its title. Requests are answered from the
+// latest published index only, so the server never touches the engine or
+// other processes' windows and never waits for the UI thread. Activation
+// requests are the exception: they are posted to the UI thread as one
+// heap-allocated QueryActivation per batch, which the receiver must delete
+// (including batches still queued when it shuts down). A batch whose post
+// fails is deleted here.
+//
+// Changes in Version 1.1:
+//  - Documented who frees activation batches that are never handled.
+// -------------------------------------------------------------------------
+
+#ifndef QUERYSERVER_H
+#define QUERYSERVER_H
+
+#include <windows.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <cstdint>
+
+/**
+ * @struct QueryFileTable
+ * @brief File names of the project folder; rebuilt when the folder changes.
+ */
+struct QueryFileTable {
+    std::vector<std::wstring> names;                    ///< Display names, by file index.
+    std::unordered_map<std::wstring, UINT> byFoldedName; ///< FoldNoCase(name) to file index.
+};
+
+/**
+ * @struct QueryIndex
+ * @brief Immutable answers for one window snapshot.
+ */
+struct QueryIndex {
+    struct FileState {
+        HWND hwnd;              ///< nullptr if the file has no window.
+        DWORD processId;
+        RECT rect;
+        const wchar_t *state;   ///< Static status text, or nullptr.
+    };
+    struct WindowFiles {
+        HWND hwnd;
+        UINT first;             ///< Offset into fileIndices.
+        UINT count;
+    };
+
+    ULONGLONG generation;
+    std::shared_ptr<const QueryFileTable> files;
+    std::vector<FileState> states;          ///< By file index.
+    std::vector<WindowFiles> windows;       ///< Sorted by hwnd; only windows with files.
+    std::vector<UINT> fileIndices;
+
+    // Returns the file index of a name or full path in the project folder, or -1.
+    int FindFile(const wchar_t *name, size_t length) const;
+    // Returns the entry of hwnd in windows, or nullptr.
+    const WindowFiles* FindWindowFiles(HWND hwnd) const;
+};
+
+/**
+ * @struct QueryActivation
+ * @brief File names to activate, posted with WM_APP_QUERY_ACTIVATE (LPARAM).
+ */
+struct QueryActivation {
+    std::vector<std::wstring> fileNames;
+};
+
+class QueryServer {
+public:
+    QueryServer();
+    ~QueryServer();
+
+    // Creates the first pipe instance and starts the server thread. Batches
+    // of activation requests are posted to hwndNotify as activateMsg.
+    bool Start(HWND hwndNotify, UINT activateMsg);
+    void Stop();
+    bool IsRunning() const { return m_thread.joinable(); }
+
+    // UI thread: replaces the index requests are answered from.
+    void Publish(std::shared_ptr<const QueryIndex> index);
+
+private:
+    struct Connection;
+
+    void Run();
+    bool AddInstance();
+    void Listen(Connection &connection);
+    void StartRead(Connection &connection);
+    void StartWrite(Connection &connection);
+    void Reset(Connection &connection);
+    void OnCompletion(Connection &connection, DWORD bytes, DWORD error);
+
+    // Builds connection.response for connection.request.
+    void Process(Connection &connection);
+    // Appends one response record per request record of message to response.
+    // Returns false if the message is malformed or the answers do not fit.
+    bool AnswerBatch(const BYTE *message, size_t size, const QueryIndex *index,
+                     std::vector<BYTE> &response, uint32_t &count);
+
+    std::shared_ptr<const QueryIndex> GetIndex();
+
+    std::wstring m_scratchName;     // Server thread: name of the record being answered.
+    std::wstring m_scratchText;     // Server thread: text of the record being answered.
+
+    HWND m_hwndNotify;
+    UINT m_activateMsg;
+    HANDLE m_port;
+    std::thread m_thread;
+
+    // Server thread only.
+    std::vector<std::unique_ptr<Connection>> m_connections;
+    int m_pending;          // Operations whose completion packet is outstanding.
+    int m_listening;        // Instances waiting in ConnectNamedPipe.
+
+    std::mutex m_indexMutex;    // Guards m_index.
+    std::shared_ptr<const QueryIndex> m_index;
+};
+
+#endif // QUERYSERVER_H
+
+// End of file: QueryServer.h (Version: 1.1)
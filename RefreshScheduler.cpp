@@ -0,0 +1,106 @@
+// File: RefreshScheduler.cpp
+// Version: 1.0
+// -------------------------------------------------------------------------
+// This file implements RefreshScheduler (see RefreshScheduler.h).
+// -------------------------------------------------------------------------
+
+#include "RefreshScheduler.h"
+#include "Config.h"
+#include <algorithm>
+
+RefreshScheduler::RefreshScheduler()
+    : m_visiblePanel(REFRESH_PANEL_FILE_TRACKING)
+    , m_minimized(false)
+    , m_sessionLocked(false)
+{
+    m_rates.visibleInterval = REFRESH_VISIBLE_INTERVAL;
+    m_rates.hiddenInterval = REFRESH_HIDDEN_INTERVAL;
+    m_rates.sweepInterval = TIMER_INTERVAL;
+    for (int panel = 0; panel < REFRESH_PANEL_COUNT; ++panel) {
+        m_stale[panel] = true;
+        m_lastRefresh[panel] = 0;
+        m_interval[panel] = (panel == m_visiblePanel) ? m_rates.visibleInterval : GetDecayStart();
+    }
+}
+
+UINT RefreshScheduler::GetDecayStart() const {
+    return (std::min)((std::max)(m_rates.visibleInterval, REFRESH_DECAY_START_INTERVAL), m_rates.hiddenInterval);
+}
+
+void RefreshScheduler::SetRates(const RefreshRates &rates) {
+    m_rates = rates;
+    // Hidden panels keep their decay, clamped to the new bounds.
+    for (int panel = 0; panel < REFRESH_PANEL_COUNT; ++panel)
+        m_interval[panel] = (panel == m_visiblePanel) ? m_rates.visibleInterval
+                                                      : (std::min)((std::max)(m_interval[panel], GetDecayStart()),
+                                                                   m_rates.hiddenInterval);
+}
+
+void RefreshScheduler::SetVisiblePanel(int panel) {
+    if (panel < 0 || panel >= REFRESH_PANEL_COUNT)
+        return;
+    if (panel != m_visiblePanel) {
+        // The panel being hidden starts decaying from the fastest hidden rate.
+        m_interval[m_visiblePanel] = GetDecayStart();
+        m_visiblePanel = panel;
+    }
+    m_interval[panel] = m_rates.visibleInterval;
+    m_lastRefresh[panel] = 0; // Catch up now.
+}
+
+void RefreshScheduler::SetMinimized(bool minimized) {
+    if (m_minimized && !minimized)
+        m_lastRefresh[m_visiblePanel] = 0;
+    m_minimized = minimized;
+}
+
+void RefreshScheduler::SetSessionLocked(bool locked) {
+    if (m_sessionLocked && !locked)
+        m_lastRefresh[m_visiblePanel] = 0;
+    m_sessionLocked = locked;
+}
+
+void RefreshScheduler::Invalidate() {
+    for (int panel = 0; panel < REFRESH_PANEL_COUNT; ++panel)
+        m_stale[panel] = true;
+}
+
+ULONGLONG RefreshScheduler::GetDueTime(int panel) const {
+    return (m_lastRefresh[panel] == 0) ? 0 : m_lastRefresh[panel] + m_interval[panel];
+}
+
+unsigned RefreshScheduler::TakeDuePanels(ULONGLONG now) {
+    if (IsSuspended())
+        return 0;
+    unsigned due = 0;
+    for (int panel = 0; panel < REFRESH_PANEL_COUNT; ++panel) {
+        if (!m_stale[panel] || GetDueTime(panel) > now)
+            continue;
+        due |= RefreshPanelBit(panel);
+        m_stale[panel] = false;
+        m_lastRefresh[panel] = now;
+        if (panel != m_visiblePanel)
+            m_interval[panel] = (std::min)(m_interval[panel] * 2, m_rates.hiddenInterval);
+    }
+    return due;
+}
+
+DWORD RefreshScheduler::GetNextDelay(ULONGLONG now) const {
+    if (IsSuspended())
+        return INFINITE;
+    ULONGLONG next = 0;
+    bool pending = false;
+    for (int panel = 0; panel < REFRESH_PANEL_COUNT; ++panel) {
+        if (!m_stale[panel])
+            continue;
+        ULONGLONG due = GetDueTime(panel);
+        if (!pending || due < next)
+            next = due;
+        pending = true;
+    }
+    if (!pending)
+        return INFINITE;
+    return (next > now) ? static_cast<DWORD>(next - now) : 0;
+}
+
+// End of file: RefreshScheduler.cpp (Version: 1.0)
@@ -0,0 +1,89 @@
+// File: RefreshScheduler.h
+// Version: 1.0
+// -------------------------------------------------------------------------
+// This header declares RefreshScheduler, which decides when each of the
+// three panels (File Tracking, Window Monitoring, CLI) re-renders from the
+// current window snapshot.
+//
+// The visible panel is refreshed at RefreshRates::visibleInterval. A hidden
+// panel starts at the same rate when it is hidden and its interval doubles
+// with every refresh, up to RefreshRates::hiddenInterval. While the main
+// window is minimized or the session is locked nothing is due at all; the
+// visible panel is due immediately on restore, unlock and tab switch.
+//
+// The scheduler only keeps time stamps; MainWindow asks it which panels are
+// due (TakeDuePanels) and arms a one-shot timer for the next one
+// (GetNextDelay). All calls are made on the UI thread.
+// -------------------------------------------------------------------------
+
+#ifndef REFRESHSCHEDULER_H
+#define REFRESHSCHEDULER_H
+
+#include <windows.h>
+
+// Panels, in tab order.
+enum RefreshPanel {
+    REFRESH_PANEL_FILE_TRACKING = 0,
+    REFRESH_PANEL_WINDOW_MONITORING = 1,
+    REFRESH_PANEL_CLI = 2,
+    REFRESH_PANEL_COUNT = 3
+};
+
+// Bit of a panel in the mask returned by TakeDuePanels().
+inline unsigned RefreshPanelBit(int panel) { return 1u << panel; }
+
+/**
+ * @struct RefreshRates
+ * @brief Refresh cadence, adjustable at run time.
+ */
+struct RefreshRates {
+    UINT visibleInterval;  ///< Minimum time between refreshes of the visible panel (ms); 0 = every snapshot.
+    UINT hiddenInterval;   ///< Slowest rate a hidden panel decays to (ms).
+    UINT sweepInterval;    ///< Consistency sweep interval of the snapshot worker (ms).
+};
+
+class RefreshScheduler {
+public:
+    RefreshScheduler();
+
+    void SetRates(const RefreshRates &rates);
+    const RefreshRates& GetRates() const { return m_rates; }
+
+    // Makes panel the visible one; it becomes due immediately.
+    void SetVisiblePanel(int panel);
+    int GetVisiblePanel() const { return m_visiblePanel; }
+
+    // Suspension while the main window is minimized or the session is locked.
+    // Leaving the suspended state makes the visible panel due immediately.
+    void SetMinimized(bool minimized);
+    void SetSessionLocked(bool locked);
+    bool IsMinimized() const { return m_minimized; }
+    bool IsSuspended() const { return m_minimized || m_sessionLocked; }
+
+    // A new snapshot was taken: every panel is out of date.
+    void Invalidate();
+
+    // Returns the panels to refresh now (RefreshPanelBit mask) and marks them
+    // refreshed at now. Returns 0 while suspended.
+    unsigned TakeDuePanels(ULONGLONG now);
+
+    // Milliseconds until the next out-of-date panel is due, or INFINITE if
+    // every panel is current or the scheduler is suspended.
+    DWORD GetNextDelay(ULONGLONG now) const;
+
+private:
+    ULONGLONG GetDueTime(int panel) const;
+    UINT GetDecayStart() const;  // Interval of a panel that was just hidden.
+
+    RefreshRates m_rates;
+    int m_visiblePanel;
+    bool m_minimized;
+    bool m_sessionLocked;
+    bool m_stale[REFRESH_PANEL_COUNT];          ///< A newer snapshot than the panel shows exists.
+    ULONGLONG m_lastRefresh[REFRESH_PANEL_COUNT];
+    UINT m_interval[REFRESH_PANEL_COUNT];       ///< Current interval; decays while hidden.
+};
+
+#endif // REFRESHSCHEDULER_H
+
+// End of file: RefreshScheduler.h (Version: 1.0)
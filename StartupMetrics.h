@@ -0,0 +1,55 @@
+// File: StartupMetrics.h
+// Version: 1.0
+// -------------------------------------------------------------------------
+// This header declares StartupMetrics, which measures how long MYexplorer
+// takes to start so the numbers can be compared across releases.
+//
+// Two milestones are recorded, each once, as the time since the process was
+// created (GetProcessTimes), so loader and static initialization count too:
+//
+//   FirstPaint    the visible File Tracking list finished its first paint
+//   Interactive   the first paint happened, the project folder is listed,
+//                 the stored tracking is resolved and a window snapshot was
+//                 rendered; the window shows live data
+//
+// Each milestone is written as a StartupMilestone trace event (Tracing.h).
+// Once both are known, one JSON object per start is appended to
+// STARTUP_METRICS_FILE:
+//
+//   {"startedUtc":"2026-10-14T08:00:00Z","build":"Oct 14 2026 09:30:00",
+//    "firstPaintMs":182.4,"interactiveMs":441.9,"files":120}
+//
+// All methods are called on the UI thread.
+// -------------------------------------------------------------------------
+
+#ifndef STARTUPMETRICS_H
+#define STARTUPMETRICS_H
+
+#include <windows.h>
+#include <string>
+
+class StartupMetrics {
+public:
+    StartupMetrics();
+
+    void MarkFirstPaint();
+    // files: project files listed at that point.
+    void MarkInteractive(size_t files);
+
+    bool HasFirstPaint() const { return m_firstPaintUs != 0; }
+    bool IsInteractive() const { return m_interactiveUs != 0; }
+
+private:
+    // Microseconds since the process was created (at least 1).
+    ULONGLONG GetSinceProcessStartUs() const;
+    // Appends this start's line to STARTUP_METRICS_FILE.
+    void AppendRecord(size_t files) const;
+
+    ULONGLONG m_processStart;   ///< Creation time as a FILETIME value.
+    ULONGLONG m_firstPaintUs;
+    ULONGLONG m_interactiveUs;
+};
+
+#endif // STARTUPMETRICS_H
+
+// End of file: StartupMetrics.h (Version: 1.0)
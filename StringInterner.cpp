@@ -0,0 +1,45 @@
+// File: StringInterner.cpp
+// Version: 1.0
+// -------------------------------------------------------------------------
+// This file implements StringInterner (see StringInterner.h).
+// -------------------------------------------------------------------------
+
+#include "StringInterner.h"
+
+StringInterner::StringInterner() {
+    m_strings.push_back(std::wstring());
+    m_ids.emplace(std::wstring(), 0);
+}
+
+StringInterner& StringInterner::ClassNames() {
+    static StringInterner interner;
+    return interner;
+}
+
+StringInterner& StringInterner::ProcessNames() {
+    static StringInterner interner;
+    return interner;
+}
+
+UINT StringInterner::Intern(const wchar_t *text, size_t length) {
+    if (length == 0)
+        return 0;
+    // Reused per thread so that hits do not allocate.
+    thread_local std::wstring key;
+    key.assign(text, length);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_ids.find(key);
+    if (it != m_ids.end())
+        return it->second;
+    UINT id = static_cast<UINT>(m_strings.size());
+    m_strings.push_back(key);
+    m_ids.emplace(key, id);
+    return id;
+}
+
+const std::wstring& StringInterner::Get(UINT id) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return (id < m_strings.size()) ? m_strings[id] : m_strings[0];
+}
+
+// End of file: StringInterner.cpp (Version: 1.0)
@@ -0,0 +1,51 @@
+// File: StringInterner.h
+// Version: 1.0
+// -------------------------------------------------------------------------
+// This header declares StringInterner, a process-wide table that maps
+// strings which repeat across many windows (class names, process image
+// paths) to small integer IDs.
+//
+// Equal strings get equal IDs, so comparisons become integer compares and
+// per-window records store a UINT instead of a std::wstring. Interned
+// strings live for the whole process; ID 0 is always the empty string.
+// Intern() does not allocate when the string is already present.
+// -------------------------------------------------------------------------
+
+#ifndef STRINGINTERNER_H
+#define STRINGINTERNER_H
+
+#include <windows.h>
+#include <string>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+class StringInterner {
+public:
+    StringInterner();
+
+    // Interner for window class names (used by the fingerprint helpers).
+    static StringInterner& ClassNames();
+    // Interner for process image paths (used by ProcessCache).
+    static StringInterner& ProcessNames();
+
+    // Returns the ID of text; equal texts get equal IDs.
+    UINT Intern(const wchar_t *text, size_t length);
+    UINT Intern(const std::wstring &text) { return Intern(text.c_str(), text.size()); }
+
+    // Returns the string for an ID (empty for unknown IDs). The reference
+    // stays valid for the lifetime of the process.
+    const std::wstring& Get(UINT id) const;
+
+private:
+    mutable std::mutex m_mutex;
+    std::deque<std::wstring> m_strings;  // Deque keeps references stable.
+    std::unordered_map<std::wstring, UINT> m_ids;
+
+    StringInterner(const StringInterner&) = delete;
+    StringInterner& operator=(const StringInterner&) = delete;
+};
+
+#endif // STRINGINTERNER_H
+
+// End of file: StringInterner.h (Version: 1.0)
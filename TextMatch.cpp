@@ -0,0 +1,277 @@
+// File: TextMatch.cpp
+// Version: 1.0
+// -------------------------------------------------------------------------
+// This file implements the case-insensitive matchers (see TextMatch.h).
+//
+// FindNoCase() tests a block of start positions at a time against the
+// folded first and last needle characters and verifies the remaining
+// candidates with EqualsNoCase(). In a block where all units are ASCII,
+// folding is "OR 0x20 where the unit is in A-Z". A block containing a unit
+// above 0x7F is handled by the scalar code.
+// -------------------------------------------------------------------------
+
+#include "TextMatch.h"
+#include <cwchar>
+
+#if (defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)) && WCHAR_MAX == 0xFFFF
+#define TEXTMATCH_SIMD 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define TEXTMATCH_AVX2_TARGET
+#else
+#define TEXTMATCH_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+
+// -------------------------------------------------------------------------
+// Scalar reference
+// -------------------------------------------------------------------------
+bool EqualsNoCaseScalar(const wchar_t *a, const wchar_t *b, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+        if (a[i] != b[i] && FoldCharNoCase(a[i]) != FoldCharNoCase(b[i]))
+            return false;
+    }
+    return true;
+}
+
+size_t FindNoCaseScalar(const wchar_t *text, size_t textLength, const wchar_t *needle, size_t needleLength) {
+    if (needleLength == 0)
+        return 0;
+    if (needleLength > textLength)
+        return std::wstring::npos;
+    wchar_t first = FoldCharNoCase(needle[0]);
+    for (size_t i = 0; i + needleLength <= textLength; ++i) {
+        if (FoldCharNoCase(text[i]) == first && EqualsNoCaseScalar(text + i + 1, needle + 1, needleLength - 1))
+            return i;
+    }
+    return std::wstring::npos;
+}
+
+void FoldNoCase(std::wstring &text) {
+    for (auto &c : text)
+        c = FoldCharNoCase(c);
+}
+
+#ifdef TEXTMATCH_SIMD
+
+// Index of the lowest set bit of a non-zero mask.
+static inline unsigned LowestBit(unsigned mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+// Bit mask (two bits per lane, as produced by movemask_epi8) of the start
+// positions in [start, start + lanes) whose folded first and last
+// characters match the needle's: the scalar version of the block filter.
+static unsigned ScalarCandidateMask(const wchar_t *start, size_t lanes, wchar_t first, wchar_t last, size_t lastOffset) {
+    unsigned mask = 0;
+    for (size_t k = 0; k < lanes; ++k) {
+        if (FoldCharNoCase(start[k]) == first && FoldCharNoCase(start[k + lastOffset]) == last)
+            mask |= 3u << (2 * k);
+    }
+    return mask;
+}
+
+// -------------------------------------------------------------------------
+// SSE2: eight UTF-16 units per block
+// -------------------------------------------------------------------------
+static inline __m128i Load8(const wchar_t *p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+// True if no lane is above 0x7F.
+static inline bool IsAscii8(__m128i v) {
+    __m128i high = _mm_subs_epu16(v, _mm_set1_epi16(0x7F));
+    return _mm_movemask_epi8(_mm_cmpeq_epi16(high, _mm_setzero_si128())) == 0xFFFF;
+}
+
+// Folds A-Z to a-z; only valid for ASCII lanes.
+static inline __m128i FoldAscii8(__m128i v) {
+    __m128i offset = _mm_sub_epi16(v, _mm_set1_epi16(L'A'));
+    __m128i upper = _mm_cmpeq_epi16(_mm_subs_epu16(offset, _mm_set1_epi16(25)), _mm_setzero_si128());
+    return _mm_or_si128(v, _mm_and_si128(upper, _mm_set1_epi16(0x20)));
+}
+
+static bool EqualsNoCaseSse2(const wchar_t *a, const wchar_t *b, size_t length) {
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        __m128i va = Load8(a + i);
+        __m128i vb = Load8(b + i);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(va, vb)) == 0xFFFF)
+            continue;
+        if (!IsAscii8(_mm_or_si128(va, vb))) {
+            if (!EqualsNoCaseScalar(a + i, b + i, 8))
+                return false;
+            continue;
+        }
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(FoldAscii8(va), FoldAscii8(vb))) != 0xFFFF)
+            return false;
+    }
+    return EqualsNoCaseScalar(a + i, b + i, length - i);
+}
+
+static size_t FindNoCaseSse2(const wchar_t *text, size_t textLength, const wchar_t *needle, size_t needleLength) {
+    if (needleLength == 0)
+        return 0;
+    if (needleLength > textLength)
+        return std::wstring::npos;
+    // Filter start positions on the first and the last needle character at
+    // once, then verify the characters in between.
+    size_t lastOffset = needleLength - 1;
+    wchar_t first = FoldCharNoCase(needle[0]);
+    wchar_t last = FoldCharNoCase(needle[lastOffset]);
+    __m128i firstLanes = _mm_set1_epi16(static_cast<short>(first));
+    __m128i lastLanes = _mm_set1_epi16(static_cast<short>(last));
+    size_t startCount = textLength - needleLength + 1;
+    size_t i = 0;
+    for (; i + 8 <= startCount; i += 8) {
+        __m128i head = Load8(text + i);
+        __m128i tail = Load8(text + i + lastOffset);
+        unsigned mask = IsAscii8(_mm_or_si128(head, tail))
+            ? static_cast<unsigned>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi16(FoldAscii8(head), firstLanes),
+                                                                    _mm_cmpeq_epi16(FoldAscii8(tail), lastLanes))))
+            : ScalarCandidateMask(text + i, 8, first, last, lastOffset);
+        while (mask) {
+            unsigned lane = LowestBit(mask) / 2;
+            mask &= ~(3u << (2 * lane));
+            if (needleLength <= 2 || EqualsNoCaseSse2(text + i + lane + 1, needle + 1, needleLength - 2))
+                return i + lane;
+        }
+    }
+    for (; i < startCount; ++i) {
+        if (FoldCharNoCase(text[i]) == first && EqualsNoCaseSse2(text + i + 1, needle + 1, lastOffset))
+            return i;
+    }
+    return std::wstring::npos;
+}
+
+// -------------------------------------------------------------------------
+// AVX2: sixteen UTF-16 units per block
+// -------------------------------------------------------------------------
+TEXTMATCH_AVX2_TARGET static inline __m256i Load16(const wchar_t *p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+}
+
+TEXTMATCH_AVX2_TARGET static inline bool IsAscii16(__m256i v) {
+    __m256i high = _mm256_subs_epu16(v, _mm256_set1_epi16(0x7F));
+    return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi16(high, _mm256_setzero_si256()))) == 0xFFFFFFFFu;
+}
+
+TEXTMATCH_AVX2_TARGET static inline __m256i FoldAscii16(__m256i v) {
+    __m256i offset = _mm256_sub_epi16(v, _mm256_set1_epi16(L'A'));
+    __m256i upper = _mm256_cmpeq_epi16(_mm256_subs_epu16(offset, _mm256_set1_epi16(25)), _mm256_setzero_si256());
+    return _mm256_or_si256(v, _mm256_and_si256(upper, _mm256_set1_epi16(0x20)));
+}
+
+TEXTMATCH_AVX2_TARGET static bool EqualsNoCaseAvx2(const wchar_t *a, const wchar_t *b, size_t length) {
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m256i va = Load16(a + i);
+        __m256i vb = Load16(b + i);
+        if (static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi16(va, vb))) == 0xFFFFFFFFu)
+            continue;
+        if (!IsAscii16(_mm256_or_si256(va, vb))) {
+            if (!EqualsNoCaseScalar(a + i, b + i, 16))
+                return false;
+            continue;
+        }
+        if (static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi16(FoldAscii16(va), FoldAscii16(vb)))) != 0xFFFFFFFFu)
+            return false;
+    }
+    // Short remainders are common (titles are short); finish with SSE2.
+    return EqualsNoCaseSse2(a + i, b + i, length - i);
+}
+
+TEXTMATCH_AVX2_TARGET static size_t FindNoCaseAvx2(const wchar_t *text, size_t textLength, const wchar_t *needle, size_t needleLength) {
+    if (needleLength == 0)
+        return 0;
+    if (needleLength > textLength)
+        return std::wstring::npos;
+    size_t lastOffset = needleLength - 1;
+    wchar_t first = FoldCharNoCase(needle[0]);
+    wchar_t last = FoldCharNoCase(needle[lastOffset]);
+    __m256i firstLanes = _mm256_set1_epi16(static_cast<short>(first));
+    __m256i lastLanes = _mm256_set1_epi16(static_cast<short>(last));
+    size_t startCount = textLength - needleLength + 1;
+    size_t i = 0;
+    for (; i + 16 <= startCount; i += 16) {
+        __m256i head = Load16(text + i);
+        __m256i tail = Load16(text + i + lastOffset);
+        unsigned mask = IsAscii16(_mm256_or_si256(head, tail))
+            ? static_cast<unsigned>(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi16(FoldAscii16(head), firstLanes),
+                                                                          _mm256_cmpeq_epi16(FoldAscii16(tail), lastLanes))))
+            : ScalarCandidateMask(text + i, 16, first, last, lastOffset);
+        while (mask) {
+            unsigned lane = LowestBit(mask) / 2;
+            mask &= ~(3u << (2 * lane));
+            if (needleLength <= 2 || EqualsNoCaseAvx2(text + i + lane + 1, needle + 1, needleLength - 2))
+                return i + lane;
+        }
+    }
+    // Fewer than sixteen start positions left: continue at SSE2 width.
+    if (i == startCount)
+        return std::wstring::npos;
+    size_t rest = FindNoCaseSse2(text + i, textLength - i, needle, needleLength);
+    return (rest != std::wstring::npos) ? i + rest : rest;
+}
+
+// True if the CPU and the OS (saved YMM state) support AVX2.
+static bool CpuSupportsAvx2() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6)
+        return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+static bool UseAvx2() {
+    static const bool avx2 = CpuSupportsAvx2();
+    return avx2;
+}
+
+size_t FindNoCase(const wchar_t *text, size_t textLength, const wchar_t *needle, size_t needleLength) {
+    return UseAvx2() ? FindNoCaseAvx2(text, textLength, needle, needleLength)
+                     : FindNoCaseSse2(text, textLength, needle, needleLength);
+}
+
+bool EqualsNoCase(const wchar_t *a, const wchar_t *b, size_t length) {
+    return UseAvx2() ? EqualsNoCaseAvx2(a, b, length) : EqualsNoCaseSse2(a, b, length);
+}
+
+const char* GetTextMatchKernelName() {
+    return UseAvx2() ? "AVX2" : "SSE2";
+}
+
+#else // !TEXTMATCH_SIMD
+
+size_t FindNoCase(const wchar_t *text, size_t textLength, const wchar_t *needle, size_t needleLength) {
+    return FindNoCaseScalar(text, textLength, needle, needleLength);
+}
+
+bool EqualsNoCase(const wchar_t *a, const wchar_t *b, size_t length) {
+    return EqualsNoCaseScalar(a, b, length);
+}
+
+const char* GetTextMatchKernelName() {
+    return "scalar";
+}
+
+#endif // TEXTMATCH_SIMD
+
+// End of file: TextMatch.cpp (Version: 1.0)
@@ -0,0 +1,60 @@
+// File: TextMatch.h
+// Version: 1.0
+// -------------------------------------------------------------------------
+// This header declares the shared case-insensitive text matching helpers
+// used for window titles and fingerprints.
+//
+// Folding is towlower() per UTF-16 unit. A-Z are folded inline, which is
+// exactly what towlower() does for ASCII in the C locale the application
+// runs in; every other unit above 0x7F goes through towlower(). The matchers never copy or
+// lowercase their inputs. Blocks of pure ASCII text are compared eight (SSE2)
+// or sixteen (AVX2, selected at run time) characters at a time; a block
+// containing any non-ASCII unit falls back to the scalar path, so the
+// result is always the same as the scalar reference.
+// -------------------------------------------------------------------------
+
+#ifndef TEXTMATCH_H
+#define TEXTMATCH_H
+
+#include <windows.h>
+#include <string>
+#include <cwctype>
+
+// Case folding of one UTF-16 unit, as used by all matchers below.
+inline wchar_t FoldCharNoCase(wchar_t c) {
+    if (c < 0x80)
+        return (c >= L'A' && c <= L'Z') ? static_cast<wchar_t>(c + (L'a' - L'A')) : c;
+    return static_cast<wchar_t>(towlower(c));
+}
+
+// Returns the offset of the first case-insensitive occurrence of needle in
+// text, or std::wstring::npos. An empty needle is found at offset 0.
+size_t FindNoCase(const wchar_t *text, size_t textLength, const wchar_t *needle, size_t needleLength);
+
+// Case-insensitive equality of two ranges of the same length.
+bool EqualsNoCase(const wchar_t *a, const wchar_t *b, size_t length);
+
+inline bool ContainsNoCase(const wchar_t *text, size_t textLength, const std::wstring &needle) {
+    return FindNoCase(text, textLength, needle.c_str(), needle.size()) != std::wstring::npos;
+}
+inline bool ContainsNoCase(const std::wstring &text, const std::wstring &needle) {
+    return ContainsNoCase(text.c_str(), text.size(), needle);
+}
+inline bool EqualsNoCase(const std::wstring &a, const std::wstring &b) {
+    return a.size() == b.size() && EqualsNoCase(a.c_str(), b.c_str(), a.size());
+}
+
+// Lowercases text in place with FoldCharNoCase().
+void FoldNoCase(std::wstring &text);
+
+// Scalar reference implementations (used by the benchmark and for
+// platforms without SSE2).
+size_t FindNoCaseScalar(const wchar_t *text, size_t textLength, const wchar_t *needle, size_t needleLength);
+bool EqualsNoCaseScalar(const wchar_t *a, const wchar_t *b, size_t length);
+
+// Name of the vector path chosen at run time: "AVX2", "SSE2" or "scalar".
+const char* GetTextMatchKernelName();
+
+#endif // TEXTMATCH_H
+
+// End of file: TextMatch.h (Version: 1.0)
@@ -0,0 +1,146 @@
+// File: TitleMatcher.cpp
+// Version: 1.3
+// -------------------------------------------------------------------------
+// This file implements TitleMatcher (see TitleMatcher.h). Matching is
+// linear in the title length regardless of how many files are in the
+// project folder.
+// -------------------------------------------------------------------------
+
+#include "TitleMatcher.h"
+#include "TextMatch.h"     // For FoldCharNoCase()
+#include "WindowUtils.h"   // For StripLnkExtension()
+#include <algorithm>
+#include <queue>
+#include <cwctype>
+
+TitleMatcher::TitleMatcher() {
+    Build(std::vector<std::wstring>());
+}
+
+void TitleMatcher::Build(const std::vector<std::wstring> &fileNames) {
+    m_nodes.clear();
+    m_nodes.push_back(Node{ {}, 0, -1, {} });
+    m_fileNames = fileNames;
+    m_fileIndex.clear();
+
+    // Insert every normalized name into the trie.
+    for (int i = 0; i < static_cast<int>(fileNames.size()); ++i) {
+        m_fileIndex.emplace(fileNames[i], i);
+        // Titles show the file name, not the folders it is in.
+        std::wstring pattern = fileNames[i].substr(fileNames[i].find_last_of(L'\\') + 1);
+        FoldNoCase(pattern);
+        pattern = StripLnkExtension(pattern);
+        if (pattern.empty())
+            continue;
+        int state = 0;
+        for (wchar_t c : pattern) {
+            int next = Goto(state, c);
+            if (next < 0) {
+                next = static_cast<int>(m_nodes.size());
+                m_nodes.push_back(Node{ {}, 0, -1, {} });
+                auto &edges = m_nodes[state].next;
+                auto pos = std::lower_bound(edges.begin(), edges.end(), std::make_pair(c, 0));
+                edges.insert(pos, std::make_pair(c, next));
+            }
+            state = next;
+        }
+        m_nodes[state].out.push_back(i);
+    }
+
+    for (int c = 0; c < ROOT_DENSE_SIZE; ++c)
+        m_rootDense[c] = Goto(0, static_cast<wchar_t>(c));
+
+    // Breadth-first pass to compute failure and output links.
+    std::queue<int> pending;
+    for (const auto &edge : m_nodes[0].next) {
+        m_nodes[edge.second].fail = 0;
+        pending.push(edge.second);
+    }
+    while (!pending.empty()) {
+        int state = pending.front();
+        pending.pop();
+        for (const auto &edge : m_nodes[state].next) {
+            int child = edge.second;
+            int fail = m_nodes[state].fail;
+            while (fail != 0 && Goto(fail, edge.first) < 0)
+                fail = m_nodes[fail].fail;
+            int target = Goto(fail, edge.first);
+            m_nodes[child].fail = (target >= 0 && target != child) ? target : 0;
+            int f = m_nodes[child].fail;
+            m_nodes[child].outLink = !m_nodes[f].out.empty() ? f : m_nodes[f].outLink;
+            pending.push(child);
+        }
+    }
+}
+
+int TitleMatcher::GetFileIndex(const std::wstring &fileName) const {
+    auto it = m_fileIndex.find(fileName);
+    return (it != m_fileIndex.end()) ? it->second : -1;
+}
+
+int TitleMatcher::Goto(int state, wchar_t c) const {
+    const auto &edges = m_nodes[state].next;
+    auto pos = std::lower_bound(edges.begin(), edges.end(), std::make_pair(c, 0));
+    if (pos != edges.end() && pos->first == c)
+        return pos->second;
+    return -1;
+}
+
+int TitleMatcher::Step(int state, wchar_t c) const {
+    for (;;) {
+        int next = (state == 0 && c < ROOT_DENSE_SIZE) ? m_rootDense[c] : Goto(state, c);
+        if (next >= 0)
+            return next;
+        if (state == 0)
+            return 0;
+        state = m_nodes[state].fail;
+    }
+}
+
+template <typename Callback>
+void TitleMatcher::Scan(const wchar_t *title, size_t length, Callback onFile) const {
+    if (m_nodes.size() <= 1)
+        return;
+    int state = 0;
+    for (size_t i = 0; i < length; ++i) {
+        state = Step(state, FoldCharNoCase(title[i]));
+        for (int node = m_nodes[state].out.empty() ? m_nodes[state].outLink : state;
+             node > 0; node = m_nodes[node].outLink) {
+            for (int fileIndex : m_nodes[node].out)
+                onFile(fileIndex);
+        }
+    }
+}
+
+void TitleMatcher::FindMatches(const std::wstring &title, std::vector<int> &fileIndices) const {
+    size_t first = fileIndices.size();
+    Scan(title.c_str(), title.size(), [&fileIndices](int fileIndex) { fileIndices.push_back(fileIndex); });
+    std::sort(fileIndices.begin() + first, fileIndices.end());
+    fileIndices.erase(std::unique(fileIndices.begin() + first, fileIndices.end()), fileIndices.end());
+}
+
+void TitleMatcher::Match(const WindowTable &windows, TitleMatchResult &result) const {
+    int windowCount = windows.GetCount();
+    result.fileWindows.assign(m_fileNames.size(), nullptr);
+    // Shrinking or growing keeps the inner vectors of the rows that remain.
+    result.windowFiles.resize(windowCount);
+
+    // Per-file stamp of the last window that reported it, to keep matches unique.
+    m_lastWindow.assign(m_fileNames.size(), -1);
+    for (int w = 0; w < windowCount; ++w) {
+        std::vector<int> &files = result.windowFiles[w];
+        files.clear();
+        Scan(windows.GetTitle(w), windows.GetTitleLength(w), [&](int fileIndex) {
+            if (m_lastWindow[fileIndex] == w)
+                return;
+            m_lastWindow[fileIndex] = w;
+            files.push_back(fileIndex);
+            if (!result.fileWindows[fileIndex])
+                result.fileWindows[fileIndex] = windows.GetHwnd(w);
+        });
+        // Report associated files in folder order, like the old per-file loop did.
+        std::sort(files.begin(), files.end());
+    }
+}
+
+// End of file: TitleMatcher.cpp (Version: 1.3)
@@ -0,0 +1,94 @@
+// File: TitleMatcher.h
+// Version: 1.3
+// -------------------------------------------------------------------------
+// This header declares TitleMatcher, a multi-pattern matcher that finds
+// which project files appear in which window titles.
+//
+// The matcher is an Aho-Corasick automaton built once from the lowercased,
+// StripLnkExtension-normalized file names. It is rebuilt only when the
+// folder contents change, and a single Match() pass over a window snapshot
+// produces both the file -> window and window -> associated files maps
+// that previously required one EnumWindows per file.
+//
+// Changes in Version 1.3:
+//  - The pattern of a name in a subfolder ("Drafts\Report.docx") is its last
+//    path component, the part a window title shows.
+// Changes in Version 1.2:
+//  - Patterns and titles are folded with FoldCharNoCase() (TextMatch.h), the
+//    same folding as the other title matchers; ASCII skips towlower().
+// Changes in Version 1.1:
+//  - Match() reads titles from a WindowTable and refills a caller-owned
+//    result, so repeated passes reuse its vectors instead of allocating.
+// -------------------------------------------------------------------------
+
+#ifndef TITLEMATCHER_H
+#define TITLEMATCHER_H
+
+#include <windows.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include "WindowTable.h"  // For WindowTable
+
+/**
+ * @struct TitleMatchResult
+ * @brief Result of matching every file name against every window title.
+ */
+struct TitleMatchResult {
+    std::vector<HWND> fileWindows;             ///< Per file index: first window (z-order) containing the name, or nullptr.
+    std::vector<std::vector<int>> windowFiles; ///< Per window index: indices of the files found in its title.
+};
+
+class TitleMatcher {
+public:
+    TitleMatcher();
+
+    // Rebuilds the automaton from the given file names (as shown in the lists).
+    void Build(const std::vector<std::wstring> &fileNames);
+
+    // Number of files the matcher was built from.
+    int GetFileCount() const { return static_cast<int>(m_fileNames.size()); }
+
+    // File name for a file index, as passed to Build().
+    const std::wstring& GetFileName(int fileIndex) const { return m_fileNames[fileIndex]; }
+
+    // Returns the file index for a file name, or -1 if it is unknown.
+    int GetFileIndex(const std::wstring &fileName) const;
+
+    // Appends the indices of all files whose name occurs in title (each at most once).
+    void FindMatches(const std::wstring &title, std::vector<int> &fileIndices) const;
+
+    // Matches all windows of a snapshot in a single pass, overwriting result.
+    void Match(const WindowTable &windows, TitleMatchResult &result) const;
+
+private:
+    struct Node {
+        std::vector<std::pair<wchar_t, int>> next; ///< Goto edges, sorted by character.
+        int fail;                                  ///< Failure link.
+        int outLink;                               ///< Nearest node on the failure chain with output, or -1.
+        std::vector<int> out;                      ///< File indices whose pattern ends at this node.
+    };
+
+    // Returns the goto target of state for c, or -1 if there is no edge.
+    int Goto(int state, wchar_t c) const;
+
+    // Advances the automaton by one (already lowercased) character.
+    int Step(int state, wchar_t c) const;
+
+    // Scans title and calls onFile(fileIndex) for every pattern occurrence.
+    template <typename Callback>
+    void Scan(const wchar_t *title, size_t length, Callback onFile) const;
+
+    static const int ROOT_DENSE_SIZE = 128;  ///< Root edges for ASCII are kept in a dense table.
+
+    std::vector<Node> m_nodes;
+    int m_rootDense[ROOT_DENSE_SIZE];
+    std::vector<std::wstring> m_fileNames;
+    std::unordered_map<std::wstring, int> m_fileIndex;
+    mutable std::vector<int> m_lastWindow;  ///< Match() scratch: last window index per file.
+};
+
+#endif // TITLEMATCHER_H
+
+// End of file: TitleMatcher.h (Version: 1.3)
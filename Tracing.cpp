@@ -0,0 +1,158 @@
+// File: Tracing.cpp
+// Version: 1.1
+// -------------------------------------------------------------------------
+// This file implements the TraceLogging provider declared in Tracing.h.
+// TraceLogging only needs advapi32.lib; no manifest is registered.
+//
+// Changes in Version 1.1:
+//  - Added the StartupMilestone event.
+// -------------------------------------------------------------------------
+
+#include "Tracing.h"
+#include <winmeta.h>
+#include <TraceLoggingProvider.h>
+
+TRACELOGGING_DEFINE_PROVIDER(
+    g_traceProvider,
+    "MYexplorer",
+    // {1febfbd8-60f2-5707-48a4-0ac885ee79f7}, derived from the provider name.
+    (0x1febfbd8, 0x60f2, 0x5707, 0x48, 0xa4, 0x0a, 0xc8, 0x85, 0xee, 0x79, 0xf7));
+
+static LONGLONG GetCounter() {
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return counter.QuadPart;
+}
+
+// Microseconds since activity.start.
+static ULONGLONG GetDurationUs(const TraceActivity &activity) {
+    static const LONGLONG frequency = [] {
+        LARGE_INTEGER f;
+        QueryPerformanceFrequency(&f);
+        return f.QuadPart;
+    }();
+    return static_cast<ULONGLONG>((GetCounter() - activity.start) * 1000000 / frequency);
+}
+
+void RegisterTracing() {
+    TraceLoggingRegister(g_traceProvider);
+}
+
+void UnregisterTracing() {
+    TraceLoggingUnregister(g_traceProvider);
+}
+
+bool IsTracingEnabled() {
+    return TraceLoggingProviderEnabled(g_traceProvider, 0, 0);
+}
+
+// Event names must be string literals, so every phase has its own write.
+#define TRACE_PHASE_START(name) \
+    TraceLoggingWriteActivity(g_traceProvider, name, &activity.id, nullptr, \
+                              TraceLoggingOpcode(WINEVENT_OPCODE_START))
+
+void TraceStart(TraceActivity &activity, TracePhase phase) {
+    activity.active = false;
+    if (!IsTracingEnabled())
+        return;
+    if (EventActivityIdControl(EVENT_ACTIVITY_CTRL_CREATE_ID, &activity.id) != ERROR_SUCCESS)
+        return;
+    activity.start = GetCounter();
+    activity.active = true;
+    switch (phase) {
+    case TracePhase::DirectoryScan:      TRACE_PHASE_START("DirectoryScan"); break;
+    case TracePhase::WindowSweep:        TRACE_PHASE_START("WindowSweep"); break;
+    case TracePhase::ProcessLookup:      TRACE_PHASE_START("ProcessLookup"); break;
+    case TracePhase::Snapshot:           TRACE_PHASE_START("Snapshot"); break;
+    case TracePhase::TitleMatch:         TRACE_PHASE_START("TitleMatch"); break;
+    case TracePhase::ListViewUpdate:     TRACE_PHASE_START("ListViewUpdate"); break;
+    case TracePhase::Launch:             TRACE_PHASE_START("Launch"); break;
+    case TracePhase::WebViewEnvironment: TRACE_PHASE_START("WebViewEnvironment"); break;
+    case TracePhase::WebViewController:  TRACE_PHASE_START("WebViewController"); break;
+    }
+}
+
+#define TRACE_PHASE_STOP(name, ...) \
+    TraceLoggingWriteActivity(g_traceProvider, name, &activity.id, nullptr, \
+                              TraceLoggingOpcode(WINEVENT_OPCODE_STOP), \
+                              TraceLoggingUInt64(GetDurationUs(activity), "DurationUs"), \
+                              __VA_ARGS__)
+
+void TraceDirectoryScanStop(TraceActivity &activity, UINT files) {
+    if (!activity.active)
+        return;
+    activity.active = false;
+    TRACE_PHASE_STOP("DirectoryScan", TraceLoggingUInt32(files, "Files"));
+}
+
+void TraceWindowSweepStop(TraceActivity &activity, UINT windows, ULONGLONG processCacheHits, ULONGLONG processCacheMisses) {
+    if (!activity.active)
+        return;
+    activity.active = false;
+    TRACE_PHASE_STOP("WindowSweep", TraceLoggingUInt32(windows, "Windows"),
+                     TraceLoggingUInt64(processCacheHits, "ProcessCacheHits"),
+                     TraceLoggingUInt64(processCacheMisses, "ProcessCacheMisses"));
+}
+
+void TraceProcessLookupStop(TraceActivity &activity, DWORD processId, bool resolved) {
+    if (!activity.active)
+        return;
+    activity.active = false;
+    TRACE_PHASE_STOP("ProcessLookup", TraceLoggingUInt32(processId, "ProcessId"),
+                     TraceLoggingBool(resolved, "Resolved"));
+}
+
+void TraceSnapshotStop(TraceActivity &activity, UINT windows, UINT tracked, UINT fingerprintHits, UINT fingerprintMisses) {
+    if (!activity.active)
+        return;
+    activity.active = false;
+    TRACE_PHASE_STOP("Snapshot", TraceLoggingUInt32(windows, "Windows"), TraceLoggingUInt32(tracked, "Tracked"),
+                     TraceLoggingUInt32(fingerprintHits, "FingerprintCacheHits"),
+                     TraceLoggingUInt32(fingerprintMisses, "FingerprintCacheMisses"));
+}
+
+void TraceTitleMatchStop(TraceActivity &activity, UINT windows, UINT files, UINT matchedWindows) {
+    if (!activity.active)
+        return;
+    activity.active = false;
+    TRACE_PHASE_STOP("TitleMatch", TraceLoggingUInt32(windows, "Windows"), TraceLoggingUInt32(files, "Files"),
+                     TraceLoggingUInt32(matchedWindows, "MatchedWindows"));
+}
+
+void TraceListViewUpdateStop(TraceActivity &activity, UINT panel, UINT rows) {
+    if (!activity.active)
+        return;
+    activity.active = false;
+    TRACE_PHASE_STOP("ListViewUpdate", TraceLoggingUInt32(panel, "Panel"), TraceLoggingUInt32(rows, "Rows"));
+}
+
+void TraceLaunchStop(TraceActivity &activity, bool launched, bool windowFound) {
+    if (!activity.active)
+        return;
+    activity.active = false;
+    TRACE_PHASE_STOP("Launch", TraceLoggingBool(launched, "Launched"), TraceLoggingBool(windowFound, "WindowFound"));
+}
+
+void TraceWebViewEnvironmentStop(TraceActivity &activity, HRESULT result) {
+    if (!activity.active)
+        return;
+    activity.active = false;
+    TRACE_PHASE_STOP("WebViewEnvironment", TraceLoggingHResult(result, "Result"));
+}
+
+void TraceWebViewControllerStop(TraceActivity &activity, HRESULT result) {
+    if (!activity.active)
+        return;
+    activity.active = false;
+    TRACE_PHASE_STOP("WebViewController", TraceLoggingHResult(result, "Result"));
+}
+
+void TraceStartupMilestone(const wchar_t *milestone, ULONGLONG sinceProcessStartUs) {
+    if (!IsTracingEnabled())
+        return;
+    TraceLoggingWrite(g_traceProvider, "StartupMilestone",
+                      TraceLoggingWideString(milestone, "Milestone"),
+                      TraceLoggingUInt64(sinceProcessStartUs, "SinceProcessStartUs"));
+}
+
+// End of file: Tracing.cpp (Version: 1.1)
@@ -0,0 +1,89 @@
+// File: Tracing.h
+// Version: 1.1
+// -------------------------------------------------------------------------
+// This header declares MYexplorer's ETW instrumentation: a TraceLogging
+// provider named "MYexplorer" ({1febfbd8-60f2-5707-48a4-0ac885ee79f7}, the
+// name-derived GUID, so "*MYexplorer" works in WPR/tracelog profiles).
+//
+// Every phase is a pair of events with the START and STOP opcodes that share
+// an activity ID, so WPA shows them as regions; the stop event carries the
+// phase's duration in microseconds and its counters. The phases are:
+//
+//   DirectoryScan       full listing of the project folder (files)
+//   WindowSweep         consistency sweep (windows, process cache hits/misses)
+//   ProcessLookup       one process cache miss (OpenProcess + image name)
+//   Snapshot            snapshot capture (windows, tracked, fingerprint hits/misses)
+//   TitleMatch          one matcher pass (windows, files, windows with matches)
+//   ListViewUpdate      one panel refresh (panel, rows)
+//   Launch              ShellExecuteEx until the file's window appeared (window found)
+//   WebViewEnvironment  CreateCoreWebView2EnvironmentWithOptions until its callback
+//   WebViewController   CreateCoreWebView2Controller until its callback
+//
+// A Trace*Start() costs one check of the provider's enablement when no
+// session listens, and the matching Trace*Stop() returns at once if the
+// start was not written. The inputs of a stop event (counts) are cheap
+// values the caller has anyway.
+//
+// Startup milestones are single events (StartupMilestone, with the milestone
+// name and the microseconds since the process was created); see
+// StartupMetrics.h.
+//
+// Changes in Version 1.1:
+//  - Added TraceStartupMilestone().
+// -------------------------------------------------------------------------
+
+#ifndef TRACING_H
+#define TRACING_H
+
+#include <windows.h>
+
+enum class TracePhase {
+    DirectoryScan,
+    WindowSweep,
+    ProcessLookup,
+    Snapshot,
+    TitleMatch,
+    ListViewUpdate,
+    Launch,
+    WebViewEnvironment,
+    WebViewController
+};
+
+/**
+ * @struct TraceActivity
+ * @brief One started phase; lives until its stop event is written.
+ */
+struct TraceActivity {
+    GUID id;
+    LONGLONG start;     ///< QueryPerformanceCounter() at the start event.
+    bool active;        ///< The start event was written.
+    TraceActivity() : id(), start(0), active(false) {}
+};
+
+// Registers the provider (once per process, before any event) and unregisters it.
+void RegisterTracing();
+void UnregisterTracing();
+
+// True while a session listens to the provider.
+bool IsTracingEnabled();
+
+// Writes the start event of phase if a session listens.
+void TraceStart(TraceActivity &activity, TracePhase phase);
+
+// Stop events; each writes nothing unless its activity was started.
+void TraceDirectoryScanStop(TraceActivity &activity, UINT files);
+void TraceWindowSweepStop(TraceActivity &activity, UINT windows, ULONGLONG processCacheHits, ULONGLONG processCacheMisses);
+void TraceProcessLookupStop(TraceActivity &activity, DWORD processId, bool resolved);
+void TraceSnapshotStop(TraceActivity &activity, UINT windows, UINT tracked, UINT fingerprintHits, UINT fingerprintMisses);
+void TraceTitleMatchStop(TraceActivity &activity, UINT windows, UINT files, UINT matchedWindows);
+void TraceListViewUpdateStop(TraceActivity &activity, UINT panel, UINT rows);
+void TraceLaunchStop(TraceActivity &activity, bool launched, bool windowFound);
+void TraceWebViewEnvironmentStop(TraceActivity &activity, HRESULT result);
+void TraceWebViewControllerStop(TraceActivity &activity, HRESULT result);
+
+// Writes a StartupMilestone event if a session listens.
+void TraceStartupMilestone(const wchar_t *milestone, ULONGLONG sinceProcessStartUs);
+
+#endif // TRACING_H
+
+// End of file: Tracing.h (Version: 1.1)
@@ -0,0 +1,42 @@
+// File: TrackedWindow.h
+// Version: 1.1
+// -------------------------------------------------------------------------
+// This header defines TrackedWindow, the window fingerprint stored for each
+// tracked file. It was moved out of MainWindow.h so that worker-side code
+// (WindowSnapshotWorker, FingerprintUtils) can use it without depending on
+// the main window.
+//
+// Changes in Version 1.1:
+//  - The class name is stored as an interned ID (see InternClassName() in
+//    FingerprintUtils.h); title and class carry precomputed 64-bit hashes
+//    of their lowercased text for cheap comparisons.
+// -------------------------------------------------------------------------
+
+#ifndef TRACKEDWINDOW_H
+#define TRACKEDWINDOW_H
+
+#include <windows.h>
+#include <string>
+
+/**
+ * @struct TrackedWindow
+ * @brief Extended fingerprint for a tracked window.
+ *
+ * Contains process ID, window handle, geometry, interned class name, window
+ * title with hashes, a failure counter, and the launch time.
+ */
+struct TrackedWindow {
+    DWORD processId;
+    HWND hwnd;
+    RECT rect;
+    UINT classId;          ///< Interned class name; GetInternedClassName() returns the text.
+    ULONGLONG classHash;   ///< HashNormalized() of the class name.
+    std::wstring windowTitle;
+    ULONGLONG titleHash;   ///< HashNormalized() of windowTitle.
+    int failCount;         ///< Initialized to 0 when a new entry is added.
+    ULONGLONG launchTime;  ///< Timestamp (in ms) when the window was first captured.
+};
+
+#endif // TRACKEDWINDOW_H
+
+// End of file: TrackedWindow.h (Version: 1.1)
@@ -0,0 +1,559 @@
+// File: TrackerEngine.cpp
+// Version: 1.14
+// -------------------------------------------------------------------------
+// This file implements TrackerEngine (see TrackerEngine.h). The logic was
+// moved here from MainWindow, which now only renders the engine's state.
+//
+// Changes in Version 1.14:
+//  - Stop() also frees loaded tracking entries that were posted but not handled.
+// Changes in Version 1.13:
+//  - Stop() frees query activation batches that were posted but not handled.
+// Changes in Version 1.12:
+//  - GetFrecencyScores() indexes the scores by the query name table, not the
+//    directory index, whose order differs while file list rebuilds are deferred.
+// Changes in Version 1.11:
+//  - OnDirectoryChanged() coalesces the rebuilds of a streaming listing.
+// Changes in Version 1.10:
+//  - Title matcher indices are looked up by the file's name (DirectoryIndex::
+//    GetName()) rather than its leaf, so same-named files in different
+//    folders no longer share a window state.
+// Changes in Version 1.9:
+//  - OpenFile() records every activation in the frecency table, which is
+//    read from and written to FRECENCY_FILE by Start() and Stop().
+// Changes in Version 1.8:
+//  - Lists all PROJECT_ROOTS; names under other roots are full paths.
+// Changes in Version 1.7:
+//  - Start() opens the window history's segment file HISTORY_FILE.
+// Changes in Version 1.6:
+//  - Start() no longer lists the project folder; the file list starts empty
+//    and is filled by the directory thread's first Reset.
+// Changes in Version 1.5:
+//  - Tracking changes are appended to the TrackingJournal as they happen;
+//    tracking.dat is loaded and written by the journal's thread, not saved
+//    in Stop().
+// Changes in Version 1.4:
+//  - Title matching is traced as the TitleMatch phase (Tracing.h).
+// Changes in Version 1.3:
+//  - OpenFile() goes through the ActivationService resolution cache.
+// Changes in Version 1.2:
+//  - Opens the window event ring and hands it the file IDs of the project files.
+// Changes in Version 1.1:
+//  - Added the query server: PublishQueryIndex() and WM_APP_QUERY_ACTIVATE.
+// -------------------------------------------------------------------------
+
+#include "TrackerEngine.h"
+#include "FingerprintUtils.h"  // For GetFingerprint() and CompareStableAttributes()
+#include "WindowUtils.h"       // For GetWindowHandleByFileName()
+#include "WorkspaceLayout.h"   // For ApplyWorkspaceLayout()
+#include "TextMatch.h"         // For FoldNoCase()
+#include "Tracing.h"
+#include "Config.h"
+#include <algorithm>
+#include <climits>
+#include <memory>
+
+// Brings a tracked window to the foreground, restoring it if minimized.
+static void ActivateTrackedWindow(const TrackedWindow &tw) {
+    if (IsIconic(tw.hwnd))
+        ShowWindow(tw.hwnd, SW_RESTORE);
+    SetForegroundWindow(tw.hwnd);
+}
+
+TrackerEngine::TrackerEngine()
+    : m_hwndNotify(nullptr)
+    , m_listener(nullptr)
+    , m_started(false)
+    , m_folderAvailable(false)
+    , m_eventRingOpen(false)
+    , m_hasSnapshot(false)
+    , m_fileListDeferred(false)
+    , m_rehydrationPending(false)
+    , m_trackingResolved(false)
+    , m_titleMatcher(std::make_shared<TitleMatcher>())
+    , m_matchesStale(true)
+    , m_frecencyScoresGeneration(0)
+{
+}
+
+TrackerEngine::~TrackerEngine() {
+    Stop();
+}
+
+std::wstring TrackerEngine::GetFilePath(const std::wstring &fileName) {
+    std::wstring filePath;
+    GetFilePath(fileName, filePath);
+    return filePath;
+}
+
+void TrackerEngine::GetFilePath(const std::wstring &fileName, std::wstring &filePath) {
+    if (DirectoryIndex::IsFullPath(fileName)) {
+        filePath.assign(fileName);
+        return;
+    }
+    filePath.assign(PROJECT_FOLDER);
+    filePath += L'\\';
+    filePath += fileName;
+}
+
+bool TrackerEngine::Start(HWND hwndNotify, TrackerEngineListener *listener) {
+    if (m_started)
+        return true;
+    m_hwndNotify = hwndNotify;
+    m_listener = listener;
+    m_hasSnapshot = false;
+    m_rehydrationPending = false;
+    m_trackingResolved = false;
+    // A missing or unreadable file just starts the ranking over.
+    m_frecency.Load(FRECENCY_FILE);
+    // The listing arrives in batches as WM_APP_DIRECTORY_CHANGED; until then the file list is empty.
+    m_folderAvailable = m_directoryIndex.Start(PROJECT_ROOTS, hwndNotify, WM_APP_DIRECTORY_CHANGED);
+    RebuildFileList();
+    // tracking.dat and its journal are read on the journal's thread; the entries
+    // arrive as WM_APP_TRACKING_LOADED and are resolved against a window
+    // snapshot, so startup does not enumerate the desktop per entry.
+    // Without the journal thread nothing is loaded or persisted.
+    m_trackingResolved = !m_journal.Start(TRACKING_FILE, TRACKING_JOURNAL_FILE, hwndNotify, WM_APP_TRACKING_LOADED);
+    m_eventRingOpen = m_snapshotWorker.OpenEventRing(WINDOW_EVENT_RING_NAME, WINDOW_EVENT_RING_SLOTS);
+    // Without the file the history still answers from the blocks in memory.
+    m_snapshotWorker.OpenHistory(HISTORY_FILE);
+    bool monitoring = m_snapshotWorker.Start(hwndNotify, WM_APP_SNAPSHOT_READY);
+    m_launchService.Start(hwndNotify, WM_APP_LAUNCH_COMPLETE);
+    // Without the pipe (e.g. a second instance owns it) the engine works as before.
+    if (m_queryServer.Start(hwndNotify, WM_APP_QUERY_ACTIVATE))
+        PublishQueryIndex();
+    m_started = true;
+    return monitoring;
+}
+
+void TrackerEngine::Stop() {
+    if (!m_started)
+        return;
+    m_started = false;
+    m_queryServer.Stop();
+    m_snapshotWorker.Stop();
+    m_directoryIndex.Stop();
+    m_launchService.Stop();
+    // Every change is already queued; this commits the last group. Entries that
+    // were never rehydrated stay in the journal as they were.
+    m_journal.Stop();
+    m_frecency.Save(FRECENCY_FILE);
+    // The workers are stopped, so nothing is posted any more. Batches still queued
+    // for the window would be discarded with it; the payloads are ours to free.
+    MSG msg;
+    while (PeekMessage(&msg, m_hwndNotify, WM_APP_QUERY_ACTIVATE, WM_APP_QUERY_ACTIVATE, PM_REMOVE))
+        delete reinterpret_cast<QueryActivation*>(msg.lParam);
+    while (PeekMessage(&msg, m_hwndNotify, WM_APP_TRACKING_LOADED, WM_APP_TRACKING_LOADED, PM_REMOVE))
+        delete reinterpret_cast<std::vector<StoredTrackedWindow>*>(msg.lParam);
+}
+
+bool TrackerEngine::HandleMessage(UINT uMsg, WPARAM wParam, LPARAM lParam) {
+    switch (uMsg) {
+    case WM_APP_SNAPSHOT_READY:
+        OnSnapshotReady();
+        return true;
+
+    case WM_APP_DIRECTORY_CHANGED:
+        // DirectoryIndex posts this once per ApplyPendingChanges().
+        OnDirectoryChanged();
+        return true;
+
+    case WM_APP_LAUNCH_COMPLETE: {
+            // LaunchService hands over ownership of the result.
+            std::unique_ptr<LaunchResult> result(reinterpret_cast<LaunchResult*>(lParam));
+            OnLaunchComplete(*result);
+        }
+        return true;
+
+    case WM_APP_QUERY_ACTIVATE: {
+            // QueryServer hands over ownership of the batch.
+            std::unique_ptr<QueryActivation> activation(reinterpret_cast<QueryActivation*>(lParam));
+            for (const auto &fileName : activation->fileNames)
+                OpenFile(GetFilePath(fileName));
+        }
+        return true;
+
+    case WM_APP_TRACKING_LOADED: {
+            // TrackingJournal hands over ownership of the entries.
+            std::unique_ptr<std::vector<StoredTrackedWindow>> entries(reinterpret_cast<std::vector<StoredTrackedWindow>*>(lParam));
+            if (m_started)
+                OnTrackingLoaded(*entries);
+        }
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+// -------------------------------------------------------------------------
+// Snapshots
+// -------------------------------------------------------------------------
+void TrackerEngine::OnSnapshotReady() {
+    // Use only the newest snapshot; older unused ones were already recycled.
+    if (!m_snapshotWorker.TakeLatest())
+        return;
+    m_hasSnapshot = true;
+    if (m_rehydrationPending)
+        RehydrateStoredWindows();
+    UpdateTrackedFingerprints();
+    SyncTrackedWindows();
+    m_matchesStale = true;
+    PublishQueryIndex();
+    if (m_listener)
+        m_listener->OnSnapshotUpdated();
+}
+
+void TrackerEngine::OnTrackingLoaded(std::vector<StoredTrackedWindow> &entries) {
+    m_storedTrackedWindows.swap(entries);
+    m_rehydrationPending = true;
+    if (!m_hasSnapshot)
+        return; // Resolved against the first snapshot.
+    RehydrateStoredWindows();
+    SyncTrackedWindows();
+    PublishQueryIndex();
+    if (m_listener)
+        m_listener->OnSnapshotUpdated();
+}
+
+void TrackerEngine::RehydrateStoredWindows() {
+    RehydrateTrackingMapping(m_storedTrackedWindows, GetSnapshot().windows, m_fileWindowMap);
+    // Resolved entries carry their new window; the others are dropped.
+    for (const auto &entry : m_storedTrackedWindows) {
+        auto it = m_fileWindowMap.find(entry.filePath);
+        if (it != m_fileWindowMap.end())
+            m_journal.AppendUpsert(it->first, it->second);
+        else
+            m_journal.AppendRemove(entry.filePath);
+    }
+    std::vector<StoredTrackedWindow>().swap(m_storedTrackedWindows);
+    m_rehydrationPending = false;
+    m_trackingResolved = true;
+}
+
+void TrackerEngine::UpdateTrackedFingerprints() {
+    // Fingerprints were refreshed on the snapshot worker; nothing here talks
+    // to other processes' windows.
+    const WindowSnapshot &snapshot = GetSnapshot();
+    for (auto &pair : m_fileWindowMap) {
+        const TrackedWindowStatus *status = snapshot.FindTracked(pair.second.hwnd);
+        if (status && status->alive && !CompareStableAttributes(pair.second, status->fingerprint)) {
+            pair.second = status->fingerprint;
+            m_journal.AppendUpsert(pair.first, pair.second);
+        }
+    }
+}
+
+void TrackerEngine::SyncTrackedWindows() {
+    m_scratchHwnds.clear();
+    for (const auto &pair : m_fileWindowMap)
+        m_scratchHwnds.push_back(pair.second.hwnd);
+    m_snapshotWorker.SetTrackedWindows(m_scratchHwnds);
+}
+
+void TrackerEngine::PublishQueryIndex() {
+    if (!m_queryServer.IsRunning() || !m_queryFiles)
+        return;
+    // Built here so that the server thread answers without touching the
+    // engine; the index is immutable once published.
+    const WindowSnapshot &snapshot = GetSnapshot();
+    const TitleMatchResult &matches = GetMatches();
+    std::shared_ptr<QueryIndex> index = std::make_shared<QueryIndex>();
+    index->generation = snapshot.generation;
+    index->files = m_queryFiles;
+    index->states.assign(m_fileNames.size(), QueryIndex::FileState{ nullptr, 0, RECT{}, nullptr });
+    for (size_t i = 0; i < index->states.size() && i < matches.fileWindows.size(); ++i) {
+        int row = matches.fileWindows[i] ? snapshot.FindWindowIndex(matches.fileWindows[i]) : -1;
+        if (row >= 0)
+            index->states[i] = { snapshot.windows.GetHwnd(row), snapshot.windows.GetPid(row),
+                                 snapshot.windows.GetRect(row), snapshot.GetStateText(row) };
+    }
+    // A live tracked window wins over the first title match, as in GetFileState().
+    for (const auto &pair : m_fileWindowMap) {
+        const TrackedWindowStatus *status = snapshot.FindTracked(pair.second.hwnd);
+        if (!status || !status->alive)
+            continue;
+        int fileIndex = GetFileIndex(pair.first);
+        if (fileIndex >= 0 && fileIndex < static_cast<int>(index->states.size()))
+            index->states[fileIndex] = { status->hwnd, status->fingerprint.processId,
+                                         status->fingerprint.rect, status->state };
+    }
+    for (size_t row = 0; row < matches.windowFiles.size(); ++row) {
+        const std::vector<int> &files = matches.windowFiles[row];
+        if (files.empty())
+            continue;
+        index->windows.push_back({ snapshot.windows.GetHwnd(static_cast<int>(row)),
+                                   static_cast<UINT>(index->fileIndices.size()), static_cast<UINT>(files.size()) });
+        index->fileIndices.insert(index->fileIndices.end(), files.begin(), files.end());
+    }
+    std::sort(index->windows.begin(), index->windows.end(),
+              [](const QueryIndex::WindowFiles &a, const QueryIndex::WindowFiles &b) { return a.hwnd < b.hwnd; });
+    m_queryServer.Publish(std::move(index));
+}
+
+const TitleMatchResult& TrackerEngine::GetMatches() {
+    // One matcher pass per snapshot, however many views ask.
+    if (m_matchesStale) {
+        TraceActivity activity;
+        TraceStart(activity, TracePhase::TitleMatch);
+        m_titleMatcher->Match(GetSnapshot().windows, m_matches);
+        m_matchesStale = false;
+        if (activity.active) {
+            UINT matchedWindows = 0;
+            for (const auto &files : m_matches.windowFiles)
+                matchedWindows += files.empty() ? 0 : 1;
+            TraceTitleMatchStop(activity, static_cast<UINT>(m_matches.windowFiles.size()),
+                                static_cast<UINT>(m_fileNames.size()), matchedWindows);
+        }
+    }
+    return m_matches;
+}
+
+int TrackerEngine::GetFileIndex(const std::wstring &filePath) const {
+    // The matcher is keyed by the file name, which carries the folders (and,
+    // under the other roots, the whole path); the leaf alone is ambiguous.
+    std::wstring name = m_directoryIndex.GetName(filePath);
+    return name.empty() ? -1 : m_titleMatcher->GetFileIndex(name);
+}
+
+const wchar_t* TrackerEngine::GetFileState(const std::wstring &fileName) {
+    const WindowSnapshot &snapshot = GetSnapshot();
+    GetFilePath(fileName, m_scratchPath);
+    auto it = m_fileWindowMap.find(m_scratchPath);
+    const TrackedWindowStatus *status = (it != m_fileWindowMap.end()) ? snapshot.FindTracked(it->second.hwnd) : nullptr;
+    if (status && status->alive)
+        return status->state;
+    const TitleMatchResult &matches = GetMatches();
+    int fileIndex = m_titleMatcher->GetFileIndex(fileName);
+    if (fileIndex >= 0 && fileIndex < static_cast<int>(matches.fileWindows.size())) {
+        int windowIndex = snapshot.FindWindowIndex(matches.fileWindows[fileIndex]);
+        if (windowIndex >= 0)
+            return snapshot.GetStateText(windowIndex);
+    }
+    return nullptr;
+}
+
+// -------------------------------------------------------------------------
+// Project folder
+// -------------------------------------------------------------------------
+void TrackerEngine::RebuildFileList() {
+    m_fileNames.clear();
+    m_fileNames.reserve(m_directoryIndex.GetEntries().size());
+    for (const auto &entry : m_directoryIndex.GetEntries())
+        m_fileNames.push_back(entry.name);
+    // The worker may still be matching titles with the previous matcher.
+    std::shared_ptr<TitleMatcher> matcher = std::make_shared<TitleMatcher>();
+    matcher->Build(m_fileNames);
+    m_titleMatcher = matcher;
+    m_matchesStale = true;
+
+    std::shared_ptr<WindowEventFiles> eventFiles = std::make_shared<WindowEventFiles>();
+    eventFiles->matcher = matcher;
+    eventFiles->ids.reserve(m_fileNames.size());
+    for (const auto &name : m_fileNames)
+        eventFiles->ids.push_back(WindowEventFileId(name.c_str(), name.size()));
+    m_snapshotWorker.SetEventFiles(std::move(eventFiles));
+
+    std::shared_ptr<QueryFileTable> queryFiles = std::make_shared<QueryFileTable>();
+    queryFiles->names = m_fileNames;
+    std::wstring folded;
+    for (size_t i = 0; i < m_fileNames.size(); ++i) {
+        folded = m_fileNames[i];
+        FoldNoCase(folded);
+        queryFiles->byFoldedName.emplace(folded, static_cast<UINT>(i));
+    }
+    m_queryFiles = std::move(queryFiles);
+    m_frecencyScores.reset(); // Indexed by the old file list.
+}
+
+std::shared_ptr<const std::vector<std::wstring>> TrackerEngine::GetFileNameTable() const {
+    if (!m_queryFiles)
+        return nullptr;
+    // Shares the query server's copy instead of making another one.
+    return std::shared_ptr<const std::vector<std::wstring>>(m_queryFiles, &m_queryFiles->names);
+}
+
+std::shared_ptr<const std::vector<float>> TrackerEngine::GetFrecencyScores() {
+    if (m_frecencyScores && m_frecencyScoresGeneration == m_frecency.GetGeneration())
+        return m_frecencyScores;
+    if (!m_queryFiles)
+        return nullptr;
+    std::shared_ptr<std::vector<float>> scores = std::make_shared<std::vector<float>>(m_queryFiles->names.size(), 0.0f);
+    // Indexed like the name table the searcher ranks (GetFileNameTable()), which lags
+    // the directory index while a listing's rebuilds are deferred.
+    std::wstring folded;
+    m_frecency.ForEach(FrecencyTable::FrecencyNow(), [&](const std::wstring &filePath, double score) {
+        folded = m_directoryIndex.GetName(filePath);
+        if (folded.empty())
+            return;
+        FoldNoCase(folded);
+        auto it = m_queryFiles->byFoldedName.find(folded);
+        if (it != m_queryFiles->byFoldedName.end() && it->second < scores->size())
+            (*scores)[it->second] = static_cast<float>(score);
+    });
+    m_frecencyScores = std::move(scores);
+    m_frecencyScoresGeneration = m_frecency.GetGeneration();
+    return m_frecencyScores;
+}
+
+void TrackerEngine::OnDirectoryChanged() {
+    ULONGLONG generation = m_directoryIndex.GetGeneration();
+    std::vector<DirectoryDelta> deltas = m_directoryIndex.ApplyPendingChanges();
+    bool onlyListed = true;
+    for (const auto &delta : deltas) {
+        if (delta.change != DirectoryChange::Listed && delta.change != DirectoryChange::Reset)
+            onlyListed = false;
+        if (delta.change == DirectoryChange::Reset)
+            m_activation.Clear();
+        else if (delta.change == DirectoryChange::Removed)
+            m_activation.Forget(GetFilePath(delta.name));
+        if (delta.change != DirectoryChange::Renamed)
+            continue;
+        m_activation.Forget(GetFilePath(delta.oldName));
+        m_frecency.Rename(GetFilePath(delta.oldName), GetFilePath(delta.name));
+        // Keep tracking attached to a renamed file.
+        auto tracked = m_fileWindowMap.find(GetFilePath(delta.oldName));
+        if (tracked != m_fileWindowMap.end()) {
+            std::wstring newPath = GetFilePath(delta.name);
+            m_journal.AppendRemove(tracked->first);
+            m_journal.AppendUpsert(newPath, m_fileWindowMap[newPath] = tracked->second);
+            m_fileWindowMap.erase(tracked);
+        }
+    }
+    if (m_directoryIndex.GetGeneration() == generation && !m_fileListDeferred)
+        return; // Only modification times changed; no file is affected.
+    // A listing arrives in a batch every DIRECTORY_SCAN_FLUSH_INTERVAL, and every
+    // rebuild here and in the listener's views costs O(files). While only listing
+    // batches arrive, rebuild when the list has doubled since the last rebuild and
+    // when the listing completes, so a whole listing costs O(files).
+    if (onlyListed && m_directoryIndex.IsListing() &&
+        m_directoryIndex.GetEntries().size() < 2 * m_fileNames.size()) {
+        m_fileListDeferred = true;
+        return;
+    }
+    m_fileListDeferred = false;
+    RebuildFileList();
+    PublishQueryIndex();
+    if (m_listener)
+        m_listener->OnFolderChanged(deltas);
+}
+
+// -------------------------------------------------------------------------
+// Activation and launching
+// -------------------------------------------------------------------------
+ULONGLONG TrackerEngine::GetLastWriteTime(const std::wstring &filePath) const {
+    std::wstring name = m_directoryIndex.GetName(filePath);
+    if (name.empty())
+        return 0;
+    int index = m_directoryIndex.Find(name);
+    return (index >= 0) ? m_directoryIndex.GetEntries()[index].lastWriteTime : 0;
+}
+
+OpenOutcome TrackerEngine::OpenFile(const std::wstring &filePath, std::wstring *url) {
+    if (url) {
+        switch (m_activation.GetUrl(filePath, GetLastWriteTime(filePath), *url)) {
+        case UrlTarget::Found:
+            m_frecency.Record(filePath);
+            return OpenOutcome::ShowUrl;
+        case UrlTarget::Unreadable:
+            return OpenOutcome::UrlUnreadable;
+        default:
+            break; // Not a .url file, or one without a target: open it normally.
+        }
+    }
+    const WindowSnapshot &snapshot = GetSnapshot();
+    auto it = m_fileWindowMap.find(filePath);
+    if (it != m_fileWindowMap.end() && IsWindow(it->second.hwnd)) {
+        HWND hwnd = it->second.hwnd;
+        if (!m_activation.IsVerified(filePath, hwnd, snapshot.generation)) {
+            // Windows in the snapshot got their fingerprint refreshed by the
+            // worker; only a window it has not seen is read here.
+            const TrackedWindowStatus *status = snapshot.FindTracked(hwnd);
+            if (!status || !status->alive) {
+                TrackedWindow currentFp = GetFingerprint(hwnd);
+                if (!CompareStableAttributes(it->second, currentFp)) {
+                    it->second = currentFp;
+                    m_journal.AppendUpsert(filePath, it->second);
+                }
+            }
+            m_activation.SetVerified(filePath, hwnd, snapshot.generation);
+        }
+        ActivateTrackedWindow(it->second);
+        m_frecency.Record(filePath);
+        return OpenOutcome::Activated;
+    }
+    HWND hwndFound = m_activation.FindFileWindow(filePath, GetFileIndex(filePath), snapshot, GetMatches());
+    if (hwndFound) {
+        TrackedWindow &tracked = m_fileWindowMap[filePath] = GetFingerprint(hwndFound);
+        m_journal.AppendUpsert(filePath, tracked);
+        ActivateTrackedWindow(tracked);
+        SyncTrackedWindows();
+        PublishQueryIndex();
+        m_frecency.Record(filePath);
+        return OpenOutcome::Activated;
+    }
+    if (!m_launchService.Launch(filePath))
+        return OpenOutcome::Failed;
+    m_frecency.Record(filePath);
+    return OpenOutcome::Launching;
+}
+
+bool TrackerEngine::CloseFileWindow(const std::wstring &filePath) {
+    auto it = m_fileWindowMap.find(filePath);
+    if (it == m_fileWindowMap.end() || !IsWindow(it->second.hwnd))
+        return false;
+    PostMessage(it->second.hwnd, WM_CLOSE, 0, 0);
+    return true;
+}
+
+void TrackerEngine::OnLaunchComplete(const LaunchResult &result) {
+    auto restore = m_pendingRestoreRects.find(result.filePath);
+    if (result.launched && result.hwnd) {
+        // The fingerprint was captured on the launch thread.
+        TrackedWindow &tracked = m_fileWindowMap[result.filePath] = result.fingerprint;
+        if (restore != m_pendingRestoreRects.end()) {
+            // Launched by RestoreWorkspace(): keep the workspace rectangle.
+            ApplyWorkspaceLayout({ { result.hwnd, restore->second } });
+            tracked.rect = restore->second;
+        }
+        m_journal.AppendUpsert(result.filePath, tracked);
+        SyncTrackedWindows();
+        PublishQueryIndex();
+    }
+    if (restore != m_pendingRestoreRects.end())
+        m_pendingRestoreRects.erase(restore);
+    if (m_listener)
+        m_listener->OnLaunchComplete(result);
+}
+
+void TrackerEngine::RestoreWorkspace() {
+    // Open windows keep their current relative stacking (the snapshot table is in
+    // z-order); windows the snapshot does not list yet go below them.
+    const WindowSnapshot &snapshot = GetSnapshot();
+    std::vector<std::pair<int, WorkspacePlacement>> open;
+    for (const auto &pair : m_fileWindowMap) {
+        const TrackedWindow &tracked = pair.second;
+        if (tracked.hwnd && IsWindow(tracked.hwnd)) {
+            int index = snapshot.FindWindowIndex(tracked.hwnd);
+            open.push_back({ (index >= 0) ? index : INT_MAX, { tracked.hwnd, tracked.rect } });
+        } else if (!m_launchService.IsPending(pair.first)) {
+            m_pendingRestoreRects[pair.first] = tracked.rect;
+            if (!m_launchService.Launch(pair.first))
+                m_pendingRestoreRects.erase(pair.first);
+        }
+    }
+    if (open.empty())
+        return;
+    std::stable_sort(open.begin(), open.end(),
+                     [](const std::pair<int, WorkspacePlacement> &a, const std::pair<int, WorkspacePlacement> &b) {
+                         return a.first < b.first;
+                     });
+    std::vector<WorkspacePlacement> placements;
+    placements.reserve(open.size());
+    for (const auto &entry : open)
+        placements.push_back(entry.second);
+    ApplyWorkspaceLayout(placements);
+    // One activation for the whole set instead of one per window.
+    SetForegroundWindow(placements.front().hwnd);
+}
+
+// End of file: TrackerEngine.cpp (Version: 1.14)
@@ -0,0 +1,258 @@
+// File: TrackerEngine.h
+// Version: 1.13
+// -------------------------------------------------------------------------
+// This header declares TrackerEngine, the UI-independent core of MYexplorer.
+//
+// The engine owns everything that decides which window belongs to which
+// file: the watched project folder (DirectoryIndex), the window snapshots
+// (WindowSnapshotWorker), title matching (TitleMatcher), asynchronous
+// launches (LaunchService) and the tracking map with its persistence in
+// tracking.dat and its journal (TrackingJournal). It has no controls of its own. A client provides a window
+// that receives the engine's private messages and forwards them to
+// HandleMessage(); the engine then reports what changed through
+// TrackerEngineListener. MainWindow is one client, HeadlessHost (the
+// --headless mode) is another.
+//
+// All methods are called on the thread that owns the notification window.
+//
+// Changes in Version 1.13:
+//  - Stop() drains the engine messages that carry heap payloads.
+// Changes in Version 1.12:
+//  - While a root is listed, the file list and OnFolderChanged() follow the
+//    listing at doubling sizes and at its end rather than every batch.
+// Changes in Version 1.11:
+//  - GetFileName() maps a file path to its project file name.
+// Changes in Version 1.10:
+//  - OpenFile() counts activations and launches in a FrecencyTable
+//    (Frecency.h), persisted in FRECENCY_FILE. GetFrecencyScores() and
+//    GetFileNameTable() hand them to searches on other threads.
+// Changes in Version 1.9:
+//  - The index lists every root of PROJECT_ROOTS recursively; file names may
+//    contain folders or, for roots other than the first, be full paths.
+//    GetFilePath() maps both, and the tracking keys stay the full paths.
+// Changes in Version 1.8:
+//  - The snapshot worker records window activity in HISTORY_FILE
+//    (WindowHistory.h). Added GetHistory() and QueryFileHistory().
+// Changes in Version 1.7:
+//  - The project folder is listed by the DirectoryIndex thread; the listing
+//    arrives through OnFolderChanged() like any other change. Added
+//    IsFolderLoaded() and HasSnapshot() for the startup metrics.
+// Changes in Version 1.6:
+//  - GetLastWriteTime() is public; IconCache keys per-file icons by it.
+// Changes in Version 1.5:
+//  - Every tracking change is appended to the TrackingJournal, which commits
+//    and compacts on its own thread; tracking.dat is no longer read in
+//    Start() nor saved in Stop(). The loaded entries arrive as
+//    WM_APP_TRACKING_LOADED and are rehydrated against a snapshot.
+// Changes in Version 1.4:
+//  - GetMatches() is traced as the TitleMatch phase (Tracing.h).
+// Changes in Version 1.3:
+//  - OpenFile() resolves through ActivationService, which caches the last
+//    verified window per file and parsed .url targets, and reports .url
+//    targets to clients that show them (OpenOutcome::ShowUrl).
+// Changes in Version 1.2:
+//  - The snapshot worker publishes window events to the shared-memory ring
+//    WINDOW_EVENT_RING_NAME (WindowEventRing.h). The title matcher is shared
+//    with it, so a folder change builds a new matcher instead of rebuilding
+//    the one in use.
+// Changes in Version 1.1:
+//  - The engine serves the query pipe (QueryServer.h): it publishes a
+//    QueryIndex after every snapshot, folder and tracking change and handles
+//    the activation requests the server posts back.
+// -------------------------------------------------------------------------
+
+#ifndef TRACKERENGINE_H
+#define TRACKERENGINE_H
+
+#include <windows.h>
+#include <string>
+#include <map>
+#include <vector>
+#include "TrackedWindow.h"        // For TrackedWindow
+#include "WindowSnapshotWorker.h" // For WindowSnapshot
+#include "TitleMatcher.h"         // For TitleMatchResult
+#include "DirectoryIndex.h"       // For DirectoryDelta
+#include "LaunchService.h"        // For LaunchResult
+#include "FileUtils.h"            // For StoredTrackedWindow
+#include "QueryServer.h"          // For QueryServer
+#include "ActivationService.h"    // For ActivationService
+#include "TrackingJournal.h"      // For TrackingJournal
+#include "Frecency.h"             // For FrecencyTable
+#include <memory>
+
+/**
+ * @class TrackerEngineListener
+ * @brief Change notifications from TrackerEngine::HandleMessage().
+ */
+class TrackerEngineListener {
+public:
+    virtual ~TrackerEngineListener() {}
+    // A new window snapshot is current; tracked fingerprints were refreshed from it.
+    virtual void OnSnapshotUpdated() = 0;
+    // The file list changed. Tracking already follows renamed files.
+    virtual void OnFolderChanged(const std::vector<DirectoryDelta> &deltas) = 0;
+    // A launch finished. A window that appeared is already tracked.
+    virtual void OnLaunchComplete(const LaunchResult &result) = 0;
+};
+
+// Outcome of TrackerEngine::OpenFile().
+enum class OpenOutcome {
+    Activated,      ///< A window of the file was brought to the foreground.
+    Launching,      ///< No window was found; the file is being launched.
+    Failed,         ///< The launch could not be started.
+    ShowUrl,        ///< A .url file; its target was returned instead of opening it.
+    UrlUnreadable   ///< A .url file that could not be read.
+};
+
+class TrackerEngine {
+public:
+    TrackerEngine();
+    ~TrackerEngine();
+
+    // Starts the workers, including the directory thread that lists the project
+    // folder and the journal thread that loads tracking.dat.
+    // Engine messages are posted to hwndNotify. Returns false if window
+    // monitoring could not be started; a missing project folder only leaves
+    // the file list empty (see IsFolderAvailable()), and the query pipe is
+    // optional (see IsQueryServerRunning()).
+    bool Start(HWND hwndNotify, TrackerEngineListener *listener);
+
+    // Stops the workers and commits the last journal group. Payloads of engine
+    // messages still queued for hwndNotify are freed.
+    void Stop();
+
+    // Handles WM_APP_SNAPSHOT_READY, WM_APP_DIRECTORY_CHANGED,
+    // WM_APP_LAUNCH_COMPLETE, WM_APP_QUERY_ACTIVATE and
+    // WM_APP_TRACKING_LOADED. Returns false for any other message.
+    bool HandleMessage(UINT uMsg, WPARAM wParam, LPARAM lParam);
+
+    // False if another process owns QUERY_PIPE_NAME.
+    bool IsQueryServerRunning() const { return m_queryServer.IsRunning(); }
+    // False if another process owns WINDOW_EVENT_RING_NAME.
+    bool IsEventRingOpen() const { return m_eventRingOpen; }
+
+    // True once the entries of tracking.dat and its journal were resolved
+    // against a snapshot. OnSnapshotUpdated() is reported when that happens.
+    bool IsTrackingResolved() const { return m_trackingResolved; }
+
+    // True once a window snapshot was published.
+    bool HasSnapshot() const { return m_hasSnapshot; }
+
+    // Project folder listing.
+    bool IsFolderAvailable() const { return m_folderAvailable; }
+    // True once the first listing arrived (or there is no folder to list).
+    bool IsFolderLoaded() const { return !m_folderAvailable || m_directoryIndex.IsLoaded(); }
+    const std::vector<std::wstring>& GetFileNames() const { return m_fileNames; }
+    // The same names as an immutable table that other threads may keep
+    // (nullptr before Start()); replaced, not changed, by every folder change.
+    std::shared_ptr<const std::vector<std::wstring>> GetFileNameTable() const;
+    // Frecency of the files by GetFileNames() index. The table is rebuilt
+    // when a file is opened or the file list changes, and is immutable.
+    std::shared_ptr<const std::vector<float>> GetFrecencyScores();
+    const FrecencyTable& GetFrecency() const { return m_frecency; }
+    // Full path of a project file name (see DirectoryIndex.h); the second form reuses filePath.
+    static std::wstring GetFilePath(const std::wstring &fileName);
+    static void GetFilePath(const std::wstring &fileName, std::wstring &filePath);
+    // Project file name of filePath (the inverse of GetFilePath()), or "" if
+    // the file is under none of the roots.
+    std::wstring GetFileName(const std::wstring &filePath) const { return m_directoryIndex.GetName(filePath); }
+    // Last write time of a project file from the directory index, or 0.
+    ULONGLONG GetLastWriteTime(const std::wstring &filePath) const;
+
+    // Current window snapshot and the file/title matches against it.
+    const WindowSnapshot& GetSnapshot() const { return m_snapshotWorker.GetCurrent(); }
+    const TitleMatcher& GetTitleMatcher() const { return *m_titleMatcher; }
+    const TitleMatchResult& GetMatches();
+
+    // Status text of a project file ("Maximized (Focused)", ...), from its
+    // tracked window or else from a window whose title contains the name.
+    // Returns nullptr if no window of the file is open.
+    const wchar_t* GetFileState(const std::wstring &fileName);
+
+    // Window activity history of the snapshot worker (see WindowHistory.h).
+    WindowHistory& GetHistory() { return m_snapshotWorker.GetHistory(); }
+    // Activity of the windows that showed fileName (a project file name)
+    // within [from, to] (HistoryNow() times), most focused first.
+    bool QueryFileHistory(const std::wstring &fileName, ULONGLONG from, ULONGLONG to,
+                          std::vector<WindowActivity> &activity) {
+        return GetHistory().QueryFile(WindowEventFileId(fileName.c_str(), fileName.size()), from, to, activity);
+    }
+
+    // Tracking map: file path to the fingerprint of its window.
+    const std::map<std::wstring, TrackedWindow>& GetTrackedWindows() const { return m_fileWindowMap; }
+
+    // Activates the window of filePath (tracked, or found by title), or
+    // launches the file. Completion of a launch arrives as OnLaunchComplete().
+    // With url, a .url file with a URL= line is not opened; its target is
+    // returned in *url instead (OpenOutcome::ShowUrl).
+    OpenOutcome OpenFile(const std::wstring &filePath, std::wstring *url = nullptr);
+
+    // Posts WM_CLOSE to the tracked window of filePath. Returns false if it has none.
+    bool CloseFileWindow(const std::wstring &filePath);
+
+    // Positions and stacks all tracked windows in one batch and launches the
+    // tracked files that have no window; those are moved to their stored
+    // rectangle when they appear.
+    void RestoreWorkspace();
+
+    // Snapshot worker controls, for clients that know when nobody is looking.
+    void SetPaused(bool paused) { m_snapshotWorker.SetPaused(paused); }
+    void SetSweepInterval(UINT interval) { m_snapshotWorker.SetSweepInterval(interval); }
+
+private:
+    void OnSnapshotReady();
+    void OnDirectoryChanged();
+    void OnLaunchComplete(const LaunchResult &result);
+    void OnTrackingLoaded(std::vector<StoredTrackedWindow> &entries);
+
+    // Resolves m_storedTrackedWindows against the current snapshot and
+    // journals the outcome of every entry.
+    void RehydrateStoredWindows();
+
+    // Rebuilds m_fileNames and the title matcher from the directory index.
+    void RebuildFileList();
+    // TitleMatcher index of the project file at filePath, or -1.
+    int GetFileIndex(const std::wstring &filePath) const;
+    // Copies fingerprints refreshed by the worker into m_fileWindowMap.
+    void UpdateTrackedFingerprints();
+    // Passes the tracked window handles to the snapshot worker.
+    void SyncTrackedWindows();
+    // Hands the query server a QueryIndex of the current snapshot and tracking.
+    void PublishQueryIndex();
+
+    HWND m_hwndNotify;
+    TrackerEngineListener *m_listener;
+    bool m_started;
+    bool m_folderAvailable;
+    bool m_eventRingOpen;
+    bool m_hasSnapshot;                                     ///< A snapshot was taken since Start().
+    bool m_fileListDeferred;                                ///< Listed batches await RebuildFileList().
+
+    std::map<std::wstring, TrackedWindow> m_fileWindowMap;  ///< File path to window fingerprint.
+    std::vector<StoredTrackedWindow> m_storedTrackedWindows; ///< Entries loaded by the journal, not yet resolved.
+    bool m_rehydrationPending;                              ///< m_storedTrackedWindows awaits a snapshot.
+    bool m_trackingResolved;                                ///< The loaded entries were rehydrated.
+    TrackingJournal m_journal;                              ///< Persists every change of m_fileWindowMap.
+    std::map<std::wstring, RECT> m_pendingRestoreRects;     ///< Workspace rectangles of files RestoreWorkspace() is launching.
+
+    WindowSnapshotWorker m_snapshotWorker;                  ///< Collects window snapshots off the UI thread.
+    DirectoryIndex m_directoryIndex;                        ///< Watched listing of PROJECT_ROOTS, one shard per root.
+    LaunchService m_launchService;                          ///< Opens files on worker threads.
+    ActivationService m_activation;                         ///< Resolution cache of OpenFile().
+    FrecencyTable m_frecency;                               ///< Activation counts of OpenFile(), decaying.
+    std::shared_ptr<const std::vector<float>> m_frecencyScores; ///< GetFrecencyScores(), or null if stale.
+    ULONGLONG m_frecencyScoresGeneration;                   ///< m_frecency generation of m_frecencyScores.
+    std::vector<std::wstring> m_fileNames;                  ///< Names in m_directoryIndex order.
+    std::shared_ptr<TitleMatcher> m_titleMatcher;           ///< Matches project file names in window titles; shared with the event ring.
+    TitleMatchResult m_matches;                             ///< Last match of m_titleMatcher against the snapshot.
+    bool m_matchesStale;                                    ///< Snapshot or file list changed since m_matches.
+    QueryServer m_queryServer;                              ///< Answers the query pipe from published indices.
+    std::shared_ptr<const QueryFileTable> m_queryFiles;     ///< m_fileNames for the query server.
+
+    std::vector<HWND> m_scratchHwnds;                       ///< Reused by SyncTrackedWindows().
+    std::wstring m_scratchPath;                             ///< Reused by GetFileState().
+};
+
+#endif // TRACKERENGINE_H
+
+// End of file: TrackerEngine.h (Version: 1.13)
@@ -0,0 +1,344 @@
+// File: TrackingJournal.cpp
+// Version: 1.0
+// -------------------------------------------------------------------------
+// This file implements TrackingJournal (see TrackingJournal.h for the file
+// layout and the commit and compaction rules).
+// -------------------------------------------------------------------------
+
+#include "TrackingJournal.h"
+#include "FingerprintUtils.h"  // For GetInternedClassName() and the fingerprint setters
+#include "ProcessCache.h"      // For process creation times
+#include "Config.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+static const uint32_t JOURNAL_FILE_MAGIC = 0x4A54594D; // "MYTJ"
+static const uint16_t JOURNAL_FILE_VERSION = 1;
+
+struct JournalFileHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;
+};
+
+struct JournalRecordHeader {
+    uint32_t size;         ///< Bytes of the record including this header and its strings.
+    uint32_t checksum;     ///< FNV-1a over the record after this field.
+    uint8_t kind;          ///< TrackingJournal::RecordKind.
+    uint8_t reserved;
+    uint16_t pathLength;   ///< In WCHARs, like the two lengths below.
+    uint16_t classLength;
+    uint16_t titleLength;
+    uint32_t processId;
+    int32_t failCount;
+    int32_t left;
+    int32_t top;
+    int32_t right;
+    int32_t bottom;
+    uint64_t hwnd;
+    uint64_t launchTime;
+    uint64_t processCreateTime;
+};
+
+static_assert(sizeof(JournalFileHeader) == 8, "JournalFileHeader layout changed");
+static_assert(sizeof(JournalRecordHeader) == 64, "JournalRecordHeader layout changed");
+
+static const size_t CHECKSUM_OFFSET = offsetof(JournalRecordHeader, kind);
+
+static uint32_t Fnv1a32(const BYTE *data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+TrackingJournal::TrackingJournal()
+    : m_hwndNotify(nullptr)
+    , m_loadedMsg(0)
+    , m_stopEvent(nullptr)
+    , m_wakeEvent(nullptr)
+    , m_journal(INVALID_HANDLE_VALUE)
+    , m_journalBytes(0)
+{
+}
+
+TrackingJournal::~TrackingJournal() {
+    Stop();
+}
+
+bool TrackingJournal::Start(const std::wstring &snapshotFile, const std::wstring &journalFile, HWND hwndNotify, UINT loadedMsg) {
+    Stop();
+    m_snapshotFile = snapshotFile;
+    m_journalFile = journalFile;
+    m_hwndNotify = hwndNotify;
+    m_loadedMsg = loadedMsg;
+    m_stopEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+    m_wakeEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    if (!m_stopEvent || !m_wakeEvent) {
+        Stop();
+        return false;
+    }
+    m_thread = std::thread(&TrackingJournal::Run, this);
+    return true;
+}
+
+void TrackingJournal::Stop() {
+    if (m_stopEvent) {
+        SetEvent(m_stopEvent);
+        if (m_thread.joinable())
+            m_thread.join();
+        CloseHandle(m_stopEvent);
+        m_stopEvent = nullptr;
+    }
+    if (m_wakeEvent) {
+        CloseHandle(m_wakeEvent);
+        m_wakeEvent = nullptr;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_queue.clear();
+}
+
+void TrackingJournal::AppendUpsert(const std::wstring &filePath, const TrackedWindow &window) {
+    if (!m_wakeEvent)
+        return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.push_back({ RecordKind::Upsert, filePath, window });
+    }
+    SetEvent(m_wakeEvent);
+}
+
+void TrackingJournal::AppendRemove(const std::wstring &filePath) {
+    if (!m_wakeEvent)
+        return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.push_back({ RecordKind::Remove, filePath, TrackedWindow() });
+    }
+    SetEvent(m_wakeEvent);
+}
+
+void TrackingJournal::Run() {
+    Load();
+    std::vector<StoredTrackedWindow> *loaded = new std::vector<StoredTrackedWindow>();
+    loaded->reserve(m_state.size());
+    for (const auto &pair : m_state)
+        loaded->push_back(pair.second);
+    if (!PostMessage(m_hwndNotify, m_loadedMsg, 0, reinterpret_cast<LPARAM>(loaded)))
+        delete loaded;
+
+    std::vector<Record> group;
+    HANDLE handles[2] = { m_stopEvent, m_wakeEvent };
+    for (;;) {
+        DWORD wait = WaitForMultipleObjects(2, handles, FALSE, INFINITE);
+        bool stopping = (wait != WAIT_OBJECT_0 + 1);
+        // Let the rest of a burst (e.g. one snapshot's fingerprint refreshes) join the group.
+        if (!stopping)
+            stopping = WaitForSingleObject(m_stopEvent, TRACKING_JOURNAL_COMMIT_DELAY) != WAIT_TIMEOUT;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            group.swap(m_queue);
+        }
+        if (!group.empty())
+            Commit(group);
+        group.clear();
+        if (stopping)
+            break;
+    }
+    if (m_journal != INVALID_HANDLE_VALUE) {
+        CloseHandle(m_journal);
+        m_journal = INVALID_HANDLE_VALUE;
+    }
+    m_state.clear();
+}
+
+void TrackingJournal::Load() {
+    m_state.clear();
+    std::vector<StoredTrackedWindow> entries;
+    if (ReadTrackingFile(m_snapshotFile, entries)) {
+        for (auto &entry : entries)
+            m_state[entry.filePath] = std::move(entry);
+    }
+
+    m_journal = CreateFileW(m_journalFile.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                            OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (m_journal == INVALID_HANDLE_VALUE)
+        return;
+    LARGE_INTEGER fileSize = {};
+    std::vector<BYTE> image;
+    // Compaction keeps the journal near TRACKING_JOURNAL_COMPACT_BYTES; anything
+    // far larger is not ours and is discarded rather than read.
+    if (GetFileSizeEx(m_journal, &fileSize) && fileSize.QuadPart > 0 &&
+        fileSize.QuadPart <= 16 * static_cast<LONGLONG>(TRACKING_JOURNAL_COMPACT_BYTES)) {
+        image.resize(static_cast<size_t>(fileSize.QuadPart));
+        DWORD read = 0;
+        if (!ReadFile(m_journal, image.data(), static_cast<DWORD>(image.size()), &read, nullptr) || read != image.size())
+            image.clear();
+    }
+    size_t valid = Replay(image);
+    if (valid == 0) {
+        // Missing, foreign or unreadable: start an empty journal.
+        if (!ResetJournal()) {
+            CloseHandle(m_journal);
+            m_journal = INVALID_HANDLE_VALUE;
+        }
+        return;
+    }
+    if (valid != image.size()) {
+        // Cut the torn tail, or new records would follow bytes the replay stops at.
+        LARGE_INTEGER end = {};
+        end.QuadPart = static_cast<LONGLONG>(valid);
+        if (!SetFilePointerEx(m_journal, end, nullptr, FILE_BEGIN) || !SetEndOfFile(m_journal)) {
+            CloseHandle(m_journal);
+            m_journal = INVALID_HANDLE_VALUE;
+        }
+    }
+    m_journalBytes = valid;
+    // Fold the replayed records into the snapshot, so the next start replays nothing.
+    if (valid > sizeof(JournalFileHeader))
+        Compact();
+}
+
+size_t TrackingJournal::Replay(const std::vector<BYTE> &image) {
+    JournalFileHeader header;
+    if (image.size() < sizeof(header))
+        return 0;
+    memcpy(&header, image.data(), sizeof(header));
+    if (header.magic != JOURNAL_FILE_MAGIC || header.version != JOURNAL_FILE_VERSION ||
+        header.headerSize < sizeof(JournalFileHeader) || header.headerSize > image.size())
+        return 0;
+
+    size_t offset = header.headerSize;
+    std::wstring className;
+    while (image.size() - offset >= sizeof(JournalRecordHeader)) {
+        JournalRecordHeader rec;
+        memcpy(&rec, image.data() + offset, sizeof(rec));
+        size_t stringBytes = (size_t(rec.pathLength) + rec.classLength + rec.titleLength) * sizeof(WCHAR);
+        // A torn or corrupt record ends the replay; everything before it was committed.
+        if (rec.size != sizeof(JournalRecordHeader) + stringBytes || rec.size > image.size() - offset ||
+            Fnv1a32(image.data() + offset + CHECKSUM_OFFSET, rec.size - CHECKSUM_OFFSET) != rec.checksum)
+            break;
+        const WCHAR *strings = reinterpret_cast<const WCHAR*>(image.data() + offset + sizeof(JournalRecordHeader));
+        std::wstring filePath(strings, rec.pathLength);
+        if (rec.kind == static_cast<uint8_t>(RecordKind::Upsert)) {
+            StoredTrackedWindow &entry = m_state[filePath];
+            entry.filePath = filePath;
+            className.assign(strings + rec.pathLength, rec.classLength);
+            SetFingerprintClassName(entry.window, className);
+            SetFingerprintTitle(entry.window, strings + rec.pathLength + rec.classLength, rec.titleLength);
+            entry.window.processId = rec.processId;
+            entry.window.hwnd = reinterpret_cast<HWND>(static_cast<uintptr_t>(rec.hwnd));
+            entry.window.rect = { rec.left, rec.top, rec.right, rec.bottom };
+            entry.window.failCount = rec.failCount;
+            entry.window.launchTime = rec.launchTime;
+            entry.processCreateTime = rec.processCreateTime;
+        } else if (rec.kind == static_cast<uint8_t>(RecordKind::Remove)) {
+            m_state.erase(filePath);
+        } else {
+            break;
+        }
+        offset += rec.size;
+    }
+    return offset;
+}
+
+void TrackingJournal::Commit(std::vector<Record> &records) {
+    m_buffer.clear();
+    for (Record &record : records) {
+        JournalRecordHeader rec = {};
+        rec.kind = static_cast<uint8_t>(record.kind);
+        const std::wstring &filePath = record.filePath;
+        const std::wstring *className = nullptr;
+        const std::wstring *title = nullptr;
+        if (record.kind == RecordKind::Upsert) {
+            const TrackedWindow &tw = record.window;
+            StoredTrackedWindow &entry = m_state[filePath];
+            entry.filePath = filePath;
+            entry.window = tw;
+            entry.processCreateTime = tw.processId ? ProcessCache::Shared().GetCreationTime(tw.processId) : 0;
+            className = &GetInternedClassName(tw.classId);
+            title = &tw.windowTitle;
+            rec.processId = tw.processId;
+            rec.failCount = tw.failCount;
+            rec.left = tw.rect.left;
+            rec.top = tw.rect.top;
+            rec.right = tw.rect.right;
+            rec.bottom = tw.rect.bottom;
+            rec.hwnd = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(tw.hwnd));
+            rec.launchTime = tw.launchTime;
+            rec.processCreateTime = entry.processCreateTime;
+        } else {
+            m_state.erase(filePath);
+        }
+        if (m_journal == INVALID_HANDLE_VALUE)
+            continue;
+        // Paths are bounded by MAX_PATH-like limits; long titles are cut, which only
+        // weakens the title comparison of a rehydrated fingerprint.
+        rec.pathLength = static_cast<uint16_t>((std::min)(filePath.size(), size_t(0xFFFF)));
+        rec.classLength = className ? static_cast<uint16_t>((std::min)(className->size(), size_t(0xFFFF))) : 0;
+        rec.titleLength = title ? static_cast<uint16_t>((std::min)(title->size(), size_t(0xFFFF))) : 0;
+        rec.size = static_cast<uint32_t>(sizeof(JournalRecordHeader) +
+                                         (size_t(rec.pathLength) + rec.classLength + rec.titleLength) * sizeof(WCHAR));
+
+        size_t start = m_buffer.size();
+        m_buffer.resize(start + rec.size);
+        BYTE *out = m_buffer.data() + start + sizeof(JournalRecordHeader);
+        memcpy(out, filePath.data(), rec.pathLength * sizeof(WCHAR));
+        out += rec.pathLength * sizeof(WCHAR);
+        if (rec.classLength)
+            memcpy(out, className->data(), rec.classLength * sizeof(WCHAR));
+        out += rec.classLength * sizeof(WCHAR);
+        if (rec.titleLength)
+            memcpy(out, title->data(), rec.titleLength * sizeof(WCHAR));
+        memcpy(m_buffer.data() + start, &rec, sizeof(rec));
+        rec.checksum = Fnv1a32(m_buffer.data() + start + CHECKSUM_OFFSET, rec.size - CHECKSUM_OFFSET);
+        memcpy(m_buffer.data() + start, &rec, sizeof(rec));
+    }
+
+    if (m_journal == INVALID_HANDLE_VALUE) {
+        // No journal: the snapshot is the only persistence left.
+        Compact();
+        return;
+    }
+    DWORD written = 0;
+    if (!WriteFile(m_journal, m_buffer.data(), static_cast<DWORD>(m_buffer.size()), &written, nullptr) ||
+        written != m_buffer.size() || !FlushFileBuffers(m_journal)) {
+        // The state already holds the group; a snapshot still persists it.
+        Compact();
+        return;
+    }
+    m_journalBytes += written;
+    if (m_journalBytes > TRACKING_JOURNAL_COMPACT_BYTES)
+        Compact();
+}
+
+void TrackingJournal::Compact() {
+    std::vector<StoredTrackedWindow> entries;
+    entries.reserve(m_state.size());
+    for (const auto &pair : m_state)
+        entries.push_back(pair.second);
+    if (!SaveTrackingEntries(m_snapshotFile, entries))
+        return; // Keep the journal; it still holds what the snapshot lacks.
+    if (m_journal != INVALID_HANDLE_VALUE && !ResetJournal()) {
+        CloseHandle(m_journal);
+        m_journal = INVALID_HANDLE_VALUE;
+    }
+}
+
+bool TrackingJournal::ResetJournal() {
+    JournalFileHeader header = { JOURNAL_FILE_MAGIC, JOURNAL_FILE_VERSION, sizeof(JournalFileHeader) };
+    LARGE_INTEGER zero = {};
+    DWORD written = 0;
+    if (!SetFilePointerEx(m_journal, zero, nullptr, FILE_BEGIN) || !SetEndOfFile(m_journal) ||
+        !WriteFile(m_journal, &header, sizeof(header), &written, nullptr) || written != sizeof(header) ||
+        !FlushFileBuffers(m_journal))
+        return false;
+    m_journalBytes = sizeof(header);
+    return true;
+}
+
+// End of file: TrackingJournal.cpp (Version: 1.0)
@@ -0,0 +1,112 @@
+// File: TrackingJournal.h
+// Version: 1.1
+// -------------------------------------------------------------------------
+// This header declares TrackingJournal, which persists the tracking map
+// while the engine runs instead of once on WM_DESTROY.
+//
+// Every change of the engine's tracking map (a launch, an activation, a
+// fingerprint refresh, a rename) is appended as a small binary record:
+// Upsert carries the file path and the full fingerprint, Remove only the
+// path. Append*() only queue the record; a writer thread commits everything
+// queued within TRACKING_JOURNAL_COMMIT_DELAY as one group (one WriteFile
+// and one FlushFileBuffers), so a crash loses at most the last group.
+//
+// The writer keeps the state the records describe. Once the journal grows
+// past TRACKING_JOURNAL_COMPACT_BYTES it writes that state to the snapshot
+// file (tracking.dat, see FileUtils.h) and truncates the journal, which
+// bounds the replay at startup to one journal of that size. A crash between
+// the two steps is harmless: records replay to the state they produced, so
+// replaying them over the new snapshot yields the same map.
+//
+// Loading also runs on the writer thread: it reads the snapshot, replays
+// the journal over it (a torn last record ends the replay), compacts, and
+// posts the resulting entries to the owner as a heap-allocated
+// std::vector<StoredTrackedWindow> that the receiver must delete, also when
+// it shuts down before handling the message; if the post fails, the writer
+// deletes it. No persistence I/O runs on the caller's thread.
+//
+// Journal layout (little-endian): JournalFileHeader, then records of
+// JournalRecordHeader followed by the path, class name and title in WCHARs.
+// Each record carries its size and an FNV-1a checksum of everything after
+// the checksum field.
+//
+// Changes in Version 1.1:
+//  - Documented who frees loaded entries whose message is never handled.
+// -------------------------------------------------------------------------
+
+#ifndef TRACKINGJOURNAL_H
+#define TRACKINGJOURNAL_H
+
+#include <windows.h>
+#include <string>
+#include <map>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include "TrackedWindow.h"
+#include "FileUtils.h"  // For StoredTrackedWindow
+
+class TrackingJournal {
+public:
+    TrackingJournal();
+    ~TrackingJournal();
+
+    // Starts the writer thread, which loads snapshotFile and journalFile and
+    // posts loadedMsg (LPARAM: std::vector<StoredTrackedWindow>*, owned by
+    // the receiver) to hwndNotify. Returns false if the thread could not be
+    // started.
+    bool Start(const std::wstring &snapshotFile, const std::wstring &journalFile, HWND hwndNotify, UINT loadedMsg);
+
+    // Commits the queued records and joins the writer.
+    void Stop();
+
+    // Queue a record for the next group commit. Cheap; no I/O.
+    void AppendUpsert(const std::wstring &filePath, const TrackedWindow &window);
+    void AppendRemove(const std::wstring &filePath);
+
+private:
+    enum class RecordKind : BYTE {
+        Upsert = 1,
+        Remove = 2
+    };
+
+    struct Record {
+        RecordKind kind;
+        std::wstring filePath;
+        TrackedWindow window;   ///< Upsert only.
+    };
+
+    // Writer thread body.
+    void Run();
+    // Reads the snapshot and replays the journal into m_state.
+    void Load();
+    // Replays the journal image into m_state. Returns the byte length of the valid prefix.
+    size_t Replay(const std::vector<BYTE> &image);
+    // Writes one group of records to the journal and applies them to m_state.
+    void Commit(std::vector<Record> &records);
+    // Writes m_state to the snapshot file and empties the journal.
+    void Compact();
+    // Truncates the journal to its header.
+    bool ResetJournal();
+
+    std::wstring m_snapshotFile;
+    std::wstring m_journalFile;
+    HWND m_hwndNotify;
+    UINT m_loadedMsg;
+    HANDLE m_stopEvent;
+    HANDLE m_wakeEvent;                 // Auto-reset; set by Append*().
+    std::thread m_thread;
+
+    std::mutex m_mutex;                 // Guards m_queue.
+    std::vector<Record> m_queue;
+
+    // Writer thread only.
+    std::map<std::wstring, StoredTrackedWindow> m_state;  ///< Tracking map the snapshot and journal describe.
+    HANDLE m_journal;                   ///< Open journal, or INVALID_HANDLE_VALUE (every group then compacts).
+    ULONGLONG m_journalBytes;           ///< Current journal size.
+    std::vector<BYTE> m_buffer;         ///< Serialized group, reused.
+};
+
+#endif // TRACKINGJOURNAL_H
+
+// End of file: TrackingJournal.h (Version: 1.1)
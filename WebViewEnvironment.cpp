@@ -0,0 +1,79 @@
+// File: WebViewEnvironment.cpp
+// Version: 1.1
+// -------------------------------------------------------------------------
+// This file implements WebViewEnvironment (see WebViewEnvironment.h).
+//
+// Changes in Version 1.1:
+//  - Removed the OutputDebugString messages; creation and its failures are
+//    reported by the WebViewEnvironment trace event.
+// -------------------------------------------------------------------------
+
+#include "WebViewEnvironment.h"
+#include "Config.h"
+
+WebViewEnvironment &WebViewEnvironment::Shared()
+{
+    static WebViewEnvironment instance;
+    return instance;
+}
+
+WebViewEnvironment::WebViewEnvironment()
+    : m_creating(false)
+{
+}
+
+std::wstring WebViewEnvironment::GetUserDataFolder()
+{
+    wchar_t localAppData[MAX_PATH];
+    DWORD length = GetEnvironmentVariableW(L"LOCALAPPDATA", localAppData, MAX_PATH);
+    if (length == 0 || length >= MAX_PATH)
+        return std::wstring();
+    return std::wstring(localAppData) + L"\\" + BROWSER_USER_DATA_FOLDER;
+}
+
+void WebViewEnvironment::WhenReady(const ReadyCallback &callback)
+{
+    if (m_environment) {
+        callback(S_OK, m_environment.Get());
+        return;
+    }
+    m_waiting.push_back(callback);
+    if (m_creating)
+        return;
+    m_creating = true;
+
+    // WebView2 creates the folder if it does not exist yet.
+    std::wstring userDataFolder = GetUserDataFolder();
+    TraceStart(m_activity, TracePhase::WebViewEnvironment);
+    HRESULT hr = CreateCoreWebView2EnvironmentWithOptions(
+        nullptr, // browserExecutableFolder
+        userDataFolder.empty() ? nullptr : userDataFolder.c_str(),
+        nullptr, // options
+        Microsoft::WRL::Callback<ICoreWebView2CreateCoreWebView2EnvironmentCompletedHandler>(
+            [this](HRESULT result, ICoreWebView2Environment* env) -> HRESULT
+            {
+                OnCreated((FAILED(result) || env) ? result : E_FAIL, env);
+                return S_OK;
+            }
+        ).Get()
+    );
+    if (FAILED(hr))
+        OnCreated(hr, nullptr);
+}
+
+void WebViewEnvironment::OnCreated(HRESULT result, ICoreWebView2Environment *environment)
+{
+    TraceWebViewEnvironmentStop(m_activity, result);
+    m_creating = false;
+    // The outcome is reported by the WebViewEnvironment trace event only.
+    if (SUCCEEDED(result))
+        m_environment = environment;
+
+    // A callback may queue another caller (e.g. retry after a failure).
+    std::vector<ReadyCallback> waiting;
+    waiting.swap(m_waiting);
+    for (const ReadyCallback &callback : waiting)
+        callback(result, m_environment.Get());
+}
+
+// End of file: WebViewEnvironment.cpp (Version: 1.1)
@@ -0,0 +1,66 @@
+// File: WebViewEnvironment.h
+// Version: 1.0
+// -------------------------------------------------------------------------
+// This header declares WebViewEnvironment, the one WebView2 environment of
+// the process.
+//
+// Creating an environment starts the WebView2 browser process, which is the
+// slow part of the first integrated browser. Every BrowserPanel controller
+// is created from this shared environment instead of its own, and the
+// environment uses an explicit user data folder (BROWSER_USER_DATA_FOLDER
+// under %LOCALAPPDATA%) instead of one next to the executable.
+//
+// Creation starts with the first WhenReady() call; callers that arrive while
+// it runs are queued and called in order once it completes. After a failure
+// the next WhenReady() tries again.
+//
+// WebView2 calls back on the thread that created the environment, so all
+// methods are called on the UI thread.
+// -------------------------------------------------------------------------
+
+#ifndef WEBVIEWENVIRONMENT_H
+#define WEBVIEWENVIRONMENT_H
+
+#include <windows.h>
+#include <string>
+#include <vector>
+#include <functional>
+#include <wrl.h>            // For Microsoft::WRL::ComPtr
+#include <WebView2.h>       // For ICoreWebView2Environment
+#include "Tracing.h"        // For TraceActivity
+
+class WebViewEnvironment {
+public:
+    // Called with S_OK and the environment, or with the creation error and nullptr.
+    typedef std::function<void(HRESULT, ICoreWebView2Environment*)> ReadyCallback;
+
+    // The process-wide instance.
+    static WebViewEnvironment &Shared();
+
+    // Calls callback once the environment exists: at once if it already does,
+    // else when the creation started (if needed) by this call completes.
+    void WhenReady(const ReadyCallback &callback);
+
+    // True once the environment exists.
+    bool IsReady() const { return m_environment.Get() != nullptr; }
+
+    // %LOCALAPPDATA%\BROWSER_USER_DATA_FOLDER, or empty for the WebView2 default.
+    static std::wstring GetUserDataFolder();
+
+private:
+    WebViewEnvironment();
+    WebViewEnvironment(const WebViewEnvironment &) = delete;
+    WebViewEnvironment &operator=(const WebViewEnvironment &) = delete;
+
+    // Completes the creation and calls the queued callbacks.
+    void OnCreated(HRESULT result, ICoreWebView2Environment *environment);
+
+    Microsoft::WRL::ComPtr<ICoreWebView2Environment> m_environment;
+    bool m_creating;
+    std::vector<ReadyCallback> m_waiting;   ///< Callers queued while m_creating.
+    TraceActivity m_activity;               ///< CreateCoreWebView2EnvironmentWithOptions until its callback.
+};
+
+#endif // WEBVIEWENVIRONMENT_H
+
+// End of file: WebViewEnvironment.h (Version: 1.0)
@@ -0,0 +1,264 @@
+// File: WindowEventRing.cpp
+// Version: 1.1
+// -------------------------------------------------------------------------
+// This file implements WindowEventRing and WindowEventRingReader (see
+// WindowEventRing.h for the layout and the sequence protocol).
+// -------------------------------------------------------------------------
+
+#include "WindowEventRing.h"
+#include "WindowMonitor.h"  // For WindowInfo
+#include "TitleMatcher.h"   // For TitleMatcher::FindMatches()
+#include <algorithm>
+#include <cstring>
+
+// Creation time of a process as a FILETIME value, or 0 if it cannot be read.
+static uint64_t GetProcessStartTime(HANDLE process) {
+    FILETIME creation, exitTime, kernel, user;
+    if (!GetProcessTimes(process, &creation, &exitTime, &kernel, &user))
+        return 0;
+    return (static_cast<uint64_t>(creation.dwHighDateTime) << 32) | creation.dwLowDateTime;
+}
+
+// Returns true if the producer that started at startTime (0: unknown) is still
+// running, or if its process cannot be inspected. A running process with another
+// start time reused the PID.
+static bool IsProducerRunning(DWORD processId, uint64_t startTime) {
+    HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, processId);
+    if (!process)
+        return GetLastError() == ERROR_ACCESS_DENIED;
+    DWORD exitCode = 0;
+    bool running = GetExitCodeProcess(process, &exitCode) && exitCode == STILL_ACTIVE;
+    if (running && startTime != 0) {
+        uint64_t processStart = GetProcessStartTime(process);
+        running = (processStart == 0 || processStart == startTime);
+    }
+    CloseHandle(process);
+    return running;
+}
+
+static bool IsValidHeader(const WindowEventRingHeader &header) {
+    return header.magic == WINDOW_EVENT_RING_MAGIC && header.version == WINDOW_EVENT_RING_VERSION &&
+           header.recordSize == sizeof(WindowEventRecord) &&
+           header.slotCount != 0 && (header.slotCount & (header.slotCount - 1)) == 0;
+}
+
+// -------------------------------------------------------------------------
+// Writer
+// -------------------------------------------------------------------------
+WindowEventRing::WindowEventRing()
+    : m_mapping(nullptr)
+    , m_header(nullptr)
+    , m_slots(nullptr)
+    , m_mask(0)
+    , m_next(0)
+{
+}
+
+WindowEventRing::~WindowEventRing() {
+    Close();
+}
+
+bool WindowEventRing::Create(const wchar_t *name, uint32_t slotCount) {
+    Close();
+    uint32_t slots = 1;
+    while (slots < slotCount)
+        slots <<= 1;
+    size_t size = sizeof(WindowEventRingHeader) + static_cast<size_t>(slots) * sizeof(WindowEventRecord);
+    m_mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, static_cast<DWORD>(size), name);
+    if (!m_mapping)
+        return false;
+    bool existed = GetLastError() == ERROR_ALREADY_EXISTS;
+    void *view = MapViewOfFile(m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (!view) {
+        Close();
+        return false;
+    }
+    WindowEventRingHeader *header = static_cast<WindowEventRingHeader*>(view);
+    if (existed) {
+        // A reader keeps the mapping alive after its producer exited. Take it
+        // over and continue the sequence, unless another producer still runs.
+        if (!IsValidHeader(*header) || header->slotCount != slots ||
+            IsProducerRunning(header->producerPid, header->producerStartTime)) {
+            UnmapViewOfFile(view);
+            Close();
+            return false;
+        }
+        m_next = header->writeSequence.load(std::memory_order_acquire);
+    } else {
+        // A new mapping is zero-filled: every stamp is 0, i.e. "never written".
+        header->version = WINDOW_EVENT_RING_VERSION;
+        header->recordSize = sizeof(WindowEventRecord);
+        header->slotCount = slots;
+        header->writeSequence.store(0, std::memory_order_relaxed);
+        m_next = 0;
+    }
+    header->producerPid = GetCurrentProcessId();
+    header->producerStartTime = GetProcessStartTime(GetCurrentProcess());
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = WINDOW_EVENT_RING_MAGIC;
+    m_header = header;
+    m_slots = reinterpret_cast<WindowEventRecord*>(header + 1);
+    m_mask = slots - 1;
+    return true;
+}
+
+void WindowEventRing::Close() {
+    if (m_header) {
+        UnmapViewOfFile(m_header);
+        m_header = nullptr;
+        m_slots = nullptr;
+    }
+    if (m_mapping) {
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+    }
+}
+
+void WindowEventRing::SetFiles(std::shared_ptr<const WindowEventFiles> files) {
+    std::lock_guard<std::mutex> lock(m_filesMutex);
+    m_files = std::move(files);
+}
+
+void WindowEventRing::Publish(WindowEventKind kind, HWND hwnd, const WindowInfo *info) {
+    if (!m_header)
+        return;
+    WindowEventRecord &slot = m_slots[m_next & m_mask];
+    // Odd stamp: readers that catch the slot now know it is being rewritten.
+    slot.stamp.store(2 * m_next + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.timestamp = GetTickCount64();
+    slot.hwnd = reinterpret_cast<uint64_t>(hwnd);
+    slot.kind = kind;
+    slot.fileCount = 0;
+    slot.titleLength = 0;
+    if (info) {
+        slot.processId = info->processId;
+        slot.left = info->rect.left;
+        slot.top = info->rect.top;
+        slot.right = info->rect.right;
+        slot.bottom = info->rect.bottom;
+        slot.state = static_cast<uint16_t>(info->state);
+        slot.focused = info->isFocused ? 1 : 0;
+        size_t titleLength = (std::min)(info->title.size(), static_cast<size_t>(WINDOW_EVENT_TITLE_CHARS));
+        memcpy(slot.title, info->title.data(), titleLength * sizeof(wchar_t));
+        slot.titleLength = static_cast<uint16_t>(titleLength);
+
+        std::shared_ptr<const WindowEventFiles> files;
+        {
+            std::lock_guard<std::mutex> lock(m_filesMutex);
+            files = m_files;
+        }
+        if (files && files->matcher) {
+            m_scratchMatches.clear();
+            files->matcher->FindMatches(info->title, m_scratchMatches);
+            for (int fileIndex : m_scratchMatches) {
+                if (slot.fileCount == WINDOW_EVENT_MAX_FILES)
+                    break;
+                if (fileIndex >= 0 && fileIndex < static_cast<int>(files->ids.size()))
+                    slot.fileIds[slot.fileCount++] = files->ids[fileIndex];
+            }
+        }
+    } else {
+        slot.processId = 0;
+        slot.left = slot.top = slot.right = slot.bottom = 0;
+        slot.state = 0;
+        slot.focused = 0;
+    }
+
+    slot.stamp.store(2 * m_next + 2, std::memory_order_release);
+    ++m_next;
+    m_header->writeSequence.store(m_next, std::memory_order_release);
+}
+
+// -------------------------------------------------------------------------
+// Reader
+// -------------------------------------------------------------------------
+WindowEventRingReader::WindowEventRingReader()
+    : m_mapping(nullptr)
+    , m_header(nullptr)
+    , m_slots(nullptr)
+    , m_mask(0)
+    , m_next(0)
+    , m_lost(0)
+{
+}
+
+WindowEventRingReader::~WindowEventRingReader() {
+    Close();
+}
+
+bool WindowEventRingReader::Open(const wchar_t *name) {
+    Close();
+    m_mapping = OpenFileMappingW(FILE_MAP_READ, FALSE, name);
+    if (!m_mapping)
+        return false;
+    const void *view = MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+    MEMORY_BASIC_INFORMATION region{};
+    const WindowEventRingHeader *header = static_cast<const WindowEventRingHeader*>(view);
+    if (!view || !VirtualQuery(view, &region, sizeof(region)) || region.RegionSize < sizeof(WindowEventRingHeader) ||
+        !IsValidHeader(*header) ||
+        region.RegionSize < sizeof(WindowEventRingHeader) + static_cast<size_t>(header->slotCount) * sizeof(WindowEventRecord)) {
+        if (view)
+            UnmapViewOfFile(view);
+        Close();
+        return false;
+    }
+    m_header = header;
+    m_slots = reinterpret_cast<const WindowEventRecord*>(header + 1);
+    m_mask = header->slotCount - 1;
+    m_next = header->writeSequence.load(std::memory_order_acquire);
+    m_lost = 0;
+    return true;
+}
+
+void WindowEventRingReader::Close() {
+    if (m_header) {
+        UnmapViewOfFile(m_header);
+        m_header = nullptr;
+        m_slots = nullptr;
+    }
+    if (m_mapping) {
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+    }
+}
+
+WindowEventRingReader::Result WindowEventRingReader::Read(WindowEventRecord &record) {
+    if (!m_header)
+        return Result::Empty;
+    const int64_t slotCount = m_mask + 1;
+    for (;;) {
+        int64_t head = m_header->writeSequence.load(std::memory_order_acquire);
+        if (m_next >= head)
+            return Result::Empty;
+        if (head - m_next > slotCount) {
+            // Lapped: the oldest events still in the ring start at head - slotCount.
+            m_lost += static_cast<uint64_t>(head - slotCount - m_next);
+            m_next = head - slotCount;
+        }
+        const WindowEventRecord &slot = m_slots[m_next & m_mask];
+        const int64_t expected = 2 * m_next + 2;
+        int64_t stamp = slot.stamp.load(std::memory_order_acquire);
+        if (stamp == expected) {
+            // Copy everything after the stamp, then check that the writer did
+            // not start on this slot meanwhile.
+            const size_t offset = sizeof(record.stamp);
+            memcpy(reinterpret_cast<char*>(&record) + offset, reinterpret_cast<const char*>(&slot) + offset,
+                   sizeof(WindowEventRecord) - offset);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.stamp.load(std::memory_order_relaxed) == stamp) {
+                record.stamp.store(stamp, std::memory_order_relaxed);
+                ++m_next;
+                return Result::Event;
+            }
+        } else if (stamp < expected) {
+            return Result::Empty; // Not complete yet.
+        }
+        // Overwritten while we looked at it.
+        ++m_lost;
+        ++m_next;
+    }
+}
+
+// End of file: WindowEventRing.cpp (Version: 1.1)
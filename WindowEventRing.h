@@ -0,0 +1,187 @@
+// File: WindowEventRing.h
+// Version: 1.1
+// -------------------------------------------------------------------------
+// This header declares the shared-memory window event ring: every change the
+// WindowMonitor applies to its window table (create, destroy, focus, move or
+// resize, title change) is published as one fixed-size WindowEventRecord
+// into a named file mapping (WINDOW_EVENT_RING_NAME) that other processes
+// map read-only.
+//
+// Layout: a WindowEventRingHeader followed by slotCount records (a power of
+// two). Event n is written to slot n % slotCount. There is one writer, the
+// snapshot worker thread; readers never write to the mapping, and the writer
+// never waits for them.
+//
+// Sequence protocol (a seqlock per slot):
+//   writer, event n:  stamp = 2n + 1   (slot being written)
+//                     record fields
+//                     stamp = 2n + 2   (release: event n complete)
+//                     writeSequence = n + 1
+//   reader, event n:  s1 = stamp (acquire); s1 == 2n + 2 or give up
+//                     copy the record
+//                     s2 = stamp (after an acquire fence); s2 == s1 or lapped
+// A reader that falls more than slotCount events behind has lost events; it
+// notices because the stamp is larger than expected, and skips ahead.
+// WindowEventRingReader implements this; clients may compile this header
+// and WindowEventRing.cpp as is.
+//
+// File IDs are WindowEventFileId() of the project file names whose names
+// occur in the window title, so a reader can map them back to names it got
+// from the folder (or from the query pipe) without a shared table.
+//
+// Changes in Version 1.1:
+//  - The header records the producer's process start time next to its PID
+//    (in a formerly reserved field), so a new producer takes over a ring
+//    whose PID now belongs to an unrelated process.
+// -------------------------------------------------------------------------
+
+#ifndef WINDOWEVENTRING_H
+#define WINDOWEVENTRING_H
+
+#include <windows.h>
+#include <cstdint>
+#include <cwctype>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct WindowInfo;
+class TitleMatcher;
+
+const uint32_t WINDOW_EVENT_RING_MAGIC = 0x3145574D;  // "MWE1"
+const uint16_t WINDOW_EVENT_RING_VERSION = 1;
+const uint32_t WINDOW_EVENT_MAX_FILES = 8;
+const uint32_t WINDOW_EVENT_TITLE_CHARS = 84;
+
+enum WindowEventKind : uint32_t {
+    WINDOW_EVENT_CREATED = 1,     // Window entered the table (shown, created or first seen).
+    WINDOW_EVENT_DESTROYED = 2,   // Window left the table (destroyed, hidden or title cleared).
+    WINDOW_EVENT_FOCUSED = 3,     // Window became the foreground window.
+    WINDOW_EVENT_MOVED = 4,       // Rectangle or state changed.
+    WINDOW_EVENT_TITLE = 5,       // Title changed.
+    WINDOW_EVENT_RESYNC = 6       // The table was rebuilt by a sweep; no window fields.
+};
+
+struct WindowEventRingHeader {
+    uint32_t magic;                      // WINDOW_EVENT_RING_MAGIC
+    uint16_t version;                    // WINDOW_EVENT_RING_VERSION
+    uint16_t recordSize;                 // sizeof(WindowEventRecord)
+    uint32_t slotCount;                  // Power of two.
+    uint32_t producerPid;
+    std::atomic<int64_t> writeSequence;  // Number of events published.
+    uint64_t producerStartTime;          // Creation time (FILETIME) of producerPid; 0 if unknown.
+    uint64_t reserved[4];
+};
+
+struct WindowEventRecord {
+    std::atomic<int64_t> stamp;          // See the sequence protocol above.
+    uint64_t timestamp;                  // GetTickCount64() of the producer.
+    uint64_t hwnd;
+    uint32_t kind;                       // WindowEventKind
+    uint32_t processId;
+    int32_t left, top, right, bottom;
+    uint16_t state;                      // WindowState
+    uint16_t focused;
+    uint16_t fileCount;                  // Entries of fileIds in use.
+    uint16_t titleLength;                // UTF-16 units of title in use (truncated to WINDOW_EVENT_TITLE_CHARS).
+    uint32_t fileIds[WINDOW_EVENT_MAX_FILES];
+    uint16_t title[WINDOW_EVENT_TITLE_CHARS];
+};
+
+static_assert(sizeof(WindowEventRingHeader) == 64, "WindowEventRingHeader layout");
+static_assert(sizeof(WindowEventRecord) == 256, "WindowEventRecord layout");
+static_assert(std::atomic<int64_t>::is_always_lock_free, "The ring needs lock-free 64-bit atomics");
+
+// FNV-1a of the case-folded UTF-16 name (the folding of FoldCharNoCase()).
+inline uint32_t WindowEventFileId(const wchar_t *name, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; ++i) {
+        wchar_t c = name[i];
+        c = (c < 0x80) ? ((c >= L'A' && c <= L'Z') ? static_cast<wchar_t>(c + (L'a' - L'A')) : c)
+                       : static_cast<wchar_t>(towlower(c));
+        hash = (hash ^ (c & 0xFF)) * 16777619u;
+        hash = (hash ^ ((c >> 8) & 0xFF)) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @struct WindowEventFiles
+ * @brief Project files the writer looks for in titles; replaced on folder changes.
+ */
+struct WindowEventFiles {
+    std::shared_ptr<const TitleMatcher> matcher;
+    std::vector<uint32_t> ids;          ///< WindowEventFileId() by file index of matcher.
+};
+
+/**
+ * @class WindowEventRing
+ * @brief Writer side: owns the mapping and publishes events.
+ */
+class WindowEventRing {
+public:
+    WindowEventRing();
+    ~WindowEventRing();
+
+    // Creates the named mapping with slotCount (rounded up to a power of two)
+    // records. Fails if the name already exists, i.e. another producer runs.
+    bool Create(const wchar_t *name, uint32_t slotCount);
+    void Close();
+    bool IsOpen() const { return m_header != nullptr; }
+
+    // Any thread: replaces the files matched against titles.
+    void SetFiles(std::shared_ptr<const WindowEventFiles> files);
+
+    // Writer thread: publishes one event. info may be nullptr for WINDOW_EVENT_RESYNC.
+    void Publish(WindowEventKind kind, HWND hwnd, const WindowInfo *info);
+
+private:
+    HANDLE m_mapping;
+    WindowEventRingHeader *m_header;
+    WindowEventRecord *m_slots;
+    uint32_t m_mask;
+    int64_t m_next;                     // Writer thread: sequence of the next event.
+
+    std::mutex m_filesMutex;            // Guards m_files; held only to copy the pointer.
+    std::shared_ptr<const WindowEventFiles> m_files;
+    std::vector<int> m_scratchMatches;  // Writer thread.
+};
+
+/**
+ * @class WindowEventRingReader
+ * @brief Reader side, for consumers in other processes.
+ */
+class WindowEventRingReader {
+public:
+    enum class Result {
+        Event,      ///< record holds the next event.
+        Empty,      ///< No event was published since the last one read.
+    };
+
+    WindowEventRingReader();
+    ~WindowEventRingReader();
+
+    // Maps the ring read-only. Reading starts with the next event published.
+    bool Open(const wchar_t *name);
+    void Close();
+
+    // Copies the next event into record. Events overwritten before they were
+    // read are skipped and counted in GetLostCount().
+    Result Read(WindowEventRecord &record);
+
+    uint64_t GetLostCount() const { return m_lost; }
+
+private:
+    HANDLE m_mapping;
+    const WindowEventRingHeader *m_header;
+    const WindowEventRecord *m_slots;
+    uint32_t m_mask;
+    int64_t m_next;
+    uint64_t m_lost;
+};
+
+#endif // WINDOWEVENTRING_H
+
+// End of file: WindowEventRing.h (Version: 1.1)
@@ -0,0 +1,828 @@
+// File: WindowHistory.cpp
+// Version: 1.1
+// -------------------------------------------------------------------------
+// This file implements WindowHistory (see WindowHistory.h).
+//
+// Changes in Version 1.1:
+//  - Query() reads the segment file through a duplicate of m_file, so a
+//    concurrent Close() no longer closes the handle in the middle of a read.
+// -------------------------------------------------------------------------
+
+#include "WindowHistory.h"
+#include "Config.h"
+#include "TitleMatcher.h"   // For TitleMatcher::FindMatches()
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+static const size_t SLOT_BYTES = sizeof(HistoryBlockHeader) + HISTORY_BLOCK_BYTES;
+// Largest field, time and window ID prefix of a record.
+static const size_t RECORD_PREFIX_BYTES = 1 + 10 + 5;
+
+static uint32_t Fnv1a32(const BYTE *data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; ++i)
+        hash = (hash ^ data[i]) * 16777619u;
+    return hash;
+}
+
+ULONGLONG HistoryNow() {
+    FILETIME ft;
+    GetSystemTimeAsFileTime(&ft);
+    ULARGE_INTEGER time;
+    time.LowPart = ft.dwLowDateTime;
+    time.HighPart = ft.dwHighDateTime;
+    return time.QuadPart / 10000;
+}
+
+// ---- Encoding -------------------------------------------------------------
+
+static void PutVarint(std::vector<uint8_t> &out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+static void PutSigned(std::vector<uint8_t> &out, int64_t value) {
+    PutVarint(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+static uint64_t GetFileBit(uint32_t fileId) {
+    return 1ull << (fileId % 64);
+}
+
+// Window payload of HISTORY_OPENED and of a keyframe entry.
+static void PutTitle(std::vector<uint8_t> &out, const std::wstring &title, const std::vector<uint32_t> &fileIds) {
+    PutVarint(out, title.size());
+    for (wchar_t c : title)
+        PutVarint(out, static_cast<uint16_t>(c));
+    PutVarint(out, fileIds.size());
+    for (uint32_t id : fileIds)
+        PutVarint(out, id);
+}
+
+static void PutWindow(std::vector<uint8_t> &out, DWORD processId, const RECT &rect, uint8_t state,
+                      const std::wstring &title, const std::vector<uint32_t> &fileIds) {
+    PutVarint(out, processId);
+    out.push_back(state);
+    PutSigned(out, rect.left);
+    PutSigned(out, rect.top);
+    PutSigned(out, rect.right);
+    PutSigned(out, rect.bottom);
+    PutTitle(out, title, fileIds);
+}
+
+// Bounds-checked reader over a block's record bytes.
+struct RecordReader {
+    const uint8_t *pos;
+    const uint8_t *end;
+
+    bool Byte(uint8_t &value) {
+        if (pos >= end)
+            return false;
+        value = *pos++;
+        return true;
+    }
+    bool Varint(uint64_t &value) {
+        value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t b;
+            if (!Byte(b))
+                return false;
+            value |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if (!(b & 0x80))
+                return true;
+        }
+        return false;
+    }
+    bool Varint32(uint32_t &value) {
+        uint64_t v;
+        if (!Varint(v) || v > 0xFFFFFFFFull)
+            return false;
+        value = static_cast<uint32_t>(v);
+        return true;
+    }
+    bool Signed(LONG &value) {
+        uint64_t v;
+        if (!Varint(v))
+            return false;
+        value = static_cast<LONG>(static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1));
+        return true;
+    }
+    bool Title(std::wstring &title, std::vector<uint32_t> &fileIds) {
+        uint64_t length, count;
+        if (!Varint(length) || length > HISTORY_TITLE_CHARS)
+            return false;
+        title.resize(static_cast<size_t>(length));
+        for (size_t i = 0; i < title.size(); ++i) {
+            uint64_t c;
+            if (!Varint(c) || c > 0xFFFF)
+                return false;
+            title[i] = static_cast<wchar_t>(c);
+        }
+        if (!Varint(count) || count > WINDOW_EVENT_MAX_FILES)
+            return false;
+        fileIds.resize(static_cast<size_t>(count));
+        for (uint32_t &id : fileIds) {
+            if (!Varint32(id))
+                return false;
+        }
+        return true;
+    }
+};
+
+// ---- Writer ---------------------------------------------------------------
+
+WindowHistory::WindowHistory()
+    : m_file(INVALID_HANDLE_VALUE)
+    , m_blocks(HISTORY_MEMORY_BLOCKS)
+    , m_current(0)
+    , m_blockStarted(false)
+    , m_nextSequence(1)
+    , m_lastTime(0)
+    , m_foreground(0)
+{
+    for (Block &block : m_blocks)
+        block.header = HistoryBlockHeader();
+}
+
+WindowHistory::~WindowHistory() {
+    Close();
+}
+
+bool WindowHistory::Open(const std::wstring &segmentFile) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_file != INVALID_HANDLE_VALUE)
+        CloseHandle(m_file);
+    m_diskIndex.assign(HISTORY_DISK_BLOCKS, HistoryBlockHeader());
+    m_file = CreateFileW(segmentFile.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                         OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE)
+        return false;
+
+    // Only the headers are read here; the records are verified when a query reads them.
+    uint64_t lastSequence = 0;
+    for (size_t slot = 0; slot < HISTORY_DISK_BLOCKS; ++slot) {
+        HistoryBlockHeader header;
+        ULARGE_INTEGER offset;
+        offset.QuadPart = static_cast<ULONGLONG>(slot) * SLOT_BYTES;
+        OVERLAPPED at = {};
+        at.Offset = offset.LowPart;
+        at.OffsetHigh = offset.HighPart;
+        DWORD read = 0;
+        if (!ReadFile(m_file, &header, sizeof(header), &read, &at) || read != sizeof(header))
+            break; // Past the end of a file that is still growing.
+        if (header.magic != HISTORY_BLOCK_MAGIC || header.version != HISTORY_BLOCK_VERSION ||
+            header.capacity != HISTORY_BLOCK_BYTES || header.bytes > header.capacity ||
+            header.sequence % HISTORY_DISK_BLOCKS != slot)
+            continue;
+        m_diskIndex[slot] = header;
+        lastSequence = (std::max)(lastSequence, header.sequence);
+    }
+    m_nextSequence = (std::max)(m_nextSequence, lastSequence + 1);
+    return true;
+}
+
+void WindowHistory::Close() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    SealBlock(HistoryNow());
+    if (m_file != INVALID_HANDLE_VALUE) {
+        CloseHandle(m_file);
+        m_file = INVALID_HANDLE_VALUE;
+    }
+    // A restarted monitor reports every window again.
+    m_live.clear();
+    m_foreground = 0;
+}
+
+void WindowHistory::SetFiles(std::shared_ptr<const WindowEventFiles> files) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_files = std::move(files);
+}
+
+void WindowHistory::Record(WindowEventKind kind, HWND hwnd, const WindowInfo *info) {
+    uint32_t windowId = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(hwnd));
+    if (!windowId)
+        return;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ULONGLONG now = HistoryNow();
+    auto it = m_live.find(windowId);
+    switch (kind) {
+        case WINDOW_EVENT_CREATED:
+        case WINDOW_EVENT_MOVED:
+        case WINDOW_EVENT_TITLE:
+            if (!info)
+                break;
+            if (it != m_live.end())
+                UpdateWindow(now, windowId, it->second, *info);
+            else
+                OpenWindow(now, windowId, *info);
+            break;
+        case WINDOW_EVENT_DESTROYED:
+            CloseWindow(now, windowId);
+            break;
+        case WINDOW_EVENT_FOCUSED:
+            if (it == m_live.end() && info)
+                OpenWindow(now, windowId, *info);
+            FocusWindow(now, windowId);
+            break;
+        default:
+            break;
+    }
+}
+
+void WindowHistory::Resync(const std::vector<WindowInfo> &windows) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ULONGLONG now = HistoryNow();
+    m_scratchIds.clear();
+    uint32_t focused = 0;
+    for (const WindowInfo &info : windows) {
+        uint32_t windowId = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(info.hwnd));
+        if (!windowId)
+            continue;
+        m_scratchIds.push_back(windowId);
+        auto it = m_live.find(windowId);
+        if (it != m_live.end())
+            UpdateWindow(now, windowId, it->second, info);
+        else
+            OpenWindow(now, windowId, info);
+        if (info.isFocused)
+            focused = windowId;
+    }
+    std::sort(m_scratchIds.begin(), m_scratchIds.end());
+    std::vector<uint32_t> closed;
+    for (const auto &pair : m_live) {
+        if (!std::binary_search(m_scratchIds.begin(), m_scratchIds.end(), pair.first))
+            closed.push_back(pair.first);
+    }
+    for (uint32_t windowId : closed)
+        CloseWindow(now, windowId);
+    if (focused)
+        FocusWindow(now, focused);
+}
+
+void WindowHistory::SetTitle(const std::wstring &title, LiveWindow &live) {
+    live.titleHash = Fnv1a32(reinterpret_cast<const BYTE*>(title.c_str()), title.size() * sizeof(wchar_t));
+    live.title.assign(title, 0, (std::min)(title.size(), HISTORY_TITLE_CHARS));
+    live.fileIds.clear();
+    if (m_files && m_files->matcher) {
+        m_files->matcher->FindMatches(title, m_scratchMatches);
+        for (int index : m_scratchMatches) {
+            if (live.fileIds.size() >= WINDOW_EVENT_MAX_FILES)
+                break;
+            if (index >= 0 && static_cast<size_t>(index) < m_files->ids.size())
+                live.fileIds.push_back(m_files->ids[index]);
+        }
+    }
+}
+
+void WindowHistory::OpenWindow(ULONGLONG now, uint32_t windowId, const WindowInfo &info) {
+    LiveWindow live;
+    live.processId = info.processId;
+    live.rect = info.rect;
+    live.state = static_cast<uint8_t>(info.state);
+    SetTitle(info.title, live);
+    uint64_t fileMask = 0;
+    for (uint32_t id : live.fileIds)
+        fileMask |= GetFileBit(id);
+    m_payload.clear();
+    PutWindow(m_payload, live.processId, live.rect, live.state, live.title, live.fileIds);
+    Append(now, HISTORY_OPENED, windowId, m_payload, fileMask);
+    m_live[windowId] = std::move(live);
+}
+
+void WindowHistory::UpdateWindow(ULONGLONG now, uint32_t windowId, LiveWindow &live, const WindowInfo &info) {
+    const RECT &rc = info.rect;
+    if (rc.left != live.rect.left || rc.top != live.rect.top ||
+        rc.right != live.rect.right || rc.bottom != live.rect.bottom) {
+        m_payload.clear();
+        PutSigned(m_payload, static_cast<int64_t>(rc.left) - live.rect.left);
+        PutSigned(m_payload, static_cast<int64_t>(rc.top) - live.rect.top);
+        PutSigned(m_payload, static_cast<int64_t>(rc.right) - live.rect.right);
+        PutSigned(m_payload, static_cast<int64_t>(rc.bottom) - live.rect.bottom);
+        Append(now, HISTORY_RECT, windowId, m_payload, 0);
+        live.rect = rc;
+    }
+    uint8_t state = static_cast<uint8_t>(info.state);
+    if (state != live.state) {
+        m_payload.assign(1, state);
+        Append(now, HISTORY_STATE, windowId, m_payload, 0);
+        live.state = state;
+    }
+    uint32_t titleHash = Fnv1a32(reinterpret_cast<const BYTE*>(info.title.c_str()), info.title.size() * sizeof(wchar_t));
+    if (titleHash != live.titleHash) {
+        LiveWindow next;
+        SetTitle(info.title, next);
+        uint64_t fileMask = 0;
+        for (uint32_t id : next.fileIds)
+            fileMask |= GetFileBit(id);
+        m_payload.clear();
+        PutTitle(m_payload, next.title, next.fileIds);
+        Append(now, HISTORY_TITLE, windowId, m_payload, fileMask);
+        live.titleHash = next.titleHash;
+        live.title.swap(next.title);
+        live.fileIds.swap(next.fileIds);
+    }
+}
+
+void WindowHistory::CloseWindow(ULONGLONG now, uint32_t windowId) {
+    auto it = m_live.find(windowId);
+    if (it == m_live.end())
+        return;
+    m_payload.clear();
+    Append(now, HISTORY_CLOSED, windowId, m_payload, 0);
+    m_live.erase(it);
+    if (m_foreground == windowId)
+        m_foreground = 0;
+}
+
+void WindowHistory::FocusWindow(ULONGLONG now, uint32_t windowId) {
+    if (windowId == m_foreground)
+        return;
+    m_payload.clear();
+    Append(now, HISTORY_FOCUSED, windowId, m_payload, 0);
+    m_foreground = windowId;
+}
+
+void WindowHistory::Append(ULONGLONG now, HistoryField field, uint32_t windowId,
+                           const std::vector<uint8_t> &payload, uint64_t fileMask) {
+    if (m_blockStarted) {
+        const Block &block = m_blocks[m_current];
+        if (block.header.bytes + RECORD_PREFIX_BYTES + payload.size() > HISTORY_BLOCK_BYTES ||
+            now >= block.header.firstTime + HISTORY_KEYFRAME_INTERVAL)
+            SealBlock(now);
+    }
+    if (!m_blockStarted)
+        StartBlock(now);
+    Block &block = m_blocks[m_current];
+    if (block.header.bytes + RECORD_PREFIX_BYTES + payload.size() > HISTORY_BLOCK_BYTES)
+        return; // Cannot happen with capped titles and file lists; the keyframe uses at most half a block.
+
+    now = (std::max)(now, m_lastTime); // The system clock may be set back.
+    m_scratchRecord.clear();
+    m_scratchRecord.push_back(static_cast<uint8_t>(field));
+    PutVarint(m_scratchRecord, now - m_lastTime);
+    PutVarint(m_scratchRecord, windowId);
+    memcpy(block.data.data() + block.header.bytes, m_scratchRecord.data(), m_scratchRecord.size());
+    block.header.bytes += static_cast<uint32_t>(m_scratchRecord.size());
+    if (!payload.empty()) {
+        memcpy(block.data.data() + block.header.bytes, payload.data(), payload.size());
+        block.header.bytes += static_cast<uint32_t>(payload.size());
+    }
+    block.header.records++;
+    block.header.fileMask |= fileMask;
+    block.header.lastTime = now;
+    m_lastTime = now;
+}
+
+void WindowHistory::StartBlock(ULONGLONG now) {
+    Block &block = m_blocks[m_current];
+    if (block.data.size() != HISTORY_BLOCK_BYTES)
+        block.data.resize(HISTORY_BLOCK_BYTES);
+    HistoryBlockHeader &header = block.header;
+    header = HistoryBlockHeader();
+    header.magic = HISTORY_BLOCK_MAGIC;
+    header.version = HISTORY_BLOCK_VERSION;
+    header.capacity = static_cast<uint32_t>(HISTORY_BLOCK_BYTES);
+    header.sequence = m_nextSequence++;
+    header.firstTime = now;
+    header.lastTime = now;
+
+    // The keyframe: the foreground window and every open window, in at most half a block.
+    m_scratchRecord.clear();
+    uint32_t count = 0;
+    for (const auto &pair : m_live) {
+        size_t mark = m_scratchRecord.size();
+        const LiveWindow &live = pair.second;
+        PutVarint(m_scratchRecord, pair.first);
+        PutWindow(m_scratchRecord, live.processId, live.rect, live.state, live.title, live.fileIds);
+        if (m_scratchRecord.size() + RECORD_PREFIX_BYTES + 5 > HISTORY_BLOCK_BYTES / 2) {
+            m_scratchRecord.resize(mark);
+            header.flags |= HISTORY_BLOCK_TRUNCATED;
+            break;
+        }
+        for (uint32_t id : live.fileIds)
+            header.fileMask |= GetFileBit(id);
+        ++count;
+    }
+    std::vector<uint8_t> prefix;
+    prefix.push_back(static_cast<uint8_t>(HISTORY_KEYFRAME));
+    PutVarint(prefix, 0);
+    PutVarint(prefix, m_foreground);
+    PutVarint(prefix, count);
+    memcpy(block.data.data(), prefix.data(), prefix.size());
+    memcpy(block.data.data() + prefix.size(), m_scratchRecord.data(), m_scratchRecord.size());
+    header.bytes = static_cast<uint32_t>(prefix.size() + m_scratchRecord.size());
+    header.records = 1;
+    m_lastTime = now;
+    m_blockStarted = true;
+}
+
+void WindowHistory::SealBlock(ULONGLONG now) {
+    if (!m_blockStarted)
+        return;
+    Block &block = m_blocks[m_current];
+    block.header.lastTime = (std::max)(now, static_cast<ULONGLONG>(block.header.lastTime));
+    block.header.checksum = Fnv1a32(block.data.data(), block.header.bytes);
+    WriteBlock(block);
+    m_current = (m_current + 1) % m_blocks.size();
+    m_blockStarted = false;
+}
+
+void WindowHistory::WriteBlock(const Block &block) {
+    if (m_file == INVALID_HANDLE_VALUE)
+        return;
+    size_t slot = static_cast<size_t>(block.header.sequence % HISTORY_DISK_BLOCKS);
+    ULARGE_INTEGER offset;
+    offset.QuadPart = static_cast<ULONGLONG>(slot) * SLOT_BYTES;
+    // Records first, then the header: a torn write leaves a checksum mismatch, not a wrong block.
+    OVERLAPPED atData = {};
+    ULARGE_INTEGER dataOffset;
+    dataOffset.QuadPart = offset.QuadPart + sizeof(HistoryBlockHeader);
+    atData.Offset = dataOffset.LowPart;
+    atData.OffsetHigh = dataOffset.HighPart;
+    OVERLAPPED atHeader = {};
+    atHeader.Offset = offset.LowPart;
+    atHeader.OffsetHigh = offset.HighPart;
+    DWORD written = 0;
+    if (!WriteFile(m_file, block.data.data(), block.header.bytes, &written, &atData) ||
+        written != block.header.bytes ||
+        !WriteFile(m_file, &block.header, sizeof(block.header), &written, &atHeader) ||
+        written != sizeof(block.header)) {
+        m_diskIndex[slot] = HistoryBlockHeader();
+        return;
+    }
+    m_diskIndex[slot] = block.header;
+}
+
+// ---- Queries --------------------------------------------------------------
+
+bool WindowHistory::ReadBlock(HANDLE file, const HistoryBlockHeader &expected, std::vector<uint8_t> &data) {
+    size_t slot = static_cast<size_t>(expected.sequence % HISTORY_DISK_BLOCKS);
+    ULARGE_INTEGER offset;
+    offset.QuadPart = static_cast<ULONGLONG>(slot) * SLOT_BYTES;
+    OVERLAPPED at = {};
+    at.Offset = offset.LowPart;
+    at.OffsetHigh = offset.HighPart;
+    HistoryBlockHeader header;
+    DWORD read = 0;
+    // The slot may have been overwritten since it was selected; the header and checksum tell.
+    if (!ReadFile(file, &header, sizeof(header), &read, &at) || read != sizeof(header) ||
+        header.sequence != expected.sequence || header.bytes != expected.bytes)
+        return false;
+    data.resize(header.bytes);
+    ULARGE_INTEGER dataOffset;
+    dataOffset.QuadPart = offset.QuadPart + sizeof(HistoryBlockHeader);
+    at = OVERLAPPED();
+    at.Offset = dataOffset.LowPart;
+    at.OffsetHigh = dataOffset.HighPart;
+    if (!ReadFile(file, data.data(), header.bytes, &read, &at) || read != header.bytes)
+        return false;
+    return Fnv1a32(data.data(), data.size()) == header.checksum;
+}
+
+namespace {
+
+// Replays one block and adds the clipped open and focused time of its windows.
+class BlockReplay {
+public:
+    BlockReplay(bool byFile, uint32_t fileId, ULONGLONG from, ULONGLONG to,
+                std::unordered_map<uint64_t, WindowActivity> &activity)
+        : m_byFile(byFile), m_fileId(fileId), m_from(from), m_to(to), m_activity(activity)
+        , m_foreground(0), m_focusing(false), m_focusSince(0)
+    {
+    }
+
+    void Run(const HistoryBlockHeader &header, const std::vector<uint8_t> &data, ULONGLONG blockEnd) {
+        RecordReader reader = { data.data(), data.data() + data.size() };
+        ULONGLONG time = header.firstTime;
+        ULONGLONG end = (std::min)(blockEnd, m_to);
+        uint8_t field;
+        uint64_t dt;
+        uint32_t windowId, count;
+        if (reader.Byte(field) && field == HISTORY_KEYFRAME && reader.Varint(dt) &&
+            reader.Varint32(windowId) && reader.Varint32(count)) {
+            bool ok = true;
+            for (uint32_t i = 0; i < count && ok; ++i) {
+                uint32_t id;
+                Window window;
+                ok = reader.Varint32(id) && ReadWindow(reader, window);
+                if (ok)
+                    m_windows[id] = std::move(window);
+            }
+            if (ok) {
+                for (auto &pair : m_windows)
+                    Start(pair.first, pair.second, time);
+                SetForeground(windowId, time);
+                while (reader.pos < reader.end && ApplyNext(reader, time)) {
+                }
+            }
+        }
+        for (auto &pair : m_windows)
+            Stop(pair.first, pair.second, (std::max)(time, end));
+    }
+
+private:
+    struct Window {
+        DWORD processId;
+        RECT rect;
+        uint8_t state;
+        std::wstring title;
+        std::vector<uint32_t> fileIds;
+        bool counting;
+        ULONGLONG since;
+    };
+
+    static bool ReadWindow(RecordReader &reader, Window &window) {
+        window.counting = false;
+        window.since = 0;
+        uint32_t processId;
+        if (!reader.Varint32(processId) || !reader.Byte(window.state) ||
+            !reader.Signed(window.rect.left) || !reader.Signed(window.rect.top) ||
+            !reader.Signed(window.rect.right) || !reader.Signed(window.rect.bottom) ||
+            !reader.Title(window.title, window.fileIds))
+            return false;
+        window.processId = processId;
+        return true;
+    }
+
+    // Applies the next record; false at the end of the range or on a damaged record.
+    bool ApplyNext(RecordReader &reader, ULONGLONG &time) {
+        uint8_t field;
+        uint64_t dt;
+        uint32_t windowId;
+        if (!reader.Byte(field) || !reader.Varint(dt) || !reader.Varint32(windowId))
+            return false;
+        if (time + dt > m_to)
+            return false;
+        time += dt;
+        auto it = m_windows.find(windowId);
+        switch (field) {
+            case HISTORY_OPENED: {
+                Window window;
+                if (!ReadWindow(reader, window))
+                    return false;
+                if (it != m_windows.end())
+                    Stop(windowId, it->second, time);
+                Window &slot = m_windows[windowId];
+                slot = std::move(window);
+                Start(windowId, slot, time);
+                return true;
+            }
+            case HISTORY_CLOSED:
+                if (it != m_windows.end()) {
+                    Stop(windowId, it->second, time);
+                    m_windows.erase(it);
+                    if (m_foreground == windowId)
+                        SetForeground(0, time);
+                }
+                return true;
+            case HISTORY_FOCUSED:
+                SetForeground(windowId, time);
+                return true;
+            case HISTORY_RECT: {
+                LONG dl, dtop, dr, db;
+                if (!reader.Signed(dl) || !reader.Signed(dtop) || !reader.Signed(dr) || !reader.Signed(db))
+                    return false;
+                if (it != m_windows.end()) {
+                    it->second.rect.left += dl;
+                    it->second.rect.top += dtop;
+                    it->second.rect.right += dr;
+                    it->second.rect.bottom += db;
+                }
+                return true;
+            }
+            case HISTORY_STATE: {
+                uint8_t state;
+                if (!reader.Byte(state))
+                    return false;
+                if (it != m_windows.end())
+                    it->second.state = state;
+                return true;
+            }
+            case HISTORY_TITLE: {
+                std::wstring title;
+                std::vector<uint32_t> fileIds;
+                if (!reader.Title(title, fileIds))
+                    return false;
+                if (it != m_windows.end()) {
+                    // The interval is split so the title counted for a file is the one that showed it.
+                    Stop(windowId, it->second, time);
+                    it->second.title.swap(title);
+                    it->second.fileIds.swap(fileIds);
+                    Start(windowId, it->second, time);
+                }
+                return true;
+            }
+            default:
+                return false;
+        }
+    }
+
+    bool Counts(const Window &window) const {
+        return !m_byFile || std::find(window.fileIds.begin(), window.fileIds.end(), m_fileId) != window.fileIds.end();
+    }
+
+    WindowActivity& GetActivity(uint32_t windowId, const Window &window) {
+        uint64_t key = (static_cast<uint64_t>(window.processId) << 32) | windowId;
+        auto result = m_activity.emplace(key, WindowActivity());
+        WindowActivity &activity = result.first->second;
+        if (result.second) {
+            activity.windowId = windowId;
+            activity.processId = window.processId;
+            activity.firstSeen = 0;
+            activity.lastSeen = 0;
+            activity.openMs = 0;
+            activity.focusedMs = 0;
+        }
+        return activity;
+    }
+
+    void Start(uint32_t windowId, Window &window, ULONGLONG time) {
+        if (!Counts(window))
+            return;
+        window.counting = true;
+        window.since = time;
+        if (m_foreground == windowId) {
+            m_focusing = true;
+            m_focusSince = time;
+        }
+    }
+
+    void Stop(uint32_t windowId, Window &window, ULONGLONG time) {
+        if (!window.counting)
+            return;
+        window.counting = false;
+        ULONGLONG begin = (std::max)(window.since, m_from);
+        ULONGLONG end = (std::min)(time, m_to);
+        if (m_focusing && m_foreground == windowId) {
+            AddFocus(windowId, window, m_focusSince, time);
+            m_focusing = false;
+        }
+        if (end <= begin)
+            return;
+        WindowActivity &activity = GetActivity(windowId, window);
+        if (!activity.openMs || begin < activity.firstSeen)
+            activity.firstSeen = begin;
+        if (end >= activity.lastSeen) {
+            activity.lastSeen = end;
+            activity.title = window.title;
+            activity.rect = window.rect;
+            activity.state = static_cast<WindowState>(window.state);
+        }
+        activity.openMs += end - begin;
+        for (uint32_t id : window.fileIds) {
+            if (std::find(activity.fileIds.begin(), activity.fileIds.end(), id) == activity.fileIds.end())
+                activity.fileIds.push_back(id);
+        }
+    }
+
+    void AddFocus(uint32_t windowId, const Window &window, ULONGLONG since, ULONGLONG time) {
+        ULONGLONG begin = (std::max)(since, m_from);
+        ULONGLONG end = (std::min)(time, m_to);
+        if (end > begin)
+            GetActivity(windowId, window).focusedMs += end - begin;
+    }
+
+    void SetForeground(uint32_t windowId, ULONGLONG time) {
+        if (m_focusing) {
+            auto it = m_windows.find(m_foreground);
+            if (it != m_windows.end())
+                AddFocus(m_foreground, it->second, m_focusSince, time);
+            m_focusing = false;
+        }
+        m_foreground = windowId;
+        auto it = m_windows.find(windowId);
+        if (it != m_windows.end() && it->second.counting) {
+            m_focusing = true;
+            m_focusSince = time;
+        }
+    }
+
+    bool m_byFile;
+    uint32_t m_fileId;
+    ULONGLONG m_from;
+    ULONGLONG m_to;
+    std::unordered_map<uint64_t, WindowActivity> &m_activity;
+    std::unordered_map<uint32_t, Window> m_windows;
+    uint32_t m_foreground;
+    bool m_focusing;
+    ULONGLONG m_focusSince;
+};
+
+struct SelectedBlock {
+    HistoryBlockHeader header;
+    ULONGLONG end;                  ///< Time the block's state is known up to.
+    bool inMemory;
+    std::vector<uint8_t> data;      ///< Copied for memory blocks, read later for disk blocks.
+};
+
+} // namespace
+
+bool WindowHistory::QueryRange(ULONGLONG from, ULONGLONG to, std::vector<WindowActivity> &activity) {
+    return Query(false, 0, from, to, activity);
+}
+
+bool WindowHistory::QueryFile(uint32_t fileId, ULONGLONG from, ULONGLONG to, std::vector<WindowActivity> &activity) {
+    return Query(true, fileId, from, to, activity);
+}
+
+bool WindowHistory::Query(bool byFile, uint32_t fileId, ULONGLONG from, ULONGLONG to,
+                          std::vector<WindowActivity> &activity) {
+    activity.clear();
+    if (to < from)
+        return false;
+    std::vector<SelectedBlock> selected;
+    HANDLE file = INVALID_HANDLE_VALUE;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ULONGLONG now = HistoryNow();
+        auto overlaps = [&](const HistoryBlockHeader &header, ULONGLONG end) {
+            return header.magic == HISTORY_BLOCK_MAGIC && header.firstTime <= to && end >= from &&
+                   (!byFile || (header.fileMask & GetFileBit(fileId)));
+        };
+        for (size_t i = 0; i < m_blocks.size(); ++i) {
+            const Block &block = m_blocks[i];
+            bool current = (i == m_current);
+            if (current && !m_blockStarted)
+                continue; // Not started yet: holds the oldest block, about to be reused.
+            // The open block's windows are known to be open up to now.
+            ULONGLONG end = current ? (std::max)(now, static_cast<ULONGLONG>(block.header.lastTime)) : block.header.lastTime;
+            if (!overlaps(block.header, end))
+                continue;
+            SelectedBlock pick;
+            pick.header = block.header;
+            pick.end = end;
+            pick.inMemory = true;
+            pick.data.assign(block.data.begin(), block.data.begin() + block.header.bytes);
+            selected.push_back(std::move(pick));
+        }
+        for (const HistoryBlockHeader &header : m_diskIndex) {
+            if (!overlaps(header, header.lastTime))
+                continue;
+            bool inMemory = false;
+            for (const SelectedBlock &pick : selected)
+                inMemory = inMemory || (pick.inMemory && pick.header.sequence == header.sequence);
+            if (inMemory)
+                continue;
+            SelectedBlock pick;
+            pick.header = header;
+            pick.end = header.lastTime;
+            pick.inMemory = false;
+            selected.push_back(std::move(pick));
+        }
+        // The blocks are read unlocked; a handle of our own stays valid if Close()
+        // or Open() closes m_file meanwhile.
+        bool onDisk = false;
+        for (const SelectedBlock &pick : selected)
+            onDisk = onDisk || !pick.inMemory;
+        if (onDisk && m_file != INVALID_HANDLE_VALUE &&
+            !DuplicateHandle(GetCurrentProcess(), m_file, GetCurrentProcess(), &file, 0, FALSE, DUPLICATE_SAME_ACCESS))
+            file = INVALID_HANDLE_VALUE;
+    }
+    if (selected.empty())
+        return false;
+
+    std::sort(selected.begin(), selected.end(), [](const SelectedBlock &a, const SelectedBlock &b) {
+        return a.header.sequence < b.header.sequence;
+    });
+    std::unordered_map<uint64_t, WindowActivity> byWindow;
+    for (SelectedBlock &pick : selected) {
+        if (!pick.inMemory && (file == INVALID_HANDLE_VALUE || !ReadBlock(file, pick.header, pick.data)))
+            continue;
+        BlockReplay replay(byFile, fileId, from, to, byWindow);
+        replay.Run(pick.header, pick.data, pick.end);
+    }
+    if (file != INVALID_HANDLE_VALUE)
+        CloseHandle(file);
+
+    activity.reserve(byWindow.size());
+    for (auto &pair : byWindow)
+        activity.push_back(std::move(pair.second));
+    std::sort(activity.begin(), activity.end(), [](const WindowActivity &a, const WindowActivity &b) {
+        if (a.focusedMs != b.focusedMs)
+            return a.focusedMs > b.focusedMs;
+        return a.openMs > b.openMs;
+    });
+    return true;
+}
+
+ULONGLONG WindowHistory::GetOldestTime() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ULONGLONG oldest = 0;
+    auto consider = [&](const HistoryBlockHeader &header) {
+        if (header.magic == HISTORY_BLOCK_MAGIC && (!oldest || header.firstTime < oldest))
+            oldest = header.firstTime;
+    };
+    for (const HistoryBlockHeader &header : m_diskIndex)
+        consider(header);
+    for (size_t i = 0; i < m_blocks.size(); ++i) {
+        if (i != m_current || m_blockStarted)
+            consider(m_blocks[i].header);
+    }
+    return oldest;
+}
+
+// End of file: WindowHistory.cpp (Version: 1.1)
@@ -0,0 +1,188 @@
+// File: WindowHistory.h
+// Version: 1.1
+// -------------------------------------------------------------------------
+// This header declares WindowHistory, the bounded record of window activity
+// (what was open, focused and where) behind the usage queries.
+//
+// The snapshot worker's WindowMonitor hands every change it applies to its
+// table to Record() (and a rebuilt table to Resync(), which diffs it against
+// the windows the history knows). Each change becomes one delta record:
+//
+//   field (1 byte), time since the previous record (varint, ms),
+//   window ID (varint, low 32 bits of the HWND), new value
+//
+// where the new value is the full window for HISTORY_OPENED, nothing for
+// HISTORY_CLOSED and HISTORY_FOCUSED, the zigzag difference to the previous
+// rectangle for HISTORY_RECT, the state for HISTORY_STATE, and the title
+// (truncated to HISTORY_TITLE_CHARS) with the IDs of the project files it
+// shows (WindowEventFileId()) for HISTORY_TITLE.
+//
+// Records are appended to blocks of HISTORY_BLOCK_BYTES. Every block starts
+// with a keyframe, the full state of the open windows and the foreground
+// window, so a block decodes on its own. A block is sealed when it is full
+// or when a record arrives HISTORY_KEYFRAME_INTERVAL after its keyframe. Sealed blocks are
+// written to a slot of the segment file, which holds HISTORY_DISK_BLOCKS
+// fixed-size slots written round robin, and the last HISTORY_MEMORY_BLOCKS
+// blocks stay in memory. Memory and disk use are therefore fixed; the
+// oldest block is overwritten once the file is full.
+//
+// Every block header carries its time range and a 64-bit mask of the file
+// IDs it mentions (bit fileId % 64). QueryRange() and QueryFile() decode
+// only the blocks whose time range overlaps the query (and, for a file,
+// whose mask has its bit), each from its own keyframe.
+//
+// Times are HistoryNow(): UTC milliseconds since 1601, so they survive
+// restarts. Record() and Resync() run on the worker thread; Open(), Close()
+// and the queries may be called from any thread.
+//
+// Changes in Version 1.1:
+//  - Queries read the segment file through a handle of their own.
+// -------------------------------------------------------------------------
+
+#ifndef WINDOWHISTORY_H
+#define WINDOWHISTORY_H
+
+#include <windows.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "WindowEventRing.h"    // For WindowEventKind, WindowEventFiles and WindowEventFileId()
+#include "WindowMonitor.h"      // For WindowInfo and WindowState
+
+const uint32_t HISTORY_BLOCK_MAGIC = 0x3148574D;   // "MWH1"
+const uint16_t HISTORY_BLOCK_VERSION = 1;
+const uint16_t HISTORY_BLOCK_TRUNCATED = 0x0001;   // The keyframe could not hold every open window.
+
+enum HistoryField : uint8_t {
+    HISTORY_KEYFRAME = 0,   // First record of a block: foreground ID, count, then ID + window per open window.
+    HISTORY_OPENED = 1,
+    HISTORY_CLOSED = 2,
+    HISTORY_FOCUSED = 3,
+    HISTORY_RECT = 4,
+    HISTORY_STATE = 5,
+    HISTORY_TITLE = 6
+};
+
+// Header of a block, in memory and in front of every slot of the segment file.
+struct HistoryBlockHeader {
+    uint32_t magic;         // HISTORY_BLOCK_MAGIC (0: slot never written)
+    uint16_t version;       // HISTORY_BLOCK_VERSION
+    uint16_t flags;
+    uint32_t capacity;      // HISTORY_BLOCK_BYTES when written.
+    uint32_t bytes;         // Record bytes in use.
+    uint64_t sequence;      // Block number; the slot is sequence % HISTORY_DISK_BLOCKS.
+    uint64_t firstTime;     // Time of the keyframe.
+    uint64_t lastTime;      // The state is known up to this time.
+    uint64_t fileMask;      // Bit fileId % 64 of every file ID in the block.
+    uint32_t records;
+    uint32_t checksum;      // FNV-1a of the record bytes.
+    uint64_t reserved;
+};
+
+static_assert(sizeof(HistoryBlockHeader) == 64, "HistoryBlockHeader layout");
+
+/**
+ * @struct WindowActivity
+ * @brief One window's activity within a query range.
+ */
+struct WindowActivity {
+    uint32_t windowId;              ///< Low 32 bits of the HWND.
+    DWORD processId;
+    std::wstring title;             ///< Last title in the range (truncated to HISTORY_TITLE_CHARS).
+    std::vector<uint32_t> fileIds;  ///< WindowEventFileId() of the files its titles showed.
+    ULONGLONG firstSeen;            ///< Start of the first counted interval in the range.
+    ULONGLONG lastSeen;             ///< End of the last counted interval in the range.
+    ULONGLONG openMs;               ///< Time open within the range.
+    ULONGLONG focusedMs;            ///< Time in the foreground within the range.
+    RECT rect;                      ///< Last rectangle in the range.
+    WindowState state;              ///< Last state in the range.
+};
+
+// UTC milliseconds since 1601, the clock of all history times.
+ULONGLONG HistoryNow();
+
+class WindowHistory {
+public:
+    WindowHistory();
+    ~WindowHistory();
+
+    // Opens or creates the segment file and reads its block headers. Without
+    // a file the history keeps only the blocks in memory. Returns false then.
+    bool Open(const std::wstring &segmentFile);
+    // Seals the current block (written to the file) and closes the file.
+    void Close();
+
+    // Worker thread: project files whose IDs are attached to titles.
+    void SetFiles(std::shared_ptr<const WindowEventFiles> files);
+    // Worker thread: one change of the monitor's table (WINDOW_EVENT_RESYNC is ignored).
+    void Record(WindowEventKind kind, HWND hwnd, const WindowInfo *info);
+    // Worker thread: the table after a sweep; records what changed.
+    void Resync(const std::vector<WindowInfo> &windows);
+
+    // Activity of every window within [from, to], most focused first.
+    // Returns false if no recorded block overlaps the range.
+    bool QueryRange(ULONGLONG from, ULONGLONG to, std::vector<WindowActivity> &activity);
+    // The same, counting only the time a window's title showed fileId.
+    bool QueryFile(uint32_t fileId, ULONGLONG from, ULONGLONG to, std::vector<WindowActivity> &activity);
+
+    // Time of the oldest recorded keyframe, or 0 if nothing is recorded.
+    ULONGLONG GetOldestTime();
+
+private:
+    struct LiveWindow {
+        DWORD processId;
+        RECT rect;
+        uint8_t state;                  ///< WindowState
+        uint32_t titleHash;             ///< Of the whole title, to notice changes past HISTORY_TITLE_CHARS.
+        std::wstring title;             ///< Truncated to HISTORY_TITLE_CHARS.
+        std::vector<uint32_t> fileIds;
+    };
+    struct Block {
+        HistoryBlockHeader header;      ///< magic 0 until the slot is first used.
+        std::vector<uint8_t> data;      ///< HISTORY_BLOCK_BYTES, allocated once.
+    };
+
+    // Writer side, called with m_mutex held. Append() starts and seals blocks
+    // before it writes the record, so a keyframe never includes the change
+    // that is being recorded.
+    void Append(ULONGLONG now, HistoryField field, uint32_t windowId, const std::vector<uint8_t> &payload,
+                uint64_t fileMask);
+    void StartBlock(ULONGLONG now);
+    void SealBlock(ULONGLONG now);
+    void WriteBlock(const Block &block);
+    void OpenWindow(ULONGLONG now, uint32_t windowId, const WindowInfo &info);
+    void UpdateWindow(ULONGLONG now, uint32_t windowId, LiveWindow &live, const WindowInfo &info);
+    void CloseWindow(ULONGLONG now, uint32_t windowId);
+    void FocusWindow(ULONGLONG now, uint32_t windowId);
+    void SetTitle(const std::wstring &title, LiveWindow &live);
+
+    // Query side: selects the blocks under m_mutex, then reads (through a duplicate
+    // of m_file) and decodes them unlocked.
+    bool Query(bool byFile, uint32_t fileId, ULONGLONG from, ULONGLONG to, std::vector<WindowActivity> &activity);
+    static bool ReadBlock(HANDLE file, const HistoryBlockHeader &header, std::vector<uint8_t> &data);
+
+    std::mutex m_mutex;                 // Guards everything below.
+    HANDLE m_file;
+    std::vector<HistoryBlockHeader> m_diskIndex;    ///< Header of every slot (magic 0 if empty).
+    std::vector<Block> m_blocks;        ///< Memory ring; m_blocks[m_current] is written next.
+    size_t m_current;
+    bool m_blockStarted;                ///< m_blocks[m_current] holds a keyframe.
+    uint64_t m_nextSequence;
+    ULONGLONG m_lastTime;               ///< Time of the last record appended.
+
+    // Writer state: the windows as last recorded.
+    std::unordered_map<uint32_t, LiveWindow> m_live;
+    uint32_t m_foreground;              ///< Window ID, 0 if none.
+    std::shared_ptr<const WindowEventFiles> m_files;
+    std::vector<uint8_t> m_payload;
+    std::vector<uint8_t> m_scratchRecord;
+    std::vector<int> m_scratchMatches;
+    std::vector<uint32_t> m_scratchIds;
+};
+
+#endif // WINDOWHISTORY_H
+
+// End of file: WindowHistory.h (Version: 1.1)
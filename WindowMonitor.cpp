@@ -1,32 +1,47 @@
 // File: WindowMonitor.cpp
-// Version: 1.2
+// Version: 1.11 (Single creation event per window)
 
 #include "WindowMonitor.h"
-#include <psapi.h>
+#include "ProcessCache.h"
+#include "StringInterner.h"
+#include "WindowEventRing.h"
+#include "WindowHistory.h"
+#include "Tracing.h"
+#include <algorithm>
 #include <sstream>
 #include <vector>
 #include <cwchar>
 
-// Helper callback used by EnumWindows.
-static BOOL CALLBACK EnumWindowsCallback(HWND hwnd, LPARAM lParam) {
-    std::vector<WindowInfo>* pWindows = reinterpret_cast<std::vector<WindowInfo>*>(lParam);
+WindowMonitor* WindowMonitor::s_activeMonitor = nullptr;
+
+// Cached processes without any lookup for this long are released on Resync().
+static const ULONGLONG PROCESS_CACHE_IDLE_MS = 60000;
 
+// Reads the title of hwnd into title, reusing its capacity.
+static void ReadWindowTitle(HWND hwnd, int length, std::wstring &title) {
+    // Thread-local so that rereading a title of similar length does not allocate.
+    thread_local std::vector<wchar_t> buffer;
+    if (buffer.size() < static_cast<size_t>(length) + 1)
+        buffer.resize(length + 1);
+    int copied = GetWindowText(hwnd, buffer.data(), length + 1);
+    title.assign(buffer.data(), copied > 0 ? copied : 0);
+}
+
+// Fills info for a visible top-level window with a non-empty title.
+// Returns false if the window should not appear in the window table.
+static bool CaptureWindowInfo(HWND hwnd, WindowInfo &info) {
     // Only consider visible windows with non-empty titles.
     if (!IsWindowVisible(hwnd))
-        return TRUE;
+        return false;
     int length = GetWindowTextLength(hwnd);
     if (length == 0)
-        return TRUE;
+        return false;
 
-    std::wstring title(length + 1, L'\0');
-    GetWindowText(hwnd, &title[0], length + 1);
-    title.resize(wcslen(title.c_str()));
-    if(title.empty())
-        return TRUE;
+    ReadWindowTitle(hwnd, length, info.title);
+    if(info.title.empty())
+        return false;
 
-    WindowInfo info;
     info.hwnd = hwnd;
-    info.title = title;
     GetWindowRect(hwnd, &info.rect);
 
     // Determine window state using GetWindowPlacement.
@@ -48,31 +63,53 @@ static BOOL CALLBACK EnumWindowsCallback(HWND hwnd, LPARAM lParam) {
     GetWindowThreadProcessId(hwnd, &pid);
     info.processId = pid;
 
-    // Retrieve process name.
-    info.processName = L"";
-    HANDLE hProcess = OpenProcess(PROCESS_QUERY_INFORMATION | PROCESS_VM_READ, FALSE, pid);
-    if(hProcess) {
-        wchar_t processPath[MAX_PATH] = {0};
-        if(GetModuleFileNameEx(hProcess, NULL, processPath, MAX_PATH))
-            info.processName = processPath;
-        CloseHandle(hProcess);
-    }
-    
+    // Retrieve the process name (cached and interned per process instance).
+    info.processNameId = ProcessCache::Shared().GetImagePathId(pid);
+
     // Determine if the window is focused.
     info.isFocused = (hwnd == GetForegroundWindow());
-    
+
     // Retrieve the window's class name.
     wchar_t classBuf[256] = {0};
-    if(GetClassName(hwnd, classBuf, 256))
-        info.className = classBuf;
-    else
-        info.className = L"";
+    int classLen = GetClassName(hwnd, classBuf, 256);
+    info.classId = StringInterner::ClassNames().Intern(classBuf, classLen > 0 ? classLen : 0);
+    return true;
+}
+
+// EnumWindows state for a sweep that refills an existing table in place.
+struct SweepContext {
+    std::vector<WindowInfo> *windows;
+    size_t count;  // Rows filled so far; rows past count are stale.
+};
 
-    pWindows->push_back(info);
+// Helper callback used by EnumWindows.
+static BOOL CALLBACK EnumWindowsCallback(HWND hwnd, LPARAM lParam) {
+    SweepContext *context = reinterpret_cast<SweepContext*>(lParam);
+    std::vector<WindowInfo> &windows = *context->windows;
+    if (context->count == windows.size())
+        windows.emplace_back();
+    // Capturing into an old row reuses its title buffer.
+    if (CaptureWindowInfo(hwnd, windows[context->count]))
+        ++context->count;
     return TRUE;
 }
 
-WindowMonitor::WindowMonitor() : m_hook(nullptr) {}
+// Returns true if hwnd is a top-level window (a direct child of the desktop).
+static bool IsTopLevelWindow(HWND hwnd) {
+    return GetAncestor(hwnd, GA_PARENT) == GetDesktopWindow();
+}
+
+WindowMonitor::WindowMonitor()
+    : m_generation(0)
+    , m_hwndNotify(nullptr)
+    , m_notifyMsg(0)
+    , m_notifyPending(false)
+    , m_eventRing(nullptr)
+    , m_history(nullptr)
+{
+    for (int i = 0; i < HOOK_COUNT; ++i)
+        m_hooks[i] = nullptr;
+}
 
 WindowMonitor::~WindowMonitor() {
     StopMonitoring();
@@ -80,30 +117,230 @@ WindowMonitor::~WindowMonitor() {
 
 std::vector<WindowInfo> WindowMonitor::EnumerateWindows() {
     std::vector<WindowInfo> windows;
-    EnumWindows(EnumWindowsCallback, reinterpret_cast<LPARAM>(&windows));
+    SweepContext context = { &windows, 0 };
+    EnumWindows(EnumWindowsCallback, reinterpret_cast<LPARAM>(&context));
+    windows.resize(context.count);
     return windows;
 }
 
-bool WindowMonitor::StartMonitoring() {
-    if(m_hook)
+bool WindowMonitor::StartMonitoring(HWND hwndNotify, UINT notifyMsg) {
+    if(m_hooks[0])
         return true;
-    m_hook = SetWinEventHook(EVENT_OBJECT_CREATE, EVENT_OBJECT_DESTROY, NULL,
-                             WinEventProc, 0, 0, WINEVENT_OUTOFCONTEXT);
-    return (m_hook != nullptr);
+    if(s_activeMonitor && s_activeMonitor != this)
+        return false;
+    s_activeMonitor = this;
+    m_hwndNotify = hwndNotify;
+    m_notifyMsg = notifyMsg;
+    m_notifyPending = false;
+
+    // Object events: create, destroy, show, hide, location change and name change.
+    m_hooks[0] = SetWinEventHook(EVENT_OBJECT_CREATE, EVENT_OBJECT_NAMECHANGE, NULL,
+                                 WinEventProc, 0, 0, WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+    // The object events above skip our own process: its list controls raise them on
+    // every refresh, and its windows are picked up by Resync(). The two system hooks
+    // below do not. They are rare, and when one of MYexplorer's windows takes the
+    // foreground (or is minimized) the previously focused row must still lose its flag.
+    // Foreground changes update the focused flag and z-order.
+    m_hooks[1] = SetWinEventHook(EVENT_SYSTEM_FOREGROUND, EVENT_SYSTEM_FOREGROUND, NULL,
+                                 WinEventProc, 0, 0, WINEVENT_OUTOFCONTEXT);
+    // Minimize/restore changes the window state column.
+    m_hooks[2] = SetWinEventHook(EVENT_SYSTEM_MINIMIZESTART, EVENT_SYSTEM_MINIMIZEEND, NULL,
+                                 WinEventProc, 0, 0, WINEVENT_OUTOFCONTEXT);
+    if (!m_hooks[0] || !m_hooks[1] || !m_hooks[2]) {
+        StopMonitoring();
+        return false;
+    }
+
+    Resync();
+    return true;
 }
 
 void WindowMonitor::StopMonitoring() {
-    if(m_hook) {
-        UnhookWinEvent(m_hook);
-        m_hook = nullptr;
+    for (int i = 0; i < HOOK_COUNT; ++i) {
+        if(m_hooks[i]) {
+            UnhookWinEvent(m_hooks[i]);
+            m_hooks[i] = nullptr;
+        }
     }
+    if (s_activeMonitor == this)
+        s_activeMonitor = nullptr;
+}
+
+void WindowMonitor::Resync() {
+    TraceActivity activity;
+    TraceStart(activity, TracePhase::WindowSweep);
+    ProcessCache &processCache = ProcessCache::Shared();
+    ULONGLONG hits = processCache.GetHitCount();
+    ULONGLONG misses = processCache.GetMissCount();
+    processCache.Prune(PROCESS_CACHE_IDLE_MS);
+    // Refill the spare table, then swap it in; the old rows become the spare.
+    // resize() only runs destructors on surplus rows, so the buffers of the
+    // remaining rows survive for the next sweep.
+    SweepContext context = { &m_sweep, 0 };
+    EnumWindows(EnumWindowsCallback, reinterpret_cast<LPARAM>(&context));
+    m_sweep.resize(context.count);
+    m_windows.swap(m_sweep);
+    PublishEvent(WINDOW_EVENT_RESYNC, nullptr, nullptr);
+    NotifyChanged();
+    TraceWindowSweepStop(activity, static_cast<UINT>(m_windows.size()),
+                         processCache.GetHitCount() - hits, processCache.GetMissCount() - misses);
 }
 
 void CALLBACK WindowMonitor::WinEventProc(HWINEVENTHOOK hWinEventHook, DWORD event, HWND hwnd,
                                           LONG idObject, LONG idChild, DWORD dwEventThread, DWORD dwmsEventTime) {
-    std::wstringstream ss;
-    ss << L"WinEvent: event=" << event << L", hwnd=0x" << std::hex << (uintptr_t)hwnd;
-    OutputDebugString(ss.str().c_str());
+    // Only whole-window events are relevant; skip carets, cursors and child objects.
+    if (!hwnd || idObject != OBJID_WINDOW || idChild != CHILDID_SELF)
+        return;
+    if (s_activeMonitor)
+        s_activeMonitor->OnWindowEvent(event, hwnd);
+}
+
+void WindowMonitor::OnWindowEvent(DWORD event, HWND hwnd) {
+    int index = FindWindowIndex(hwnd);
+
+    switch (event) {
+    case EVENT_OBJECT_DESTROY:
+    case EVENT_OBJECT_HIDE:
+        // Hidden windows are excluded from the table, just like in EnumerateWindows().
+        if (index >= 0) {
+            PublishEvent(WINDOW_EVENT_DESTROYED, hwnd, &m_windows[index]);
+            m_windows.erase(m_windows.begin() + index);
+            NotifyChanged();
+        }
+        return;
+
+    case EVENT_SYSTEM_FOREGROUND: {
+        bool changed = false;
+        for (auto &win : m_windows) {
+            bool focused = (win.hwnd == hwnd);
+            if (win.isFocused != focused) {
+                win.isFocused = focused;
+                changed = true;
+            }
+        }
+        // The new foreground window moves to the top of the z-order.
+        if (index > 0) {
+            std::rotate(m_windows.begin(), m_windows.begin() + index, m_windows.begin() + index + 1);
+            changed = true;
+        }
+        if (changed)
+            NotifyChanged();
+        if (index >= 0) {
+            if (changed)
+                PublishEvent(WINDOW_EVENT_FOCUSED, hwnd, &m_windows[0]);
+            return;
+        }
+        break; // Not tracked yet; try to capture it below.
+    }
+
+    case EVENT_OBJECT_LOCATIONCHANGE:
+    case EVENT_SYSTEM_MINIMIZESTART:
+    case EVENT_SYSTEM_MINIMIZEEND:
+        if (index >= 0) {
+            WindowInfo &win = m_windows[index];
+            RECT rc;
+            GetWindowRect(hwnd, &rc);
+            WindowState state = GetWindowState(hwnd);
+            if (!EqualRect(&rc, &win.rect) || state != win.state) {
+                win.rect = rc;
+                win.state = state;
+                PublishEvent(WINDOW_EVENT_MOVED, hwnd, &win);
+                NotifyChanged();
+            }
+            return;
+        }
+        break;
+
+    case EVENT_OBJECT_NAMECHANGE:
+        if (index >= 0 || IsTopLevelWindow(hwnd))
+            m_renamed.insert(hwnd);
+        if (index >= 0) {
+            int length = GetWindowTextLength(hwnd);
+            std::wstring title;
+            if (length > 0)
+                ReadWindowTitle(hwnd, length, title);
+            if (title.empty()) {
+                PublishEvent(WINDOW_EVENT_DESTROYED, hwnd, &m_windows[index]);
+                m_windows.erase(m_windows.begin() + index);
+                NotifyChanged();
+            } else if (title != m_windows[index].title) {
+                m_windows[index].title = title;
+                PublishEvent(WINDOW_EVENT_TITLE, hwnd, &m_windows[index]);
+                NotifyChanged();
+            }
+            return;
+        }
+        break;
+
+    case EVENT_OBJECT_CREATE:
+    case EVENT_OBJECT_SHOW:
+        break;
+
+    default:
+        return;
+    }
+
+    // The window is not in the table yet (or was just shown); capture it if it qualifies.
+    if (!IsTopLevelWindow(hwnd))
+        return;
+    WindowInfo info;
+    if (!CaptureWindowInfo(hwnd, info))
+        return;
+    if (index >= 0) {
+        // Shown or created again while in the table: report only what changed, so the
+        // event ring and the history see a single creation per window.
+        WindowInfo &win = m_windows[index];
+        bool moved = !EqualRect(&info.rect, &win.rect) || info.state != win.state;
+        bool retitled = info.title != win.title;
+        bool changed = moved || retitled || info.isFocused != win.isFocused || info.processId != win.processId ||
+                       info.processNameId != win.processNameId || info.classId != win.classId;
+        win = info;
+        if (retitled)
+            PublishEvent(WINDOW_EVENT_TITLE, hwnd, &win);
+        if (moved)
+            PublishEvent(WINDOW_EVENT_MOVED, hwnd, &win);
+        if (changed)
+            NotifyChanged();
+        return;
+    }
+    m_windows.insert(m_windows.begin(), info); // New windows appear at the top.
+    PublishEvent(WINDOW_EVENT_CREATED, hwnd, &info);
+    if (event == EVENT_SYSTEM_FOREGROUND)
+        PublishEvent(WINDOW_EVENT_FOCUSED, hwnd, &info);
+    NotifyChanged();
+}
+
+void WindowMonitor::TakeRenamedWindows(std::unordered_set<HWND> &renamed) {
+    renamed.clear();
+    renamed.swap(m_renamed);
+}
+
+int WindowMonitor::FindWindowIndex(HWND hwnd) const {
+    for (size_t i = 0; i < m_windows.size(); ++i) {
+        if (m_windows[i].hwnd == hwnd)
+            return static_cast<int>(i);
+    }
+    return -1;
+}
+
+void WindowMonitor::NotifyChanged() {
+    ++m_generation;
+    if (m_hwndNotify && !m_notifyPending) {
+        m_notifyPending = true;
+        PostMessage(m_hwndNotify, m_notifyMsg, 0, 0);
+    }
+}
+
+void WindowMonitor::PublishEvent(int kind, HWND hwnd, const WindowInfo *info) {
+    if (m_eventRing)
+        m_eventRing->Publish(static_cast<WindowEventKind>(kind), hwnd, info);
+    if (m_history) {
+        // A sweep carries no window; the history diffs the new table instead.
+        if (kind == WINDOW_EVENT_RESYNC)
+            m_history->Resync(m_windows);
+        else
+            m_history->Record(static_cast<WindowEventKind>(kind), hwnd, info);
+    }
 }
 
 WindowState WindowMonitor::GetWindowState(HWND hwnd) {
@@ -120,14 +357,3 @@ WindowState WindowMonitor::GetWindowState(HWND hwnd) {
     return WindowState::Unknown;
 }
 
-std::wstring WindowMonitor::GetProcessName(DWORD processId) {
-    std::wstring processName;
-    HANDLE hProcess = OpenProcess(PROCESS_QUERY_INFORMATION | PROCESS_VM_READ, FALSE, processId);
-    if(hProcess) {
-        wchar_t name[MAX_PATH] = {0};
-        if(GetModuleFileNameEx(hProcess, NULL, name, MAX_PATH))
-            processName = name;
-        CloseHandle(hProcess);
-    }
-    return processName;
-}
@@ -1,5 +1,43 @@
 // File: WindowMonitor.h
-// Version: 1.2
+// Version: 1.11 (Single creation event per window)
+// -------------------------------------------------------------------------
+// Changes in Version 1.11:
+//  - A show or create event for a window already in the table publishes
+//    WINDOW_EVENT_TITLE/WINDOW_EVENT_MOVED for what changed, not another
+//    WINDOW_EVENT_CREATED.
+// Changes in Version 1.10:
+//  - EVENT_SYSTEM_FOREGROUND moves the window to the top with std::rotate
+//    instead of copying it out and inserting it again.
+// Changes in Version 1.9:
+//  - The same changes are recorded in an optional WindowHistory
+//    (SetHistory()); a Resync() hands it the rebuilt table to diff.
+// Changes in Version 1.8:
+//  - Resync() is traced as the WindowSweep phase with the process cache
+//    hits and misses of the sweep (Tracing.h).
+// Changes in Version 1.7:
+//  - Every change applied to the table is also published to an optional
+//    WindowEventRing (SetEventRing()) for readers in other processes.
+// Changes in Version 1.6:
+//  - WindowInfo stores interned IDs for the class name and process image
+//    path instead of two strings per window.
+//  - Resync() enumerates into a second table that is swapped with the live
+//    one, so sweeps reuse the rows (and their title buffers) of the sweep
+//    before instead of allocating a new vector.
+// Changes in Version 1.5:
+//  - Records top-level windows that fired EVENT_OBJECT_NAMECHANGE so that
+//    fingerprint refreshes can reuse titles that have not changed.
+// Changes in Version 1.4:
+//  - Process names are resolved through ProcessCache instead of opening the
+//    process for every window; Resync() prunes exited processes.
+// Changes in Version 1.3:
+//  - StartMonitoring() now installs hooks for create/destroy/show/hide,
+//    name-change, location-change, minimize and foreground events and keeps
+//    an incremental table of top-level windows up to date.
+//  - Added Resync() for the slow consistency sweep and GetWindows() to read
+//    the current table without enumerating the desktop.
+//  - The owner is notified of table changes with a single posted message
+//    that is re-armed by AcknowledgeChanges().
+// -------------------------------------------------------------------------
 
 #ifndef WINDOWMONITOR_H
 #define WINDOWMONITOR_H
@@ -7,6 +45,10 @@
 #include <windows.h>
 #include <string>
 #include <vector>
+#include <unordered_set>
+
+class WindowEventRing;
+class WindowHistory;
 
 enum class WindowState {
     Normal,
@@ -21,9 +63,9 @@ struct WindowInfo {
     RECT rect;
     WindowState state;
     DWORD processId;
-    std::wstring processName;
+    UINT processNameId;     // Process image path, interned in StringInterner::ProcessNames().
     bool isFocused;         // Indicates whether the window is focused.
-    std::wstring className; // The window's class name.
+    UINT classId;           // Class name, interned in StringInterner::ClassNames().
 };
 
 class WindowMonitor {
@@ -34,22 +76,70 @@ public:
     // Enumerate all top-level windows.
     std::vector<WindowInfo> EnumerateWindows();
 
-    // (Optional) Real-time monitoring using WinEventHook.
-    bool StartMonitoring();
+    // Real-time monitoring using WinEventHook. The table is updated from the
+    // hook callbacks, and notifyMsg is posted to hwndNotify whenever it changes.
+    bool StartMonitoring(HWND hwndNotify, UINT notifyMsg);
     void StopMonitoring();
 
+    // Rebuilds the window table from a full enumeration (consistency sweep).
+    void Resync();
+
+    // Current window table, in z-order as of the last Resync() with
+    // incremental updates applied since.
+    const std::vector<WindowInfo>& GetWindows() const { return m_windows; }
+
+    // Incremented on every change to the window table.
+    ULONGLONG GetGeneration() const { return m_generation; }
+
+    // Re-arms the change notification after the owner has handled one.
+    void AcknowledgeChanges() { m_notifyPending = false; }
+
+    // Moves the set of top-level windows whose title changed since the last
+    // call (including windows outside the table) into renamed.
+    void TakeRenamedWindows(std::unordered_set<HWND> &renamed);
+
+    // Publishes table changes to ring (nullptr to stop). Events are written by
+    // the thread that receives the hook callbacks.
+    void SetEventRing(WindowEventRing *ring) { m_eventRing = ring; }
+
+    // Records table changes in history (nullptr to stop), on the same thread.
+    void SetHistory(WindowHistory *history) { m_history = history; }
+
 private:
     // Helper to determine a window's state.
     WindowState GetWindowState(HWND hwnd);
 
-    // Helper to get the process name given a process ID.
-    std::wstring GetProcessName(DWORD processId);
-
-    // Callback for WinEventHook (if needed).
+    // Callback for WinEventHook.
     static void CALLBACK WinEventProc(HWINEVENTHOOK hWinEventHook, DWORD event, HWND hwnd,
                                       LONG idObject, LONG idChild, DWORD dwEventThread, DWORD dwmsEventTime);
 
-    HWINEVENTHOOK m_hook;
+    // Applies a single WinEvent to the window table.
+    void OnWindowEvent(DWORD event, HWND hwnd);
+
+    // Returns the table index of hwnd, or -1 if it is not tracked.
+    int FindWindowIndex(HWND hwnd) const;
+
+    // Marks the table as changed and notifies the owner (once per acknowledgement).
+    void NotifyChanged();
+
+    // Publishes one event to m_eventRing and records it in m_history, if any.
+    void PublishEvent(int kind, HWND hwnd, const WindowInfo *info);
+
+    static const int HOOK_COUNT = 3;
+    HWINEVENTHOOK m_hooks[HOOK_COUNT];
+
+    std::vector<WindowInfo> m_windows;  // Incremental table of top-level windows.
+    std::vector<WindowInfo> m_sweep;    // Rows of the previous table, refilled by Resync().
+    std::unordered_set<HWND> m_renamed; // Top-level windows with a name change since TakeRenamedWindows().
+    ULONGLONG m_generation;
+    HWND m_hwndNotify;
+    UINT m_notifyMsg;
+    bool m_notifyPending;
+    WindowEventRing *m_eventRing;
+    WindowHistory *m_history;
+
+    // Only one monitor can receive hook callbacks at a time.
+    static WindowMonitor* s_activeMonitor;
 };
 
 #endif // WINDOWMONITOR_H
@@ -0,0 +1,177 @@
+// File: WindowResolver.cpp
+// Version: 1.0
+// -------------------------------------------------------------------------
+// This file implements WindowResolverRegistry (see WindowResolver.h).
+// -------------------------------------------------------------------------
+
+#include "WindowResolver.h"
+#include "WindowUtils.h"       // For StripLnkExtension()
+#include "FingerprintUtils.h"  // For InternClassName()
+#include "StringInterner.h"
+#include "ProcessCache.h"
+#include "TextMatch.h"         // For FoldNoCase(), FindNoCase() and EqualsNoCase()
+#include <vector>
+
+// True if imagePath is imageName or ends in "\imageName" (case-insensitive).
+static bool ImageNameIs(const std::wstring &imagePath, const std::wstring &imageName) {
+    if (imagePath.size() < imageName.size())
+        return false;
+    size_t offset = imagePath.size() - imageName.size();
+    if (offset > 0 && imagePath[offset - 1] != L'\\')
+        return false;
+    return EqualsNoCase(imagePath.c_str() + offset, imageName.c_str(), imageName.size());
+}
+
+// True if key occurs in title as a whole name: at the start or after a space,
+// '-' or '[', and followed by the end, a space, '.', ']' or '*'. A short stem
+// such as "a" must not match every title that contains the letter.
+static bool ContainsName(const wchar_t *title, size_t length, const std::wstring &key) {
+    size_t offset = 0;
+    while (offset + key.size() <= length) {
+        size_t pos = FindNoCase(title + offset, length - offset, key.c_str(), key.size());
+        if (pos == std::wstring::npos)
+            return false;
+        pos += offset;
+        size_t end = pos + key.size();
+        wchar_t before = (pos > 0) ? title[pos - 1] : L' ';
+        wchar_t after = (end < length) ? title[end] : L' ';
+        if ((before == L' ' || before == L'-' || before == L'[') &&
+            (after == L' ' || after == L'.' || after == L']' || after == L'*'))
+            return true;
+        offset = pos + 1;
+    }
+    return false;
+}
+
+WindowResolverRegistry::WindowResolverRegistry()
+{
+}
+
+WindowResolverRegistry& WindowResolverRegistry::Shared() {
+    static WindowResolverRegistry registry = [] {
+        WindowResolverRegistry r;
+        // Office applications run one instance and title windows "Name - Word"
+        // when extensions are hidden in Explorer.
+        r.Register({ L"Word", { L".doc", L".docx", L".docm", L".dot", L".dotx", L".rtf" },
+                     L"OpusApp", L"WINWORD.EXE", true });
+        r.Register({ L"Excel", { L".xls", L".xlsx", L".xlsm", L".xlsb", L".csv" },
+                     L"XLMAIN", L"EXCEL.EXE", true });
+        r.Register({ L"PowerPoint", { L".ppt", L".pptx", L".pptm", L".pps", L".ppsx" },
+                     L"PPTFrameClass", L"POWERPNT.EXE", true });
+        return r;
+    }();
+    return registry;
+}
+
+void WindowResolverRegistry::Register(const WindowResolverRule &rule) {
+    CompiledRule compiled;
+    compiled.rule = rule;
+    compiled.classId = rule.className.empty() ? 0 : InternClassName(rule.className);
+    int index = static_cast<int>(m_rules.size());
+    m_rules.push_back(compiled);
+    for (std::wstring extension : rule.extensions) {
+        FoldNoCase(extension);
+        m_byExtension[extension] = index;
+    }
+}
+
+int WindowResolverRegistry::FindRule(const std::wstring &filePath) const {
+    if (m_byExtension.empty())
+        return -1;
+    std::wstring name = filePath.substr(filePath.find_last_of(L'\\') + 1);
+    FoldNoCase(name);
+    name = StripLnkExtension(name);
+    size_t dot = name.find_last_of(L'.');
+    if (dot == std::wstring::npos)
+        return -1;
+    auto it = m_byExtension.find(name.substr(dot));
+    return (it != m_byExtension.end()) ? it->second : -1;
+}
+
+std::wstring WindowResolverRegistry::GetTitleKey(int rule, const std::wstring &fileName) const {
+    std::wstring key = fileName;
+    FoldNoCase(key);
+    key = StripLnkExtension(key);
+    if (rule >= 0 && m_rules[rule].rule.titleWithoutExtension) {
+        // The stem is also contained in "Name.docx - Word".
+        size_t dot = key.find_last_of(L'.');
+        if (dot != std::wstring::npos && dot > 0)
+            key.erase(dot);
+    }
+    return key;
+}
+
+bool WindowResolverRegistry::MatchesImage(const CompiledRule &compiled, DWORD processId) const {
+    if (compiled.rule.processImage.empty())
+        return true;
+    UINT imageId = ProcessCache::Shared().GetImagePathId(processId);
+    return imageId && ImageNameIs(StringInterner::ProcessNames().Get(imageId), compiled.rule.processImage);
+}
+
+bool WindowResolverRegistry::Matches(int rule, const WindowTable &windows, int row,
+                                     const std::wstring &titleKey) const {
+    if (rule < 0 || row < 0 || row >= windows.GetCount() || titleKey.empty())
+        return false;
+    const CompiledRule &compiled = m_rules[rule];
+    if (!compiled.rule.className.empty() && windows.GetClassId(row) != compiled.classId)
+        return false;
+    if (!ContainsName(windows.GetTitle(row), windows.GetTitleLength(row), titleKey))
+        return false;
+    return compiled.rule.processImage.empty() ||
+           ImageNameIs(StringInterner::ProcessNames().Get(windows.GetProcessNameId(row)), compiled.rule.processImage);
+}
+
+int WindowResolverRegistry::FindInTable(int rule, const WindowTable &windows, const std::wstring &titleKey) const {
+    for (int row = 0; row < windows.GetCount(); ++row) {
+        if (Matches(rule, windows, row, titleKey))
+            return row;
+    }
+    return -1;
+}
+
+bool WindowResolverRegistry::MatchesWindow(int rule, HWND hwnd, const std::wstring &titleKey) const {
+    if (rule < 0 || !hwnd || titleKey.empty())
+        return false;
+    const CompiledRule &compiled = m_rules[rule];
+    if (!compiled.rule.className.empty()) {
+        wchar_t className[256];
+        int classLength = GetClassName(hwnd, className, 256);
+        if (classLength <= 0 || static_cast<size_t>(classLength) != compiled.rule.className.size() ||
+            !EqualsNoCase(className, compiled.rule.className.c_str(), classLength))
+            return false;
+    }
+    int len = GetWindowTextLength(hwnd);
+    if (len <= 0)
+        return false;
+    thread_local std::vector<wchar_t> title;
+    if (title.size() < static_cast<size_t>(len) + 1)
+        title.resize(len + 1);
+    int copied = GetWindowText(hwnd, title.data(), len + 1);
+    if (copied <= 0 || !ContainsName(title.data(), static_cast<size_t>(copied), titleKey))
+        return false;
+    DWORD processId = 0;
+    GetWindowThreadProcessId(hwnd, &processId);
+    return MatchesImage(compiled, processId);
+}
+
+HWND WindowResolverRegistry::FindOnDesktop(int rule, const std::wstring &titleKey) const {
+    struct Search {
+        const WindowResolverRegistry *registry;
+        int rule;
+        const std::wstring *titleKey;
+        HWND found;
+    } search = { this, rule, &titleKey, nullptr };
+    if (rule < 0 || titleKey.empty())
+        return nullptr;
+    EnumWindows([](HWND hwnd, LPARAM lParam) -> BOOL {
+        Search *s = reinterpret_cast<Search*>(lParam);
+        if (IsWindowVisible(hwnd) && s->registry->MatchesWindow(s->rule, hwnd, *s->titleKey)) {
+            s->found = hwnd;
+            return FALSE;
+        }
+        return TRUE;
+    }, reinterpret_cast<LPARAM>(&search));
+    return search.found;
+}
+
+// End of file: WindowResolver.cpp (Version: 1.0)
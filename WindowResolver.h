@@ -0,0 +1,93 @@
+// File: WindowResolver.h
+// Version: 1.0
+// -------------------------------------------------------------------------
+// This header declares WindowResolverRegistry, the per-application rules
+// for finding the window that shows a file.
+//
+// Single-instance applications such as Office hand a file to the instance
+// that is already running, so the process handle ShellExecuteExW returns
+// says nothing about the window, and their titles often show the file name
+// without its extension. WindowUtils used to special-case Word and
+// PowerPoint with their own desktop scans (GetWordWindow(),
+// GetPowerPointWindow()); everything else fell back to a title scan.
+//
+// A rule is keyed by file extension and declares cheap criteria: the frame
+// window class, the process image file name and whether the title may omit
+// the extension. The title has to contain the file name (or stem) as a whole
+// name, e.g. "Report - Word" for Report.docx but not "Reports - Word".
+// Criteria are checked cheapest first: the interned class ID, then the
+// title, then the interned process image path. Against a snapshot
+// (FindInTable(), Matches()) nothing is read from other processes; the live
+// checks (FindOnDesktop(), MatchesWindow()) read the class name first and the
+// title only for windows of the rule's class. Resolutions are cached by
+// ActivationService together with the rule that made them.
+//
+// The shared registry starts with rules for Word, Excel and PowerPoint.
+// Register() more before the engine starts; afterwards the registry is only
+// read, from any thread.
+// -------------------------------------------------------------------------
+
+#ifndef WINDOWRESOLVER_H
+#define WINDOWRESOLVER_H
+
+#include <windows.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "WindowTable.h"
+
+/**
+ * @struct WindowResolverRule
+ * @brief Match criteria of one application's document windows.
+ */
+struct WindowResolverRule {
+    std::wstring application;             ///< Display name, e.g. L"Word".
+    std::vector<std::wstring> extensions; ///< With the dot, e.g. L".docx" (case-insensitive).
+    std::wstring className;               ///< Frame window class; empty matches any class.
+    std::wstring processImage;            ///< Image file name, e.g. L"WINWORD.EXE"; empty matches any.
+    bool titleWithoutExtension;           ///< The title may show the file name without its extension.
+};
+
+class WindowResolverRegistry {
+public:
+    WindowResolverRegistry();
+
+    // Process-wide registry with the built-in rules.
+    static WindowResolverRegistry& Shared();
+
+    // Adds a rule; for an extension already registered the new rule wins.
+    void Register(const WindowResolverRule &rule);
+
+    // Index of the rule for filePath's extension, or -1.
+    int FindRule(const std::wstring &filePath) const;
+    const WindowResolverRule& GetRule(int rule) const { return m_rules[rule].rule; }
+
+    // Folded text a matching title contains: the file name without a .lnk
+    // extension, or its stem for rules with titleWithoutExtension.
+    std::wstring GetTitleKey(int rule, const std::wstring &fileName) const;
+
+    // True if row of windows meets the rule for titleKey (see GetTitleKey()).
+    bool Matches(int rule, const WindowTable &windows, int row, const std::wstring &titleKey) const;
+    // First matching row in z-order, or -1.
+    int FindInTable(int rule, const WindowTable &windows, const std::wstring &titleKey) const;
+
+    // Live equivalents for windows the snapshot has not seen yet.
+    bool MatchesWindow(int rule, HWND hwnd, const std::wstring &titleKey) const;
+    // One EnumWindows pass; returns the first matching top-level window or nullptr.
+    HWND FindOnDesktop(int rule, const std::wstring &titleKey) const;
+
+private:
+    struct CompiledRule {
+        WindowResolverRule rule;
+        UINT classId;       ///< Interned rule.className (0 if empty).
+    };
+
+    bool MatchesImage(const CompiledRule &compiled, DWORD processId) const;
+
+    std::vector<CompiledRule> m_rules;
+    std::unordered_map<std::wstring, int> m_byExtension;    ///< Folded extension to rule index.
+};
+
+#endif // WINDOWRESOLVER_H
+
+// End of file: WindowResolver.h (Version: 1.0)
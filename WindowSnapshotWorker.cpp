@@ -0,0 +1,281 @@
+// File: WindowSnapshotWorker.cpp
+// Version: 1.6
+// -------------------------------------------------------------------------
+// This file implements WindowSnapshotWorker (see WindowSnapshotWorker.h).
+// -------------------------------------------------------------------------
+
+#include "WindowSnapshotWorker.h"
+#include "FingerprintUtils.h"  // For GetFingerprint()
+#include "Config.h"
+#include "Tracing.h"
+#include <algorithm>
+
+// Status column text for a window outside the table.
+static const wchar_t* GetStateText(HWND hwnd, HWND hwndForeground) {
+    WINDOWPLACEMENT wp{};
+    wp.length = sizeof(WINDOWPLACEMENT);
+    WindowState state = WindowState::Unknown;
+    if (GetWindowPlacement(hwnd, &wp)) {
+        if (wp.showCmd == SW_SHOWMINIMIZED)
+            state = WindowState::Minimized;
+        else if (wp.showCmd == SW_SHOWMAXIMIZED)
+            state = WindowState::Maximized;
+        else
+            state = WindowState::Normal;
+    }
+    return GetWindowStateText(state, hwnd == hwndForeground);
+}
+
+const wchar_t* WindowSnapshot::GetStateText(int index) const {
+    return GetWindowStateText(windows.GetState(index), windows.GetHwnd(index) == hwndForeground);
+}
+
+const TrackedWindowStatus* WindowSnapshot::FindTracked(HWND hwnd) const {
+    auto it = std::lower_bound(tracked.begin(), tracked.end(), hwnd,
+                               [](const TrackedWindowStatus &status, HWND h) { return status.hwnd < h; });
+    return (it != tracked.end() && it->hwnd == hwnd) ? &*it : nullptr;
+}
+
+WindowSnapshotWorker::WindowSnapshotWorker()
+    : m_hwndNotify(nullptr)
+    , m_notifyMsg(0)
+    , m_stopEvent(nullptr)
+    , m_wakeEvent(nullptr)
+    , m_ready(nullptr)
+    , m_free(nullptr)
+    , m_notifyPending(false)
+    , m_paused(false)
+    , m_sweepInterval(TIMER_INTERVAL)
+    , m_current(nullptr)
+    , m_pass(0)
+{
+    m_empty.generation = 0;
+    m_empty.hwndForeground = nullptr;
+}
+
+WindowSnapshotWorker::~WindowSnapshotWorker() {
+    Stop();
+    delete m_ready.exchange(nullptr);
+    delete m_free.exchange(nullptr);
+    delete m_current;
+    m_current = nullptr;
+}
+
+bool WindowSnapshotWorker::Start(HWND hwndNotify, UINT notifyMsg) {
+    if (m_thread.joinable())
+        return true;
+    m_hwndNotify = hwndNotify;
+    m_notifyMsg = notifyMsg;
+    m_stopEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+    m_wakeEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    if (!m_stopEvent || !m_wakeEvent) {
+        Stop();
+        return false;
+    }
+    m_thread = std::thread(&WindowSnapshotWorker::Run, this);
+    return true;
+}
+
+void WindowSnapshotWorker::Stop() {
+    if (m_stopEvent)
+        SetEvent(m_stopEvent);
+    if (m_thread.joinable())
+        m_thread.join();
+    if (m_stopEvent) {
+        CloseHandle(m_stopEvent);
+        m_stopEvent = nullptr;
+    }
+    if (m_wakeEvent) {
+        CloseHandle(m_wakeEvent);
+        m_wakeEvent = nullptr;
+    }
+    m_eventRing.Close();
+    m_history.Close();
+}
+
+void WindowSnapshotWorker::SetTrackedWindows(const std::vector<HWND> &hwnds) {
+    // Sorting into a reused buffer; after a swap it holds the previous list's storage.
+    std::vector<HWND> &sorted = m_sortedHwnds;
+    sorted.assign(hwnds.begin(), hwnds.end());
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+    {
+        std::lock_guard<std::mutex> lock(m_trackedMutex);
+        if (sorted == m_trackedHwnds)
+            return;
+        m_trackedHwnds.swap(sorted);
+    }
+    RequestSnapshot();
+}
+
+void WindowSnapshotWorker::RequestSnapshot() {
+    if (m_wakeEvent)
+        SetEvent(m_wakeEvent);
+}
+
+void WindowSnapshotWorker::SetPaused(bool paused) {
+    if (m_paused.exchange(paused) != paused)
+        RequestSnapshot(); // Re-evaluate the wait; resuming publishes right away.
+}
+
+void WindowSnapshotWorker::SetSweepInterval(UINT interval) {
+    if (m_sweepInterval.exchange(interval) != interval)
+        RequestSnapshot();
+}
+
+const WindowSnapshot* WindowSnapshotWorker::TakeLatest() {
+    // Re-arm first so a snapshot published right after the exchange is announced.
+    m_notifyPending = false;
+    WindowSnapshot *latest = m_ready.exchange(nullptr);
+    if (!latest)
+        return nullptr;
+    // Hand the snapshot we stop rendering back to the worker for reuse.
+    if (m_current)
+        delete m_free.exchange(m_current);
+    m_current = latest;
+    return m_current;
+}
+
+void WindowSnapshotWorker::Publish(WindowSnapshot *snapshot) {
+    WindowSnapshot *superseded = m_ready.exchange(snapshot);
+    if (superseded) {
+        // The UI never took it; recycle it unless a free buffer is already waiting.
+        WindowSnapshot *expected = nullptr;
+        if (!m_free.compare_exchange_strong(expected, superseded))
+            delete superseded;
+    }
+    if (m_hwndNotify && !m_notifyPending.exchange(true))
+        PostMessage(m_hwndNotify, m_notifyMsg, 0, 0);
+}
+
+void WindowSnapshotWorker::Capture(WindowMonitor &monitor, WindowSnapshot &snapshot) {
+    TraceActivity activity;
+    TraceStart(activity, TracePhase::Snapshot);
+    UINT fingerprintHits = 0;
+    UINT fingerprintMisses = 0;
+    // The snapshot is a recycled buffer; refilling it reuses its capacity.
+    snapshot.generation = monitor.GetGeneration();
+    snapshot.hwndForeground = GetForegroundWindow();
+    snapshot.windows.Clear();
+    for (const WindowInfo &info : monitor.GetWindows())
+        snapshot.windows.Append(info);
+    snapshot.windows.BuildIndex();
+
+    {
+        std::lock_guard<std::mutex> lock(m_trackedMutex);
+        m_captureHwnds.assign(m_trackedHwnds.begin(), m_trackedHwnds.end());
+    }
+
+    // Titles and class names are only read again for windows that fired a
+    // name change (or are new); otherwise the previous fingerprint is reused
+    // with a fresh rectangle. Titles of windows in the table are current anyway.
+    monitor.TakeRenamedWindows(m_renamed);
+    ++m_pass;
+
+    snapshot.tracked.resize(m_captureHwnds.size());
+    for (size_t i = 0; i < m_captureHwnds.size(); ++i) {
+        HWND hwnd = m_captureHwnds[i];
+        TrackedWindowStatus &status = snapshot.tracked[i];
+        status.hwnd = hwnd;
+        status.alive = IsWindow(hwnd) != FALSE;
+        status.state = nullptr;
+        if (!status.alive)
+            continue;
+        int index = snapshot.FindWindowIndex(hwnd);
+        DWORD pid = 0;
+        GetWindowThreadProcessId(hwnd, &pid);
+        CachedFingerprint &cached = m_fingerprints[hwnd];
+        if (cached.pass != 0 && cached.fingerprint.processId == pid &&
+            m_renamed.find(hwnd) == m_renamed.end()) {
+            if (index >= 0)
+                cached.fingerprint.rect = snapshot.windows.GetRect(index);
+            else
+                GetWindowRect(hwnd, &cached.fingerprint.rect);
+            ++fingerprintHits;
+        } else {
+            cached.fingerprint = (index >= 0) ? GetFingerprint(snapshot.windows, index) : GetFingerprint(hwnd);
+            ++fingerprintMisses;
+        }
+        cached.pass = m_pass;
+        status.fingerprint = cached.fingerprint;
+        status.state = (index >= 0) ? snapshot.GetStateText(index) : GetStateText(hwnd, snapshot.hwndForeground);
+    }
+
+    // Forget windows that are no longer tracked or have been destroyed.
+    for (auto it = m_fingerprints.begin(); it != m_fingerprints.end(); ) {
+        if (it->second.pass != m_pass)
+            it = m_fingerprints.erase(it);
+        else
+            ++it;
+    }
+    TraceSnapshotStop(activity, static_cast<UINT>(snapshot.windows.GetCount()), static_cast<UINT>(snapshot.tracked.size()),
+                      fingerprintHits, fingerprintMisses);
+}
+
+void WindowSnapshotWorker::Run() {
+    // The hooks must be installed by the thread that pumps their callbacks.
+    WindowMonitor monitor;
+    if (m_eventRing.IsOpen())
+        monitor.SetEventRing(&m_eventRing);
+    monitor.SetHistory(&m_history);
+    if (!monitor.StartMonitoring(nullptr, 0))
+        monitor.Resync(); // Hooks unavailable; fall back to sweeps only.
+
+    ULONGLONG lastSweep = GetTickCount64();
+    ULONGLONG publishedGeneration = 0;
+    ULONGLONG publishAt = GetTickCount64(); // Publish the initial snapshot right away.
+    bool publishArmed = true;
+
+    for (;;) {
+        ULONGLONG now = GetTickCount64();
+        // Paused: the hooks keep the table current, but nothing is swept,
+        // captured or published until the UI is visible again.
+        bool paused = m_paused.load();
+        ULONGLONG nextSweep = lastSweep + m_sweepInterval.load();
+        if (!paused && now >= nextSweep) {
+            // Consistency sweep: catches anything the WinEvent hooks missed.
+            monitor.Resync();
+            lastSweep = now;
+            nextSweep = now + m_sweepInterval.load();
+        }
+        if (!publishArmed && monitor.GetGeneration() != publishedGeneration) {
+            // Coalesce a burst of events (e.g. dragging a window) into one snapshot.
+            publishArmed = true;
+            publishAt = now + EVENT_REFRESH_DELAY;
+        }
+        if (!paused && publishArmed && now >= publishAt) {
+            WindowSnapshot *snapshot = m_free.exchange(nullptr);
+            if (!snapshot)
+                snapshot = new WindowSnapshot();
+            Capture(monitor, *snapshot);
+            publishedGeneration = snapshot->generation;
+            Publish(snapshot);
+            publishArmed = false;
+        }
+
+        DWORD timeout = INFINITE;
+        if (!paused) {
+            ULONGLONG deadline = publishArmed ? (std::min)(publishAt, nextSweep) : nextSweep;
+            now = GetTickCount64();
+            timeout = (deadline > now) ? static_cast<DWORD>(deadline - now) : 0;
+        }
+        HANDLE handles[2] = { m_stopEvent, m_wakeEvent };
+        DWORD wait = MsgWaitForMultipleObjects(2, handles, FALSE, timeout, QS_ALLINPUT);
+        if (wait == WAIT_OBJECT_0)
+            break;
+        if (wait == WAIT_OBJECT_0 + 1 && (!publishArmed || m_paused.load() != paused)) {
+            // Tracked windows changed, a refresh was requested or the worker was resumed.
+            publishArmed = true;
+            publishAt = GetTickCount64();
+        }
+        // WinEvent callbacks are dispatched while messages are retrieved.
+        MSG msg;
+        while (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE)) {
+            TranslateMessage(&msg);
+            DispatchMessage(&msg);
+        }
+    }
+    monitor.StopMonitoring();
+}
+
+// End of file: WindowSnapshotWorker.cpp (Version: 1.6)
@@ -0,0 +1,182 @@
+// File: WindowSnapshotWorker.h
+// Version: 1.6 (Window history)
+// -------------------------------------------------------------------------
+// This header declares WindowSnapshotWorker, which collects window data on a
+// dedicated thread so that a hung application cannot block the UI thread.
+//
+// The worker thread owns a WindowMonitor (its WinEvent hooks are delivered
+// to the thread that installed them), runs the consistency sweep, refreshes
+// the fingerprints and state strings of tracked windows, and publishes the
+// result as an immutable WindowSnapshot.
+//
+// Publication is a lock-free triple buffer: the worker swaps a finished
+// snapshot into the "ready" slot; the UI swaps it out in TakeLatest() and
+// returns the snapshot it no longer renders to the "free" slot, where the
+// worker picks it up again. A snapshot that is superseded before the UI took
+// it is simply overwritten, so the UI only ever renders the latest one.
+//
+// Changes in Version 1.6:
+//  - The monitor's changes are also recorded in a WindowHistory
+//    (OpenHistory(), GetHistory()), which is sealed and closed in Stop().
+// Changes in Version 1.5:
+//  - Capture() is traced as the Snapshot phase with the fingerprint cache
+//    hits and misses of the pass (Tracing.h).
+// Changes in Version 1.4:
+//  - The worker can publish its monitor's window events to a shared-memory
+//    WindowEventRing (OpenEventRing()); events are written from the hook
+//    callbacks on this thread, paused or not.
+// Changes in Version 1.3:
+//  - SetPaused() stops sweeps and publication while the UI is minimized or
+//    the session is locked; the hooks keep the table current, so resuming
+//    publishes immediately. SetSweepInterval() replaces the fixed
+//    TIMER_INTERVAL sweep.
+// Changes in Version 1.2:
+//  - The window table is a column-oriented WindowTable with a title arena,
+//    and state texts are static strings. A snapshot coming back through the
+//    free slot is refilled in place, so the three buffers of the triple
+//    buffer act as reused arenas and a steady-state pass does not allocate.
+//  - The HWND index is a sorted vector instead of an unordered_map.
+// Changes in Version 1.1:
+//  - Tracked fingerprints are kept between passes; titles and class names are
+//    only read again after EVENT_OBJECT_NAMECHANGE or a change of process.
+// -------------------------------------------------------------------------
+
+#ifndef WINDOWSNAPSHOTWORKER_H
+#define WINDOWSNAPSHOTWORKER_H
+
+#include <windows.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include "WindowMonitor.h"
+#include "WindowTable.h"
+#include "TrackedWindow.h"
+#include "WindowEventRing.h"
+#include "WindowHistory.h"
+
+/**
+ * @struct TrackedWindowStatus
+ * @brief Worker-side refresh of one window the UI tracks.
+ */
+struct TrackedWindowStatus {
+    HWND hwnd;
+    bool alive;                 ///< IsWindow() at capture time.
+    TrackedWindow fingerprint;  ///< GetFingerprint() at capture time (valid if alive).
+    const wchar_t *state;       ///< Status column text, a static string (valid if alive).
+};
+
+/**
+ * @struct WindowSnapshot
+ * @brief Immutable result of one collection pass.
+ */
+struct WindowSnapshot {
+    ULONGLONG generation;                       ///< WindowMonitor generation captured.
+    HWND hwndForeground;                        ///< Foreground window at capture time.
+    WindowTable windows;                        ///< Window table, in z-order.
+    std::vector<TrackedWindowStatus> tracked;   ///< Sorted by hwnd.
+
+    // Returns the index of hwnd in windows, or -1.
+    int FindWindowIndex(HWND hwnd) const { return windows.Find(hwnd); }
+    // Status column text of a row of windows, e.g. "Maximized (Focused)".
+    const wchar_t* GetStateText(int index) const;
+    // Returns the refreshed status of a tracked window, or nullptr if it was not requested.
+    const TrackedWindowStatus* FindTracked(HWND hwnd) const;
+};
+
+class WindowSnapshotWorker {
+public:
+    WindowSnapshotWorker();
+    ~WindowSnapshotWorker();
+
+    // Starts the worker. notifyMsg is posted to hwndNotify when a new snapshot
+    // is ready; it is not posted again until TakeLatest() has been called.
+    bool Start(HWND hwndNotify, UINT notifyMsg);
+    void Stop();
+
+    // Creates the shared-memory event ring; call before Start(). Returns
+    // false if it could not be created (the worker runs without it).
+    bool OpenEventRing(const wchar_t *name, UINT slotCount) { return m_eventRing.Create(name, slotCount); }
+
+    // Sets the project files whose IDs are attached to ring events.
+    void SetEventFiles(std::shared_ptr<const WindowEventFiles> files) {
+        m_history.SetFiles(files);
+        m_eventRing.SetFiles(std::move(files));
+    }
+
+    // Opens the window history's segment file; call before Start(). Without
+    // it the history keeps only the blocks in memory.
+    bool OpenHistory(const std::wstring &segmentFile) { return m_history.Open(segmentFile); }
+
+    // Window activity history; its queries may be called from any thread.
+    WindowHistory& GetHistory() { return m_history; }
+
+    // Sets the windows whose fingerprints the worker refreshes, and requests a snapshot.
+    void SetTrackedWindows(const std::vector<HWND> &hwnds);
+
+    // Asks for a snapshot as soon as possible (e.g. after a launch).
+    void RequestSnapshot();
+
+    // While paused the worker only keeps its window table current from the
+    // hooks: no sweeps, no snapshots. Unpausing publishes a snapshot at once.
+    void SetPaused(bool paused);
+
+    // Consistency sweep interval in milliseconds (TIMER_INTERVAL by default).
+    void SetSweepInterval(UINT interval);
+
+    // UI thread: returns the newest published snapshot, or nullptr if none was
+    // published since the previous call. The previous snapshot returned is
+    // recycled, so callers must not keep pointers into it after calling again.
+    const WindowSnapshot* TakeLatest();
+
+    // Snapshot last returned by TakeLatest(), or an empty one before the first.
+    const WindowSnapshot& GetCurrent() const { return m_current ? *m_current : m_empty; }
+
+private:
+    // Worker thread body.
+    void Run();
+
+    // Fills snapshot from the monitor's table and the tracked window list.
+    void Capture(WindowMonitor &monitor, WindowSnapshot &snapshot);
+
+    // Publishes snapshot through the ready slot and notifies the owner.
+    void Publish(WindowSnapshot *snapshot);
+
+    HWND m_hwndNotify;
+    UINT m_notifyMsg;
+    HANDLE m_stopEvent;
+    HANDLE m_wakeEvent;      // Set by SetTrackedWindows() and RequestSnapshot().
+    std::thread m_thread;
+
+    std::atomic<WindowSnapshot*> m_ready;   // Latest published, not yet taken.
+    std::atomic<WindowSnapshot*> m_free;    // Returned by the UI for reuse.
+    std::atomic<bool> m_notifyPending;
+    std::atomic<bool> m_paused;
+    std::atomic<UINT> m_sweepInterval;
+    WindowSnapshot *m_current;              // UI thread only.
+    WindowSnapshot m_empty;
+    WindowEventRing m_eventRing;            // Written by the worker thread only.
+    WindowHistory m_history;                // Recorded by the worker thread, queried by any.
+
+    // Worker thread only: fingerprints kept between passes, stamped with the
+    // pass that last saw them, plus scratch lists reused by every pass.
+    struct CachedFingerprint {
+        TrackedWindow fingerprint;
+        ULONGLONG pass;
+    };
+    std::unordered_map<HWND, CachedFingerprint> m_fingerprints;
+    std::unordered_set<HWND> m_renamed;
+    std::vector<HWND> m_captureHwnds;
+    ULONGLONG m_pass;
+
+    std::mutex m_trackedMutex;              // Guards m_trackedHwnds.
+    std::vector<HWND> m_trackedHwnds;
+    std::vector<HWND> m_sortedHwnds;        // SetTrackedWindows() scratch (caller's thread).
+};
+
+#endif // WINDOWSNAPSHOTWORKER_H
+
+// End of file: WindowSnapshotWorker.h (Version: 1.6)
@@ -0,0 +1,91 @@
+// File: WindowTable.cpp
+// Version: 1.0
+// -------------------------------------------------------------------------
+// This file implements WindowTable (see WindowTable.h).
+// -------------------------------------------------------------------------
+
+#include "WindowTable.h"
+#include "StringInterner.h"
+#include <algorithm>
+
+static const ULONGLONG FNV_OFFSET_BASIS = 14695981039346656037ULL;
+static const ULONGLONG FNV_PRIME = 1099511628211ULL;
+
+// Folds raw bytes into a 64-bit FNV-1a hash.
+static void HashBytes(ULONGLONG &hash, const void *data, size_t size) {
+    const unsigned char *bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+}
+
+const wchar_t* GetWindowStateText(WindowState state, bool focused) {
+    switch (state) {
+        case WindowState::Normal:     return focused ? L"Normal (Focused)"    : L"Normal";
+        case WindowState::Minimized:  return focused ? L"Minimized (Focused)" : L"Minimized";
+        case WindowState::Maximized:  return focused ? L"Maximized (Focused)" : L"Maximized";
+        default:                      return focused ? L"Unknown (Focused)"   : L"Unknown";
+    }
+}
+
+WindowTable::WindowTable()
+    : m_contentHash(FNV_OFFSET_BASIS)
+{
+}
+
+void WindowTable::Clear() {
+    m_hwnds.clear();
+    m_rects.clear();
+    m_states.clear();
+    m_processIds.clear();
+    m_classIds.clear();
+    m_processNameIds.clear();
+    m_titles.clear();
+    m_titleChars.clear();
+    m_index.clear();
+    m_contentHash = FNV_OFFSET_BASIS;
+}
+
+void WindowTable::Append(const WindowInfo &info) {
+    m_hwnds.push_back(info.hwnd);
+    m_rects.push_back(info.rect);
+    m_states.push_back(info.state);
+    m_processIds.push_back(info.processId);
+    m_classIds.push_back(info.classId);
+    m_processNameIds.push_back(info.processNameId);
+    m_titles.emplace_back(m_titleChars.size(), info.title.size());
+    m_titleChars.insert(m_titleChars.end(), info.title.begin(), info.title.end());
+    m_titleChars.push_back(L'\0');
+
+    HashBytes(m_contentHash, &info.hwnd, sizeof(info.hwnd));
+    HashBytes(m_contentHash, &info.rect, sizeof(info.rect));
+    HashBytes(m_contentHash, &info.state, sizeof(info.state));
+    HashBytes(m_contentHash, &info.processId, sizeof(info.processId));
+    HashBytes(m_contentHash, &info.classId, sizeof(info.classId));
+    HashBytes(m_contentHash, &info.processNameId, sizeof(info.processNameId));
+    // The terminator separates titles, so ("ab", "c") and ("a", "bc") differ.
+    HashBytes(m_contentHash, info.title.c_str(), (info.title.size() + 1) * sizeof(wchar_t));
+}
+
+void WindowTable::BuildIndex() {
+    m_index.clear();
+    for (int i = 0; i < GetCount(); ++i)
+        m_index.emplace_back(m_hwnds[i], i);
+    std::sort(m_index.begin(), m_index.end());
+}
+
+const std::wstring& WindowTable::GetWindowClass(int index) const {
+    return StringInterner::ClassNames().Get(m_classIds[index]);
+}
+
+const std::wstring& WindowTable::GetProcessName(int index) const {
+    return StringInterner::ProcessNames().Get(m_processNameIds[index]);
+}
+
+int WindowTable::Find(HWND hwnd) const {
+    auto it = std::lower_bound(m_index.begin(), m_index.end(), std::make_pair(hwnd, 0));
+    return (it != m_index.end() && it->first == hwnd) ? it->second : -1;
+}
+
+// End of file: WindowTable.cpp (Version: 1.0)
@@ -0,0 +1,77 @@
+// File: WindowTable.h
+// Version: 1.0
+// -------------------------------------------------------------------------
+// This header declares WindowTable, the column-oriented (structure of
+// arrays) copy of the window table that a WindowSnapshot carries.
+//
+// Fixed-size fields (HWND, rectangle, state, PID, interned class and process
+// name IDs) are kept in parallel arrays, and all titles share one
+// character arena. Clear() keeps every capacity, so a table that is filled
+// again on every collection pass stops allocating once it has grown to the
+// size of the desktop. A 64-bit content hash is computed while rows are
+// appended, so two tables can be compared without walking the strings.
+// -------------------------------------------------------------------------
+
+#ifndef WINDOWTABLE_H
+#define WINDOWTABLE_H
+
+#include <windows.h>
+#include <string>
+#include <vector>
+#include <utility>
+#include "WindowMonitor.h"  // For WindowInfo and WindowState
+
+// Status column text for a window state, e.g. "Maximized (Focused)".
+const wchar_t* GetWindowStateText(WindowState state, bool focused);
+
+class WindowTable {
+public:
+    WindowTable();
+
+    // Removes all rows; capacities are kept for the next fill.
+    void Clear();
+
+    // Appends one window (in z-order). Call BuildIndex() after the last row.
+    void Append(const WindowInfo &info);
+
+    // Sorts the HWND index used by Find().
+    void BuildIndex();
+
+    int GetCount() const { return static_cast<int>(m_hwnds.size()); }
+    HWND GetHwnd(int index) const { return m_hwnds[index]; }
+    const RECT& GetRect(int index) const { return m_rects[index]; }
+    WindowState GetState(int index) const { return m_states[index]; }
+    DWORD GetPid(int index) const { return m_processIds[index]; }
+    UINT GetClassId(int index) const { return m_classIds[index]; }
+    UINT GetProcessNameId(int index) const { return m_processNameIds[index]; }
+
+    // Null-terminated title stored in the arena (valid until the next Clear()).
+    const wchar_t* GetTitle(int index) const { return &m_titleChars[m_titles[index].first]; }
+    size_t GetTitleLength(int index) const { return m_titles[index].second; }
+
+    // Interned class name and process image path.
+    const std::wstring& GetWindowClass(int index) const;
+    const std::wstring& GetProcessName(int index) const;
+
+    // Returns the row of hwnd, or -1.
+    int Find(HWND hwnd) const;
+
+    // Hash over every column of every row, in order. Equal tables have equal hashes.
+    ULONGLONG GetContentHash() const { return m_contentHash; }
+
+private:
+    std::vector<HWND> m_hwnds;
+    std::vector<RECT> m_rects;
+    std::vector<WindowState> m_states;
+    std::vector<DWORD> m_processIds;
+    std::vector<UINT> m_classIds;
+    std::vector<UINT> m_processNameIds;
+    std::vector<std::pair<size_t, size_t>> m_titles;  // (offset, length) into m_titleChars.
+    std::vector<wchar_t> m_titleChars;                // Title arena, each title null-terminated.
+    std::vector<std::pair<HWND, int>> m_index;        // Sorted by HWND.
+    ULONGLONG m_contentHash;
+};
+
+#endif // WINDOWTABLE_H
+
+// End of file: WindowTable.h (Version: 1.0)
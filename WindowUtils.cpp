@@ -1,17 +1,26 @@
 // File: WindowUtils.cpp
-// Version: 1.0 (Phase 3.2: Window Utility Functions extracted)
+// Version: 1.2 (Resolver registry)
 // -------------------------------------------------------------------------
 // This file implements window utility functions for locating and matching
 // system windows. It includes implementations for:
 //   - GetMainWindowHandle()
 //   - GetWindowHandleByFileName()
 //   - IsFileWindowOpen()
-//   - GetPowerPointWindow()
-//   - GetWordWindow()
+//
+// Changes in Version 1.2:
+//  - Removed GetPowerPointWindow() and GetWordWindow(); their class checks
+//    are WindowResolverRegistry rules, evaluated against the snapshot.
+//
+// Changes in Version 1.1:
+//  - GetWindowHandleByFileName() lowercases the file name once per call and
+//    matches titles with ContainsNoCase() instead of copying and lowercasing
+//    every title.
 // -------------------------------------------------------------------------
 
 #include "WindowUtils.h"
+#include "TextMatch.h"  // For FoldNoCase() and ContainsNoCase()
 #include <cwchar>
+#include <vector>
 
 // -------------------------------------------------------------------------
 // GetMainWindowHandle
@@ -42,7 +51,7 @@ HWND GetMainWindowHandle(DWORD processID) {
 // GetWindowHandleByFileName
 // -------------------------------------------------------------------------
 struct CallbackData {
-    std::wstring fileName;
+    std::wstring fileName;  // Lowercased, without a .lnk extension.
     HWND hwndFound;
 };
 
@@ -50,17 +59,12 @@ static BOOL CALLBACK EnumProcFile(HWND hwnd, LPARAM lParam) {
     CallbackData* pData = reinterpret_cast<CallbackData*>(lParam);
     int len = GetWindowTextLength(hwnd);
     if (len > 0) {
-        std::wstring title(len + 1, L'\0');
-        GetWindowText(hwnd, &title[0], len + 1);
-        title.resize(wcslen(title.c_str()));
-        std::wstring titleLower = title;
-        for (auto &c : titleLower) c = towlower(c);
-        
-        std::wstring fileLower = pData->fileName;
-        for (auto &c : fileLower) c = towlower(c);
-        fileLower = StripLnkExtension(fileLower);
-        
-        if (!fileLower.empty() && titleLower.find(fileLower) != std::wstring::npos) {
+        // Titles are read into a reused buffer and matched in place.
+        thread_local std::vector<wchar_t> title;
+        if (title.size() < static_cast<size_t>(len) + 1)
+            title.resize(len + 1);
+        int copied = GetWindowText(hwnd, title.data(), len + 1);
+        if (copied > 0 && ContainsNoCase(title.data(), copied, pData->fileName)) {
             pData->hwndFound = hwnd;
             return FALSE;
         }
@@ -69,7 +73,11 @@ static BOOL CALLBACK EnumProcFile(HWND hwnd, LPARAM lParam) {
 }
 
 HWND GetWindowHandleByFileName(const std::wstring &fileName) {
-    CallbackData data = { fileName, nullptr };
+    std::wstring fileLower = fileName;
+    FoldNoCase(fileLower);
+    CallbackData data = { StripLnkExtension(fileLower), nullptr };
+    if (data.fileName.empty())
+        return nullptr;
     EnumWindows(EnumProcFile, reinterpret_cast<LPARAM>(&data));
     return data.hwndFound;
 }
@@ -103,42 +111,4 @@ bool IsFileWindowOpen(const std::wstring &fileName) {
     return data.found;
 }
 
-// -------------------------------------------------------------------------
-// GetPowerPointWindow
-// -------------------------------------------------------------------------
-HWND GetPowerPointWindow() {
-    HWND pptHwnd = nullptr;
-    EnumWindows([](HWND hwnd, LPARAM lParam) -> BOOL {
-         wchar_t className[256] = {0};
-         if (GetClassName(hwnd, className, 256)) {
-              std::wstring cls(className);
-              if (cls == L"PPTFrameClass") {
-                   *((HWND*)lParam) = hwnd;
-                   return FALSE;
-              }
-         }
-         return TRUE;
-    }, reinterpret_cast<LPARAM>(&pptHwnd));
-    return pptHwnd;
-}
-
-// -------------------------------------------------------------------------
-// GetWordWindow
-// -------------------------------------------------------------------------
-HWND GetWordWindow() {
-    HWND wordHwnd = nullptr;
-    EnumWindows([](HWND hwnd, LPARAM lParam) -> BOOL {
-         wchar_t className[256] = {0};
-         if (GetClassName(hwnd, className, 256)) {
-              std::wstring cls(className);
-              if (cls == L"OpusApp") {
-                   *((HWND*)lParam) = hwnd;
-                   return FALSE;
-              }
-         }
-         return TRUE;
-    }, reinterpret_cast<LPARAM>(&wordHwnd));
-    return wordHwnd;
-}
-
-// End of file: WindowUtils.cpp (Version: 1.0)
+// End of file: WindowUtils.cpp (Version: 1.2)
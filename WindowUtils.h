@@ -1,14 +1,16 @@
 // File: WindowUtils.h
-// Version: 1.0 (Phase 3.2: Window Utility Functions extracted)
+// Version: 1.1 (Resolver registry)
 // -------------------------------------------------------------------------
 // This header declares window utility functions used to locate and match
 // system windows. Functions include:
 //   - GetMainWindowHandle()
 //   - GetWindowHandleByFileName()
 //   - IsFileWindowOpen()
-//   - GetPowerPointWindow()
-//   - GetWordWindow()
 // Additionally, an inline helper StripLnkExtension() is provided.
+//
+// Changes in Version 1.1:
+//  - GetPowerPointWindow() and GetWordWindow() were replaced by the rules of
+//    WindowResolverRegistry (WindowResolver.h).
 // -------------------------------------------------------------------------
 
 #ifndef WINDOWUTILS_H
@@ -26,12 +28,6 @@ HWND GetWindowHandleByFileName(const std::wstring &fileName);
 // Checks if any window with a title containing fileName is open.
 bool IsFileWindowOpen(const std::wstring &fileName);
 
-// Returns the handle of the PowerPoint window (if found).
-HWND GetPowerPointWindow();
-
-// Returns the handle of the Word window (if found).
-HWND GetWordWindow();
-
 // Inline function to strip the ".lnk" extension from a file name.
 inline std::wstring StripLnkExtension(const std::wstring &fileLower) {
     static const std::wstring lnkExt = L".lnk";
@@ -44,4 +40,4 @@ inline std::wstring StripLnkExtension(const std::wstring &fileLower) {
 
 #endif // WINDOWUTILS_H
 
-// End of file: WindowUtils.h (Version: 1.0)
+// End of file: WindowUtils.h (Version: 1.1)
@@ -0,0 +1,81 @@
+// File: WorkspaceLayout.cpp
+// Version: 1.0
+// -------------------------------------------------------------------------
+// This file implements ApplyWorkspaceLayout() (see WorkspaceLayout.h).
+// -------------------------------------------------------------------------
+
+#include "WorkspaceLayout.h"
+
+// Restores a minimized window without activating it, at rect.
+static void RestoreMinimized(HWND hwnd, const RECT &rect) {
+    WINDOWPLACEMENT wp{};
+    wp.length = sizeof(WINDOWPLACEMENT);
+    if (!GetWindowPlacement(hwnd, &wp))
+        return;
+    // rcNormalPosition is in workspace coordinates: relative to the work area
+    // of the monitor rather than to the whole screen.
+    MONITORINFO mi{};
+    mi.cbSize = sizeof(MONITORINFO);
+    LONG dx = 0, dy = 0;
+    if (GetMonitorInfo(MonitorFromRect(&rect, MONITOR_DEFAULTTONEAREST), &mi)) {
+        dx = mi.rcWork.left - mi.rcMonitor.left;
+        dy = mi.rcWork.top - mi.rcMonitor.top;
+    }
+    wp.rcNormalPosition = rect;
+    OffsetRect(&wp.rcNormalPosition, -dx, -dy);
+    wp.showCmd = SW_SHOWNOACTIVATE;
+    wp.flags = 0;
+    SetWindowPlacement(hwnd, &wp);
+}
+
+// SetWindowPos flags of one placement; maximized windows are only restacked.
+static UINT GetPlacementFlags(HWND hwnd) {
+    UINT flags = SWP_NOACTIVATE | SWP_NOOWNERZORDER;
+    if (IsZoomed(hwnd))
+        flags |= SWP_NOMOVE | SWP_NOSIZE;
+    return flags;
+}
+
+int ApplyWorkspaceLayout(const std::vector<WorkspacePlacement> &placements) {
+    std::vector<const WorkspacePlacement*> live;
+    live.reserve(placements.size());
+    for (const auto &placement : placements) {
+        if (!IsWindow(placement.hwnd))
+            continue;
+        if (IsIconic(placement.hwnd))
+            RestoreMinimized(placement.hwnd, placement.rect);
+        live.push_back(&placement);
+    }
+    if (live.empty())
+        return 0;
+
+    // Every window is inserted below the previous one; the first goes on top.
+    HDWP hdwp = BeginDeferWindowPos(static_cast<int>(live.size()));
+    HWND insertAfter = HWND_TOP;
+    for (const WorkspacePlacement *placement : live) {
+        if (!hdwp)
+            break;
+        const RECT &r = placement->rect;
+        // A failed DeferWindowPos() releases the batch and returns nullptr.
+        hdwp = DeferWindowPos(hdwp, placement->hwnd, insertAfter, r.left, r.top,
+                              r.right - r.left, r.bottom - r.top, GetPlacementFlags(placement->hwnd));
+        insertAfter = placement->hwnd;
+    }
+    if (hdwp && EndDeferWindowPos(hdwp))
+        return static_cast<int>(live.size());
+
+    // The batch failed as a whole; position the windows one by one without
+    // waiting for their threads.
+    int positioned = 0;
+    insertAfter = HWND_TOP;
+    for (const WorkspacePlacement *placement : live) {
+        const RECT &r = placement->rect;
+        if (SetWindowPos(placement->hwnd, insertAfter, r.left, r.top, r.right - r.left, r.bottom - r.top,
+                         GetPlacementFlags(placement->hwnd) | SWP_ASYNCWINDOWPOS))
+            ++positioned;
+        insertAfter = placement->hwnd;
+    }
+    return positioned;
+}
+
+// End of file: WorkspaceLayout.cpp (Version: 1.0)
@@ -0,0 +1,40 @@
+// File: WorkspaceLayout.h
+// Version: 1.0
+// -------------------------------------------------------------------------
+// This header declares ApplyWorkspaceLayout(), which moves, sizes and
+// stacks a set of top-level windows in one BeginDeferWindowPos /
+// EndDeferWindowPos batch, so the desktop repaints once instead of once per
+// window.
+//
+// Minimized windows are restored without activation first (with their
+// normal position set to the target rectangle, so they do not flash at the
+// old one). Maximized windows keep their size and only take part in the
+// z-order change. If the batch is rejected as a whole (e.g. one window
+// belongs to an elevated process), each window is positioned on its own
+// with SWP_ASYNCWINDOWPOS instead.
+// -------------------------------------------------------------------------
+
+#ifndef WORKSPACELAYOUT_H
+#define WORKSPACELAYOUT_H
+
+#include <windows.h>
+#include <vector>
+
+/**
+ * @struct WorkspacePlacement
+ * @brief Target screen rectangle of one window.
+ */
+struct WorkspacePlacement {
+    HWND hwnd;
+    RECT rect;  ///< Screen coordinates, as returned by GetWindowRect().
+};
+
+// Applies placements in one batch. placements[0] ends up on top of the
+// other windows of the set, which are stacked below it in order; windows
+// are not activated. Destroyed windows are skipped.
+// Returns the number of windows positioned.
+int ApplyWorkspaceLayout(const std::vector<WorkspacePlacement> &placements);
+
+#endif // WORKSPACELAYOUT_H
+
+// End of file: WorkspaceLayout.h (Version: 1.0)
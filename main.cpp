@@ -1,14 +1,53 @@
 // File: main.cpp
-// Version: 1.4
+// Version: 1.7
+// -------------------------------------------------------------------------
+// Entry point. "MYexplorer.exe --headless [file ...]" runs the tracking
+// engine without any UI (see HeadlessHost.h); otherwise the main window is
+// created. Both register the ETW provider (Tracing.h) for their lifetime.
+// -------------------------------------------------------------------------
 
 #include <windows.h>
 #include "MainWindow.h"
+#include "HeadlessHost.h"
+#include "Tracing.h"
 #include <commctrl.h>
+#include <shellapi.h>
+#include <string>
+#include <vector>
 
-int APIENTRY wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmdLine, int nCmdShow)
+// Returns true if the command line starts with --headless; the remaining
+// arguments are returned in files.
+static bool ParseHeadlessArgs(std::vector<std::wstring> &files) {
+    int argc = 0;
+    LPWSTR *argv = CommandLineToArgvW(GetCommandLineW(), &argc);
+    if (!argv)
+        return false;
+    bool headless = argc >= 2 && lstrcmpiW(argv[1], L"--headless") == 0;
+    for (int i = 2; headless && i < argc; ++i)
+        files.push_back(argv[i]);
+    LocalFree(argv);
+    return headless;
+}
+
+// Runs the application; wWinMain wraps it in the tracing registration.
+static int Run()
 {
-    // Initialize common controls (for the ListView control)
-    INITCOMMONCONTROLSEX icex = { sizeof(icex), ICC_LISTVIEW_CLASSES };
+    std::vector<std::wstring> files;
+    if (ParseHeadlessArgs(files)) {
+        // No common controls, ListViews or WebView2 in headless mode.
+        HeadlessHost host;
+        if (!host.Create(files))
+            return 1;
+        MSG msg;
+        while (GetMessage(&msg, nullptr, 0, 0)) {
+            TranslateMessage(&msg);
+            DispatchMessage(&msg);
+        }
+        return static_cast<int>(msg.wParam);
+    }
+
+    // Initialize common controls (ListViews, and the launcher bar's toolbar and pager)
+    INITCOMMONCONTROLSEX icex = { sizeof(icex), ICC_LISTVIEW_CLASSES | ICC_BAR_CLASSES | ICC_PAGESCROLLER_CLASS };
     InitCommonControlsEx(&icex);
 
     // Create and show the main window with increased dimensions.
@@ -35,3 +74,11 @@ int APIENTRY wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmd
     }
     return static_cast<int>(msg.wParam);
 }
+
+int APIENTRY wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmdLine, int nCmdShow)
+{
+    RegisterTracing();
+    int exitCode = Run();
+    UnregisterTracing();
+    return exitCode;
+}